@@ -0,0 +1,73 @@
+/**
+ * File: access-log-stats.cpp
+ * --------------------------
+ * Runs the query-map extraction over a whole access log (one URL per
+ * line) and reports which parameter keys turned up most often, about
+ * how many distinct values each one took on and which value was most
+ * common, and how quickly and in how much memory the log was processed.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include "genlib.h"
+#include "simpio.h"
+#include "vector.h"
+#include "access-log.h"
+
+static const int kNumKeysToReport = 20;
+
+/**
+ * Prints the throughput and memory numbers for a pass over a log,
+ * followed by a table of the most frequent keys.
+ *
+ * @param AccessLogStats& stats the tallies for the log.
+ * @param logRunT run the timing and memory use for the pass.
+ * @return void
+ */
+
+void PrintReport(AccessLogStats & stats, logRunT run) {
+	double seconds = (run.seconds > 0) ? run.seconds : 1e-9;
+	cout << fixed << setprecision(1);
+	cout << run.lines << " lines (" << stats.getParameterCount()
+	     << " parameters) in " << setprecision(3) << run.seconds << "s on "
+	     << run.numThreads << " threads" << endl;
+	cout << setprecision(0) << run.lines / seconds << " lines/s, "
+	     << setprecision(1) << run.bytes / seconds / (1 << 20) << " MB/s, "
+	     << "peak memory " << run.peakMemory / double(1 << 20) << " MB" << endl;
+
+	Vector<string> keys = stats.getKeysByFrequency();
+	int numKeys = (keys.size() < kNumKeysToReport) ? keys.size() : kNumKeysToReport;
+	cout << endl << "Top " << numKeys << " of " << keys.size() << " keys:" << endl;
+	cout << "  " << left << setw(24) << "key" << right << setw(14) << "occurrences"
+	     << setw(16) << "~distinct values" << "  most common value" << endl;
+	for (int i = 0; i < numKeys; i++) {
+		Vector<heavyHitterT> top = stats.getTopValues(keys[i], 1);
+		cout << "  " << left << setw(24) << keys[i] << right
+		     << setw(14) << stats.getOccurrences(keys[i])
+		     << setw(16) << stats.getCardinality(keys[i]) << "  ";
+		if (!top.isEmpty()) {
+			cout << "\"" << top[0].item << "\" (~" << top[0].count << ")";
+		}
+		cout << endl;
+	}
+	cout << endl;
+}
+
+/**
+ * Asks for the names of access logs and reports on each one in turn.
+ *
+ * @return int 0, when the user enters a blank line.
+ */
+
+int main() {
+	while (true) {
+		cout << "Access log? [hit enter to quit]: ";
+		string filename = GetLine();
+		if (filename.empty()) break;
+		AccessLogStats stats;
+		logRunT run = ProcessAccessLog(filename, stats);
+		PrintReport(stats, run);
+	}
+
+	return 0;
+}
@@ -0,0 +1,275 @@
+/**
+ * File: access-log.cpp
+ * --------------------
+ * Implements the AccessLogStats tallies and the threaded log reader
+ * exported by access-log.h.
+ */
+
+#include "genlib.h"
+#include "access-log.h"
+#include "delimiter-scan.h"
+#include "url-query.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+AccessLogStats::AccessLogStats() {
+	numURLs = 0;
+	numParameters = 0;
+}
+
+/**
+ * Implementation notes: addURL
+ * ----------------------------
+ * The key is copied into keyBuffer rather than into a fresh string so
+ * that its storage is reused from one parameter to the next, and the
+ * key=value pair for the CountMinSketch is built in pairBuffer the
+ * same way.  Only the values a SpaceSaving summary starts tracking end
+ * up being allocated.
+ */
+
+void AccessLogStats::addURL(string_view url) {
+	numURLs++;
+	QueryTokenizer tokenizer(url);
+	while (tokenizer.hasNext()) {
+		queryParameter param = tokenizer.next();
+		if (param.key.empty() && param.value.empty()) continue;
+		numParameters++;
+		keyBuffer.assign(param.key.data(), param.key.size());
+		keyStatsT & entry = keys[keyBuffer];
+		entry.occurrences++;
+		entry.distinctValues.add(param.value);
+		entry.topValues.add(param.value);
+		pairBuffer.assign(keyBuffer);
+		pairBuffer += '=';
+		pairBuffer.append(param.value.data(), param.value.size());
+		pairCounts.add(pairBuffer);
+	}
+}
+
+void AccessLogStats::merge(AccessLogStats & other) {
+	numURLs += other.numURLs;
+	numParameters += other.numParameters;
+	for (const string & key : other.keys) {
+		keyStatsT & theirs = other.keys[key];
+		keyStatsT & ours = keys[key];
+		ours.occurrences += theirs.occurrences;
+		ours.distinctValues.merge(theirs.distinctValues);
+		ours.topValues.merge(theirs.topValues);
+	}
+	pairCounts.merge(other.pairCounts);
+}
+
+long AccessLogStats::getURLCount() {
+	return numURLs;
+}
+
+long AccessLogStats::getParameterCount() {
+	return numParameters;
+}
+
+Vector<string> AccessLogStats::getKeysByFrequency() {
+	std::vector<std::pair<long, string> > ranked;
+	for (const string & key : keys) {
+		ranked.push_back(std::make_pair(-keys[key].occurrences, key));
+	}
+	std::sort(ranked.begin(), ranked.end());
+	Vector<string> result;
+	for (size_t i = 0; i < ranked.size(); i++) {
+		result.add(ranked[i].second);
+	}
+	return result;
+}
+
+long AccessLogStats::getOccurrences(string key) {
+	if (!keys.containsKey(key)) return 0;
+	return keys[key].occurrences;
+}
+
+long AccessLogStats::getCardinality(string key) {
+	if (!keys.containsKey(key)) return 0;
+	return keys[key].distinctValues.estimate();
+}
+
+Vector<heavyHitterT> AccessLogStats::getTopValues(string key, int k) {
+	if (!keys.containsKey(key)) return Vector<heavyHitterT>();
+	return keys[key].topValues.topK(k);
+}
+
+long AccessLogStats::getValueFrequency(string key, string value) {
+	return pairCounts.estimate(key + "=" + value);
+}
+
+/**
+ * Type: logReaderT
+ * ----------------
+ * The state the worker threads share: the open log, and the partial
+ * line left over at the end of the last chunk read, which belongs at
+ * the front of the next one.  Everything here is guarded by lock.
+ */
+
+struct logReaderT {
+	FILE *file;
+	bool atEnd;
+	string carry;
+	long bytesRead;
+	std::mutex lock;
+};
+
+/**
+ * Fills buffer with the next run of whole lines from the log and sets
+ * length to the number of bytes they occupy, or returns false if the
+ * log is exhausted.  The read itself happens under the reader's lock,
+ * which keeps the file position and the carried-over partial line
+ * consistent; the caller parses the lines after the lock is released.
+ * A line longer than chunkSize is handled by reading more until its
+ * newline (or the end of the file) turns up.
+ */
+
+static bool ReadLogChunk(logReaderT & reader, string & buffer,
+                         size_t chunkSize, size_t & length) {
+	std::lock_guard<std::mutex> guard(reader.lock);
+	buffer.assign(reader.carry);
+	reader.carry.clear();
+	while (true) {
+		if (!reader.atEnd) {
+			size_t start = buffer.size();
+			size_t wanted = (start < chunkSize) ? chunkSize - start : start;
+			buffer.resize(start + wanted);
+			size_t got = fread(&buffer[start], 1, wanted, reader.file);
+			buffer.resize(start + got);
+			reader.bytesRead += got;
+			if (got < wanted) reader.atEnd = true;
+		}
+		size_t lastNewline = buffer.rfind('\n');
+		if (lastNewline != string::npos) {
+			reader.carry.assign(buffer, lastNewline + 1, string::npos);
+			length = lastNewline + 1;
+			return true;
+		}
+		if (reader.atEnd) {
+			length = buffer.size();
+			return length > 0;
+		}
+	}
+}
+
+/**
+ * Tallies each line in chunk into stats and returns the number of
+ * lines seen, blank ones included.  The line breaks are found by the
+ * same block scanner the query tokenizer uses.
+ */
+
+static long TallyLines(string_view chunk, AccessLogStats & stats) {
+	DelimiterScanner scanner(chunk, "\n");
+	const char *lineStart = chunk.data();
+	const char *chunkEnd = chunk.data() + chunk.size();
+	long lines = 0;
+	while (lineStart < chunkEnd) {
+		const char *lineEnd = scanner.nextDelimiter();
+		const char *next = (lineEnd == NULL) ? chunkEnd : lineEnd + 1;
+		if (lineEnd == NULL) lineEnd = chunkEnd;
+		if (lineEnd > lineStart && lineEnd[-1] == '\r') lineEnd--;
+		if (lineEnd > lineStart) {
+			stats.addURL(string_view(lineStart, lineEnd - lineStart));
+		}
+		lines++;
+		lineStart = next;
+	}
+	return lines;
+}
+
+/**
+ * The body of each worker thread: keep claiming chunks and tallying
+ * them until the log runs out.  Every thread has its own buffer and its
+ * own stats, so the reader's lock is the only thing they contend for.
+ */
+
+static void TallyLogChunks(logReaderT *reader, AccessLogStats *stats,
+                           size_t chunkSize, long *lines) {
+	string buffer;
+	size_t length;
+	while (ReadLogChunk(*reader, buffer, chunkSize, length)) {
+		*lines += TallyLines(string_view(buffer.data(), length), *stats);
+	}
+}
+
+/**
+ * Implementation notes: ProcessAccessLog
+ * --------------------------------------
+ * The calling thread works alongside the numThreads - 1 it starts,
+ * tallying straight into stats; the others tally into partials of
+ * their own, which are merged into stats once everyone is joined.
+ */
+
+logRunT ProcessAccessLog(string filename, AccessLogStats & stats,
+                         int numThreads, int chunkSize) {
+	if (chunkSize <= 0) Error("ProcessAccessLog: chunk size must be positive");
+	logReaderT reader;
+	reader.file = fopen(filename.c_str(), "rb");
+	if (reader.file == NULL) Error("ProcessAccessLog: can't open " + filename);
+	reader.atEnd = false;
+	reader.bytesRead = 0;
+	if (numThreads <= 0) numThreads = std::thread::hardware_concurrency();
+	if (numThreads <= 0) numThreads = 1;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	AccessLogStats *partials = new AccessLogStats[numThreads];
+	long *lines = new long[numThreads];
+	std::thread *workers = new std::thread[numThreads];
+	for (int i = 0; i < numThreads; i++) {
+		lines[i] = 0;
+	}
+	for (int i = 1; i < numThreads; i++) {
+		workers[i] = std::thread(TallyLogChunks, &reader, &partials[i],
+		                         (size_t) chunkSize, &lines[i]);
+	}
+	TallyLogChunks(&reader, &stats, chunkSize, &lines[0]);
+	for (int i = 1; i < numThreads; i++) {
+		workers[i].join();
+	}
+	logRunT run;
+	run.lines = lines[0];
+	for (int i = 1; i < numThreads; i++) {
+		stats.merge(partials[i]);
+		run.lines += lines[i];
+	}
+	delete[] workers;
+	delete[] lines;
+	delete[] partials;
+	fclose(reader.file);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	run.bytes = reader.bytesRead;
+	run.seconds = elapsed.count();
+	run.numThreads = numThreads;
+	run.peakMemory = PeakMemoryUsage();
+	return run;
+}
+
+long PeakMemoryUsage() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return (long) counters.PeakWorkingSetSize;
+#elif defined(__APPLE__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	return usage.ru_maxrss;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	return usage.ru_maxrss * 1024L;
+#endif
+}
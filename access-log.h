@@ -0,0 +1,190 @@
+/**
+ * File: access-log.h
+ * ------------------
+ * Exports the pieces of a tool that runs query-map extraction over
+ * an entire web server access log, one URL per line.  The log is read
+ * in large chunks and the lines in each chunk are parsed by a pool of
+ * threads, each of which tallies what it sees into its own
+ * AccessLogStats; the per-thread tallies are merged once at the end.
+ * Value cardinalities and frequencies are tracked with the fixed-size
+ * sketches from frequency-sketches.h, so memory use depends on the
+ * number of distinct keys but not on the size of the log.
+ */
+
+#ifndef __access_log__
+#define __access_log__
+
+#include "genlib.h"
+#include "map.h"
+#include "vector.h"
+#include "frequency-sketches.h"
+#include <string_view>
+
+/**
+ * Type: keyStatsT
+ * ---------------
+ * Everything we know about one query parameter key: the number of
+ * times it appeared across the log, a HyperLogLog estimating how many
+ * distinct values it appeared with, and a SpaceSaving summary of its
+ * most common values.  A key with no value contributes the empty
+ * string as its value.
+ */
+
+struct keyStatsT {
+	long occurrences;
+	HyperLogLog distinctValues;
+	SpaceSaving topValues;
+};
+
+/**
+ * Class: AccessLogStats
+ * ---------------------
+ * Accumulates key frequencies and value cardinalities over a series
+ * of URLs.  Each worker thread owns one of these, so none of the
+ * methods lock; merge folds one worker's tallies into another's.
+ */
+
+class AccessLogStats {
+public:
+
+/**
+ * Constructs an empty set of tallies.
+ */
+	AccessLogStats();
+
+/**
+ * Tallies the query parameters of a single URL.  Empty pairs (as in
+ * "?a=1&&b=2") are not counted as parameters.
+ *
+ * @param string_view url the URL to be tallied.
+ */
+	void addURL(string_view url);
+
+/**
+ * Adds all of the tallies in other to this one.  other is left
+ * unchanged.
+ *
+ * @param AccessLogStats& other the tallies to be folded in.
+ */
+	void merge(AccessLogStats & other);
+
+/**
+ * Returns the number of URLs tallied, including those with no
+ * query string.
+ *
+ * @return long the number of URLs passed to addURL.
+ */
+	long getURLCount();
+
+/**
+ * Returns the total number of parameters seen across every URL.
+ *
+ * @return long the number of parameters tallied.
+ */
+	long getParameterCount();
+
+/**
+ * Returns every key seen, most frequent first.  Keys that appeared
+ * equally often are listed alphabetically.
+ *
+ * @return Vector<string> the keys, ordered by frequency.
+ */
+	Vector<string> getKeysByFrequency();
+
+/**
+ * Returns the number of times the given key appeared, or 0 if it
+ * never did.
+ *
+ * @param string key the key of interest.
+ * @return long the number of occurrences of key.
+ */
+	long getOccurrences(string key);
+
+/**
+ * Returns an estimate of the number of distinct values the given key
+ * appeared with, or 0 if it never appeared.  The estimate is usually
+ * within 2% of the true count.
+ *
+ * @param string key the key of interest.
+ * @return long the estimated number of distinct values for key.
+ */
+	long getCardinality(string key);
+
+/**
+ * Returns up to k of the values the given key appeared with most
+ * often, most frequent first, each with an upper bound on its count
+ * and the most by which that bound may be off.
+ *
+ * @param string key the key of interest.
+ * @param int k the number of values wanted.
+ * @return Vector<heavyHitterT> the key's most frequent values.
+ */
+	Vector<heavyHitterT> getTopValues(string key, int k);
+
+/**
+ * Returns an estimate of the number of times key appeared with the
+ * given value.  The estimate is never too low.
+ *
+ * @param string key the key of interest.
+ * @param string value the value of interest.
+ * @return long an upper bound on the number of times key=value appeared.
+ */
+	long getValueFrequency(string key, string value);
+
+private:
+	long numURLs;
+	long numParameters;
+	Map<keyStatsT> keys;
+	CountMinSketch pairCounts;
+	string keyBuffer;
+	string pairBuffer;
+};
+
+/**
+ * Type: logRunT
+ * -------------
+ * Describes how a pass over a log went: how many lines and bytes
+ * were processed, how long it took, how many threads did the work,
+ * and the process's peak memory use (in bytes) by the time it was
+ * done.
+ */
+
+struct logRunT {
+	long lines;
+	long bytes;
+	double seconds;
+	int numThreads;
+	long peakMemory;
+};
+
+/**
+ * Reads the named log and tallies every line of it into stats, which
+ * should start out empty.  Each line holds one URL; trailing carriage
+ * returns and blank lines are ignored.  The file is read chunkSize
+ * bytes at a time by whichever thread is ready for more work, so no
+ * more than about numThreads * chunkSize bytes of the log are in memory
+ * at once, however large it is.  A numThreads of 0 means one thread per
+ * processor.  Raises an error if the file can't be opened.
+ *
+ * @param string filename the name of the access log.
+ * @param AccessLogStats& stats the tallies the log is added to.
+ * @param int numThreads the number of threads to use, or 0.
+ * @param int chunkSize the number of bytes to read at a time.
+ * @return logRunT the line count, timing and memory use of the pass.
+ */
+
+static const int kDefaultLogChunkSize = 4 << 20;
+
+logRunT ProcessAccessLog(string filename, AccessLogStats & stats,
+                         int numThreads = 0, int chunkSize = kDefaultLogChunkSize);
+
+/**
+ * Returns the largest amount of memory, in bytes, that this process has
+ * had resident at any point so far, or 0 if the platform doesn't say.
+ *
+ * @return long the memory high-water mark, in bytes.
+ */
+
+long PeakMemoryUsage();
+
+#endif
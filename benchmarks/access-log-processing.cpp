@@ -0,0 +1,112 @@
+/**
+ * File: access-log-processing.cpp
+ * -------------------------------
+ * Writes a synthetic access log to disk and measures how quickly
+ * ProcessAccessLog gets through it as the number of threads grows,
+ * checking along the way that every thread count arrives at the same
+ * tallies.  Keys are drawn from a fixed pool with a skewed popularity,
+ * and each key has its own value cardinality, from a handful of
+ * languages up to effectively unique session ids.
+ */
+
+#include "genlib.h"
+#include "random.h"
+#include "vector.h"
+#include "access-log.h"
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+static const int kNumLines = 1000000;
+static const char *const kLogFile = "access-log-bench.log";
+
+/**
+ * Type: keySpecT
+ * --------------
+ * One key in the synthetic pool, the number of distinct values it can
+ * take on, and how likely a URL is to carry it.
+ */
+
+struct keySpecT {
+	const char *key;
+	int cardinality;
+	double probability;
+};
+
+static const keySpecT kKeys[] = {
+	{ "utm_source", 40, 0.6 },
+	{ "utm_medium", 8, 0.55 },
+	{ "utm_campaign", 2000, 0.5 },
+	{ "lang", 12, 0.45 },
+	{ "page", 500, 0.4 },
+	{ "q", 200000, 0.3 },
+	{ "session", 1000000000, 0.25 },
+	{ "ref", 50000, 0.2 },
+	{ "debug", 1, 0.02 },
+	{ "id", 5000000, 0.15 },
+	{ "sort", 4, 0.1 },
+	{ "format", 3, 0.05 },
+};
+
+static string RandomURL() {
+	string url = "http://www.example.com/products/";
+	url += IntegerToString(RandomInteger(0, 999));
+	char separator = '?';
+	for (int i = 0; i < (int) (sizeof(kKeys) / sizeof(kKeys[0])); i++) {
+		if (!RandomChance(kKeys[i].probability)) continue;
+		url += separator;
+		url += kKeys[i].key;
+		if (kKeys[i].cardinality > 1) {
+			url += "=v" + IntegerToString(RandomInteger(0, kKeys[i].cardinality - 1));
+		}
+		separator = '&';
+	}
+	return url;
+}
+
+static void WriteSyntheticLog() {
+	FILE *out = fopen(kLogFile, "wb");
+	if (out == NULL) Error("Can't write " + string(kLogFile));
+	for (int i = 0; i < kNumLines; i++) {
+		string line = RandomURL() + "\n";
+		fwrite(line.data(), 1, line.size(), out);
+	}
+	fclose(out);
+}
+
+/**
+ * Returns a checksum over the tallies that every thread count should
+ * agree on.
+ */
+
+static long Checksum(AccessLogStats & stats) {
+	long checksum = stats.getURLCount() + stats.getParameterCount();
+	Vector<string> keys = stats.getKeysByFrequency();
+	for (int i = 0; i < keys.size(); i++) {
+		checksum = checksum * 31 + stats.getOccurrences(keys[i]) * 7 + stats.getCardinality(keys[i]);
+	}
+	return checksum;
+}
+
+int main() {
+	SetRandomSeed(106);
+	WriteSyntheticLog();
+	cout << "Processing a " << kNumLines << "-line synthetic access log." << endl;
+
+	int maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads <= 0) maxThreads = 1;
+	long expected = 0;
+	for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+		AccessLogStats stats;
+		logRunT run = ProcessAccessLog(kLogFile, stats, numThreads);
+		long checksum = Checksum(stats);
+		if (numThreads == 1) expected = checksum;
+		cout << "  " << numThreads << " threads: "
+		     << run.lines / run.seconds / 1e6 << "M lines/s, "
+		     << run.bytes / run.seconds / (1 << 20) << " MB/s, peak memory "
+		     << run.peakMemory / (1 << 20) << " MB"
+		     << ((checksum == expected) ? "" : "  ** MISMATCH **") << endl;
+	}
+	remove(kLogFile);
+	return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * File: bst-bulk-ops.cpp
+ * ----------------------
+ * Times the BST operations that work on whole trees at once against
+ * the element-at-a-time code they replace:
+ *
+ *   copy    the copy constructor, which used to add the elements of
+ *           the original to the new tree one by one and now clones the
+ *           original node for node.
+ *   join    joinWith, against adding each element of the second tree
+ *           to the first.
+ *   split   splitAt, against adding each element at or past the key to
+ *           a new tree and removing it from the old one.
+ *
+ * Every result is checked against the element-at-a-time version.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "bst.h"
+#include "random.h"
+#include "vector.h"
+
+static const int kSizes[] = { 1000, 100000, 1000000 };
+static const int kMinElementsTimed = 2000000;
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, long count) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return 1e9 * elapsed.count() / count;
+}
+
+static void AddToTree(int elem, BST<int> & tree) {
+	tree.add(elem);
+}
+
+static bool SameElements(BST<int> & one, BST<int> & two) {
+	if (one.size() != two.size()) return false;
+	BST<int>::Iterator it1 = one.iterator();
+	BST<int>::Iterator it2 = two.iterator();
+	while (it1.hasNext()) {
+		if (it1.next() != it2.next()) return false;
+	}
+	return true;
+}
+
+/*
+ * Fills tree with size elements from [lo, lo + 2 * size), added in a
+ * random order.
+ */
+
+static void FillTree(BST<int> & tree, int lo, int size) {
+	Vector<int> elems;
+	for (int i = 0; i < size; i++) {
+		elems.add(lo + 2 * i + RandomInteger(0, 1));
+	}
+	for (int i = size - 1; i > 0; i--) {
+		int j = RandomInteger(0, i);
+		int tmp = elems[i];
+		elems[i] = elems[j];
+		elems[j] = tmp;
+	}
+	for (int i = 0; i < size; i++) {
+		tree.add(elems[i]);
+	}
+}
+
+static void PrintRow(string label, int size, double before, double after, bool agree) {
+	cout << setw(8) << label << setw(10) << size << fixed << setprecision(1)
+	     << setw(14) << before << setw(14) << after << setw(10)
+	     << before / after << "x" << (agree ? "" : "  DISAGREE") << endl;
+}
+
+/*
+ * The copy is timed per element; the element-at-a-time copy is the
+ * one the copy constructor used to make, through mapAll.
+ */
+
+static bool TimeCopy(int size) {
+	BST<int> original;
+	FillTree(original, 0, size);
+	int reps = (size < kMinElementsTimed) ? kMinElementsTimed / size : 1;
+	double before = 0, after = 0;
+	bool agree = true;
+	for (int r = 0; r < reps; r++) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		BST<int> added;
+		original.mapAll(AddToTree, added);
+		before += NanosecondsSince(start, size);
+		start = std::chrono::steady_clock::now();
+		BST<int> cloned(original);
+		after += NanosecondsSince(start, size);
+		if (r == 0) agree = SameElements(added, cloned);
+	}
+	PrintRow("copy", size, before / reps, after / reps, agree);
+	return agree;
+}
+
+/*
+ * Join and split are timed per call, on trees built fresh for each
+ * call outside the timed region.
+ */
+
+static void AddAll(BST<int> & tree, BST<int> & other) {
+	BST<int>::Iterator iter = other.iterator();
+	while (iter.hasNext()) {
+		tree.add(iter.next());
+	}
+	other.clear();
+}
+
+static void MoveFrom(BST<int> & tree, int key, BST<int> & rest) {
+	Vector<int> toMove;
+	BST<int>::Iterator iter = tree.iterator();
+	while (iter.hasNext()) {
+		int elem = iter.next();
+		if (elem >= key) toMove.add(elem);
+	}
+	rest.clear();
+	for (int i = 0; i < toMove.size(); i++) {
+		rest.add(toMove[i]);
+		tree.remove(toMove[i]);
+	}
+}
+
+static bool TimeJoinAndSplit(int size) {
+	int reps = (size < kMinElementsTimed / 10) ? kMinElementsTimed / 10 / size : 1;
+	double joinBefore = 0, joinAfter = 0, splitBefore = 0, splitAfter = 0;
+	bool joinAgree = true;
+	bool splitAgree = true;
+	for (int r = 0; r < reps; r++) {
+		BST<int> left1, right1;
+		FillTree(left1, 0, size);
+		FillTree(right1, 2 * size, size / 2);
+		BST<int> left2(left1), right2(right1);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		AddAll(left1, right1);
+		joinBefore += NanosecondsSince(start, 1);
+		start = std::chrono::steady_clock::now();
+		left2.joinWith(right2);
+		joinAfter += NanosecondsSince(start, 1);
+		joinAgree = joinAgree && SameElements(left1, left2) && right2.isEmpty();
+
+		int key = RandomInteger(0, 3 * size);
+		BST<int> rest1, rest2;
+		start = std::chrono::steady_clock::now();
+		MoveFrom(left1, key, rest1);
+		splitBefore += NanosecondsSince(start, 1);
+		start = std::chrono::steady_clock::now();
+		left2.splitAt(key, rest2);
+		splitAfter += NanosecondsSince(start, 1);
+		splitAgree = splitAgree && SameElements(left1, left2) && SameElements(rest1, rest2);
+	}
+	PrintRow("join", size, joinBefore / reps, joinAfter / reps, joinAgree);
+	PrintRow("split", size, splitBefore / reps, splitAfter / reps, splitAgree);
+	return joinAgree && splitAgree;
+}
+
+int main() {
+	SetRandomSeed(106);
+	cout << "copy: nanoseconds per element; join, split: nanoseconds per call" << endl;
+	cout << setw(8) << "op" << setw(10) << "size" << setw(14) << "per-element"
+	     << setw(14) << "bulk" << setw(11) << "speedup" << endl;
+	bool agree = true;
+	for (int i = 0; i < 3; i++) {
+		agree = TimeCopy(kSizes[i]) && agree;
+	}
+	for (int i = 0; i < 3; i++) {
+		agree = TimeJoinAndSplit(kSizes[i]) && agree;
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * File: bst-traversal.cpp
+ * -----------------------
+ * Times a full in-order walk over a BST of ten million ints, in each
+ * of the ways a client can make one: next(), which copies each
+ * element, nextRef(), which doesn't, the reverse iterator, a
+ * range-based for loop and mapAll.  The walk is made over two trees
+ * with the same elements: one built by adding them in random order,
+ * whose nodes are scattered through memory, and one built by
+ * buildFromSorted, whose nodes were allocated in order.  A B-tree with the same elements is walked too,
+ * for comparison.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "bst.h"
+#include "btree.h"
+#include "random.h"
+#include "vector.h"
+
+static const int kNumElements = 10000000;
+
+static long mapSum;
+
+static void AddToSum(int elem) {
+	mapSum += elem;
+}
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, long count) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return 1e9 * elapsed.count() / count;
+}
+
+/*
+ * Walks tree every way there is and prints the nanoseconds per element
+ * for each, returning false if any walk gets a different sum.
+ */
+
+template <typename TreeType>
+static bool TimeWalks(string label, TreeType & tree, long expected) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	long sum = 0;
+	typename TreeType::Iterator iter = tree.iterator();
+	while (iter.hasNext()) {
+		sum += iter.next();
+	}
+	double next = NanosecondsSince(start, tree.size());
+	bool agree = (sum == expected);
+
+	start = std::chrono::steady_clock::now();
+	sum = 0;
+	iter = tree.iterator();
+	while (iter.hasNext()) {
+		sum += iter.nextRef();
+	}
+	double nextRef = NanosecondsSince(start, tree.size());
+	agree = agree && (sum == expected);
+
+	start = std::chrono::steady_clock::now();
+	sum = 0;
+	iter = tree.reverseIterator();
+	while (iter.hasNext()) {
+		sum += iter.nextRef();
+	}
+	double reverse = NanosecondsSince(start, tree.size());
+	agree = agree && (sum == expected);
+
+	start = std::chrono::steady_clock::now();
+	sum = 0;
+	for (int elem : tree) {
+		sum += elem;
+	}
+	double rangeFor = NanosecondsSince(start, tree.size());
+	agree = agree && (sum == expected);
+
+	start = std::chrono::steady_clock::now();
+	mapSum = 0;
+	tree.mapAll(AddToSum);
+	double mapAll = NanosecondsSince(start, tree.size());
+	agree = agree && (mapSum == expected);
+
+	cout << setw(16) << label << fixed << setprecision(1) << setw(9) << next
+	     << setw(9) << nextRef << setw(9) << reverse << setw(9) << rangeFor
+	     << setw(9) << mapAll << (agree ? "" : "  DISAGREE") << endl;
+	return agree;
+}
+
+int main() {
+	SetRandomSeed(106);
+	Vector<int> elems;
+	long expected = 0;
+	for (int i = 0; i < kNumElements; i++) {
+		elems.add(i);
+		expected += i;
+	}
+	cout << "Nanoseconds per element for a walk over " << kNumElements << " elements" << endl;
+	cout << setw(16) << "tree" << setw(9) << "next" << setw(9) << "nextRef"
+	     << setw(9) << "reverse" << setw(9) << "for" << setw(9) << "mapAll" << endl;
+	bool agree = true;
+	{
+		BST<int> sorted;
+		Vector<int> copy = elems;
+		sorted.buildFromSorted(copy);
+		agree = TimeWalks("BST, sorted", sorted, expected) && agree;
+	}
+	{
+		Vector<int> shuffled = elems;
+		for (int i = shuffled.size() - 1; i > 0; i--) {
+			int j = RandomInteger(0, i);
+			int tmp = shuffled[i];
+			shuffled[i] = shuffled[j];
+			shuffled[j] = tmp;
+		}
+		BST<int> random;
+		for (int i = 0; i < shuffled.size(); i++) {
+			random.add(shuffled[i]);
+		}
+		agree = TimeWalks("BST, random", random, expected) && agree;
+	}
+	{
+		BTree<int> btree;
+		btree.buildFromSorted(elems);
+		agree = TimeWalks("BTree", btree, expected) && agree;
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
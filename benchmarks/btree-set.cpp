@@ -0,0 +1,162 @@
+/**
+ * File: btree-set.cpp
+ * -------------------
+ * Compares the two trees a Set can be kept in: the AVL tree from bst.h,
+ * which is the default, and the B+-tree from btree.h.  For each size
+ * from a thousand to ten million elements, the same shuffled keys are
+ * added to a Set<int> of each kind, looked up in a different order,
+ * walked with an iterator and then removed.  Set<string> is measured
+ * up to a million elements.  Every phase adds to a checksum, and the
+ * two kinds of set must agree on it.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "random.h"
+#include "set.h"
+#include "strutils.h"
+#include "vector.h"
+
+static const int kMinSize = 1000;
+static const int kMaxIntSize = 10000000;
+static const int kMaxStringSize = 1000000;
+static const int kMinElementsTimed = 2000000;
+
+/**
+ * The average cost of each phase, in nanoseconds per element.
+ */
+
+struct phaseTimesT {
+	double add;
+	double find;
+	double iterate;
+	double remove;
+};
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, long count) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return 1e9 * elapsed.count() / count;
+}
+
+/**
+ * Returns the keys 0 to size - 1 in random order, converted to the
+ * element type by MakeKey.
+ */
+
+static int MakeKey(int i, int *) {
+	return i;
+}
+
+static string MakeKey(int i, string *) {
+	return "key-" + IntegerToString(i * 7919 % 1000003) + "-" + IntegerToString(i);
+}
+
+template <typename ElemType>
+static Vector<ElemType> ShuffledKeys(int size) {
+	Vector<ElemType> keys(size);
+	for (int i = 0; i < size; i++) {
+		keys.add(MakeKey(i, (ElemType *) NULL));
+	}
+	for (int i = size - 1; i > 0; i--) {
+		int j = RandomInteger(0, i);
+		ElemType tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+	return keys;
+}
+
+static long Weight(int key) {
+	return key;
+}
+
+static long Weight(const string & key) {
+	return key.size();
+}
+
+/**
+ * Runs the four phases on a set of the given type, repeating them
+ * enough times that small sizes get a measurable total.
+ */
+
+template <typename SetType, typename ElemType>
+static phaseTimesT TimeSet(Vector<ElemType> & addOrder, Vector<ElemType> & findOrder,
+                           long & checksum) {
+	int size = addOrder.size();
+	int reps = (size < kMinElementsTimed) ? kMinElementsTimed / size : 1;
+	phaseTimesT times = { 0, 0, 0, 0 };
+	for (int r = 0; r < reps; r++) {
+		SetType set;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < size; i++) {
+			set.add(addOrder[i]);
+		}
+		times.add += NanosecondsSince(start, size);
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < size; i++) {
+			if (set.contains(findOrder[i])) checksum++;
+		}
+		times.find += NanosecondsSince(start, size);
+
+		start = std::chrono::steady_clock::now();
+		typename SetType::Iterator iter = set.iterator();
+		while (iter.hasNext()) {
+			checksum += Weight(iter.nextRef());
+		}
+		times.iterate += NanosecondsSince(start, size);
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < size; i++) {
+			set.remove(findOrder[i]);
+		}
+		times.remove += NanosecondsSince(start, size);
+		checksum += set.size();
+	}
+	times.add /= reps;
+	times.find /= reps;
+	times.iterate /= reps;
+	times.remove /= reps;
+	return times;
+}
+
+static void PrintRow(string label, int size, phaseTimesT avl, phaseTimesT btree) {
+	cout << setw(8) << label << setw(10) << size << fixed << setprecision(1)
+	     << setw(9) << avl.add << setw(8) << btree.add
+	     << setw(9) << avl.find << setw(8) << btree.find
+	     << setw(9) << avl.iterate << setw(8) << btree.iterate
+	     << setw(9) << avl.remove << setw(8) << btree.remove
+	     << setw(8) << avl.find / btree.find << "x" << endl;
+}
+
+template <typename ElemType>
+static bool RunSizes(string label, int maxSize) {
+	bool agree = true;
+	for (int size = kMinSize; size <= maxSize; size *= 10) {
+		Vector<ElemType> addOrder = ShuffledKeys<ElemType>(size);
+		Vector<ElemType> findOrder = ShuffledKeys<ElemType>(size);
+		long avlChecksum = 0;
+		long btreeChecksum = 0;
+		phaseTimesT avl = TimeSet< Set<ElemType>, ElemType >(addOrder, findOrder, avlChecksum);
+		phaseTimesT btree = TimeSet< Set<ElemType, BTree>, ElemType >(addOrder, findOrder,
+		                                                            btreeChecksum);
+		PrintRow(label, size, avl, btree);
+		if (avlChecksum != btreeChecksum) agree = false;
+	}
+	return agree;
+}
+
+int main() {
+	SetRandomSeed(106);
+	cout << "Nanoseconds per element, AVL tree (BST) vs B+-tree (BTree)" << endl;
+	cout << setw(8) << "type" << setw(10) << "size"
+	     << setw(17) << "add" << setw(17) << "contains"
+	     << setw(17) << "iterate" << setw(17) << "remove"
+	     << setw(9) << "find x" << endl;
+	bool agree = RunSizes<int>("int", kMaxIntSize);
+	agree = RunSizes<string>("string", kMaxStringSize) && agree;
+	cout << "Checksums " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * File: concurrent-queues.cpp
+ * ---------------------------
+ * Times how fast elements pass from producer threads to consumer
+ * threads for 1 to N producer/consumer pairs, where N is the number of
+ * cores (at least four).  Each producer sends two million integers,
+ * and each consumer receives as many.  The transfer is run three ways:
+ *
+ *   locked    one Queue shared by every thread and guarded by a
+ *             mutex, the way a Queue has to be shared without these
+ *             classes.
+ *   spsc      one SPSCQueue per pair, so no two producers or two
+ *             consumers ever touch the same queue.
+ *   mpmc      one MPMCQueue shared by every thread.
+ *
+ * Every queue holds at most 1024 elements, so producers wait for
+ * consumers whenever they get far ahead.  The figures are millions of
+ * elements moved per second.  With fewer cores than threads the
+ * threads take turns on the processor, and the figures show more about
+ * the cost of waiting than about contention.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "genlib.h"
+#include "queue.h"
+#include "spscqueue.h"
+#include "mpmcqueue.h"
+
+static const int kElementsPerProducer = 2000000;
+static const int kCapacity = 1024;
+static const int kSpinsBeforeYield = 64;
+
+/*
+ * A bounded Queue behind a mutex, with the same operations as the
+ * lock-free queues so the same code can drive all three.
+ */
+
+class LockedQueue {
+public:
+	bool tryEnqueue(long elem) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.size() >= kCapacity) return false;
+		queue.enqueue(elem);
+		return true;
+	}
+
+	bool tryDequeue(long & elem) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.isEmpty()) return false;
+		elem = queue.dequeue();
+		return true;
+	}
+
+	void enqueue(long elem) {
+		for (int tries = 0; !tryEnqueue(elem); tries++) {
+			if (tries >= kSpinsBeforeYield) std::this_thread::yield();
+		}
+	}
+
+	long dequeue() {
+		long elem;
+		for (int tries = 0; !tryDequeue(elem); tries++) {
+			if (tries >= kSpinsBeforeYield) std::this_thread::yield();
+		}
+		return elem;
+	}
+
+private:
+	std::mutex mutex;
+	Queue<long> queue;
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/*
+ * Runs pairs producers and pairs consumers, where producer i and
+ * consumer i use queue QueueFor(i).  Stores the sum of everything the
+ * consumers received in total and returns the elapsed time.
+ */
+
+template <typename QueueType, typename QueueFor>
+static double Transfer(int pairs, QueueFor queueFor, long & total) {
+	std::vector<long> sums(pairs, 0);
+	std::vector<std::thread> threads;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < pairs; i++) {
+		QueueType *queue = queueFor(i);
+		threads.push_back(std::thread([queue] {
+			for (long n = 0; n < kElementsPerProducer; n++) {
+				queue->enqueue(n);
+			}
+		}));
+		long *sum = &sums[i];
+		threads.push_back(std::thread([queue, sum] {
+			long s = 0;
+			for (long n = 0; n < kElementsPerProducer; n++) {
+				s += queue->dequeue();
+			}
+			*sum = s;
+		}));
+	}
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	double seconds = SecondsSince(start);
+	total = 0;
+	for (int i = 0; i < pairs; i++) {
+		total += sums[i];
+	}
+	return seconds;
+}
+
+static double Rate(int pairs, double seconds) {
+	return double(pairs) * kElementsPerProducer / seconds / 1e6;
+}
+
+int main() {
+	int maxPairs = std::max(4, int(std::thread::hardware_concurrency()));
+	long perProducer = long(kElementsPerProducer) * (kElementsPerProducer - 1) / 2;
+	cout << "Millions of elements per second, " << kElementsPerProducer
+	     << " per producer, on " << std::thread::hardware_concurrency() << " cores" << endl;
+	cout << setw(8) << "pairs" << setw(10) << "locked" << setw(10) << "spsc"
+	     << setw(10) << "mpmc" << endl;
+	cout << fixed << setprecision(2);
+	bool agree = true;
+	for (int pairs = 1; pairs <= maxPairs; pairs++) {
+		long expected = perProducer * pairs;
+		long total;
+
+		LockedQueue locked;
+		double lockedTime = Transfer<LockedQueue>(pairs,
+		                        [&locked](int) { return &locked; }, total);
+		agree = agree && total == expected;
+
+		std::vector<SPSCQueue<long> *> rings;
+		for (int i = 0; i < pairs; i++) {
+			rings.push_back(new SPSCQueue<long>(kCapacity));
+		}
+		double spscTime = Transfer< SPSCQueue<long> >(pairs,
+		                      [&rings](int i) { return rings[i]; }, total);
+		agree = agree && total == expected;
+		for (int i = 0; i < pairs; i++) {
+			delete rings[i];
+		}
+
+		MPMCQueue<long> shared(kCapacity);
+		double mpmcTime = Transfer< MPMCQueue<long> >(pairs,
+		                      [&shared](int) { return &shared; }, total);
+		agree = agree && total == expected;
+
+		cout << setw(8) << pairs << setw(10) << Rate(pairs, lockedTime)
+		     << setw(10) << Rate(pairs, spscTime) << setw(10) << Rate(pairs, mpmcTime) << endl;
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
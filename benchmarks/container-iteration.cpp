@@ -0,0 +1,186 @@
+/**
+ * File: container-iteration.cpp
+ * -----------------------------
+ * Times a full pass over each of the collection classes in three ways,
+ * in nanoseconds per element:
+ *
+ *   before    the way foreach used to step through the collection, by
+ *             calling hasNext and next on an Iterator, which checks the
+ *             timestamp and returns a copy of each element.  Queue and
+ *             Stack had no iterator, so for them this is the old way of
+ *             looking at every element: copying the collection and
+ *             emptying the copy.
+ *   value     a range-based for loop that copies each element into
+ *             the loop variable.
+ *   ref       a range-based for loop with a const reference, which
+ *             copies nothing.
+ *
+ * Each pass adds up the elements, or the length and first character of
+ * each string, so that every way must touch every element.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "genlib.h"
+#include "grid.h"
+#include "map.h"
+#include "queue.h"
+#include "set.h"
+#include "stack.h"
+#include "vector.h"
+
+static const int kIntElements = 10000000;
+static const int kStringElements = 2000000;
+static const int kSetElements = 2000000;
+static const int kMapElements = 1000000;
+static const int kGridSide = 3000;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+static long Weight(int value) {
+	return value;
+}
+
+static long Weight(const string & str) {
+	return str.length() + str[0];
+}
+
+template <typename CollectionType>
+static long IterateByIterator(CollectionType & collection) {
+	long total = 0;
+	typename CollectionType::Iterator iter = collection.iterator();
+	while (iter.hasNext()) {
+		total += Weight(iter.next());
+	}
+	return total;
+}
+
+template <typename ElemType>
+static long IterateByIterator(Queue<ElemType> & queue) {
+	long total = 0;
+	Queue<ElemType> copy = queue;
+	while (!copy.isEmpty()) {
+		total += Weight(copy.dequeue());
+	}
+	return total;
+}
+
+template <typename ElemType>
+static long IterateByIterator(Stack<ElemType> & stack) {
+	long total = 0;
+	Stack<ElemType> copy = stack;
+	while (!copy.isEmpty()) {
+		total += Weight(copy.pop());
+	}
+	return total;
+}
+
+template <typename CollectionType>
+static long IterateByValue(CollectionType & collection) {
+	long total = 0;
+	for (auto elem : collection) {
+		total += Weight(elem);
+	}
+	return total;
+}
+
+template <typename CollectionType>
+static long IterateByReference(CollectionType & collection) {
+	long total = 0;
+	for (const auto & elem : collection) {
+		total += Weight(elem);
+	}
+	return total;
+}
+
+/*
+ * Times the three passes over collection and prints a row of the table,
+ * returning whether the three agree on the total.
+ */
+
+template <typename CollectionType>
+static bool TimePasses(string name, CollectionType & collection, long numElements) {
+	long totals[3];
+	double seconds[3];
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	totals[0] = IterateByIterator(collection);
+	seconds[0] = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	totals[1] = IterateByValue(collection);
+	seconds[1] = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	totals[2] = IterateByReference(collection);
+	seconds[2] = SecondsSince(start);
+	cout << setw(16) << name;
+	for (int i = 0; i < 3; i++) {
+		cout << setw(10) << seconds[i] * 1e9 / numElements;
+	}
+	cout << endl;
+	return totals[0] == totals[1] && totals[1] == totals[2];
+}
+
+int main() {
+	cout << "Nanoseconds per element" << endl;
+	cout << setw(16) << "collection" << setw(10) << "before" << setw(10) << "value"
+	     << setw(10) << "ref" << endl;
+	cout << fixed << setprecision(2);
+	bool agree = true;
+	{
+		Vector<int> vector(kIntElements);
+		for (int i = 0; i < kIntElements; i++) {
+			vector.add(i % 1000);
+		}
+		agree = TimePasses("Vector<int>", vector, kIntElements) && agree;
+	}
+	{
+		Vector<string> vector(kStringElements);
+		for (int i = 0; i < kStringElements; i++) {
+			vector.add(string(24 + i % 16, char('a' + i % 26)));
+		}
+		agree = TimePasses("Vector<string>", vector, kStringElements) && agree;
+	}
+	{
+		Set<int> set;
+		for (int i = 0; i < kSetElements; i++) {
+			set.add(int((i * 2654435761U) % 1000000007U));
+		}
+		agree = TimePasses("Set<int>", set, set.size()) && agree;
+	}
+	{
+		Map<int> map;
+		for (int i = 0; i < kMapElements; i++) {
+			map.put("key" + IntegerToString(i), i);
+		}
+		agree = TimePasses("Map<int> keys", map, kMapElements) && agree;
+	}
+	{
+		Grid<int> grid(kGridSide, kGridSide);
+		for (int row = 0; row < kGridSide; row++) {
+			for (int col = 0; col < kGridSide; col++) {
+				grid[row][col] = (row ^ col) & 255;
+			}
+		}
+		agree = TimePasses("Grid<int>", grid, long(kGridSide) * kGridSide) && agree;
+	}
+	{
+		Queue<int> queue;
+		for (int i = 0; i < kIntElements; i++) {
+			queue.enqueue(i % 1000);
+		}
+		agree = TimePasses("Queue<int>", queue, kIntElements) && agree;
+	}
+	{
+		Stack<int> stack;
+		for (int i = 0; i < kIntElements; i++) {
+			stack.push(i % 1000);
+		}
+		agree = TimePasses("Stack<int>", stack, kIntElements) && agree;
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * File: delimiter-scan.cpp
+ * ------------------------
+ * Measures how quickly the DelimiterScanner walks multi-kilobyte query
+ * strings at each instruction set the processor supports, next to a
+ * plain character-by-character loop, and times Explode and the
+ * QueryTokenizer on the same strings.
+ */
+
+#include "genlib.h"
+#include "random.h"
+#include "delimiter-scan.h"
+#include "url-query.h"
+#include <ctime>
+#include <iostream>
+
+static const int kTotalBytes = 64 * 1024 * 1024;
+
+/**
+ * Builds a query string of roughly the given length whose keys and
+ * values average meanTokenLength characters.
+ */
+
+static string RandomQuery(int length, int meanTokenLength) {
+	string query = "http://www.example.com/search?";
+	bool inValue = false;
+	while ((int) query.size() < length) {
+		int tokenLength = RandomInteger(1, 2 * meanTokenLength - 1);
+		for (int i = 0; i < tokenLength; i++) {
+			query += (char) ('a' + RandomInteger(0, 25));
+		}
+		query += inValue ? '&' : '=';
+		inValue = !inValue;
+	}
+	return query;
+}
+
+static double MegabytesPerSecond(clock_t start) {
+	double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+	return kTotalBytes / seconds / (1024 * 1024);
+}
+
+/**
+ * Hides the text from the optimizer, so that it can't notice that each
+ * repetition counts the same string and only do the work once.
+ */
+
+static string_view Opaque(const string & text) {
+	const char *volatile data = text.data();
+	return string_view(data, text.size());
+}
+
+static long SumDelimiterOffsetsByLoop(string_view text) {
+	long sum = 0;
+	for (size_t i = 0; i < text.size(); i++) {
+		char ch = text[i];
+		if (ch == '&' || ch == '=' || ch == '#') sum += i;
+	}
+	return sum;
+}
+
+static long SumDelimiterOffsetsByScanner(string_view text) {
+	long sum = 0;
+	DelimiterScanner scanner(text, "&=#");
+	const char *delim;
+	while ((delim = scanner.nextDelimiter()) != NULL) {
+		sum += delim - text.data();
+	}
+	return sum;
+}
+
+static void TimeQueries(const string & query) {
+	int numRepeats = kTotalBytes / query.size();
+	long expected = SumDelimiterOffsetsByLoop(query);
+
+	clock_t start = clock();
+	long count = 0;
+	for (int i = 0; i < numRepeats; i++) {
+		count += SumDelimiterOffsetsByLoop(Opaque(query));
+	}
+	cout << "    char loop      : " << MegabytesPerSecond(start) << " MB/s";
+	if (count != expected * numRepeats) cout << "  ** wrong offsets **";
+	cout << endl;
+
+	scanLevelT best = GetDelimiterScanLevel();
+	for (int level = SCAN_SCALAR; level <= best; level++) {
+		SetDelimiterScanLevel(scanLevelT(level));
+		start = clock();
+		count = 0;
+		for (int i = 0; i < numRepeats; i++) {
+			count += SumDelimiterOffsetsByScanner(Opaque(query));
+		}
+		double rate = MegabytesPerSecond(start);
+		cout << "    scanner, " << DelimiterScanLevelName(scanLevelT(level))
+		     << (level == SCAN_SCALAR ? "" : "  ") << ": " << rate << " MB/s";
+		if (count != expected * numRepeats) cout << "  ** wrong offsets **";
+		cout << endl;
+	}
+
+	Vector<string_view> tokens;
+	start = clock();
+	for (int i = 0; i < numRepeats; i++) {
+		Explode(Opaque(query), '&', tokens);
+	}
+	cout << "    Explode (views): " << MegabytesPerSecond(start) << " MB/s" << endl;
+
+	start = clock();
+	count = 0;
+	for (int i = 0; i < numRepeats; i++) {
+		QueryTokenizer tokenizer(Opaque(query));
+		while (tokenizer.hasNext()) {
+			count += tokenizer.next().value.size();
+		}
+	}
+	cout << "    QueryTokenizer : " << MegabytesPerSecond(start) << " MB/s" << endl;
+}
+
+int main() {
+	SetRandomSeed(106);
+	cout << "Best supported instruction set: "
+	     << DelimiterScanLevelName(GetDelimiterScanLevel()) << endl;
+	int lengths[] = { 2048, 16384 };
+	int tokenLengths[] = { 4, 32 };
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			cout << "  " << lengths[i] << "-byte query, tokens of ~"
+			     << tokenLengths[j] << " characters:" << endl;
+			TimeQueries(RandomQuery(lengths[i], tokenLengths[j]));
+		}
+	}
+	return 0;
+}
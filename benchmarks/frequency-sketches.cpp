@@ -0,0 +1,193 @@
+/**
+ * File: frequency-sketches.cpp
+ * ----------------------------
+ * Measures how accurate the summaries in frequency-sketches.h are for
+ * the memory they use, against exact counting with a Set or Map.
+ * HyperLogLog is run over streams of known cardinality at several
+ * precisions; CountMinSketch and SpaceSaving are run over a Zipf-
+ * distributed stream, where a few values dominate and most are rare,
+ * which is what parameter values in real logs look like.  Each sketch
+ * is also built in four pieces and merged, the way the access-log
+ * workers use them, to check that merging costs little or no accuracy.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include "genlib.h"
+#include "random.h"
+#include "vector.h"
+#include "frequency-sketches.h"
+
+static const int kNumPieces = 4;
+static const int kZipfStreamLength = 1000000;
+static const int kZipfVocabulary = 100000;
+static const double kZipfExponent = 1.1;
+static const int kTopK = 10;
+
+/**
+ * Returns the approximate number of bytes an exact Set<string> or
+ * Map<int> needs per distinct short string: the string itself plus a
+ * node or cell with a couple of pointers and some bookkeeping.
+ */
+
+static const int kExactBytesPerItem = sizeof(string) + 3 * sizeof(void *);
+
+static string ItemName(int index) {
+	return "v" + IntegerToString(index);
+}
+
+static void BenchmarkHyperLogLog() {
+	static const int kCardinalities[] = { 1000, 100000, 1000000 };
+	static const int kPrecisions[] = { 6, 8, 10, 12, 14, 16 };
+	cout << "HyperLogLog: error of the distinct-count estimate" << endl;
+	cout << "  " << setw(10) << "precision" << setw(10) << "bytes";
+	for (int c = 0; c < 3; c++) cout << setw(14) << kCardinalities[c];
+	cout << setw(16) << "merged == whole" << endl;
+	for (int p = 0; p < 6; p++) {
+		HyperLogLog probe(kPrecisions[p]);
+		probe.add("x");
+		cout << "  " << setw(10) << kPrecisions[p] << setw(10) << probe.memoryUsage();
+		bool mergesExactly = true;
+		for (int c = 0; c < 3; c++) {
+			HyperLogLog whole(kPrecisions[p]);
+			Vector<HyperLogLog> pieces;
+			for (int i = 0; i < kNumPieces; i++) pieces.add(HyperLogLog(kPrecisions[p]));
+			for (int i = 0; i < kCardinalities[c]; i++) {
+				string item = ItemName(i);
+				whole.add(item);
+				pieces[i % kNumPieces].add(item);
+			}
+			for (int i = 1; i < kNumPieces; i++) pieces[0].merge(pieces[i]);
+			if (pieces[0].estimate() != whole.estimate()) mergesExactly = false;
+			double error = 100.0 * (whole.estimate() - kCardinalities[c]) / kCardinalities[c];
+			cout << setw(13) << fixed << setprecision(2) << error << "%";
+		}
+		cout << setw(16) << (mergesExactly ? "yes" : "NO") << endl;
+	}
+	cout << "  exact Set<string>: about " << kExactBytesPerItem
+	     << " bytes per distinct value (" << kExactBytesPerItem * 1000000L / (1 << 20)
+	     << " MB for 1000000)" << endl << endl;
+}
+
+/**
+ * Fills stream with kZipfStreamLength draws from a Zipf distribution
+ * over kZipfVocabulary values, and counts holds the exact frequency of
+ * each value (indexed by rank).
+ */
+
+static void BuildZipfStream(Vector<int> & stream, Vector<long> & counts) {
+	Vector<double> cumulative;
+	double total = 0;
+	for (int rank = 1; rank <= kZipfVocabulary; rank++) {
+		total += 1.0 / pow(rank, kZipfExponent);
+		cumulative.add(total);
+	}
+	for (int i = 0; i < kZipfVocabulary; i++) counts.add(0);
+	for (int i = 0; i < kZipfStreamLength; i++) {
+		double target = RandomReal(0, total);
+		int low = 0, high = kZipfVocabulary - 1;
+		while (low < high) {
+			int mid = (low + high) / 2;
+			if (cumulative[mid] < target) low = mid + 1; else high = mid;
+		}
+		stream.add(low);
+		counts[low]++;
+	}
+}
+
+static void BenchmarkCountMin(Vector<int> & stream, Vector<long> & counts) {
+	static const int kWidths[] = { 256, 1024, 4096, 16384, 65536 };
+	int distinct = 0;
+	for (int i = 0; i < counts.size(); i++) if (counts[i] > 0) distinct++;
+	cout << "CountMinSketch (depth 4): average overestimate, Zipf stream of "
+	     << kZipfStreamLength << " over " << distinct << " distinct values" << endl;
+	cout << "  " << setw(10) << "width" << setw(10) << "bytes" << setw(16) << "all values"
+	     << setw(16) << "top " + IntegerToString(kTopK) << setw(16) << "merged == whole" << endl;
+	for (int w = 0; w < 5; w++) {
+		CountMinSketch whole(kWidths[w], 4);
+		Vector<CountMinSketch> pieces;
+		for (int i = 0; i < kNumPieces; i++) pieces.add(CountMinSketch(kWidths[w], 4));
+		for (int i = 0; i < stream.size(); i++) {
+			string item = ItemName(stream[i]);
+			whole.add(item);
+			pieces[i % kNumPieces].add(item);
+		}
+		for (int i = 1; i < kNumPieces; i++) pieces[0].merge(pieces[i]);
+		double allError = 0, topError = 0;
+		bool mergesExactly = true;
+		for (int i = 0; i < counts.size(); i++) {
+			if (counts[i] == 0) continue;
+			string item = ItemName(i);
+			long over = whole.estimate(item) - counts[i];
+			allError += over;
+			if (i < kTopK) topError += over;
+			if (pieces[0].estimate(item) != whole.estimate(item)) mergesExactly = false;
+		}
+		cout << "  " << setw(10) << kWidths[w] << setw(10) << whole.memoryUsage()
+		     << setw(16) << setprecision(1) << allError / distinct
+		     << setw(16) << topError / kTopK
+		     << setw(16) << (mergesExactly ? "yes" : "NO") << endl;
+	}
+	cout << "  exact Map<int>: about " << kExactBytesPerItem + sizeof(int)
+	     << " bytes per distinct value (" << (kExactBytesPerItem + sizeof(int)) * distinct / 1024
+	     << " KB here)" << endl << endl;
+}
+
+/**
+ * Reports how many of the true top kTopK values the summary placed in
+ * its own top kTopK, and the worst relative error among the counts of
+ * those it found.  Values that made the summary's list without being in
+ * the true top kTopK lower the recall but are left out of the error.
+ */
+
+static void ReportTopK(SpaceSaving & summary, Vector<long> & counts) {
+	Vector<heavyHitterT> top = summary.topK(kTopK);
+	int found = 0;
+	double worstError = 0;
+	for (int i = 0; i < top.size(); i++) {
+		int rank = StringToInteger(top[i].item.substr(1));
+		if (rank >= kTopK) continue;
+		found++;
+		double error = double(top[i].count - counts[rank]) / counts[rank];
+		if (error > worstError) worstError = error;
+	}
+	cout << setw(10) << found << "/" << kTopK << setw(11) << setprecision(2)
+	     << 100 * worstError << "%";
+}
+
+static void BenchmarkSpaceSaving(Vector<int> & stream, Vector<long> & counts) {
+	static const int kCapacities[] = { 16, 64, 256, 1024 };
+	cout << "SpaceSaving: recall of the true top " << kTopK
+	     << " and worst count error among them" << endl;
+	cout << "  " << setw(10) << "capacity" << setw(10) << "bytes"
+	     << setw(13) << "recall" << setw(12) << "error"
+	     << setw(13) << "merged" << setw(12) << "error" << endl;
+	for (int c = 0; c < 4; c++) {
+		SpaceSaving whole(kCapacities[c]);
+		Vector<SpaceSaving> pieces;
+		for (int i = 0; i < kNumPieces; i++) pieces.add(SpaceSaving(kCapacities[c]));
+		for (int i = 0; i < stream.size(); i++) {
+			string item = ItemName(stream[i]);
+			whole.add(item);
+			pieces[i % kNumPieces].add(item);
+		}
+		for (int i = 1; i < kNumPieces; i++) pieces[0].merge(pieces[i]);
+		cout << "  " << setw(10) << kCapacities[c] << setw(10) << whole.memoryUsage();
+		ReportTopK(whole, counts);
+		ReportTopK(pieces[0], counts);
+		cout << endl;
+	}
+	cout << endl;
+}
+
+int main() {
+	SetRandomSeed(106);
+	BenchmarkHyperLogLog();
+	Vector<int> stream;
+	Vector<long> counts;
+	BuildZipfStream(stream, counts);
+	BenchmarkCountMin(stream, counts);
+	BenchmarkSpaceSaving(stream, counts);
+	return 0;
+}
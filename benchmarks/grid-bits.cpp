@@ -0,0 +1,132 @@
+/**
+ * File: grid-bits.cpp
+ * -------------------
+ * Compares the bit-packed Grid<bool> with a grid of one byte per cell,
+ * the way a Grid<bool> used to be stored, on a 4096 x 4096 occupancy
+ * map with 1 cell in 64 set, like mines rasterized onto a field:
+ *
+ *   count     counting the set cells.
+ *   scan      visiting every set cell in row-major order.
+ *   lookup    reading cells one at a time with [][] at random locations.
+ *   union     setting each cell that is set in a second map.
+ *   flip      inverting every cell.
+ *
+ * The figures are milliseconds per pass, and the memory is that of the
+ * cells alone.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "grid.h"
+
+static const int kSide = 4096;
+static const int kLookups = 1 << 22;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+template <typename FnType>
+static void TimeOne(FnType fn) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	fn();
+	cout << setw(10) << MillisecondsSince(start);
+}
+
+/*
+ * Fills grid with a reproducible pattern of about one set cell in 64,
+ * different for each seed.
+ */
+
+template <typename GridType>
+static void Scatter(GridType & grid, unsigned seed) {
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			seed = seed * 1103515245 + 12345;
+			grid[row][col] = ((seed >> 16) & 63) == 0;
+		}
+	}
+}
+
+int main() {
+	Grid<char> bytes(kSide, kSide), otherBytes(kSide, kSide);
+	Grid<bool> bits(kSide, kSide), otherBits(kSide, kSide);
+	Scatter(bytes, 1);
+	Scatter(otherBytes, 2);
+	Scatter(bits, 1);
+	Scatter(otherBits, 2);
+	long counts[2] = { 0, 0 }, scans[2] = { 0, 0 }, lookups[2] = { 0, 0 };
+
+	cout << "Milliseconds per pass over a " << kSide << " x " << kSide
+	     << " map, " << kLookups << " random lookups" << endl;
+	cout << setw(8) << "grid" << setw(10) << "memory" << setw(10) << "count"
+	     << setw(10) << "scan" << setw(10) << "lookup" << setw(10) << "union"
+	     << setw(10) << "flip" << endl;
+	cout << fixed << setprecision(1);
+
+	cout << setw(8) << "bytes" << setw(8) << long(kSide) * kSide / 1024 << "KB";
+	TimeOne([&] {
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				counts[0] += bytes.uncheckedAt(row, col);
+			}
+		}
+	});
+	TimeOne([&] {
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				if (bytes.uncheckedAt(row, col)) scans[0] += row ^ col;
+			}
+		}
+	});
+	TimeOne([&] {
+		unsigned seed = 3;
+		for (int i = 0; i < kLookups; i++) {
+			seed = seed * 1103515245 + 12345;
+			lookups[0] += bytes[(seed >> 8) % kSide][(seed >> 20) % kSide];
+		}
+	});
+	TimeOne([&] {
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				bytes.uncheckedAt(row, col) |= otherBytes.uncheckedAt(row, col);
+			}
+		}
+	});
+	TimeOne([&] {
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				bytes.uncheckedAt(row, col) = !bytes.uncheckedAt(row, col);
+			}
+		}
+	});
+	cout << endl;
+
+	cout << setw(8) << "bits" << setw(8) << long(kSide) * kSide / 8 / 1024 << "KB";
+	TimeOne([&] { counts[1] = bits.count(); });
+	TimeOne([&] { bits.mapTrue([&](int row, int col) { scans[1] += row ^ col; }); });
+	TimeOne([&] {
+		unsigned seed = 3;
+		for (int i = 0; i < kLookups; i++) {
+			seed = seed * 1103515245 + 12345;
+			lookups[1] += bits[(seed >> 8) % kSide][(seed >> 20) % kSide];
+		}
+	});
+	TimeOne([&] { bits.unionWith(otherBits); });
+	TimeOne([&] { bits.flipAll(); });
+	cout << endl;
+
+	long finalCount = 0;
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			finalCount += bytes.uncheckedAt(row, col);
+		}
+	}
+	bool agree = counts[0] == counts[1] && scans[0] == scans[1] && lookups[0] == lookups[1]
+	             && finalCount == bits.count();
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * File: grid-kernels.cpp
+ * ----------------------
+ * Times the bulk operations of gridkernels.h on a 4096 x 4096 grid of
+ * floats against the two ways of doing the same work without them:
+ *
+ *   mapAll    Grid::mapAll with a function, called once per cell, and a
+ *             global to keep the running total.  mapAll cannot change
+ *             the cells, so only the sum, min and max have this form.
+ *   loop      a plain loop over the cells through uncheckedAt.
+ *   kernel    the gridkernels.h function run by the calling thread.
+ *   pool      the same function with ThreadPool::shared().
+ *
+ * The figures are milliseconds per pass over the grid.  The convolutions
+ * use a 3 x 3 and a 5 x 5 kernel, with the edges clamped in the loops as
+ * they are in GridConvolve.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "grid.h"
+#include "gridkernels.h"
+#include "threadpool.h"
+
+static const int kSide = 4096;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/*
+ * Runs fn, printing the time it took in a column of its own.
+ */
+
+template <typename FnType>
+static void TimeOne(FnType fn) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	fn();
+	cout << setw(10) << MillisecondsSince(start);
+}
+
+static void Skip() {
+	cout << setw(10) << "-";
+}
+
+static double runningSum;
+static float runningMin, runningMax;
+
+static void AddCell(float cell) {
+	runningSum += cell;
+}
+
+static void MinCell(float cell) {
+	if (cell < runningMin) runningMin = cell;
+}
+
+static void MaxCell(float cell) {
+	if (runningMax < cell) runningMax = cell;
+}
+
+static void LoopConvolve(Grid<float> & src, Grid<float> & dst, Grid<float> & kernel) {
+	int rr = kernel.numRows() / 2;
+	int rc = kernel.numCols() / 2;
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			float acc = 0;
+			for (int k = 0; k < kernel.numRows(); k++) {
+				int r = min(max(row + k - rr, 0), kSide - 1);
+				for (int j = 0; j < kernel.numCols(); j++) {
+					int c = min(max(col + j - rc, 0), kSide - 1);
+					acc += src.uncheckedAt(r, c) * kernel.uncheckedAt(k, j);
+				}
+			}
+			dst.uncheckedAt(row, col) = acc;
+		}
+	}
+}
+
+static bool SameGrids(Grid<float> & a, Grid<float> & b) {
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			if (a.uncheckedAt(row, col) != b.uncheckedAt(row, col)) return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	Grid<float> src(kSide, kSide), dst(kSide, kSide), expected(kSide, kSide);
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			src.uncheckedAt(row, col) = float((row * 7 + col * 13) % 101) / 8;
+		}
+	}
+	ThreadPool *pool = &ThreadPool::shared();
+	bool agree = true;
+
+	cout << "Milliseconds per pass over a " << kSide << " x " << kSide << " grid of floats, "
+	     << pool->numThreads() << " threads in the pool" << endl;
+	cout << setw(10) << "operation" << setw(10) << "mapAll" << setw(10) << "loop"
+	     << setw(10) << "kernel" << setw(10) << "pool" << endl;
+	cout << fixed << setprecision(1);
+
+	cout << setw(10) << "fill";
+	Skip();
+	TimeOne([&] {
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				dst.uncheckedAt(row, col) = 2.5f;
+			}
+		}
+	});
+	TimeOne([&] { GridFill(dst, 2.5f); });
+	TimeOne([&] { GridFill(dst, 2.5f, pool); });
+	agree = agree && GridMin(dst) == 2.5f && GridMax(dst) == 2.5f;
+	cout << endl;
+
+	cout << setw(10) << "transform";
+	Skip();
+	TimeOne([&] {
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				float x = src.uncheckedAt(row, col);
+				expected.uncheckedAt(row, col) = x * x + 1;
+			}
+		}
+	});
+	TimeOne([&] { GridTransform(src, dst, [](float x) { return x * x + 1; }); });
+	agree = agree && SameGrids(dst, expected);
+	TimeOne([&] { GridTransform(src, dst, [](float x) { return x * x + 1; }, pool); });
+	agree = agree && SameGrids(dst, expected);
+	cout << endl;
+
+	double sums[4];
+	cout << setw(10) << "sum";
+	runningSum = 0;
+	TimeOne([&] { src.mapAll(AddCell); });
+	TimeOne([&] {
+		double sum = 0;
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				sum += src.uncheckedAt(row, col);
+			}
+		}
+		sums[1] = sum;
+	});
+	TimeOne([&] { sums[2] = GridSum(src); });
+	TimeOne([&] { sums[3] = GridSum(src, pool); });
+	sums[0] = runningSum;
+	agree = agree && sums[0] == sums[1] && sums[2] == sums[3]
+	        && std::fabs(sums[1] - sums[2]) < 1e-9 * sums[1];
+	cout << endl;
+
+	float mins[4], maxes[4];
+	cout << setw(10) << "min/max";
+	runningMin = runningMax = src.uncheckedAt(0, 0);
+	TimeOne([&] { src.mapAll(MinCell); src.mapAll(MaxCell); });
+	TimeOne([&] {
+		float lo = src.uncheckedAt(0, 0), hi = lo;
+		for (int row = 0; row < kSide; row++) {
+			for (int col = 0; col < kSide; col++) {
+				float x = src.uncheckedAt(row, col);
+				if (x < lo) lo = x;
+				if (hi < x) hi = x;
+			}
+		}
+		mins[1] = lo;
+		maxes[1] = hi;
+	});
+	TimeOne([&] { mins[2] = GridMin(src); maxes[2] = GridMax(src); });
+	TimeOne([&] { mins[3] = GridMin(src, pool); maxes[3] = GridMax(src, pool); });
+	mins[0] = runningMin;
+	maxes[0] = runningMax;
+	for (int i = 1; i < 4; i++) {
+		agree = agree && mins[i] == mins[0] && maxes[i] == maxes[0];
+	}
+	cout << endl;
+
+	for (int side = 3; side <= 5; side += 2) {
+		Grid<float> kernel(side, side);
+		for (int k = 0; k < side; k++) {
+			for (int j = 0; j < side; j++) {
+				kernel[k][j] = float((k + 1) * (j + 2) % 5) / 16;
+			}
+		}
+		cout << setw(6) << side << " x " << side;
+		Skip();
+		TimeOne([&] { LoopConvolve(src, expected, kernel); });
+		TimeOne([&] { GridConvolve(src, dst, kernel); });
+		agree = agree && SameGrids(dst, expected);
+		TimeOne([&] { GridConvolve(src, dst, kernel, pool); });
+		agree = agree && SameGrids(dst, expected);
+		cout << endl;
+	}
+
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * File: grid-stencil.cpp
+ * ----------------------
+ * Times stencil work on 4096 x 4096 grids of floats in each layout from
+ * gridlayout.h, and through the old bounds-checked grid[row][col]:
+ *
+ *   rows      one Jacobi step of the five-point stencil, each interior
+ *             cell set to the average of its four neighbors, visiting
+ *             the cells a row at a time.
+ *   tiles     the same step, visiting the cells with mapTiles.
+ *   blur      a nine-point (3 x 3) box blur, visiting with mapTiles.
+ *   columns   a running sum down every column, one column at a time.
+ *   transpose copying the grid into another with rows and columns
+ *             swapped, which reads along one and writes along the other.
+ *
+ * All but the first line use uncheckedAt.  The figures are seconds per
+ * pass over the grid.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "grid.h"
+
+static const int kSide = 4096;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+template <typename GridType>
+static void FillGrid(GridType & grid) {
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			grid.uncheckedAt(row, col) = float((row * 7 + col * 13) % 101);
+		}
+	}
+}
+
+template <typename GridType>
+static double Checksum(GridType & grid) {
+	double sum = 0;
+	for (int row = 0; row < kSide; row += 3) {
+		for (int col = 0; col < kSide; col += 5) {
+			sum += grid.uncheckedAt(row, col) * ((row + col) % 11);
+		}
+	}
+	return sum;
+}
+
+/*
+ * The five-point step through the bounds-checked operator[], which is
+ * what every access cost before uncheckedAt.
+ */
+
+static void CheckedStencil(Grid<float> & src, Grid<float> & dst) {
+	for (int row = 1; row < kSide - 1; row++) {
+		for (int col = 1; col < kSide - 1; col++) {
+			dst[row][col] = 0.25f * (src[row - 1][col] + src[row + 1][col]
+			                         + src[row][col - 1] + src[row][col + 1]);
+		}
+	}
+}
+
+template <typename GridType>
+static void RowStencil(GridType & src, GridType & dst) {
+	for (int row = 1; row < kSide - 1; row++) {
+		for (int col = 1; col < kSide - 1; col++) {
+			dst.uncheckedAt(row, col) = 0.25f * (src.uncheckedAt(row - 1, col)
+			                                     + src.uncheckedAt(row + 1, col)
+			                                     + src.uncheckedAt(row, col - 1)
+			                                     + src.uncheckedAt(row, col + 1));
+		}
+	}
+}
+
+template <typename GridType>
+static void TileStencil(GridType & src, GridType & dst) {
+	dst.mapTiles([&src](int row, int col, float & cell) {
+		if (row == 0 || col == 0 || row == kSide - 1 || col == kSide - 1) return;
+		cell = 0.25f * (src.uncheckedAt(row - 1, col) + src.uncheckedAt(row + 1, col)
+		                + src.uncheckedAt(row, col - 1) + src.uncheckedAt(row, col + 1));
+	});
+}
+
+template <typename GridType>
+static void TileBlur(GridType & src, GridType & dst) {
+	dst.mapTiles([&src](int row, int col, float & cell) {
+		if (row == 0 || col == 0 || row == kSide - 1 || col == kSide - 1) return;
+		float sum = 0;
+		for (int dr = -1; dr <= 1; dr++) {
+			for (int dc = -1; dc <= 1; dc++) {
+				sum += src.uncheckedAt(row + dr, col + dc);
+			}
+		}
+		cell = sum * (1.0f / 9);
+	});
+}
+
+template <typename GridType>
+static void ColumnSums(GridType & src, GridType & dst) {
+	for (int col = 0; col < kSide; col++) {
+		float sum = 0;
+		for (int row = 0; row < kSide; row++) {
+			sum += src.uncheckedAt(row, col);
+			dst.uncheckedAt(row, col) = sum;
+		}
+	}
+}
+
+template <typename GridType>
+static void Transpose(GridType & src, GridType & dst) {
+	for (int row = 0; row < kSide; row++) {
+		for (int col = 0; col < kSide; col++) {
+			dst.uncheckedAt(col, row) = src.uncheckedAt(row, col);
+		}
+	}
+}
+
+/*
+ * Runs fn on src and dst, printing the time it took and adding dst's
+ * checksum to total.
+ */
+
+template <typename GridType, typename FnType>
+static void TimeOne(FnType fn, GridType & src, GridType & dst, double & total) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	fn(src, dst);
+	cout << setw(11) << SecondsSince(start);
+	total += Checksum(dst);
+}
+
+template <typename Layout>
+static double TimeLayout(string name) {
+	Grid<float, Layout> src(kSide, kSide), dst(kSide, kSide);
+	FillGrid(src);
+	FillGrid(dst);
+	double total = 0;
+	cout << setw(10) << name;
+	TimeOne(RowStencil< Grid<float, Layout> >, src, dst, total);
+	TimeOne(TileStencil< Grid<float, Layout> >, src, dst, total);
+	TimeOne(TileBlur< Grid<float, Layout> >, src, dst, total);
+	TimeOne(ColumnSums< Grid<float, Layout> >, src, dst, total);
+	TimeOne(Transpose< Grid<float, Layout> >, src, dst, total);
+	cout << endl;
+	return total;
+}
+
+int main() {
+	cout << "Seconds per pass over a " << kSide << " x " << kSide << " grid of floats" << endl;
+	cout << setw(10) << "layout" << setw(11) << "rows" << setw(11) << "tiles"
+	     << setw(11) << "blur" << setw(11) << "columns" << setw(11) << "transpose" << endl;
+	cout << fixed << setprecision(3);
+
+	Grid<float> src(kSide, kSide), dst(kSide, kSide);
+	FillGrid(src);
+	FillGrid(dst);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	CheckedStencil(src, dst);
+	double checkedTime = SecondsSince(start);
+	cout << setw(10) << "checked" << setw(11) << checkedTime << endl;
+	src.resize(0, 0);
+	dst.resize(0, 0);
+
+	double rowMajor = TimeLayout<RowMajorLayout>("row-major");
+	double tiled = TimeLayout< TiledLayout<16> >("tiled-16");
+	double tiled8 = TimeLayout< TiledLayout<8> >("tiled-8");
+	double morton = TimeLayout<MortonLayout>("morton");
+	bool agree = (rowMajor == tiled && tiled == tiled8 && tiled8 == morton);
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
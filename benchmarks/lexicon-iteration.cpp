@@ -0,0 +1,103 @@
+/**
+ * File: lexicon-iteration.cpp
+ * ---------------------------
+ * Times a full walk over every word in lexicon.dat, once with the
+ * copying next() and once with nextRef(), which hands back a reference
+ * to the iterator's reused word buffer, and then with parallelMapAll
+ * at increasing thread counts.  Every pass sums the word lengths so
+ * the compiler can't throw the loop away.
+ */
+
+#include "genlib.h"
+#include "lexicon.h"
+#include "strutils.h"
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+static const int kNumPasses = 20;
+
+/**
+ * Returns the number of seconds elapsed since the specified
+ * starting clock value.
+ */
+
+static double SecondsSince(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Per-word callback and merge function for the parallelMapAll passes.
+ */
+
+static void AddLength(const string & word, long & total) {
+	total += word.size();
+}
+
+static void AddTotals(long & total, long & part) {
+	total += part;
+}
+
+static void ReportPass(string label, double seconds, int numWords, long checksum) {
+	cout << "  " << label << ": " << seconds / kNumPasses * 1000 << " ms/pass, "
+	     << numWords * (kNumPasses / seconds) / 1e6 << "M words/s"
+	     << " (checksum " << checksum << ")" << endl;
+}
+
+int main() {
+	Lexicon english("lexicon.dat");
+	int numWords = english.size();
+	cout << "Iterating over " << numWords << " words, "
+	     << kNumPasses << " passes each." << endl;
+
+	long checksum = 0;
+	clock_t start = clock();
+	for (int pass = 0; pass < kNumPasses; pass++) {
+		Lexicon::Iterator iter = english.iterator();
+		while (iter.hasNext()) {
+			string word = iter.next();
+			checksum += word.size();
+		}
+	}
+	ReportPass("next()   ", SecondsSince(start), numWords, checksum);
+
+	checksum = 0;
+	start = clock();
+	for (int pass = 0; pass < kNumPasses; pass++) {
+		Lexicon::Iterator iter = english.iterator();
+		while (iter.hasNext()) {
+			const string & word = iter.nextRef();
+			checksum += word.size();
+		}
+	}
+	ReportPass("nextRef()", SecondsSince(start), numWords, checksum);
+
+	checksum = 0;
+	start = clock();
+	for (int pass = 0; pass < kNumPasses; pass++) {
+		for (const string & word : english) {
+			checksum += word.size();
+		}
+	}
+	ReportPass("range for", SecondsSince(start), numWords, checksum);
+
+	/* clock() adds up CPU time across threads, so use wall time here. */
+	int maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads < 1) maxThreads = 1;
+	for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+		checksum = 0;
+		std::chrono::steady_clock::time_point wallStart =
+			std::chrono::steady_clock::now();
+		for (int pass = 0; pass < kNumPasses; pass++) {
+			long total = 0;
+			english.parallelMapAll(AddLength, total, AddTotals, numThreads);
+			checksum += total;
+		}
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - wallStart;
+		ReportPass("parallel x" + IntegerToString(numThreads),
+		           elapsed.count(), numWords, checksum);
+	}
+	return 0;
+}
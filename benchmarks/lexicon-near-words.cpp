@@ -0,0 +1,83 @@
+/**
+ * File: lexicon-near-words.cpp
+ * ----------------------------
+ * Times Lexicon::findNearWords against the brute-force approach it
+ * replaces: iterating over the whole lexicon and computing the edit
+ * distance from every word to the misspelling.
+ */
+
+#include "genlib.h"
+#include "lexicon.h"
+#include <ctime>
+#include <iostream>
+
+static const char *const kMisspellings[] = {
+	"speling", "recieve", "definately", "seperate", "occured",
+	"accomodate", "wierd", "untill", "begining", "tommorow",
+	"enviroment", "goverment", "neccessary", "pronounciation", "teh",
+	"xylophne", "aquire", "embarass", "publically", "zoology"
+};
+static const int kNumMisspellings = sizeof kMisspellings / sizeof kMisspellings[0];
+static const int kNumRepeats = 20;
+
+/**
+ * Plain dynamic-programming edit distance, used as the baseline.
+ */
+
+static int EditDistance(const string & one, const string & two) {
+	Vector<int> prev(two.size() + 1), cur(two.size() + 1);
+	for (int j = 0; j <= (int) two.size(); j++) {
+		prev.add(j);
+		cur.add(0);
+	}
+	for (int i = 1; i <= (int) one.size(); i++) {
+		cur[0] = i;
+		for (int j = 1; j <= (int) two.size(); j++) {
+			int best = prev[j - 1] + (one[i - 1] == two[j - 1] ? 0 : 1);
+			if (prev[j] + 1 < best) best = prev[j] + 1;
+			if (cur[j - 1] + 1 < best) best = cur[j - 1] + 1;
+			cur[j] = best;
+		}
+		Vector<int> temp = prev;
+		prev = cur;
+		cur = temp;
+	}
+	return prev[two.size()];
+}
+
+static double SecondsSince(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main() {
+	Lexicon english("lexicon.dat");
+	cout << "Searching " << english.size() << " words for "
+	     << kNumMisspellings << " misspellings." << endl;
+
+	for (int maxDistance = 1; maxDistance <= 3; maxDistance++) {
+		int numFound = 0;
+		clock_t start = clock();
+		for (int repeat = 0; repeat < kNumRepeats; repeat++) {
+			for (int i = 0; i < kNumMisspellings; i++) {
+				numFound += english.findNearWords(kMisspellings[i], maxDistance).size();
+			}
+		}
+		double perQuery = SecondsSince(start) / (kNumRepeats * kNumMisspellings);
+		cout << "  findNearWords, k = " << maxDistance << ": "
+		     << perQuery * 1e6 << " us/query, "
+		     << numFound / kNumRepeats << " words found" << endl;
+	}
+
+	int numFound = 0;
+	clock_t start = clock();
+	for (int i = 0; i < kNumMisspellings; i++) {
+		Lexicon::Iterator iter = english.iterator();
+		while (iter.hasNext()) {
+			if (EditDistance(iter.nextRef(), kMisspellings[i]) <= 2) numFound++;
+		}
+	}
+	double perQuery = SecondsSince(start) / kNumMisspellings;
+	cout << "  brute force,   k = 2: " << perQuery * 1e6 << " us/query, "
+	     << numFound << " words found" << endl;
+	return 0;
+}
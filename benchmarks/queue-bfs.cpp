@@ -0,0 +1,242 @@
+/**
+ * File: queue-bfs.cpp
+ * -------------------
+ * Times the Queue on the kind of work a breadth-first search gives it,
+ * like the spread of a chain reaction from mine to mine: a search over
+ * a grid of about five million locations, each of which is enqueued
+ * and dequeued once, for ten million queue operations in all.  The
+ * search is run three ways:
+ *
+ *   linked    the singly linked list of cells that the Queue used to
+ *             be, reproduced here, which allocates a cell per enqueue
+ *             and frees it on dequeue.
+ *   ring      the Queue as it is now, one element at a time.
+ *   levels    the Queue, taking a whole level of the search at once
+ *             with dequeueInto and adding the next with enqueueAll.
+ *
+ * Two more tests isolate the queue: one keeps about a thousand
+ * elements in it while ten million operations pass through it, and
+ * the other fills it with five million elements before draining it.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "queue.h"
+#include "vector.h"
+#include "chain-reaction-types.h"
+
+static const int kGridSide = 2236;
+static const int kChurnOperations = 10000000;
+static const int kChurnBacklog = 1000;
+
+/*
+ * The old linked-list Queue, with just the operations the test uses.
+ */
+
+template <typename ElemType>
+class LinkedQueue {
+public:
+	LinkedQueue() {
+		head = tail = NULL;
+		count = 0;
+	}
+
+	~LinkedQueue() {
+		while (head != NULL) {
+			cellT *next = head->next;
+			delete head;
+			head = next;
+		}
+	}
+
+	bool isEmpty() {
+		return count == 0;
+	}
+
+	void enqueue(ElemType elem) {
+		cellT *newOne = new cellT;
+		newOne->elem = elem;
+		newOne->next = NULL;
+		if (head != NULL) {
+			tail->next = newOne;
+		} else {
+			head = newOne;
+		}
+		tail = newOne;
+		count++;
+	}
+
+	ElemType dequeue() {
+		if (isEmpty()) Error("Attempt to dequeue from empty queue");
+		ElemType first = head->elem;
+		cellT *toDelete = head;
+		head = head->next;
+		delete toDelete;
+		count--;
+		return first;
+	}
+
+private:
+	struct cellT {
+		ElemType elem;
+		cellT *next;
+	};
+	cellT *head, *tail;
+	int count;
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/*
+ * Marks loc as reached and returns true if it is on the grid and has
+ * not been reached before.
+ */
+
+static bool Reach(Vector<char> & reached, location loc) {
+	int x = int(loc.x);
+	int y = int(loc.y);
+	if (x < 0 || x >= kGridSide || y < 0 || y >= kGridSide) return false;
+	char & cell = reached[y * kGridSide + x];
+	if (cell) return false;
+	cell = 1;
+	return true;
+}
+
+static const int kDx[] = { 1, -1, 0, 0 };
+static const int kDy[] = { 0, 0, 1, -1 };
+
+/*
+ * Searches the grid from its center one location at a time, returning
+ * the sum of the distances to every location as a checksum.
+ */
+
+template <typename QueueType>
+static long SearchOneAtATime(Vector<char> & reached) {
+	QueueType queue;
+	location start = { kGridSide / 2, kGridSide / 2 };
+	Reach(reached, start);
+	queue.enqueue(start);
+	long total = 0;
+	while (!queue.isEmpty()) {
+		location loc = queue.dequeue();
+		total += long(loc.x) + long(loc.y);
+		for (int d = 0; d < 4; d++) {
+			location next = { loc.x + kDx[d], loc.y + kDy[d] };
+			if (Reach(reached, next)) queue.enqueue(next);
+		}
+	}
+	return total;
+}
+
+static long SearchByLevels(Vector<char> & reached) {
+	Queue<location> queue;
+	location start = { kGridSide / 2, kGridSide / 2 };
+	Reach(reached, start);
+	queue.enqueue(start);
+	long total = 0;
+	while (!queue.isEmpty()) {
+		Vector<location> level;
+		queue.dequeueInto(level, queue.size());
+		Vector<location> nextLevel;
+		for (int i = 0; i < level.size(); i++) {
+			location loc = level[i];
+			total += long(loc.x) + long(loc.y);
+			for (int d = 0; d < 4; d++) {
+				location next = { loc.x + kDx[d], loc.y + kDy[d] };
+				if (Reach(reached, next)) nextLevel.add(next);
+			}
+		}
+		queue.enqueueAll(nextLevel);
+	}
+	return total;
+}
+
+static Vector<char> EmptyGrid() {
+	Vector<char> reached(kGridSide * kGridSide);
+	for (int i = 0; i < kGridSide * kGridSide; i++) {
+		reached.add(0);
+	}
+	return reached;
+}
+
+template <typename QueueType>
+static long FillAndDrain() {
+	QueueType queue;
+	location loc = { 0, 0 };
+	for (int i = 0; i < kChurnOperations / 2; i++) {
+		loc.x = i;
+		queue.enqueue(loc);
+	}
+	long total = 0;
+	while (!queue.isEmpty()) {
+		total += long(queue.dequeue().x);
+	}
+	return total;
+}
+
+template <typename QueueType>
+static long Churn() {
+	QueueType queue;
+	location loc = { 0, 0 };
+	for (int i = 0; i < kChurnBacklog; i++) {
+		queue.enqueue(loc);
+	}
+	long total = 0;
+	for (int i = 0; i < kChurnOperations / 2; i++) {
+		loc.x = i;
+		queue.enqueue(loc);
+		total += long(queue.dequeue().x);
+	}
+	return total;
+}
+
+int main() {
+	cout << "Seconds for a search over " << kGridSide << " x " << kGridSide
+	     << " locations, and for " << kChurnOperations << " operations on a queue of "
+	     << kChurnBacklog << endl;
+	cout << setw(10) << "queue" << setw(10) << "search" << setw(10) << "churn"
+	     << setw(10) << "drain" << endl;
+
+	Vector<char> reached = EmptyGrid();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	long linkedTotal = SearchOneAtATime< LinkedQueue<location> >(reached);
+	double linkedSearch = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	long linkedChurn = Churn< LinkedQueue<location> >();
+	double linkedChurnTime = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	long linkedDrain = FillAndDrain< LinkedQueue<location> >();
+	double linkedDrainTime = SecondsSince(start);
+
+	reached = EmptyGrid();
+	start = std::chrono::steady_clock::now();
+	long ringTotal = SearchOneAtATime< Queue<location> >(reached);
+	double ringSearch = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	long ringChurn = Churn< Queue<location> >();
+	double ringChurnTime = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	long ringDrain = FillAndDrain< Queue<location> >();
+	double ringDrainTime = SecondsSince(start);
+
+	reached = EmptyGrid();
+	start = std::chrono::steady_clock::now();
+	long levelTotal = SearchByLevels(reached);
+	double levelSearch = SecondsSince(start);
+
+	cout << fixed << setprecision(3);
+	cout << setw(10) << "linked" << setw(10) << linkedSearch << setw(10) << linkedChurnTime
+	     << setw(10) << linkedDrainTime << endl;
+	cout << setw(10) << "ring" << setw(10) << ringSearch << setw(10) << ringChurnTime
+	     << setw(10) << ringDrainTime << endl;
+	cout << setw(10) << "levels" << setw(10) << levelSearch << endl;
+	bool agree = (linkedTotal == ringTotal && ringTotal == levelTotal
+	              && linkedChurn == ringChurn && linkedDrain == ringDrain);
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
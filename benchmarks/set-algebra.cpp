@@ -0,0 +1,162 @@
+/**
+ * File: set-algebra.cpp
+ * ---------------------
+ * Times union, intersection and difference on two sets of a million
+ * elements each, half of which they share.  The element-at-a-time
+ * versions that unionWith, intersectWith and subtract used to be are
+ * reproduced here as the baseline, and are compared against the
+ * merge-based unionWith, intersectWith and subtract and against the
+ * +, * and - operators, which build a new set.  Every result is
+ * checked against the baseline's.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "random.h"
+#include "set.h"
+#include "strutils.h"
+#include "vector.h"
+
+static const int kSetSize = 1000000;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/**
+ * The element-at-a-time set operations.
+ */
+
+template <typename SetType, typename ElemType>
+static void LegacyUnion(SetType & set, SetType & other) {
+	for (const ElemType & elem : other) {
+		set.add(elem);
+	}
+}
+
+template <typename SetType, typename ElemType>
+static void LegacyIntersect(SetType & set, SetType & other) {
+	Vector<ElemType> toDelete;
+	for (const ElemType & elem : set) {
+		if (!other.contains(elem)) toDelete.add(elem);
+	}
+	for (int i = 0; i < toDelete.size(); i++) {
+		set.remove(toDelete[i]);
+	}
+}
+
+template <typename SetType, typename ElemType>
+static void LegacySubtract(SetType & set, SetType & other) {
+	for (const ElemType & elem : other) {
+		set.remove(elem);
+	}
+}
+
+static void MakeElement(int i, int & elem) {
+	elem = i;
+}
+
+static void MakeElement(int i, string & elem) {
+	elem = "element-" + IntegerToString(i);
+}
+
+/**
+ * Fills one and two with kSetSize elements each, drawn from a range
+ * of 1.5 * kSetSize, so that half of each set's elements are shared.
+ */
+
+template <typename SetType, typename ElemType>
+static void FillSets(SetType & one, SetType & two) {
+	Vector<int> ids;
+	for (int i = 0; i < kSetSize * 3 / 2; i++) {
+		ids.add(i);
+	}
+	for (int i = ids.size() - 1; i > 0; i--) {
+		int j = RandomInteger(0, i);
+		int tmp = ids[i];
+		ids[i] = ids[j];
+		ids[j] = tmp;
+	}
+	ElemType elem;
+	for (int i = 0; i < kSetSize; i++) {
+		MakeElement(ids[i], elem);
+		one.add(elem);
+		MakeElement(ids[i + kSetSize / 2], elem);
+		two.add(elem);
+	}
+}
+
+/**
+ * Times one operation three ways, copying the receiver beforehand
+ * outside the timed region, and reports whether all three agree.
+ */
+
+enum opT { UNION, INTERSECTION, DIFFERENCE };
+
+template <typename SetType>
+static SetType Combine(opT op, SetType & one, SetType & two) {
+	switch (op) {
+	  case UNION: return one + two;
+	  case INTERSECTION: return one * two;
+	  default: return one - two;
+	}
+}
+
+template <typename SetType, typename ElemType>
+static bool TimeOperation(string label, opT op, SetType & one, SetType & two) {
+	SetType legacy = one;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	switch (op) {
+	  case UNION: LegacyUnion<SetType, ElemType>(legacy, two); break;
+	  case INTERSECTION: LegacyIntersect<SetType, ElemType>(legacy, two); break;
+	  case DIFFERENCE: LegacySubtract<SetType, ElemType>(legacy, two); break;
+	}
+	double legacySeconds = SecondsSince(start);
+
+	SetType merged = one;
+	start = std::chrono::steady_clock::now();
+	switch (op) {
+	  case UNION: merged.unionWith(two); break;
+	  case INTERSECTION: merged.intersectWith(two); break;
+	  case DIFFERENCE: merged.subtract(two); break;
+	}
+	double mergedSeconds = SecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	SetType built = Combine(op, one, two);
+	double builtSeconds = SecondsSince(start);
+
+	cout << setw(22) << label << fixed << setprecision(3)
+	     << setw(11) << legacySeconds << setw(11) << mergedSeconds
+	     << setw(11) << builtSeconds << setw(9) << setprecision(1)
+	     << legacySeconds / mergedSeconds << "x" << setw(10) << merged.size() << endl;
+	return legacy.equals(merged) && legacy.equals(built);
+}
+
+template <typename SetType, typename ElemType>
+static bool RunOperations(string typeName) {
+	SetType one, two;
+	FillSets<SetType, ElemType>(one, two);
+	bool agree = TimeOperation<SetType, ElemType>(typeName + " union", UNION, one, two);
+	agree = TimeOperation<SetType, ElemType>(typeName + " intersect", INTERSECTION,
+	                                         one, two) && agree;
+	agree = TimeOperation<SetType, ElemType>(typeName + " subtract", DIFFERENCE,
+	                                         one, two) && agree;
+	return agree;
+}
+
+int main() {
+	SetRandomSeed(106);
+	cout << "Seconds for one operation on two sets of " << kSetSize
+	     << " elements, half of them shared" << endl;
+	cout << setw(22) << "operation" << setw(11) << "per-elem" << setw(11) << "merge"
+	     << setw(11) << "operator" << setw(10) << "speedup" << setw(10) << "size" << endl;
+	bool agree = RunOperations<Set<int>, int>("Set<int>");
+	agree = RunOperations<Set<int, BTree>, int>("Set<int, BTree>") && agree;
+	agree = RunOperations<Set<string>, string>("Set<string>") && agree;
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * File: set-comparators.cpp
+ * -------------------------
+ * Measures what the comparator costs a Set.  Each set is filled with
+ * shuffled elements and then probed for every one of them, in another
+ * order.  Three kinds of comparator are compared:
+ *
+ *   function pointer  Set<string> set(OperatorCmp), or a location set
+ *                     built with LocationCompare from the chain reaction
+ *                     lab: an indirect call per comparison, with both
+ *                     elements copied to pass them by value.
+ *   default           Set<string>, which compares with < and == inline,
+ *                     taking the elements by reference.
+ *   comparator class  Set<location, BST, LocationCmp>, the inlined
+ *                     version of LocationCompare.
+ *
+ * Both kinds of set are also run on the B-tree, where comparisons are
+ * a larger share of the work.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "random.h"
+#include "set.h"
+#include "strutils.h"
+#include "vector.h"
+#include "chain-reaction-types.h"
+
+static const int kSizes[] = { 10000, 100000, 1000000 };
+static const int kMinElementsTimed = 2000000;
+
+/**
+ * LocationCompare as a comparator class.
+ */
+
+struct LocationCmp {
+	int operator()(const location & one, const location & two) const {
+		if (one.x != two.x) return (one.x < two.x) ? -1 : 1;
+		if (one.y != two.y) return (one.y < two.y) ? -1 : 1;
+		return 0;
+	}
+};
+
+/**
+ * Returns size distinct elements in random order.  The strings are
+ * long enough that copying one means a trip to the allocator, like
+ * the URLs and words the labs keep in sets.
+ */
+
+static void MakeElement(int i, string & elem) {
+	elem = "http://www.example.com/item?id=" + IntegerToString(i * 7919 % 1000003);
+}
+
+static void MakeElement(int i, location & elem) {
+	elem.x = (i * 7919 % 1000003) / 100.0;
+	elem.y = i % 97;
+}
+
+template <typename ElemType>
+static Vector<ElemType> ShuffledElements(int size) {
+	Vector<ElemType> elems(size);
+	for (int i = 0; i < size; i++) {
+		ElemType elem;
+		MakeElement(i, elem);
+		elems.add(elem);
+	}
+	for (int i = size - 1; i > 0; i--) {
+		int j = RandomInteger(0, i);
+		ElemType tmp = elems[i];
+		elems[i] = elems[j];
+		elems[j] = tmp;
+	}
+	return elems;
+}
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, long count) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return 1e9 * elapsed.count() / count;
+}
+
+/**
+ * Fills a copy of prototype, which carries the comparator, and probes
+ * it, returning the nanoseconds per element of each step through add
+ * and contains.
+ */
+
+template <typename SetType, typename ElemType>
+static void TimeSet(SetType & prototype, Vector<ElemType> & addOrder,
+                    Vector<ElemType> & findOrder, double & add, double & contains,
+                    long & checksum) {
+	int size = addOrder.size();
+	int reps = (size < kMinElementsTimed) ? kMinElementsTimed / size : 1;
+	add = contains = 0;
+	for (int r = 0; r < reps; r++) {
+		SetType set = prototype;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < size; i++) {
+			set.add(addOrder[i]);
+		}
+		add += NanosecondsSince(start, size);
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < size; i++) {
+			if (set.contains(findOrder[i])) checksum++;
+		}
+		contains += NanosecondsSince(start, size);
+	}
+	add /= reps;
+	contains /= reps;
+}
+
+template <typename SlowSet, typename FastSet, typename ElemType>
+static void CompareSets(string label, SlowSet & slow, FastSet & fast, int size,
+                        bool & agree) {
+	Vector<ElemType> addOrder = ShuffledElements<ElemType>(size);
+	Vector<ElemType> findOrder = ShuffledElements<ElemType>(size);
+	double slowAdd, slowContains, fastAdd, fastContains;
+	long slowChecksum = 0;
+	long fastChecksum = 0;
+	TimeSet(slow, addOrder, findOrder, slowAdd, slowContains, slowChecksum);
+	TimeSet(fast, addOrder, findOrder, fastAdd, fastContains, fastChecksum);
+	if (slowChecksum != fastChecksum) agree = false;
+	cout << setw(35) << label << setw(9) << size << fixed << setprecision(1)
+	     << setw(9) << slowAdd << setw(8) << fastAdd
+	     << setw(9) << slowContains << setw(8) << fastContains
+	     << setw(8) << slowContains / fastContains << "x" << endl;
+}
+
+int main() {
+	SetRandomSeed(106);
+	cout << "Nanoseconds per element, old function-pointer comparator vs inlined comparator"
+	     << endl;
+	cout << setw(35) << "set" << setw(9) << "size" << setw(17) << "add"
+	     << setw(17) << "contains" << setw(10) << "speedup" << endl;
+	bool agree = true;
+	for (int i = 0; i < 3; i++) {
+		Set<string> slow(OperatorCmp);
+		Set<string> fast;
+		CompareSets<Set<string>, Set<string>, string>("Set<string>", slow, fast,
+		                                               kSizes[i], agree);
+	}
+	for (int i = 0; i < 3; i++) {
+		Set<string, BTree> slow(OperatorCmp);
+		Set<string, BTree> fast;
+		CompareSets<Set<string, BTree>, Set<string, BTree>, string>("Set<string, BTree>",
+		                                                             slow, fast,
+		                                                             kSizes[i], agree);
+	}
+	for (int i = 0; i < 3; i++) {
+		Set<location> slow(LocationCompare);
+		Set<location, BST, LocationCmp> fast;
+		CompareSets<Set<location>, Set<location, BST, LocationCmp>, location>(
+			"Set<location, BST, LocationCmp>", slow, fast, kSizes[i], agree);
+	}
+	for (int i = 0; i < 3; i++) {
+		Set<location, BTree> slow(LocationCompare);
+		Set<location, BTree, LocationCmp> fast;
+		CompareSets<Set<location, BTree>, Set<location, BTree, LocationCmp>, location>(
+			"Set<location, BTree, LocationCmp>", slow, fast, kSizes[i], agree);
+	}
+	cout << "Checksums " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
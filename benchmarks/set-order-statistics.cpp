@@ -0,0 +1,156 @@
+/**
+ * File: set-order-statistics.cpp
+ * ------------------------------
+ * Times rank, select and range iteration on sets of growing size, to
+ * show that their cost grows with the log of the size of the set
+ * rather than with the size itself.  For comparison, the same queries
+ * are answered the way they had to be before, by iterating from the
+ * beginning of the set.  Every answer is checked against that one.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "random.h"
+#include "set.h"
+#include "vector.h"
+
+static const int kSizes[] = { 1000, 10000, 100000, 1000000, 4000000 };
+static const int kNumSizes = 5;
+static const int kQueries = 200000;
+static const int kLinearQueries = 20;
+static const int kRangeLength = 10;
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, long count) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return 1e9 * elapsed.count() / count;
+}
+
+/*
+ * The old ways: count from the beginning to find a rank or an element,
+ * and skip from the beginning to the start of a range.
+ */
+
+template <typename SetType>
+static int LinearRank(SetType & set, int key) {
+	int rank = 0;
+	typename SetType::Iterator iter = set.iterator();
+	while (iter.hasNext() && iter.nextRef() < key) {
+		rank++;
+	}
+	return rank;
+}
+
+template <typename SetType>
+static int LinearSelect(SetType & set, int index) {
+	typename SetType::Iterator iter = set.iterator();
+	for (int i = 0; i < index; i++) {
+		iter.nextRef();
+	}
+	return iter.next();
+}
+
+template <typename SetType>
+static long LinearRangeSum(SetType & set, int lo, int hi) {
+	long sum = 0;
+	typename SetType::Iterator iter = set.iterator();
+	while (iter.hasNext()) {
+		int elem = iter.next();
+		if (elem >= hi) break;
+		if (elem >= lo) sum += elem;
+	}
+	return sum;
+}
+
+template <typename SetType>
+static long RangeSum(SetType & set, int lo, int hi) {
+	long sum = 0;
+	typename SetType::Iterator iter = set.iteratorRange(lo, hi);
+	while (iter.hasNext()) {
+		sum += iter.next();
+	}
+	return sum;
+}
+
+/*
+ * Fills set with size of the even numbers below 2 * size, in random
+ * order, so that half of the keys probed are missing.
+ */
+
+template <typename SetType>
+static void FillSet(SetType & set, int size) {
+	Vector<int> elems;
+	for (int i = 0; i < size; i++) {
+		elems.add(2 * i);
+	}
+	for (int i = size - 1; i > 0; i--) {
+		int j = RandomInteger(0, i);
+		int tmp = elems[i];
+		elems[i] = elems[j];
+		elems[j] = tmp;
+	}
+	for (int i = 0; i < size; i++) {
+		set.add(elems[i]);
+	}
+}
+
+template <typename SetType>
+static bool TimeQueries(string label, int size) {
+	SetType set;
+	FillSet(set, size);
+	Vector<int> keys;
+	for (int i = 0; i < kQueries; i++) {
+		keys.add(RandomInteger(0, 2 * size - 1));
+	}
+	long checksum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kQueries; i++) {
+		checksum += set.rank(keys[i]);
+	}
+	double rank = NanosecondsSince(start, kQueries);
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kQueries; i++) {
+		checksum += set.select(keys[i] / 2);
+	}
+	double select = NanosecondsSince(start, kQueries);
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kQueries; i++) {
+		checksum += RangeSum(set, keys[i], keys[i] + 2 * kRangeLength);
+	}
+	double range = NanosecondsSince(start, kQueries);
+
+	bool agree = true;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kLinearQueries; i++) {
+		int key = keys[i];
+		if (LinearRank(set, key) != set.rank(key)) agree = false;
+		if (LinearSelect(set, key / 2) != set.select(key / 2)) agree = false;
+		if (LinearRangeSum(set, key, key + 2 * kRangeLength)
+		    != RangeSum(set, key, key + 2 * kRangeLength)) {
+			agree = false;
+		}
+	}
+	double linear = NanosecondsSince(start, 3 * kLinearQueries);
+	cout << setw(20) << label << setw(9) << size << fixed << setprecision(0)
+	     << setw(9) << rank << setw(9) << select << setw(9) << range
+	     << setw(13) << linear << (checksum == 0 ? " " : "")
+	     << (agree ? "" : "  DISAGREE") << endl;
+	return agree;
+}
+
+int main() {
+	SetRandomSeed(106);
+	cout << "Nanoseconds per query; range returns " << kRangeLength << " elements" << endl;
+	cout << setw(20) << "set" << setw(9) << "size" << setw(9) << "rank" << setw(9)
+	     << "select" << setw(9) << "range" << setw(13) << "from start" << endl;
+	bool agree = true;
+	for (int i = 0; i < kNumSizes; i++) {
+		agree = TimeQueries< Set<int> >("Set<int>", kSizes[i]) && agree;
+	}
+	for (int i = 0; i < kNumSizes; i++) {
+		agree = TimeQueries< Set<int, BTree> >("Set<int, BTree>", kSizes[i]) && agree;
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
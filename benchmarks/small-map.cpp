@@ -0,0 +1,79 @@
+/**
+ * File: small-map.cpp
+ * -------------------
+ * Measures what a short-lived map with 0 to 16 keys costs: building it,
+ * filling it, looking up every key and one missing key, and destroying
+ * it, which is the life of the map extractQueryMap returns.  The plain
+ * hashtable Map<string> is compared against Map<string, 16>, which keeps
+ * up to 16 entries inline, and Map<string, 8>, which spills to its
+ * hashtable partway through the range.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "genlib.h"
+#include "map.h"
+#include "strutils.h"
+#include "vector.h"
+
+static const int kMaxKeys = 16;
+static const int kTargetOperations = 2000000;
+
+/**
+ * Keys of the kind that show up in query strings.
+ */
+
+static const char *const kKeys[kMaxKeys] = {
+	"id", "q", "page", "lang", "utm_source", "utm_medium", "utm_campaign",
+	"ref", "session", "sort", "format", "debug", "limit", "offset", "hl",
+	"source",
+};
+
+/**
+ * Builds, fills, probes and destroys reps maps of numKeys entries, and
+ * returns the average number of nanoseconds each map took.
+ */
+
+template <typename MapType>
+static double TimeMapLifetimes(Vector<string> & keys, int numKeys, int reps, long & checksum) {
+	string missing = "not_a_key";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int r = 0; r < reps; r++) {
+		MapType map;
+		for (int i = 0; i < numKeys; i++) {
+			map[keys[i]] = keys[(i + r) % kMaxKeys];
+		}
+		for (int i = 0; i < numKeys; i++) {
+			if (map.containsKey(keys[i])) checksum += map[keys[i]].size();
+		}
+		if (map.containsKey(missing)) checksum--;
+		checksum += map.size();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return 1e9 * elapsed.count() / reps;
+}
+
+int main() {
+	Vector<string> keys;
+	for (int i = 0; i < kMaxKeys; i++) {
+		keys.add(kKeys[i]);
+	}
+	cout << "Nanoseconds per map (construct, fill, look up every key and a missing one, destroy)"
+	     << endl;
+	cout << setw(6) << "keys" << setw(16) << "Map<string>" << setw(18) << "Map<string, 8>"
+	     << setw(18) << "Map<string, 16>" << setw(10) << "speedup" << endl;
+	long checksums[3] = { 0, 0, 0 };
+	for (int numKeys = 0; numKeys <= kMaxKeys; numKeys++) {
+		int reps = kTargetOperations / (numKeys + 1);
+		double hashed = TimeMapLifetimes< Map<string> >(keys, numKeys, reps, checksums[0]);
+		double small8 = TimeMapLifetimes< Map<string, 8> >(keys, numKeys, reps, checksums[1]);
+		double small16 = TimeMapLifetimes< Map<string, 16> >(keys, numKeys, reps, checksums[2]);
+		cout << setw(6) << numKeys << fixed << setprecision(1) << setw(16) << hashed
+		     << setw(18) << small8 << setw(18) << small16
+		     << setw(9) << hashed / small16 << "x" << endl;
+	}
+	bool agree = (checksums[0] == checksums[1] && checksums[1] == checksums[2]);
+	cout << "Checksums " << (agree ? "agree" : "DISAGREE") << " (" << checksums[0] << ")" << endl;
+	return 0;
+}
@@ -0,0 +1,250 @@
+/**
+ * File: stack-iterators.cpp
+ * -------------------------
+ * Times the Stack on the work an iterator over a tree gives it, next
+ * to the Vector-backed Stack it replaced, reproduced here:
+ *
+ *   short     two hundred thousand in-order iterators over trees of 31
+ *             nodes each, the way a program iterates over many small
+ *             collections.  Each iterator keeps the path from the root
+ *             in its stack, which never holds more than five nodes.
+ *   long      one in-order walk over a tree of four million nodes,
+ *             whose stack holds at most 22.
+ *   deep      a depth-first fill of a 2000 x 2000 grid, whose stack
+ *             grows to millions of locations.
+ *   tokens    ten million pushes and pops of 40-character strings, the
+ *             way a scanner saves and restores tokens.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "genlib.h"
+#include "stack.h"
+#include "vector.h"
+
+static const int kSmallTreeDepth = 5;
+static const int kSmallTrees = 200000;
+static const int kLargeTreeNodes = 4000000;
+static const int kGridSide = 2000;
+static const int kTokenOperations = 10000000;
+
+/*
+ * The old Stack, with just the operations the test uses.
+ */
+
+template <typename ElemType>
+class VectorStack {
+public:
+	bool isEmpty() {
+		return elems.size() == 0;
+	}
+
+	void push(ElemType elem) {
+		elems.add(elem);
+	}
+
+	ElemType pop() {
+		if (isEmpty()) Error("Attempt to pop from empty stack");
+		ElemType top = elems[elems.size() - 1];
+		elems.removeAt(elems.size() - 1);
+		return top;
+	}
+
+	ElemType peek() {
+		if (isEmpty()) Error("Attempt to peek at empty stack");
+		return elems[elems.size() - 1];
+	}
+
+private:
+	Vector<ElemType> elems;
+};
+
+struct nodeT {
+	int value;
+	nodeT *left, *right;
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/*
+ * Builds a perfectly balanced tree over the values lo up to hi in the
+ * array nodes, returning its root.
+ */
+
+static nodeT *BuildTree(nodeT *nodes, int lo, int hi) {
+	if (lo >= hi) return NULL;
+	int mid = lo + (hi - lo) / 2;
+	nodeT *t = &nodes[mid];
+	t->value = mid;
+	t->left = BuildTree(nodes, lo, mid);
+	t->right = BuildTree(nodes, mid + 1, hi);
+	return t;
+}
+
+/*
+ * An in-order iterator in the style of the library's, keeping the nodes
+ * still to be visited on a stack.
+ */
+
+template <typename StackType>
+class TreeIterator {
+public:
+	TreeIterator(nodeT *root) {
+		pushLeftPath(root);
+	}
+
+	bool hasNext() {
+		return !stack.isEmpty();
+	}
+
+	int next() {
+		nodeT *t = stack.pop();
+		pushLeftPath(t->right);
+		return t->value;
+	}
+
+private:
+	StackType stack;
+
+	void pushLeftPath(nodeT *t) {
+		while (t != NULL) {
+			stack.push(t);
+			t = t->left;
+		}
+	}
+};
+
+template <typename StackType>
+static long IterateSmallTrees(nodeT *root) {
+	long total = 0;
+	for (int i = 0; i < kSmallTrees; i++) {
+		TreeIterator<StackType> iter(root);
+		while (iter.hasNext()) {
+			total += iter.next();
+		}
+	}
+	return total;
+}
+
+template <typename StackType>
+static long IterateLargeTree(nodeT *root) {
+	long total = 0;
+	TreeIterator<StackType> iter(root);
+	while (iter.hasNext()) {
+		total += iter.next();
+	}
+	return total;
+}
+
+/*
+ * Fills the grid from its center, four-connected, returning the sum of
+ * the row numbers in the order the locations are reached.
+ */
+
+template <typename StackType>
+static long FillGrid() {
+	Vector<char> seen(kGridSide * kGridSide);
+	for (int i = 0; i < kGridSide * kGridSide; i++) {
+		seen.add(0);
+	}
+	StackType stack;
+	int start = (kGridSide / 2) * kGridSide + kGridSide / 2;
+	seen[start] = 1;
+	stack.push(start);
+	long total = 0;
+	long order = 0;
+	while (!stack.isEmpty()) {
+		int loc = stack.pop();
+		int row = loc / kGridSide;
+		int col = loc % kGridSide;
+		total += row * (++order % 7);
+		int next[4] = { loc - kGridSide, loc + kGridSide, loc - 1, loc + 1 };
+		bool inside[4] = { row > 0, row < kGridSide - 1, col > 0, col < kGridSide - 1 };
+		for (int d = 0; d < 4; d++) {
+			if (inside[d] && !seen[next[d]]) {
+				seen[next[d]] = 1;
+				stack.push(next[d]);
+			}
+		}
+	}
+	return total;
+}
+
+template <typename StackType>
+static long SaveTokens() {
+	StackType stack;
+	string token(40, 'a');
+	long total = 0;
+	for (int i = 0; i < kTokenOperations / 4; i++) {
+		token[i % 40] = char('a' + i % 26);
+		stack.push(token);
+		stack.push(token);
+		total += stack.pop().length();
+		total += stack.pop()[i % 40];
+	}
+	return total;
+}
+
+template <typename StackType>
+static void RunTreeTests(nodeT *smallRoot, nodeT *largeRoot, double seconds[], long totals[]) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	totals[0] = IterateSmallTrees<StackType>(smallRoot);
+	seconds[0] = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	totals[1] = IterateLargeTree<StackType>(largeRoot);
+	seconds[1] = SecondsSince(start);
+}
+
+int main() {
+	int smallSize = (1 << kSmallTreeDepth) - 1;
+	nodeT *smallNodes = new nodeT[smallSize];
+	nodeT *smallRoot = BuildTree(smallNodes, 0, smallSize);
+	nodeT *largeNodes = new nodeT[kLargeTreeNodes];
+	nodeT *largeRoot = BuildTree(largeNodes, 0, kLargeTreeNodes);
+
+	double oldSeconds[4], newSeconds[4];
+	long oldTotals[4], newTotals[4];
+	RunTreeTests< VectorStack<nodeT *> >(smallRoot, largeRoot, oldSeconds, oldTotals);
+	RunTreeTests< Stack<nodeT *> >(smallRoot, largeRoot, newSeconds, newTotals);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	oldTotals[2] = FillGrid< VectorStack<int> >();
+	oldSeconds[2] = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	newTotals[2] = FillGrid< Stack<int> >();
+	newSeconds[2] = SecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	oldTotals[3] = SaveTokens< VectorStack<string> >();
+	oldSeconds[3] = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	newTotals[3] = SaveTokens< Stack<string> >();
+	newSeconds[3] = SecondsSince(start);
+
+	cout << "Seconds for each test" << endl;
+	cout << setw(10) << "stack" << setw(10) << "short" << setw(10) << "long"
+	     << setw(10) << "deep" << setw(10) << "tokens" << endl;
+	cout << fixed << setprecision(3);
+	cout << setw(10) << "vector";
+	for (int i = 0; i < 4; i++) {
+		cout << setw(10) << oldSeconds[i];
+	}
+	cout << endl << setw(10) << "inline";
+	for (int i = 0; i < 4; i++) {
+		cout << setw(10) << newSeconds[i];
+	}
+	cout << endl;
+	bool agree = true;
+	for (int i = 0; i < 4; i++) {
+		agree = agree && oldTotals[i] == newTotals[i];
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	delete[] smallNodes;
+	delete[] largeNodes;
+	return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * File: test-corpus-loading.cpp
+ * -----------------------------
+ * Generates a one-million-case test corpus and times loading it two
+ * ways: with the original getline-based buildTestCases, which builds
+ * every testCase up front, and with the TestCorpus, which maps the file
+ * and indexes it, then builds each case only when it's asked for.  The
+ * generated cases are also run through extractQueryMap, both as a check
+ * on the generator and to show what a full regression pass costs.
+ */
+
+#include "genlib.h"
+#include "map.h"
+#include "set.h"
+#include "vector.h"
+#include "strutils.h"
+#include "url-query.h"
+#include "test-corpus.h"
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+static const int kNumCases = 1000000;
+static const char *const kCorpusFile = "test-corpus-bench.dat";
+
+/**
+ * The original loader from extract-query-map.cpp, kept here as the
+ * baseline.
+ */
+
+static const char kEndOfLine = '\n';
+static Vector<testCase> LegacyBuildTestCases(string filename) {
+	ifstream infile(filename.c_str());
+	Vector<testCase> testCases;
+	while (true) {
+		string url;
+		getline(infile, url, kEndOfLine);
+		if (infile.fail()) return testCases;
+		testCase test;
+		test.url = url;
+		test.numParams = 0;
+		string numPairsString;
+		getline(infile, numPairsString, kEndOfLine);
+		int numPairs = StringToInteger(numPairsString);
+		for (int i = 0; i < numPairs; i++) {
+			string key, value;
+			getline(infile, key, kEndOfLine);
+			getline(infile, value, kEndOfLine);
+			test.fullKeyValuePairs.put(key, value);
+			test.numParams++;
+		}
+		string numArbitraryKeysString;
+		getline(infile, numArbitraryKeysString, kEndOfLine);
+		int numArbitraryKeys = StringToInteger(numArbitraryKeysString);
+		for (int j = 0; j < numArbitraryKeys; j++) {
+			string key;
+			getline(infile, key, kEndOfLine);
+			test.arbitraryKeys.add(key);
+			test.numParams++;
+		}
+		testCases.add(test);
+	}
+}
+
+/**
+ * A quiet version of the harness's testCasePasses.
+ */
+
+static bool Passes(testCase & test) {
+	QueryMap parameterMap = extractQueryMap(test.url);
+	if (parameterMap.size() != test.numParams) return false;
+	for (const string & key : test.fullKeyValuePairs) {
+		if (!parameterMap.containsKey(key)) return false;
+		if (parameterMap[key] != test.fullKeyValuePairs[key]) return false;
+	}
+	for (const string & key : test.arbitraryKeys) {
+		if (!parameterMap.containsKey(key)) return false;
+	}
+	return true;
+}
+
+static double SecondsSince(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Times each way of walking the corpus with a TestCorpus.  This is a
+ * function of its own so that the file is unmapped before main
+ * removes it.
+ */
+
+static void RunCorpusPasses() {
+	clock_t start = clock();
+	TestCorpus corpus(kCorpusFile);
+	cout << "  TestCorpus map + index:           " << SecondsSince(start) << "s"
+	     << " (" << corpus.size() << " cases)" << endl;
+
+	start = clock();
+	long checksum = 0;
+	for (int i = 0; i < corpus.size(); i++) {
+		checksum += corpus.getURL(i).size();
+	}
+	cout << "  TestCorpus getURL, every case:    " << SecondsSince(start) << "s"
+	     << " (checksum " << checksum << ")" << endl;
+
+	start = clock();
+	checksum = 0;
+	for (int i = 0; i < corpus.size(); i++) {
+		checksum += corpus.getCase(i).numParams;
+	}
+	cout << "  TestCorpus getCase, every case:   " << SecondsSince(start) << "s"
+	     << " (checksum " << checksum << ")" << endl;
+
+	start = clock();
+	int numFailures = 0;
+	for (int i = 0; i < corpus.size(); i++) {
+		testCase test = corpus.getCase(i);
+		if (!Passes(test)) numFailures++;
+	}
+	cout << "  TestCorpus getCase + check:       " << SecondsSince(start) << "s"
+	     << " (" << numFailures << " failures)" << endl;
+}
+
+int main() {
+	clock_t start = clock();
+	GenerateTestCorpus(kCorpusFile, kNumCases);
+	cout << "Generated " << kNumCases << " test cases in " << SecondsSince(start) << "s." << endl;
+
+	start = clock();
+	long checksum = 0;
+	{
+		Vector<testCase> testCases = LegacyBuildTestCases(kCorpusFile);
+		for (int i = 0; i < testCases.size(); i++) {
+			checksum += testCases[i].numParams;
+		}
+	}
+	cout << "  buildTestCases (getline, eager):  " << SecondsSince(start) << "s"
+	     << " (checksum " << checksum << ")" << endl;
+
+	RunCorpusPasses();
+	remove(kCorpusFile);
+	return 0;
+}
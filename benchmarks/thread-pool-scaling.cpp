@@ -0,0 +1,170 @@
+/**
+ * File: thread-pool-scaling.cpp
+ * -----------------------------
+ * Times four kinds of work on a ThreadPool of 1 worker, 2 workers and
+ * so on up to one per core, next to a plain loop on one thread:
+ *
+ *   map       parallelFor over a Vector of four million doubles,
+ *             replacing each with a short formula of itself.  Memory
+ *             bandwidth limits this one.
+ *   reduce    parallelReduce over twenty million indexes, summing a
+ *             few dozen arithmetic steps per index.
+ *   uneven    parallelReduce over twenty thousand rows of a triangle,
+ *             where row i takes i steps, so the work is piled up at
+ *             one end of the range and has to be stolen to balance.
+ *   tasks     a recursive Fibonacci sum that submits one future per
+ *             call down to a cutoff, about eleven thousand tasks.
+ *
+ * Each figure is seconds, with the speedup over the plain loop in
+ * parentheses.  The calling thread helps the workers while it waits,
+ * so a pool of n workers can keep n + 1 threads busy.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "genlib.h"
+#include "vector.h"
+#include "threadpool.h"
+
+static const int kMapSize = 4000000;
+static const int kReduceSize = 20000000;
+static const int kTriangleRows = 20000;
+static const int kFibN = 36;
+static const int kFibCutoff = 18;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+static double MapStep(double x) {
+	return std::sqrt(x) * 0.5 + 1.0;
+}
+
+/*
+ * A few dozen dependent arithmetic steps, enough that the reduction is
+ * limited by the processor rather than by memory.
+ */
+
+static long ReduceStep(int i) {
+	unsigned long x = unsigned(i);
+	for (int k = 0; k < 32; k++) {
+		x = x * 6364136223846793005UL + 1442695040888963407UL;
+	}
+	return long(x >> 40);
+}
+
+static long TriangleRow(int row) {
+	long sum = 0;
+	for (int k = 0; k < row; k++) {
+		sum += (long(row) * k) % 7;
+	}
+	return sum;
+}
+
+static long SerialFib(int n) {
+	return (n < 2) ? n : SerialFib(n - 1) + SerialFib(n - 2);
+}
+
+static long TaskFib(ThreadPool & pool, int n) {
+	if (n < kFibCutoff) return SerialFib(n);
+	Future<long> left = pool.submit([&pool, n] { return TaskFib(pool, n - 1); });
+	long right = TaskFib(pool, n - 2);
+	return left.get() + right;
+}
+
+static Vector<double> MapInput() {
+	Vector<double> vec(kMapSize);
+	for (int i = 0; i < kMapSize; i++) {
+		vec.add(i);
+	}
+	return vec;
+}
+
+/*
+ * Runs the four tests, on pool if it is not NULL and in plain loops if
+ * it is, storing the times in seconds and returning a checksum.
+ */
+
+static double RunAll(ThreadPool *pool, double seconds[]) {
+	double checksum = 0;
+
+	Vector<double> vec = MapInput();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (pool == NULL) {
+		for (int i = 0; i < vec.size(); i++) {
+			vec[i] = MapStep(vec[i]);
+		}
+	} else {
+		pool->parallelFor(vec, [](double & x) { x = MapStep(x); });
+	}
+	seconds[0] = SecondsSince(start);
+	checksum += vec[kMapSize - 1];
+
+	start = std::chrono::steady_clock::now();
+	long sum = 0;
+	if (pool == NULL) {
+		for (int i = 0; i < kReduceSize; i++) {
+			sum += ReduceStep(i);
+		}
+	} else {
+		sum = pool->parallelReduce(0, kReduceSize, 0L, ReduceStep,
+		                           [](long a, long b) { return a + b; });
+	}
+	seconds[1] = SecondsSince(start);
+	checksum += sum;
+
+	start = std::chrono::steady_clock::now();
+	if (pool == NULL) {
+		sum = 0;
+		for (int row = 0; row < kTriangleRows; row++) {
+			sum += TriangleRow(row);
+		}
+	} else {
+		sum = pool->parallelReduce(0, kTriangleRows, 0L, TriangleRow,
+		                           [](long a, long b) { return a + b; });
+	}
+	seconds[2] = SecondsSince(start);
+	checksum += sum;
+
+	start = std::chrono::steady_clock::now();
+	long fib = (pool == NULL) ? SerialFib(kFibN) : TaskFib(*pool, kFibN);
+	seconds[3] = SecondsSince(start);
+	checksum += fib;
+	return checksum;
+}
+
+int main() {
+	int cores = std::thread::hardware_concurrency();
+	if (cores <= 0) cores = 1;
+	cout << "Seconds (speedup) on " << cores << " cores" << endl;
+	cout << setw(8) << "workers" << setw(16) << "map" << setw(16) << "reduce"
+	     << setw(16) << "uneven" << setw(16) << "tasks" << endl;
+	cout << fixed << setprecision(3);
+
+	double serial[4];
+	double expected = RunAll(NULL, serial);
+	cout << setw(8) << "serial";
+	for (int i = 0; i < 4; i++) {
+		cout << setw(16) << serial[i];
+	}
+	cout << endl;
+
+	bool agree = true;
+	for (int workers = 1; workers <= cores; workers++) {
+		ThreadPool pool(workers);
+		double seconds[4];
+		agree = agree && RunAll(&pool, seconds) == expected;
+		cout << setw(8) << workers;
+		for (int i = 0; i < 4; i++) {
+			cout << setw(8) << seconds[i] << " (" << setprecision(1) << setw(4)
+			     << serial[i] / seconds[i] << ")" << setprecision(3);
+		}
+		cout << endl;
+	}
+	cout << "Results " << (agree ? "agree" : "DISAGREE") << endl;
+	return 0;
+}
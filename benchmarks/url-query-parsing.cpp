@@ -0,0 +1,151 @@
+/**
+ * File: url-query-parsing.cpp
+ * ---------------------------
+ * Measures query-string parsing throughput, in URLs per second, over a
+ * synthetic corpus of URLs.  Three approaches are compared: the original
+ * Explode-based extractQueryMap (reproduced here as the baseline), the
+ * current Map-building extractQueryMap, and a bare QueryTokenizer pass
+ * that only looks at the keys and values.
+ */
+
+#include "genlib.h"
+#include "map.h"
+#include "random.h"
+#include "vector.h"
+#include "url-query.h"
+#include <ctime>
+#include <iostream>
+
+static const int kNumURLs = 200000;
+static const int kMaxParams = 12;
+
+/**
+ * The original implementation, kept here as the baseline.
+ */
+
+static Vector<string> LegacyExplode(string str, char delim) {
+	Vector<string> explosion;
+	string cluster;
+	str += delim;
+	for (size_t i = 0; i < str.size(); i++) {
+		if (str[i] == delim) {
+			explosion.add(cluster);
+			cluster.clear();
+		} else {
+			cluster += str[i];
+		}
+	}
+	return explosion;
+}
+
+static Map<string> LegacyExtractQueryMap(string url) {
+	Map<string> parameters;
+	size_t index = url.find('?');
+	if (index == string::npos) return parameters;
+	string query = url.substr(index + 1);
+	index = query.find('#');
+	if (index != string::npos) query = query.substr(0, index);
+	Vector<string> pairs = LegacyExplode(query, '&');
+	for (int i = 0; i < pairs.size(); i++) {
+		Vector<string> components = LegacyExplode(pairs[i], '=');
+		string value = "true";
+		if (components.size() > 1 && !components[1].empty()) {
+			value = components[1];
+		}
+		parameters[components[0]] = value;
+	}
+	return parameters;
+}
+
+/**
+ * Returns a random run of lowercase letters and digits whose length
+ * is between minLength and maxLength.
+ */
+
+static string RandomToken(int minLength, int maxLength) {
+	static const string kAlphabet = "abcdefghijklmnopqrstuvwxyz0123456789";
+	string token;
+	int length = RandomInteger(minLength, maxLength);
+	for (int i = 0; i < length; i++) {
+		token += kAlphabet[RandomInteger(0, kAlphabet.size() - 1)];
+	}
+	return token;
+}
+
+/**
+ * Builds a URL with up to kMaxParams parameters, some without values,
+ * some percent-encoded, and some followed by a fragment.
+ */
+
+static string RandomURL() {
+	string url = "http://www." + RandomToken(4, 12) + ".com/" + RandomToken(0, 20);
+	int numParams = RandomInteger(0, kMaxParams);
+	for (int i = 0; i < numParams; i++) {
+		url += (i == 0) ? '?' : '&';
+		url += RandomToken(1, 10);
+		if (RandomChance(0.85)) {
+			url += "=" + RandomToken(0, 24);
+			if (RandomChance(0.1)) url += "%20" + RandomToken(1, 6);
+		}
+	}
+	if (RandomChance(0.2)) url += "#" + RandomToken(1, 16);
+	return url;
+}
+
+static void Report(string label, clock_t start, long checksum) {
+	double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+	cout << "  " << label << ": " << kNumURLs / seconds / 1e6 << "M URLs/s"
+	     << " (checksum " << checksum << ")" << endl;
+}
+
+int main() {
+	SetRandomSeed(106);
+	Vector<string> urls(kNumURLs);
+	for (int i = 0; i < kNumURLs; i++) {
+		urls.add(RandomURL());
+	}
+	cout << "Parsing " << kNumURLs << " synthetic URLs." << endl;
+
+	long checksum = 0;
+	clock_t start = clock();
+	for (int i = 0; i < urls.size(); i++) {
+		checksum += LegacyExtractQueryMap(urls[i]).size();
+	}
+	Report("Explode-based extractQueryMap", start, checksum);
+
+	checksum = 0;
+	start = clock();
+	for (int i = 0; i < urls.size(); i++) {
+		checksum += extractQueryMap(urls[i]).size();
+	}
+	Report("tokenizer-based extractQueryMap", start, checksum);
+
+	checksum = 0;
+	start = clock();
+	for (int i = 0; i < urls.size(); i++) {
+		QueryTokenizer tokenizer(urls[i]);
+		while (tokenizer.hasNext()) {
+			queryParameter param = tokenizer.next();
+			checksum += param.key.size() + param.value.size();
+		}
+	}
+	Report("QueryTokenizer alone          ", start, checksum);
+
+	checksum = 0;
+	start = clock();
+	string decoded;
+	for (int i = 0; i < urls.size(); i++) {
+		QueryTokenizer tokenizer(urls[i]);
+		while (tokenizer.hasNext()) {
+			queryParameter param = tokenizer.next();
+			if (NeedsDecoding(param.value)) {
+				DecodeQueryComponent(param.value, decoded);
+				checksum += decoded.size();
+			} else {
+				checksum += param.value.size();
+			}
+		}
+	}
+	Report("QueryTokenizer + decoding     ", start, checksum);
+	return 0;
+}
@@ -57,7 +57,7 @@ bool IsInRange(location one, location two, double distance) {
  */
 
 bool IsInRange(Set<location>& landMines, location& potentialLandMine, double threshold) {
-	foreach (location landMine in landMines) {
+	for (location landMine : landMines) {
 		if (IsInRange(landMine, potentialLandMine, threshold)) {
 			return true;
 		}
@@ -109,7 +109,7 @@ location GetUserSelection(Set<location>& landMines) {
 		WaitForMouseDown();
 		location selection = { GetMouseX(), GetMouseY() };
 		UpdateChainReactionDisplay();
-		foreach (location landMine in landMines) {
+		for (location landMine : landMines) {
 			if (IsInRange(landMine, selection, kLandMineRadius)) {
 				return landMine;
 			}
@@ -13,8 +13,8 @@
 
 #include "genlib.h"
 #include "cmpfn.h"
-#include "stack.h"
-#include "foreach.h"
+#include "vector.h"
+#include <utility>
 
 /*
  * Class: BST
@@ -26,14 +26,22 @@
  * The one requirement on the element type is that the client must
  * supply a comparison fn that compares two elements (or be willing
  * to use the default comparison function that relies on < and ==).
+ *
+ * The comparison is made by a comparator object, whose type is the
+ * optional second template argument.  The default, FunctionCompare
+ * from cmpfn.h, holds the comparison function passed to the
+ * constructor, or applies < and == inline if there is none.  A client
+ * that wants its own ordering inlined too can name a comparator class
+ * instead, e.g. BST<studentT, CompareById>; see cmpfn.h.
  */
 
-template <typename ElemType>
+template <typename ElemType, typename Comparator = FunctionCompare<ElemType> >
 class BST {
 public:
 
 /* Forward references */
 	class Iterator;
+	class RangeIterator;
 
 /*
  * Constructor: BST
@@ -44,12 +52,14 @@ public:
  * The constructor initializes a new empty binary search tree.
  * The one argument is a comparison function, which is called
  * to compare data values.  This argument is optional, if not
- * given, the OperatorCmp function from cmpfn.h is used, which
- * applies the built-in operator < to its operands. If the
- * behavior of < on your ElemType is defined and sufficient,
- * you do not need to supply your own comparison function.
+ * given, the elements are compared as by the OperatorCmp function
+ * from cmpfn.h, which applies the built-in operator < to its
+ * operands. If the behavior of < on your ElemType is defined and
+ * sufficient, you do not need to supply your own comparison function.
+ * When the tree has a comparator class of its own, the argument is
+ * an object of that class instead.
  */
-	BST(int (*cmpFn)(ElemType one, ElemType two) = OperatorCmp);
+	BST(Comparator cmpFn = Comparator());
 
 /*
  * Destructor: ~BST
@@ -122,6 +132,63 @@ public:
  */
 	void clear();
 
+/*
+ * Method: buildFromSorted
+ * Usage: bst.buildFromSorted(elems);
+ * ----------------------------------
+ * This method replaces the contents of this tree with the elements
+ * of elems, which must be in strictly increasing order.  The tree is
+ * built in a single pass, already balanced, in time proportional to
+ * the number of elements rather than by adding them one at a time.
+ * The elements are moved out of elems, which is left empty.
+ */
+	void buildFromSorted(Vector<ElemType> & elems);
+
+/*
+ * Method: joinWith
+ * Usage: bst.joinWith(other);
+ * ---------------------------
+ * This method moves all of the elements of other into this tree,
+ * leaving other empty.  Every element of other must come after every
+ * element of this tree, as they would if the two trees had been made
+ * by splitAt.  The trees are joined without visiting their elements,
+ * in time proportional to the height of the taller one.
+ */
+	void joinWith(BST & other);
+
+/*
+ * Method: splitAt
+ * Usage: bst.splitAt(key, rest);
+ * ------------------------------
+ * This method moves every element that is not less than key from
+ * this tree into rest, replacing whatever rest held before.  The
+ * tree is cut along the search path for key in time proportional to
+ * its height.
+ */
+	void splitAt(ElemType key, BST & rest);
+
+/*
+ * Method: rank
+ * Usage: n = bst.rank(key);
+ * -------------------------
+ * This method returns the number of elements in this tree that are
+ * less than key, which is the index key has or would have in the
+ * order of the tree.  Each node keeps the size of its subtree, so the
+ * count takes time proportional to the height of the tree.
+ */
+	int rank(ElemType key);
+
+/*
+ * Method: select
+ * Usage: val = bst.select(index);
+ * -------------------------------
+ * This method returns the element at the given index in the order of
+ * the tree, counting from 0, in time proportional to the height of
+ * the tree.  It is an error to give an index outside the range from
+ * 0 to size() - 1.
+ */
+	ElemType select(int index);
+
 /*
  * Method: mapAll
  * Usage: bst.mapAll(Print);
@@ -153,7 +220,9 @@ public:
  * This method creates an iterator that allows the client to
  * iterate through the elements in this binary search tree.  The
  * order of elements produced by the iterator is that of an InOrder
- * walk of the tree.
+ * walk of the tree.  The iterator finds its way from node to node
+ * through the links in the tree itself, so it takes only constant
+ * space no matter how large the tree is.
  *
  * The idiomatic code for accessing elements using an iterator is
  * to create the iterator from the collection and then enter a loop
@@ -165,9 +234,10 @@ public:
  *         . . .
  *     }
  *
- * This pattern can be abbreviated to the following more readable form:
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
  *
- *     foreach (string key in bst) {
+ *     for (string key : bst) {
  *         . . .
  *     }
  *
@@ -176,6 +246,44 @@ public:
  */
 	Iterator iterator();
 
+/*
+ * Method: reverseIterator
+ * Usage: iter = bst.reverseIterator();
+ * ------------------------------------
+ * This method creates an iterator that returns the elements of this
+ * tree in the opposite order, from the largest to the smallest.
+ */
+	Iterator reverseIterator();
+
+/*
+ * Methods: iteratorFrom, iteratorRange
+ * Usage: iter = bst.iteratorFrom(lo);
+ *        iter = bst.iteratorRange(lo, hi);
+ * ----------------------------------------
+ * These methods create iterators that start at the first element that
+ * is not less than lo, rather than at the beginning of the tree.  The
+ * one from iteratorFrom runs to the end of the tree; the one from
+ * iteratorRange stops before the first element that is not less than
+ * hi, and so returns the elements in the range [lo, hi).  Either one
+ * is created in time proportional to the height of the tree.
+ */
+	Iterator iteratorFrom(ElemType lo);
+	Iterator iteratorRange(ElemType lo, ElemType hi);
+
+/*
+ * Methods: begin, end
+ * Usage: for (const string & key : bst) . . .
+ * -------------------------------------------
+ * These methods return iterators to the smallest element of this tree
+ * and just past the largest, so that a range-based for loop visits the
+ * elements in order without copying them.  Each element is given as a
+ * const reference, since changing it could break the order of the
+ * tree.  Adding or removing elements during the loop leaves the
+ * iterators dangling.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
 private:
 
 #include "private/bst.h"
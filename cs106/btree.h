@@ -0,0 +1,258 @@
+/*
+ * File: btree.h
+ * -------------
+ * This interface file contains the BTree class template, an ordered
+ * collection of distinct elements stored in a B+-tree.  It offers the
+ * same operations as the BST class template and can stand in for it
+ * wherever a BST is used, including as the storage behind a Set.
+ */
+
+#ifndef _btree_h
+#define _btree_h
+
+#include "genlib.h"
+#include "cmpfn.h"
+#include "vector.h"
+#include <utility>
+
+/*
+ * Class: BTree
+ * ------------
+ * This interface defines a class template for an ordered set of
+ * elements kept in a B+-tree.  Where the BST allocates a node for each
+ * element, the BTree packs many elements into each node, sized to span
+ * a few cache lines, so a search touches a handful of nodes instead of
+ * one node per level of a binary tree.  The elements themselves live
+ * in the leaves, which are chained together in order; the interior
+ * nodes hold copies of elements that serve only as signposts.
+ *
+ * As with the BST, the element type is set by the client, and the one
+ * requirement on it is a comparison function that compares two
+ * elements (or the default, which relies on < and ==).  The optional
+ * second template argument is the comparator class, exactly as for
+ * the BST.  The element type must also have a default constructor,
+ * since each node reserves room for all of the elements it can hold.
+ */
+
+template <typename ElemType, typename Comparator = FunctionCompare<ElemType> >
+class BTree {
+public:
+
+/* Forward references */
+	class Iterator;
+	class RangeIterator;
+
+/*
+ * Constructor: BTree
+ * Usage: BTree<int> tree;
+ *        BTree<song> songs(CompareSong)
+ *        BTree<string> *tp = new BTree<string>;
+ * -----------------------------------------------
+ * The constructor initializes a new empty tree.  The optional argument
+ * is a comparison function, exactly as for the BST; if it is not given,
+ * the elements are compared as by the OperatorCmp function from
+ * cmpfn.h.
+ */
+	BTree(Comparator cmpFn = Comparator());
+
+/*
+ * Destructor: ~BTree
+ * Usage: delete tp;
+ * -----------------
+ * The destructor deallocates storage for this tree.
+ */
+	~BTree();
+
+/*
+ * Method: size
+ * Usage: count = tree.size();
+ * ---------------------------
+ * This method returns the number of elements in this tree.
+ */
+	int size();
+
+/*
+ * Method: isEmpty
+ * Usage: if (tree.isEmpty())...
+ * -----------------------------
+ * This method returns true if this tree contains no
+ * elements, false otherwise.
+ */
+	bool isEmpty();
+
+/*
+ * Method: find
+ * Usage:  if (tree.find(key) != NULL) . . .
+ * -----------------------------------------
+ * This method searches the tree for an element matching key.  If one
+ * is found, find returns a pointer to the element; otherwise, find
+ * returns NULL.  The pointer remains valid until the tree is next
+ * modified, since adding or removing elements can move the others
+ * between nodes.
+ */
+	ElemType *find(ElemType key);
+
+/*
+ * Method: add
+ * Usage: tree.add(val);
+ * ---------------------
+ * This method adds an element to this tree.  If an element with the
+ * same value already exists, it is overwritten with the new copy and
+ * false is returned.  Otherwise, the element is added and true is
+ * returned.
+ */
+	bool add(ElemType elem);
+
+/*
+ * Method: remove
+ * Usage: tree.remove(key);
+ * ------------------------
+ * This method removes the element in this tree that matches the
+ * specified key.  If one is found, it is removed and true is returned.
+ * If no match is found, no changes are made and false is returned.
+ */
+	bool remove(ElemType key);
+
+/*
+ * Method: clear
+ * Usage: tree.clear();
+ * --------------------
+ * This method removes all elements from this tree.
+ */
+	void clear();
+
+/*
+ * Method: buildFromSorted
+ * Usage: tree.buildFromSorted(elems);
+ * -----------------------------------
+ * This method replaces the contents of this tree with the elements
+ * of elems, which must be in strictly increasing order.  The leaves
+ * are filled left to right and the interior nodes built above them,
+ * in time proportional to the number of elements.  The elements are
+ * moved out of elems, which is left empty.
+ */
+	void buildFromSorted(Vector<ElemType> & elems);
+
+/*
+ * Method: rank
+ * Usage: n = tree.rank(key);
+ * --------------------------
+ * This method returns the number of elements in this tree that are
+ * less than key, which is the index key has or would have in the
+ * order of the tree.  Each interior node keeps the number of elements
+ * under each of its children, so the count takes time proportional
+ * to the height of the tree.
+ */
+	int rank(ElemType key);
+
+/*
+ * Method: select
+ * Usage: val = tree.select(index);
+ * --------------------------------
+ * This method returns the element at the given index in the order of
+ * the tree, counting from 0, in time proportional to the height of
+ * the tree.  It is an error to give an index outside the range from
+ * 0 to size() - 1.
+ */
+	ElemType select(int index);
+
+/*
+ * Method: mapAll
+ * Usage: tree.mapAll(Print);
+ * --------------------------
+ * This method iterates through this tree and calls the function fn
+ * once for each element, in order.
+ */
+	void mapAll(void (*fn)(ElemType elem));
+
+/*
+ * Method: mapAll
+ * Usage: tree.mapAll(PrintToFile, outputStream);
+ * ----------------------------------------------
+ * This method iterates through this tree and calls the function fn
+ * once for each element, in order, passing the element and the
+ * client's data.  That data can be of whatever type is needed for the
+ * client's callback.
+ */
+	template <typename ClientDataType>
+	void mapAll(void (*fn)(ElemType elem, ClientDataType & data),
+	            ClientDataType & data);
+
+/*
+ * Method: iterator
+ * Usage: iter = tree.iterator();
+ * ------------------------------
+ * This method creates an iterator that allows the client to iterate
+ * through the elements in this tree in order.  The iterator walks the
+ * chain of leaves, so it needs no stack and costs the same to create
+ * no matter how large the tree is.
+ *
+ * The idiomatic code for accessing elements using an iterator is
+ * to create the iterator from the collection and then enter a loop
+ * that calls next() while hasNext() is true, like this:
+ *
+ *     BTree<string>::Iterator iter = tree.iterator();
+ *     while (iter.hasNext()) {
+ *         string key = iter.next();
+ *         . . .
+ *     }
+ *
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
+ *
+ *     for (string key : tree) {
+ *         . . .
+ *     }
+ *
+ * To avoid exposing the details of the class, the definition of the
+ * Iterator class itself appears in the private/btree.h file.
+ */
+	Iterator iterator();
+
+/*
+ * Method: reverseIterator
+ * Usage: iter = tree.reverseIterator();
+ * -------------------------------------
+ * This method creates an iterator that returns the elements of this
+ * tree in the opposite order, from the largest to the smallest.
+ */
+	Iterator reverseIterator();
+
+/*
+ * Methods: iteratorFrom, iteratorRange
+ * Usage: iter = tree.iteratorFrom(lo);
+ *        iter = tree.iteratorRange(lo, hi);
+ * -----------------------------------------
+ * These methods create iterators that start at the first element that
+ * is not less than lo, rather than at the beginning of the tree.  The
+ * one from iteratorFrom runs to the end of the tree; the one from
+ * iteratorRange stops before the first element that is not less than
+ * hi, and so returns the elements in the range [lo, hi).  Either one
+ * is created in time proportional to the height of the tree.
+ */
+	Iterator iteratorFrom(ElemType lo);
+	Iterator iteratorRange(ElemType lo, ElemType hi);
+
+/*
+ * Methods: begin, end
+ * Usage: for (const string & key : tree) . . .
+ * --------------------------------------------
+ * These methods return iterators to the smallest element of this tree
+ * and just past the largest, so that a range-based for loop visits the
+ * elements in order without copying them.  Each element is given as a
+ * const reference, since changing it could break the order of the
+ * tree.  Adding or removing elements during the loop leaves the
+ * iterators dangling.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
+private:
+
+#include "private/btree.h"
+
+};
+
+#include "private/btree.cpp"
+
+#endif
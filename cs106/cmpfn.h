@@ -2,12 +2,18 @@
  * File: cmpfn.h
  * Last modified on Wed Sep 18 14:38:14 2002 by zelenski
  * -----------------------------------------------------
- * This interface exports a comparison function template.
+ * This interface exports a comparison function template, along
+ * with the comparator classes that the ordered collections (BST,
+ * BTree and Set) take as a template argument.
  */
 
 #ifndef _cmpfn_h
 #define _cmpfn_h
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 /*
  * Function template: OperatorCmp
  * Usage:  int sign = OperatorCmp(val1, val2);
@@ -25,4 +31,108 @@ int OperatorCmp(Type one, Type two) {
 	return 1;
 }
 
+/*
+ * Class template: OperatorCompare
+ * Usage: Set<string, BST, OperatorCompare<string> > set;
+ * ------------------------------------------------------
+ * A comparator object that does what OperatorCmp does, but takes its
+ * arguments by reference and can be inlined into the collection that
+ * calls it.  Any class with an operator() like this one's can serve
+ * as a comparator:
+ *
+ *     struct CompareById {
+ *         int operator()(const student & one, const student & two) const {
+ *             return one.id - two.id;
+ *         }
+ *     };
+ */
+template <typename Type>
+struct OperatorCompare {
+	int operator()(const Type & one, const Type & two) const {
+		if (one == two) return 0;
+		if (one < two) return -1;
+		return 1;
+	}
+};
+
+/*
+ * Trait: HasOperatorCmp
+ * ---------------------
+ * HasOperatorCmp<Type>::value is true if OperatorCmp can compare two
+ * values of Type, which is to say that Type has == and <.
+ */
+template <typename Type, typename = void>
+struct HasOperatorCmp : std::false_type {
+};
+
+template <typename Type>
+struct HasOperatorCmp<Type,
+	std::void_t<decltype(std::declval<const Type &>() == std::declval<const Type &>()),
+	            decltype(std::declval<const Type &>() < std::declval<const Type &>())> >
+	: std::true_type {
+};
+
+/*
+ * Class template: FunctionCompare
+ * Usage: FunctionCompare<student> cmp(CompareStudents);
+ * -----------------------------------------------------
+ * The default comparator of the ordered collections.  It adapts an
+ * old-style comparison function, which takes its arguments by value,
+ * so that code such as
+ *
+ *     Set<student> students(CompareStudents);
+ *
+ * keeps working.  A FunctionCompare made without a function compares
+ * with OperatorCompare instead, inline and with no copies, which is
+ * what a collection declared without a comparison function gets.  As
+ * with OperatorCmp, that is only possible for a type with == and <.
+ */
+template <typename Type>
+class FunctionCompare {
+public:
+	FunctionCompare() {
+		static_assert(HasOperatorCmp<Type>::value,
+		              "this element type needs a comparison function");
+		fn = NULL;
+	}
+
+	FunctionCompare(int (*fn)(Type, Type)) {
+		this->fn = fn;
+	}
+
+	int operator()(const Type & one, const Type & two) const {
+		if constexpr (HasOperatorCmp<Type>::value) {
+			if (fn == NULL) return OperatorCompare<Type>()(one, two);
+		}
+		return fn(one, two);
+	}
+
+	bool operator==(const FunctionCompare & other) const {
+		return fn == other.fn;
+	}
+
+private:
+	int (*fn)(Type, Type);
+};
+
+/*
+ * Function template: SameComparator
+ * Usage: if (SameComparator(cmp1, cmp2)) . . .
+ * --------------------------------------------
+ * Returns false if two comparators are known to order elements
+ * differently, which is the case for FunctionCompare objects made
+ * from different functions.  Comparators of any other type are
+ * assumed to agree.
+ */
+template <typename Comparator>
+bool SameComparator(const Comparator &, const Comparator &) {
+	return true;
+}
+
+template <typename Type>
+bool SameComparator(const FunctionCompare<Type> & one,
+                    const FunctionCompare<Type> & two) {
+	return one == two;
+}
+
 #endif
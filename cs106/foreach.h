@@ -3,8 +3,11 @@
  * Last modified on Thu Jun 11 12:04:09 2009 by eroberts
  * -----------------------------------------------------
  * This interface defines the foreach keyword, which is used to
- * simplify iteration.  All iterable classes import this interface,
- * so clients never need to do so explicitly.
+ * simplify iteration.  It is kept for older programs: the collection
+ * classes no longer import it, since every one of them works with an
+ * ordinary range-based for loop, and a program that wants foreach
+ * must include this file itself.  Because it defines in as a macro,
+ * it should be included after every standard header the program uses.
  */
 
 #ifndef _foreach_h
@@ -27,54 +30,29 @@ static const ios::openmode IOS_IN = ios::in;
 static const ios::openmode IOS_OUT = ios::out;
 static const ios::openmode IOS_TRUNC = ios::trunc;
 
-/*
- * Class: FE_Iterator
- * ------------------
- * This class is a base class for all Iterators that can work with
- * the foreach construct.  The only purpose of this class is to make
- * it possible to freeing the iterators after they are no longer needed.
- *
- * Note: FE_Iterator is implemented in lexicon.cpp, which is the only
- * iterable class that is not a template class.
- */
-
-class FE_Iterator {
-public:
-	FE_Iterator();
-	~FE_Iterator();
-};
-
-/*
- * Class: FE_State
- * ---------------
- * This class is used to maintain the state of the foreach processing.
- * The class itself is essentially private, but the implementations in
- * the different classes use the fields directly.
- *
- * Note: FE_State is implemented in lexicon.cpp, which is the only
- * iterable class that is not a template class.
- */
-
-class FE_State {
-public:
-	int state;
-	FE_Iterator *iter;
-
-	FE_State();
-	~FE_State();
-};
-
 /*
  * Macro: foreach
  * Usage: foreach (type var in collection) { . . . }
  * -------------------------------------------------
- * Provides a much simpler hook to the iterator facility.
+ * Provides a more readable way of writing a range-based for loop, which
+ * works with every collection class because each one has begin and end
+ * methods.  The statement
+ *
+ *     foreach (string word in lexicon) { . . . }
+ *
+ * means exactly the same as
+ *
+ *     for (string word : lexicon) { . . . }
+ *
+ * and costs no more than stepping through the collection by hand.  As
+ * with any range-based for loop, declaring the variable as a reference,
+ * as in foreach (const string & word in lexicon), saves copying each
+ * element, and a non-const reference lets the loop change the elements
+ * of a Vector, Grid, Queue or Stack in place.
  */
 
-#define foreach(arg) \
-  for (FE_State _fe; _fe.state < 2; ) \
-    for (arg.foreachHook(_fe); _fe.state++ == 1; _fe.state = 0)
+#define foreach(arg) for (arg)
 
-#define in =
+#define in :
 
 #endif
@@ -58,12 +58,16 @@ void Error(string str);
 /*
  * Function macro: main
  * --------------------
- * The purpose of this macro definition is to rename the student
- * main to Main in order to allow a custom main defined in our
- * libraries to configure the application before passing control
- * back to the student program.
+ * The precompiled Windows library defines its own main, which
+ * configures the application and then calls the student's main under
+ * the name Main.  Defining CS106_LEGACY_MAIN, as the Visual C++ project
+ * does, renames the student main to match.  The native library built
+ * by CMakeLists.txt has no main of its own, so programs built against
+ * it keep theirs, and main remains an ordinary name everywhere else.
  */
 
+#ifdef CS106_LEGACY_MAIN
 #define main Main
+#endif
 
 #endif
@@ -32,7 +32,8 @@
 
 #include "genlib.h"
 #include "strutils.h"
-#include "foreach.h"
+#include "gridlayout.h"
+#include <type_traits>
 
 /*
  * Class: Grid
@@ -43,9 +44,15 @@
  * with private data members, clients have no access to the underlying
  * data members and can only manipulate a grid object through
  * its public methods.
+ *
+ * The optional second template argument is the layout of the elements
+ * in memory, one of the classes in gridlayout.h.  Grid<int> stores them
+ * a row at a time; Grid<int, TiledLayout<> > and Grid<int, MortonLayout>
+ * keep neighboring cells together, which is much faster for work that
+ * looks at each cell's neighbors or walks down the columns.
  */
 
-template <typename ElemType>
+template <typename ElemType, typename Layout = RowMajorLayout>
 class Grid {
 
 public:
@@ -53,6 +60,7 @@ public:
 /* Forward references */
 	class GridRow;
 	class Iterator;
+	class RangeIterator;
 
 /*
  * Constructor: Grid
@@ -152,6 +160,17 @@ public:
  */
 	GridRow operator[](int row);
 
+/*
+ * Method: uncheckedAt
+ * Usage: sum += grid.uncheckedAt(row, col);
+ * -----------------------------------------
+ * This method returns a reference to the element at the given row and
+ * col, like grid[row][col] but without checking that the location is
+ * in the grid, for use in inner loops whose bounds already guarantee
+ * it.  An out-of-range location gives undefined behavior.
+ */
+	ElemType & uncheckedAt(int row, int col);
+
 /*
  * SPECIAL NOTE: mapping/iteration support
  * ---------------------------------------
@@ -184,6 +203,32 @@ public:
 	void mapAll(void (*fn)(ElemType elem, ClientDataType & data),
 	            ClientDataType & data);
 
+/*
+ * Method: mapRow
+ * Usage: grid.mapRow(row, [&](int col, double & cell) { cell *= scale; });
+ * -----------------------------------------------------------------------
+ * This method calls fn(col, cell) for each cell in the given row, from
+ * left to right.  The cell is passed by reference, so fn may change it,
+ * but fn must not resize the grid.  Raises an error if row is outside
+ * the grid.
+ */
+	template <typename FnType>
+	void mapRow(int row, FnType fn);
+
+/*
+ * Method: mapTiles
+ * Usage: grid.mapTiles([&](int row, int col, float & cell) { ... });
+ * ------------------------------------------------------------------
+ * This method calls fn(row, col, cell) for each cell in the grid, a
+ * tile at a time: the cells of one block of rows and columns are all
+ * visited before any of the next.  The blocks are the tiles of the
+ * grid's layout, so this is the fastest order in which to visit every
+ * cell when fn also looks at the cell's neighbors.  As with mapRow, fn
+ * may change the cell but must not resize the grid.
+ */
+	template <typename FnType>
+	void mapTiles(FnType fn);
+
 /*
  * Method: iterator
  * Usage: iter = grid.iterator();
@@ -202,9 +247,10 @@ public:
  *         . . .
  *     }
  *
- * This pattern can be abbreviated to the following more readable form:
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
  *
- *     foreach (int elem in grid) {
+ *     for (int elem : grid) {
  *         . . .
  *     }
  *
@@ -213,12 +259,175 @@ public:
  */
 	Iterator iterator();
 
+/*
+ * Methods: begin, end
+ * Usage: for (double & x : grid) x *= 2;
+ * --------------------------------------
+ * These methods return iterators to the first element of this grid and
+ * just past the last one, so that a range-based for loop visits the
+ * elements by reference in row-major order, whatever the layout, and
+ * without bounds checks.  Resizing the grid during the loop leaves the
+ * iterators dangling.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
 private:
 
 #include "private/grid.h"
 
 };
 
+/*
+ * Class: Grid<bool>
+ * -----------------
+ * A grid of bools stores each cell as a single bit, packed into whole
+ * words, so it takes an eighth of the space of one byte per cell and can
+ * count, combine and search its cells a word at a time.  Each row
+ * starts at the beginning of a word, and the bits are stored a row at a
+ * time whatever the Layout argument says.  A new or resized grid is all
+ * false.
+ *
+ * A bit has no address, so where a Grid<ElemType> hands out an
+ * ElemType &, a Grid<bool> hands out a CellRef instead: a small object
+ * that can be read and assigned like a bool.  Code such as
+ *
+ *      if (grid[row][col]) grid[row][col] = false;
+ *
+ * works unchanged, but a function passed to mapRow or mapTiles must
+ * take the cell as a Grid<bool>::CellRef, or as auto, not as a bool &.
+ */
+
+template <typename Layout>
+class Grid<bool, Layout> {
+
+public:
+
+/* Forward references */
+	class CellRef;
+	class GridRow;
+	class Iterator;
+	class RangeIterator;
+
+/*
+ * Methods: Grid, numRows, numCols, resize, getAt, setAt, inBounds,
+ *          operator[], mapAll, iterator
+ * ----------------------------------------------------------------
+ * These work as they do for any other type of grid.
+ */
+	Grid();
+	Grid(int numRows, int numCols);
+	~Grid();
+	int numRows();
+	int numCols();
+	void resize(int numRows, int numCols);
+	bool getAt(int row, int col);
+	void setAt(int row, int col, bool value);
+	bool inBounds(int row, int col);
+	GridRow operator[](int row);
+	void mapAll(void (*fn)(bool elem));
+	template <typename ClientDataType>
+	void mapAll(void (*fn)(bool elem, ClientDataType & data), ClientDataType & data);
+	Iterator iterator();
+
+/*
+ * Methods: uncheckedAt, mapRow, mapTiles
+ * Usage: grid.mapRow(row, [](int col, Grid<bool>::CellRef cell) { cell = col % 2; });
+ * -----------------------------------------------------------------------------------
+ * These work as they do for any other type of grid, except that they
+ * give out a CellRef for each cell.  mapTiles visits the cells a row at
+ * a time, since a row of bits is already compact.
+ */
+	CellRef uncheckedAt(int row, int col);
+	template <typename FnType>
+	void mapRow(int row, FnType fn);
+	template <typename FnType>
+	void mapTiles(FnType fn);
+
+/*
+ * Methods: begin, end
+ * Usage: for (Grid<bool>::CellRef cell : grid) cell.flip();
+ * ---------------------------------------------------------
+ * These work as they do for any other type of grid, except that the
+ * loop is given a CellRef for each cell rather than a bool &, so the
+ * loop variable is declared as a CellRef, or as a bool to read the
+ * cells without changing them.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
+/*
+ * Methods: count, countInRow
+ * Usage: int mines = field.count();
+ * ---------------------------------
+ * These methods return the number of cells that are true, in the whole
+ * grid or in the given row, counting a word of cells at a time.
+ * countInRow raises an error if row is outside the grid.
+ */
+	int count();
+	int countInRow(int row);
+
+/*
+ * Method: nextInRow
+ * Usage: for (int col = grid.nextInRow(row, 0); col != -1;
+ *             col = grid.nextInRow(row, col + 1)) . . .
+ * ---------------------------------------------------------
+ * This method returns the column of the first true cell in row at or
+ * after col, or -1 if there is none, skipping over a word of false cells
+ * at a time.  col may be anything from 0 to numCols(); raises an error
+ * if it or row is outside that range.
+ */
+	int nextInRow(int row, int col);
+
+/*
+ * Method: mapTrue
+ * Usage: field.mapTrue([&](int row, int col) { MarkNeighbors(row, col); });
+ * -------------------------------------------------------------------------
+ * This method calls fn(row, col) for each cell that is true, in
+ * row-major order, skipping over a word of false cells at a time.  fn
+ * may change the grid's cells but must not resize it; a cell it changes
+ * further along the same word may or may not be seen in its new state.
+ */
+	template <typename FnType>
+	void mapTrue(FnType fn);
+
+/*
+ * Methods: setAll, flipAll
+ * Usage: grid.setAll(false);
+ *        grid.flipAll();
+ * --------------------------
+ * These methods set every cell to value, or change every cell from
+ * true to false and false to true, a word of cells at a time.
+ */
+	void setAll(bool value);
+	void flipAll();
+
+/*
+ * Methods: unionWith, intersectWith, subtract, flipWith
+ * Usage: danger.unionWith(mines);
+ * -------------------------------
+ * These methods combine this grid with another of the same size, cell
+ * by cell and a word of cells at a time:
+ *
+ * grid.unionWith(other);      Sets each cell that is true in other.
+ * grid.intersectWith(other);  Clears each cell that is false in other.
+ * grid.subtract(other);       Clears each cell that is true in other.
+ * grid.flipWith(other);       Flips each cell that is true in other.
+ *
+ * Each raises an error if the two grids differ in size.
+ */
+	void unionWith(Grid & other);
+	void intersectWith(Grid & other);
+	void subtract(Grid & other);
+	void flipWith(Grid & other);
+
+private:
+
+#include "private/gridbits.h"
+
+};
+
 #include "private/grid.cpp"
+#include "private/gridbits.cpp"
 
 #endif
@@ -0,0 +1,138 @@
+/*
+ * File: gridkernels.h
+ * -------------------
+ * This interface exports bulk operations on whole grids of numbers:
+ * filling, transforming, summing, finding the smallest and largest
+ * element, and convolving with a small kernel of weights.  Each one
+ * works through the grid a row at a time, with no call through a
+ * function pointer per cell, and uses the processor's vector
+ * instructions where the compiler provides them.  Each one can also
+ * split the grid into bands of rows and hand the bands to a
+ * ThreadPool.
+ *
+ * Here is some sample code that runs one step of a heat simulation on
+ * every core:
+ *
+ *      Grid<float> kernel(3, 3);
+ *      GridFill(kernel, 0.0f);
+ *      kernel[0][1] = kernel[1][0] = kernel[1][2] = kernel[2][1] = 0.25f;
+ *      GridConvolve(heat, next, kernel, &ThreadPool::shared());
+ *      float hottest = GridMax(next);
+ */
+
+#ifndef _gridkernels_h
+#define _gridkernels_h
+
+#include "genlib.h"
+#include "grid.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * SPECIAL NOTE: speed and results
+ * -------------------------------
+ * The vector instructions are used for grids of the built-in number
+ * types in the default RowMajorLayout, where each row is contiguous;
+ * other grids take a plain loop over the cells, which gives the same
+ * results.  Sums of floating-point grids are added in a fixed order that
+ * depends only on the size of the grid, so they come out the same with
+ * or without a pool and whatever its number of threads, but can differ
+ * in the last bits from a simple loop over the cells.
+ *
+ * A Grid<bool> stores its cells as bits and cannot be used with these
+ * functions; it has count, setAll and its own word-wide operations.
+ *
+ * Every function takes an optional ThreadPool as its last argument.
+ * With NULL, the default, all the work is done by the calling thread.
+ */
+
+/*
+ * Type: GridSumType
+ * -----------------
+ * GridSumType<ElemType>::type is the type of GridSum's result: long for
+ * a grid of integers or characters, so that the sum does not overflow
+ * as soon as the elements would, double for a grid of floating-point
+ * numbers, and ElemType itself for anything else.
+ */
+template <typename ElemType>
+struct GridSumType {
+	typedef typename std::conditional<std::is_floating_point<ElemType>::value, double,
+	        typename std::conditional<std::is_integral<ElemType>::value, long,
+	                                  ElemType>::type>::type type;
+};
+
+/*
+ * Function: GridFill
+ * Usage: GridFill(grid, 0);
+ * -------------------------
+ * Sets every element of grid to value.  The type of value is taken from
+ * the grid, so a literal such as 0 may be used to fill a Grid<float>.
+ */
+template <typename ElemType, typename Layout>
+void GridFill(Grid<ElemType, Layout> & grid, typename std::remove_cv<ElemType>::type value,
+              ThreadPool *pool = NULL);
+
+/*
+ * Function: GridTransform
+ * Usage: GridTransform(src, dst, [](float x) { return x * x; });
+ * --------------------------------------------------------------
+ * Sets each element of dst to fn applied to the corresponding element
+ * of src, resizing dst to the size of src first if they differ.  src
+ * and dst may be the same grid.  fn is called directly in the inner
+ * loop, so a simple lambda is compiled into the loop and vectorized
+ * along with it.
+ */
+template <typename ElemType, typename Layout, typename FnType>
+void GridTransform(Grid<ElemType, Layout> & src, Grid<ElemType, Layout> & dst,
+                   FnType fn, ThreadPool *pool = NULL);
+
+/*
+ * Function: GridSum
+ * Usage: long total = GridSum(counts);
+ * ------------------------------------
+ * Returns the sum of the elements of grid, or zero if it is empty.
+ */
+template <typename ElemType, typename Layout>
+typename GridSumType<ElemType>::type GridSum(Grid<ElemType, Layout> & grid,
+                                             ThreadPool *pool = NULL);
+
+/*
+ * Functions: GridMin, GridMax
+ * Usage: float coldest = GridMin(heat);
+ *        float hottest = GridMax(heat);
+ * -------------------------------------
+ * Return the smallest and the largest element of grid, as compared by
+ * <.  Raises an error if the grid is empty.
+ */
+template <typename ElemType, typename Layout>
+ElemType GridMin(Grid<ElemType, Layout> & grid, ThreadPool *pool = NULL);
+
+template <typename ElemType, typename Layout>
+ElemType GridMax(Grid<ElemType, Layout> & grid, ThreadPool *pool = NULL);
+
+/*
+ * Function: GridConvolve
+ * Usage: GridConvolve(image, blurred, weights);
+ * ---------------------------------------------
+ * Sets each element of dst to the weighted sum of the elements of src
+ * around the same location, resizing dst to the size of src first if
+ * they differ.  kernel holds the weights: it must have an odd number of
+ * rows and columns, and its center lines up with the element being
+ * computed, so that
+ *
+ *     dst[r][c] = sum of kernel[i][j] * src[r + i - kr][c + j - kc]
+ *
+ * where kr and kc are the row and column of kernel's center.  Locations
+ * beyond the edge of src take the value of the nearest element on the
+ * edge.  Kernels of 3 x 3 and 5 x 5 are unrolled completely.  src and
+ * dst may be the same grid, at the cost of a copy.
+ */
+template <typename ElemType, typename Layout>
+void GridConvolve(Grid<ElemType, Layout> & src, Grid<ElemType, Layout> & dst,
+                  Grid<ElemType> & kernel, ThreadPool *pool = NULL);
+
+#include "private/gridkernels.cpp"
+
+#endif
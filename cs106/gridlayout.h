@@ -0,0 +1,190 @@
+/*
+ * File: gridlayout.h
+ * ------------------
+ * This interface exports the layout classes that the Grid takes as a
+ * template argument, each of which decides where in the grid's array
+ * the element at a given row and column is stored.
+ */
+
+#ifndef _gridlayout_h
+#define _gridlayout_h
+
+/*
+ * SPECIAL NOTE: choosing a layout
+ * -------------------------------
+ * A Grid<ElemType> keeps its elements in row-major order, one whole
+ * row after another, which is the fastest order for work that sweeps
+ * along the rows, including stencils that look at the rows just above
+ * and below.  Work that walks down the columns, or jumps around a
+ * neighborhood of cells, touches a new cache line and often a new page
+ * for every row it crosses, and on a large grid those are long gone
+ * from the cache by the time it comes back to them.  The other layouts
+ * keep cells that are near each other in the grid near each other in
+ * memory, at the price of a few more instructions to find each cell:
+ *
+ *     Grid<float, TiledLayout<16> > heat(4096, 4096);
+ *     Grid<char, MortonLayout> board(1024, 1024);
+ *
+ * The layout changes only the speed of the grid; every operation gives
+ * the same results with any of them.
+ *
+ * Any class with the members below can serve as a layout.  resize is
+ * called with the new dimensions before anything else; storageSize
+ * then gives the length of the array to allocate, which may include
+ * padding, and index the position in it of each cell.  TILE_ROWS and
+ * TILE_COLS give the size of the blocks in which Grid::mapTiles visits
+ * the cells: blocks that lie together in memory, where the layout has
+ * them, or blocks small enough to stay in the cache, where it does not.
+ * CONTIGUOUS_TILE_ROWS is true if the cells of each row of a block are
+ * stored one after another, which lets mapTiles step through them with
+ * a pointer instead of computing every index.
+ */
+
+/*
+ * Class: RowMajorLayout
+ * Usage: Grid<int, RowMajorLayout> grid;
+ * --------------------------------------
+ * The default layout: row 0 from left to right, then row 1, and so on.
+ */
+class RowMajorLayout {
+public:
+	static const int TILE_ROWS = 64;
+	static const int TILE_COLS = 256;
+	static const bool CONTIGUOUS_TILE_ROWS = true;
+
+	void resize(int numRows, int numCols) {
+		nCols = numCols;
+		size = long(numRows) * numCols;
+	}
+
+	long storageSize() const {
+		return size;
+	}
+
+	long index(int row, int col) const {
+		return long(row) * nCols + col;
+	}
+
+private:
+	int nCols;
+	long size;
+};
+
+/*
+ * Class template: TiledLayout
+ * Usage: Grid<double, TiledLayout<8> > grid;
+ * ------------------------------------------
+ * Cuts the grid into square tiles of TILE_SIDE rows and columns, which
+ * must be a power of two, and stores the tiles in row-major order with
+ * the cells of each tile in row-major order inside it.  The rows and
+ * columns are padded to a multiple of TILE_SIDE.  A tile should hold a
+ * few kilobytes at most: 16 is a good side for 4-byte elements, 8 for
+ * 8-byte ones.
+ */
+template <int TILE_SIDE = 16>
+class TiledLayout {
+public:
+	static_assert(TILE_SIDE > 0 && (TILE_SIDE & (TILE_SIDE - 1)) == 0,
+	              "TILE_SIDE must be a power of two");
+
+	static const int TILE_ROWS = TILE_SIDE;
+	static const int TILE_COLS = TILE_SIDE;
+	static const bool CONTIGUOUS_TILE_ROWS = true;
+
+	void resize(int numRows, int numCols) {
+		tilesPerRow = (numCols + TILE_SIDE - 1) >> SHIFT;
+		long tileRows = (numRows + TILE_SIDE - 1) >> SHIFT;
+		size = (tileRows * tilesPerRow) << (2 * SHIFT);
+	}
+
+	long storageSize() const {
+		return size;
+	}
+
+	long index(int row, int col) const {
+		long tile = long(row >> SHIFT) * tilesPerRow + (col >> SHIFT);
+		return (tile << (2 * SHIFT)) + ((row & MASK) << SHIFT) + (col & MASK);
+	}
+
+private:
+	static constexpr int Log2(int n) {
+		return (n <= 1) ? 0 : 1 + Log2(n >> 1);
+	}
+
+	static const int SHIFT = Log2(TILE_SIDE);
+	static const int MASK = TILE_SIDE - 1;
+
+	long tilesPerRow;
+	long size;
+};
+
+/*
+ * Class: MortonLayout
+ * Usage: Grid<char, MortonLayout> grid;
+ * -------------------------------------
+ * Stores the cells in Morton (Z) order, in which the index of a cell
+ * interleaves the bits of its row with the bits of its column.  Every
+ * aligned square of 2 x 2, 4 x 4, 8 x 8 cells and so on is contiguous,
+ * so the grid is local at every scale at once and needs no tile size
+ * chosen for the element type.  The rows and columns are each padded
+ * to a power of two, so a grid a little larger than a power of two
+ * wastes space; when the two differ, the extra bits of the longer side
+ * are not interleaved, and the grid is stored as a row or column of
+ * squares.
+ */
+class MortonLayout {
+public:
+	static const int TILE_ROWS = 16;
+	static const int TILE_COLS = 16;
+	static const bool CONTIGUOUS_TILE_ROWS = false;
+
+	void resize(int numRows, int numCols) {
+		int rowBits = BitsFor(numRows);
+		int colBits = BitsFor(numCols);
+		sharedBits = (rowBits < colBits) ? rowBits : colBits;
+		sharedMask = (1L << sharedBits) - 1;
+		highRows = rowBits > colBits;
+		size = 1L << (rowBits + colBits);
+		if (numRows == 0 || numCols == 0) size = 0;
+	}
+
+	long storageSize() const {
+		return size;
+	}
+
+	long index(int row, int col) const {
+		long shared = (Spread(row & sharedMask) << 1) | Spread(col & sharedMask);
+		long high = (highRows ? row : col) >> sharedBits;
+		return (high << (2 * sharedBits)) | shared;
+	}
+
+private:
+	int sharedBits;
+	long sharedMask;
+	bool highRows;
+	long size;
+
+	static int BitsFor(int n) {
+		int bits = 0;
+		while ((1L << bits) < n) {
+			bits++;
+		}
+		return bits;
+	}
+
+/*
+ * Spreads the low 32 bits of x out to the even-numbered bits of the
+ * result, by moving ever smaller groups of bits apart.
+ */
+	static long Spread(long x) {
+		unsigned long v = (unsigned long) x & 0xFFFFFFFFUL;
+		v = (v | (v << 16)) & 0x0000FFFF0000FFFFUL;
+		v = (v | (v << 8)) & 0x00FF00FF00FF00FFUL;
+		v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FUL;
+		v = (v | (v << 2)) & 0x3333333333333333UL;
+		v = (v | (v << 1)) & 0x5555555555555555UL;
+		return long(v);
+	}
+};
+
+#endif
@@ -10,7 +10,6 @@
 #define _lexicon_h
 
 #include "genlib.h"
-#include "foreach.h"
 #include "set.h"
 #include "stack.h"
 
@@ -32,6 +31,8 @@
  */
 
 #include <cctype>
+#include <atomic>
+#include <thread>
 
 class Lexicon {
 
@@ -39,6 +40,7 @@ public:
 
 /* Forward references */
 	class Iterator;
+	class RangeIterator;
 
 /*
  * Constructor: Lexicon
@@ -130,6 +132,20 @@ public:
  */
 	bool containsPrefix(string prefix);
 
+/*
+ * Method: findNearWords
+ * Usage: Vector<string> suggestions = lex.findNearWords("speling", 2);
+ * --------------------------------------------------------------------
+ * This method returns every word in this lexicon whose edit distance
+ * from target is at most maxDistance, where the edit distance is the
+ * number of single-letter insertions, deletions, and substitutions
+ * needed to turn one word into the other.  The words are ranked: all
+ * exact matches come first, then words one edit away, and so on,
+ * with ties listed alphabetically.  Like containsWord, the comparison
+ * ignores case.  Raises an error if maxDistance is negative.
+ */
+	Vector<string> findNearWords(string target, int maxDistance);
+
 /*
  * Method: clear
  * Usage: lex.clear();
@@ -157,12 +173,17 @@ public:
  *         . . .
  *     }
  *
- * This pattern can be abbreviated to the following more readable form:
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
  *
- *     foreach (string word in lexicon) {
+ *     for (string word : lexicon) {
  *         . . .
  *     }
  *
+ * When only looking at each word, iter.nextRef() avoids the copy made
+ * by next(): it returns a reference to the iterator's own word buffer,
+ * which is overwritten by the following call to hasNext or next.
+ *
  * To avoid exposing the details of the class, the definition of the
  * Iterator class itself appears in the private/lexicon.h file.
  */
@@ -199,6 +220,61 @@ public:
 	void mapAll(void (*fn)(string word, ClientDataType &),
 	            ClientDataType & data);
 
+/*
+ * SPECIAL NOTE: concurrent access
+ * -------------------------------
+ * The methods that only look at the lexicon (size, isEmpty, containsWord,
+ * containsPrefix, iterator, and the mapping functions) may be called from
+ * several threads at once, provided no thread modifies the lexicon with
+ * add, addWordsFromFile, clear, or assignment while they run.
+ */
+
+/*
+ * Method: parallelMapAll
+ * Usage: lexicon.parallelMapAll(CountVowels, vowelCount, AddCounts);
+ * ------------------------------------------------------------------
+ * This method calls fn once for each word in the lexicon, spreading the
+ * calls across numThreads worker threads (by default, one per core).
+ * The lexicon is divided by two-letter prefix, and the words under each
+ * prefix are passed to fn along with a private copy of data, so fn
+ * needs no locking as long as it touches nothing else.  When all words
+ * have been seen, merge is called once per prefix to fold each copy
+ * back into data, in alphabetical order of prefix, followed by the
+ * words added with add.  The starting value of data should therefore
+ * contribute nothing to the result (e.g. 0 for a count, an empty
+ * vector for a collection), apart from any read-only settings that
+ * fn consults.
+ */
+	template <typename ClientDataType>
+	void parallelMapAll(void (*fn)(const string & word, ClientDataType & data),
+	                    ClientDataType & data,
+	                    void (*merge)(ClientDataType & data, ClientDataType & part),
+	                    int numThreads = 0);
+
+/*
+ * Method: parallelMapAll
+ * Usage: lexicon.parallelMapAll(CheckWord);
+ * -----------------------------------------
+ * This method calls fn once for each word in the lexicon from a pool of
+ * numThreads worker threads, in no particular order.  Any state that fn
+ * shares between calls must be protected by the client.
+ */
+	void parallelMapAll(void (*fn)(const string & word), int numThreads = 0);
+
+/*
+ * Methods: begin, end
+ * Usage: for (const string & word : lexicon) . . .
+ * ------------------------------------------------
+ * These methods return iterators to the first word of this lexicon and
+ * just past the last one, so that a range-based for loop visits the
+ * words in alphabetical order without copying them.  Each word is
+ * given as a const reference that is good only until the loop moves on
+ * to the next word, so a word that must be kept has to be copied.
+ * Adding words during the loop raises an error.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
 private:
 
 #include "private/lexicon.h"
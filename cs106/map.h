@@ -12,7 +12,6 @@
 
 #include "genlib.h"
 #include "vector.h"
-#include "foreach.h"
 #include <string>
 #include <cstdlib>
 
@@ -24,15 +23,24 @@
  * class template.  The keys are always of type string, but the value
  * type is set by the client. The client specializes the map to hold
  * values of a specific type, e.g. Map<int> or Map<studentT>, as needed.
+ *
+ * The optional second template argument asks the map to keep its first
+ * few entries in a small array inside the map object itself, e.g.
+ * Map<string, 16> holds up to 16 entries without allocating a hash
+ * table or any per-entry cells, and only moves them into a hash table
+ * when a 17th is added.  This is a good choice for the many small maps
+ * a program builds and throws away, such as the parameters of a single
+ * URL.  By default, all entries go in the hash table.
  */
 
-template <typename ValueType>
+template <typename ValueType, int SmallCapacity = 0>
 class Map {
 
 public:
 
 /* Forward references */
 	class Iterator;
+	class RangeIterator;
 
 /*
  * Constructor: Map
@@ -47,7 +55,8 @@ public:
  * reasonable default is used and the map will adapt as entries
  * are added. The explicit keyword is used to prevent
  * accidental construction of a Map from an integer.
- * Raises an error if sizeHint is negative.
+ * Raises an error if sizeHint is negative.  A map with a SmallCapacity
+ * only uses the hint when it outgrows its inline entries.
  */
 	explicit Map(int sizeHint = 101);
 
@@ -133,7 +142,9 @@ public:
  * value for the newly entered key is set to the default for value
  * type, and a reference to that value is returned.  Because this
  * function returns the value by reference, it allows in-place
- * modification of the value.
+ * modification of the value.  In a map with a SmallCapacity, the
+ * reference is only good until the next entry is added or removed,
+ * since either one may move the inline entries.
  */
 	ValueType & operator[](string key);
 
@@ -197,9 +208,10 @@ public:
  *         . . .
  *     }
  *
- * This pattern can be abbreviated to the following more readable form:
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
  *
- *     foreach (string key in map) {
+ *     for (string key : map) {
  *         . . .
  *     }
  *
@@ -208,6 +220,19 @@ public:
  */
 	Iterator iterator();
 
+/*
+ * Methods: begin, end
+ * Usage: for (const string & key : map) . . .
+ * -------------------------------------------
+ * These methods return iterators to the first key of this map and just
+ * past the last one, so that a range-based for loop visits the keys in
+ * the same order as the Iterator does, without copying them.  Each key
+ * is given as a const reference to the key stored in the map.  Adding
+ * or removing entries during the loop leaves the iterators dangling.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
 private:
 
 #include "private/map.h"
@@ -0,0 +1,135 @@
+/*
+ * File: mpmcqueue.h
+ * -----------------
+ * This interface file contains the MPMCQueue class template, a bounded
+ * FIFO queue that any number of threads may add to and remove from at
+ * once without locking.
+ */
+
+#ifndef _mpmcqueue_h
+#define _mpmcqueue_h
+
+#include "genlib.h"
+#include "disallowcopy.h"
+#include <atomic>
+#include <thread>
+#include <utility>
+
+/*
+ * Class: MPMCQueue
+ * ----------------
+ * This interface defines a class template for a queue shared by many
+ * producer threads and many consumer threads, such as the queue of
+ * work between a pool of threads that parse URLs and a pool that
+ * aggregates what they find.  Any thread may call any method at any
+ * time.  Elements put in by one producer come out in the order that
+ * producer put them in; elements from different producers are
+ * interleaved in the order their enqueues took effect.
+ *
+ * The queue holds at most a fixed number of elements, set when it is
+ * created.  Each slot in the ring carries a sequence number that tells
+ * the threads whether it is ready to be filled or emptied, so a thread
+ * claims a slot with a single atomic compare-and-swap and never takes
+ * a lock.  When just one thread produces and one consumes, the
+ * SPSCQueue from spscqueue.h does the same job with less overhead.
+ */
+
+template <typename ElemType>
+class MPMCQueue {
+
+public:
+
+/*
+ * Constructor: MPMCQueue
+ * Usage: MPMCQueue<int> queue;
+ *        MPMCQueue<string> queue(4096);
+ * -------------------------------------
+ * The constructor initializes a new empty queue that can hold at least
+ * capacity elements.  The capacity is rounded up to a power of two.
+ */
+	MPMCQueue(int capacity = 1024);
+
+/*
+ * Destructor: ~MPMCQueue
+ * ----------------------
+ * The destructor deallocates storage associated with this queue.  No
+ * other thread may be using the queue when it is destroyed.
+ */
+	~MPMCQueue();
+
+/*
+ * Method: capacity
+ * Usage: max = queue.capacity();
+ * ------------------------------
+ * This method returns the largest number of elements this queue can
+ * hold at once.
+ */
+	int capacity();
+
+/*
+ * Method: size
+ * Usage: count = queue.size();
+ * ----------------------------
+ * This method returns the number of elements in this queue.  While
+ * other threads are running, the answer may be out of date by the time
+ * it is returned.
+ */
+	int size();
+
+/*
+ * Method: isEmpty
+ * Usage: if (queue.isEmpty())...
+ * ------------------------------
+ * This method returns true if this queue contains no elements, false
+ * otherwise, with the same caution as size.
+ */
+	bool isEmpty();
+
+/*
+ * Method: enqueue
+ * Usage: queue.enqueue(element);
+ * ------------------------------
+ * This method adds element to the end of this queue.  If the queue is
+ * full, it waits until a consumer makes room.
+ */
+	void enqueue(ElemType elem);
+
+/*
+ * Method: tryEnqueue
+ * Usage: if (queue.tryEnqueue(element))...
+ * ----------------------------------------
+ * This method adds element to the end of this queue and returns true,
+ * unless the queue is full, in which case it returns false at once and
+ * leaves the queue unchanged.
+ */
+	bool tryEnqueue(ElemType elem);
+
+/*
+ * Method: dequeue
+ * Usage: first = queue.dequeue();
+ * -------------------------------
+ * This method removes the front element from this queue and returns
+ * it.  If the queue is empty, it waits until a producer adds an
+ * element.
+ */
+	ElemType dequeue();
+
+/*
+ * Method: tryDequeue
+ * Usage: if (queue.tryDequeue(first))...
+ * --------------------------------------
+ * This method removes the front element from this queue, stores it in
+ * elem and returns true, unless the queue is empty, in which case it
+ * returns false at once.
+ */
+	bool tryDequeue(ElemType & elem);
+
+private:
+
+#include "private/mpmcqueue.h"
+
+};
+
+#include "private/mpmcqueue.cpp"
+
+#endif
@@ -171,7 +171,7 @@ public:
 
 private:
 /* This stream buffer is used for the actual connection. */
-	const auto_ptr<SocketStreambuf> connection;
+	const unique_ptr<SocketStreambuf> connection;
 };
 
 #endif
@@ -9,21 +9,20 @@
 
 #ifdef _bst_h
 
-template <typename ElemType>
-BST<ElemType>::BST(int (*cmp)(ElemType, ElemType)) {
+template <typename ElemType, typename Comparator>
+BST<ElemType, Comparator>::BST(Comparator cmp) : cmpFn(cmp) {
 	root = NULL;
-	cmpFn = cmp;
 	numNodes = 0;
 	timestamp = 0L;
 }
 
-template <typename ElemType>
-BST<ElemType>::~BST() {
+template <typename ElemType, typename Comparator>
+BST<ElemType, Comparator>::~BST() {
 	recDeleteTree(root);
 }
 
-template <typename ElemType>
-void BST<ElemType>::recDeleteTree(nodeT * t) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::recDeleteTree(nodeT * t) {
 	if (t != NULL) {
 		recDeleteTree(t->left);
 		recDeleteTree(t->right);
@@ -31,24 +30,76 @@ void BST<ElemType>::recDeleteTree(nodeT * t) {
 	}
 }
 
-template <typename ElemType>
-int BST<ElemType>::size() {
+template <typename ElemType, typename Comparator>
+int BST<ElemType, Comparator>::size() {
 	return numNodes;
 }
 
-template <typename ElemType>
-bool BST<ElemType>::isEmpty() {
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::isEmpty() {
 	return root == NULL;
 }
 
-template <typename ElemType>
-void BST<ElemType>::clear() {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::clear() {
 	recDeleteTree(root);
 	root = NULL;
 	numNodes = 0;
 	timestamp++;
 }
 
+/*
+ * Implementation notes: buildFromSorted, recBuildTree
+ * ---------------------------------------------------
+ * recBuildTree makes the middle element of elems[lo, hi) the root and
+ * builds the two halves beneath it, so the two subtrees of every node
+ * differ in size by at most one and the result is an AVL tree.  Each
+ * call sets height to the height of the tree it built, from which the
+ * balance factor of its root follows directly, and the size of each
+ * subtree is just the length of its range.  The nodes are allocated
+ * in order, which also suits a later walk over the tree.  Each call
+ * links its subtrees back to their new parent; the caller does the
+ * same for the node it gets back.
+ */
+
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::buildFromSorted(Vector<ElemType> & elems) {
+	for (int i = 1; i < elems.size(); i++) {
+		if (cmpFn(elems[i - 1], elems[i]) >= 0) {
+			Error("buildFromSorted: elements are not in increasing order");
+		}
+	}
+	recDeleteTree(root);
+	int height;
+	root = recBuildTree(elems, 0, elems.size(), height);
+	if (root != NULL) root->parent = NULL;
+	numNodes = elems.size();
+	timestamp++;
+	elems.clear();
+}
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::nodeT *
+BST<ElemType, Comparator>::recBuildTree(Vector<ElemType> & elems, int lo, int hi,
+                                        int & height) {
+	if (lo == hi) {
+		height = 0;
+		return NULL;
+	}
+	int mid = lo + (hi - lo) / 2;
+	int leftHeight, rightHeight;
+	nodeT *t = new nodeT;
+	t->left = recBuildTree(elems, lo, mid, leftHeight);
+	t->data = std::move(elems[mid]);
+	t->right = recBuildTree(elems, mid + 1, hi, rightHeight);
+	setParent(t->left, t);
+	setParent(t->right, t);
+	t->bf = rightHeight - leftHeight;
+	t->count = hi - lo;
+	height = 1 + ((leftHeight > rightHeight) ? leftHeight : rightHeight);
+	return t;
+}
+
 /*
  * Implementation notes: find, recFindNode
  * ---------------------------------------
@@ -58,15 +109,15 @@ void BST<ElemType>::clear() {
  * parameter with the copy and returns a pointer to the data.
  */
 
-template <typename ElemType>
-ElemType *BST<ElemType>::find(ElemType key) {
+template <typename ElemType, typename Comparator>
+ElemType *BST<ElemType, Comparator>::find(ElemType key) {
 	nodeT *found = recFindNode(root, key);
 	if (found == NULL) return NULL;
 	return &found->data;
 }
 
-template <typename ElemType>
-typename BST<ElemType>::nodeT *BST<ElemType>::recFindNode(nodeT *t,
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::nodeT *BST<ElemType, Comparator>::recFindNode(nodeT *t,
 	                                                  ElemType & key) {
 	if (t == NULL) return NULL;
 	int sign = cmpFn(key, t->data);
@@ -94,23 +145,30 @@ typename BST<ElemType>::nodeT *BST<ElemType>::recFindNode(nodeT *t,
  * it works its way upwards, if that additional height is added to
  * to existing balanace factor and results in factor that is
  * more than +- 1, then a rotation is done to fix the imbalance.
+ * Each node on the way back up also counts the new node in the size
+ * of its subtree before any rotation takes place, and makes itself
+ * the parent of the child it went through, which is how a new node
+ * gets its parent.  The rotations keep the parent pointers right for
+ * the nodes they move.
  */
 
-template <typename ElemType>
-bool BST<ElemType>::add(ElemType data) {
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::add(ElemType data) {
 	bool createdNewNode = false;
 	recAddNode(root, data, createdNewNode);
+	root->parent = NULL;
 	if (createdNewNode) timestamp++;
 	return createdNewNode;
 }
 
-template <typename ElemType>
-bool BST<ElemType>::recAddNode(nodeT * & t, ElemType & data,
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::recAddNode(nodeT * & t, ElemType & data,
                                bool & createdNewNode) {
 	if (t == NULL) {
 		t = new nodeT;
 		t->data = data;
 		t->bf = BST_IN_BALANCE;
+		t->count = 1;
 		t->left = t->right = NULL;
 		createdNewNode = true;
 		numNodes++;
@@ -127,11 +185,14 @@ bool BST<ElemType>::recAddNode(nodeT * & t, ElemType & data,
 		if (recAddNode(t->left, data, createdNewNode)) {
 			bfDelta = -1;   /* left subtree is higher */
 		}
+		t->left->parent = t;
 	} else {
 		if (recAddNode(t->right, data, createdNewNode)) {
 			bfDelta = +1;   /* right subtree is higher */
 		}
+		t->right->parent = t;
 	}
+	if (createdNewNode) t->count++;
 	updateBF(t, bfDelta);
 	return (bfDelta != 0 && t->bf != BST_IN_BALANCE);
 }
@@ -144,8 +205,8 @@ bool BST<ElemType>::recAddNode(nodeT * & t, ElemType & data,
  * tree if necessary.
  */
 
-template <typename ElemType>
-void BST<ElemType>::updateBF(nodeT * & t, int bfDelta) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::updateBF(nodeT * & t, int bfDelta) {
 	t->bf += bfDelta;
 	if (t->bf < BST_LEFT_HEAVY) {
 		fixLeftImbalance(t);
@@ -164,8 +225,8 @@ void BST<ElemType>::updateBF(nodeT * & t, int bfDelta) {
  * code performs a single or double rotation.
  */
 
-template <typename ElemType>
-void BST<ElemType>::fixLeftImbalance(nodeT * & t) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::fixLeftImbalance(nodeT * & t) {
 	nodeT *child = t->left;
 	if (child->bf == BST_RIGHT_HEAVY) {
 		int oldBF = child->right->bf;
@@ -202,14 +263,22 @@ void BST<ElemType>::fixLeftImbalance(nodeT * & t) {
  * This function performs a single left rotation of the tree
  * that is passed by reference.  The balance factors
  * are unchanged by this function and must be corrected at a
- * higher level of the algorithm.
+ * higher level of the algorithm.  The subtree sizes are fixed
+ * here: the child takes over the size of the whole subtree, and
+ * the old root's size is recounted from its new children.  The
+ * parent pointers of the three nodes that move are fixed as well.
  */
 
-template <typename ElemType>
-void BST<ElemType>::rotateLeft(nodeT * & t) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::rotateLeft(nodeT * & t) {
 	nodeT * child = t->right;
 	t->right = child->left;
+	setParent(t->right, t);
 	child->left = t;
+	child->parent = t->parent;
+	t->parent = child;
+	child->count = t->count;
+	updateCount(t);
 	t = child;
 }
 
@@ -223,8 +292,8 @@ void BST<ElemType>::rotateLeft(nodeT * & t) {
  * code performs a single or double rotation.
  */
 
-template <typename ElemType>
-void BST<ElemType>::fixRightImbalance(nodeT * & t) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::fixRightImbalance(nodeT * & t) {
 	nodeT *child = t->right;
 	if (child->bf == BST_LEFT_HEAVY) {
 		int oldBF = child->left->bf;
@@ -261,14 +330,22 @@ void BST<ElemType>::fixRightImbalance(nodeT * & t) {
  * This function performs a single right rotation of the tree
  * that is passed by reference.  The balance factors
  * are unchanged by this function and must be corrected at a
- * higher level of the algorithm.
+ * higher level of the algorithm.  The subtree sizes are fixed
+ * here: the child takes over the size of the whole subtree, and
+ * the old root's size is recounted from its new children.  The
+ * parent pointers of the three nodes that move are fixed as well.
  */
 
-template <typename ElemType>
-void BST<ElemType>::rotateRight(nodeT * & t) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::rotateRight(nodeT * & t) {
 	nodeT * child = t->left;
 	t->left = child->right;
+	setParent(t->left, t);
 	child->right = t;
+	child->parent = t->parent;
+	t->parent = child;
+	child->count = t->count;
+	updateCount(t);
 	t = child;
 }
 
@@ -280,8 +357,8 @@ void BST<ElemType>::rotateRight(nodeT * & t) {
  * node is found, RemoveTargetNode does the actual deletion.
  */
 
-template <typename ElemType>
-bool BST<ElemType>::remove(ElemType data) {
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::remove(ElemType data) {
 	bool didRemove = false;
 	recRemoveNode(root, data, didRemove);
 	if (didRemove) timestamp++;
@@ -295,11 +372,12 @@ bool BST<ElemType>::remove(ElemType data) {
  * In addition to taking the root of the tree as a parameter, this
  * method takes a flag called didRemove, which is set if a matching
  * was found in the search.  The function returns the change in the
- * size of the tree rooted at t.
+ * size of the tree rooted at t.  Each node on the path drops the
+ * removed node from the size of its subtree.
  */
 
-template <typename ElemType>
-bool BST<ElemType>::recRemoveNode(nodeT * & t, ElemType & data,
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::recRemoveNode(nodeT * & t, ElemType & data,
                                   bool & didRemove) {
 	if (t == NULL) return false;
 	int sign = cmpFn(data, t->data);
@@ -313,6 +391,7 @@ bool BST<ElemType>::recRemoveNode(nodeT * & t, ElemType & data,
 	} else {
 		if (recRemoveNode(t->right, data, didRemove)) bfDelta = -1;
 	}
+	if (didRemove) t->count--;
 	updateBF(t, bfDelta);
 	return (bfDelta != 0 && t->bf == BST_IN_BALANCE);
 }
@@ -328,18 +407,22 @@ bool BST<ElemType>::recRemoveNode(nodeT * & t, ElemType & data,
  * may not be a leaf, but will have no right child.  Its left
  * child replaces it in the tree, after which the replacement
  * data is moved to the position occupied by the target node.
+ * A child that takes the place of its parent takes over its
+ * parent pointer as well.
  */
 
-template <typename ElemType>
-bool BST<ElemType>::removeTargetNode(nodeT *  & t) {
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::removeTargetNode(nodeT *  & t) {
 	nodeT *toDelete = t;
 	if (t->left == NULL) {          /* No left child, replace with right */
 		t = t->right;
+		setParent(t, toDelete->parent);
 		delete toDelete;
 		numNodes--;
 		return true;
 	} else if (t->right == NULL) {  /* No right child, replace with left */
 		t = t->left;
+		setParent(t, toDelete->parent);
 		delete toDelete;
 		numNodes--;
 		return true;
@@ -349,8 +432,10 @@ bool BST<ElemType>::removeTargetNode(nodeT *  & t) {
 			successor = successor->right;
 		}
 		t->data = successor->data;
-		bool unused;
-		if (recRemoveNode(t->left, successor->data, unused)) {
+		bool unused = false;
+		bool shorter = recRemoveNode(t->left, successor->data, unused);
+		t->count--;
+		if (shorter) {
 			updateBF(t, 1);
 			return (t->bf == BST_IN_BALANCE);
 		}
@@ -365,13 +450,13 @@ bool BST<ElemType>::removeTargetNode(nodeT *  & t) {
  * recursive function recBSTAll, which does the actual work
  * of calling the function on all values during an InOrder walk.
  */
-template <typename ElemType>
-void BST<ElemType>::mapAll(void (*fn)(ElemType)) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::mapAll(void (*fn)(ElemType)) {
 	recBSTAll(root, fn);
 }
 
-template <typename ElemType>
-void BST<ElemType>::recBSTAll(nodeT * t, void (*fn)(ElemType)) {
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::recBSTAll(nodeT * t, void (*fn)(ElemType)) {
 	if (t != NULL) {
 		recBSTAll(t->left, fn);
 		fn(t->data);
@@ -379,16 +464,16 @@ void BST<ElemType>::recBSTAll(nodeT * t, void (*fn)(ElemType)) {
 	}
 }
 
-template <typename ElemType>
+template <typename ElemType, typename Comparator>
 template <typename ClientDataType>
-	void BST<ElemType>::mapAll(void (*fn)(ElemType, ClientDataType &),
+	void BST<ElemType, Comparator>::mapAll(void (*fn)(ElemType, ClientDataType &),
 	                           ClientDataType & data) {
 		recBSTAll(root, fn, data);
 	}
 
-template <typename ElemType>
+template <typename ElemType, typename Comparator>
 template <typename ClientDataType>
-void BST<ElemType>::recBSTAll(nodeT *t, void (*fn)(ElemType, ClientDataType &),
+void BST<ElemType, Comparator>::recBSTAll(nodeT *t, void (*fn)(ElemType, ClientDataType &),
                               ClientDataType & data) {
 	if (t != NULL) {
 		recBSTAll(t->left, fn ,data);
@@ -397,8 +482,8 @@ void BST<ElemType>::recBSTAll(nodeT *t, void (*fn)(ElemType, ClientDataType &),
 	}
 }
 
-template <typename ElemType>
-const BST<ElemType> &BST<ElemType>::operator=(const BST & rhs) {
+template <typename ElemType, typename Comparator>
+const BST<ElemType, Comparator> &BST<ElemType, Comparator>::operator=(const BST & rhs) {
 	if (this != &rhs) {
 		clear();
 		copyOtherEntries(rhs);
@@ -407,128 +492,511 @@ const BST<ElemType> &BST<ElemType>::operator=(const BST & rhs) {
 	return *this;
 }
 
-template <typename ElemType>
-BST<ElemType>::BST(const BST & rhs) {
+template <typename ElemType, typename Comparator>
+BST<ElemType, Comparator>::BST(const BST & rhs) : cmpFn(rhs.cmpFn) {
 	root = NULL;
 	copyOtherEntries(rhs);
 	timestamp = 0L;
 }
 
-template <typename ElemType>
-static void AddToTree(ElemType elem, BST<ElemType> & tree) {
-	tree.add(elem);
-}
-
 /*
  * Private method: copyOtherEntries
  * Usage: copyOtherEntries(otherBST);
  * ----------------------------------
- * This methods adds a copy of all entries from the other map to
- * this one.
- *
- * Implementation note: We aren't really adhering to const. Even though
- * the methods invoked on rhs don't modify it, they aren't marked const,
- * and thus trigger compiler problems. We cast away const-ness to avoid
- * this erroneous complaints. Sigh.
- *
- * The implementation also maps over the cells to copy as a workaround
- * for a bug in Metrowerks C++ compiler, which can't handle the
- * dual-templated map function correctly.
+ * This methods makes this tree, which must be empty, a copy of the
+ * other one.  recCloneTree copies the other tree node for node, along
+ * with the balance factors, so the copy has the same shape and takes
+ * time proportional to its size, with no comparisons or rotations.
  */
 
-template <typename ElemType>
-void BST<ElemType>::copyOtherEntries(const BST & constRhs) {
-	BST & rhs = const_cast<BST &>(constRhs);
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::copyOtherEntries(const BST & rhs) {
 	cmpFn = rhs.cmpFn;
-	rhs.mapAll< BST<ElemType> >(AddToTree, *this);
+	root = recCloneTree(rhs.root);
 	numNodes = rhs.numNodes;
 }
 
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::nodeT *
+BST<ElemType, Comparator>::recCloneTree(nodeT *t) {
+	if (t == NULL) return NULL;
+	nodeT *copy = new nodeT;
+	copy->data = t->data;
+	copy->bf = t->bf;
+	copy->count = t->count;
+	copy->left = recCloneTree(t->left);
+	copy->right = recCloneTree(t->right);
+	copy->parent = NULL;
+	setParent(copy->left, copy);
+	setParent(copy->right, copy);
+	return copy;
+}
+
+/*
+ * Implementation notes: treeHeight
+ * --------------------------------
+ * The height of an AVL tree can be read off its balance factors by
+ * following the taller child of each node down to the bottom, which
+ * takes time proportional to the height itself.
+ */
+
+template <typename ElemType, typename Comparator>
+int BST<ElemType, Comparator>::treeHeight(nodeT *t) {
+	int height = 0;
+	while (t != NULL) {
+		height++;
+		t = (t->bf == BST_LEFT_HEAVY) ? t->left : t->right;
+	}
+	return height;
+}
+
+/*
+ * Implementation notes: recJoin
+ * -----------------------------
+ * Joins the trees left and right, whose heights are leftHeight and
+ * rightHeight, using the single node mid, which falls between them,
+ * and returns the joined tree, setting height to its height.  If the
+ * heights are within one of each other, mid simply becomes the root.
+ * Otherwise the shorter tree is hung from mid at the place along the
+ * inner edge of the taller one where the heights match, and the
+ * balance factors are repaired on the way back up.  The work is
+ * proportional to the difference in heights.
+ *
+ * When a node ends up doubly heavy, fixLeftImbalance and
+ * fixRightImbalance rotate it exactly as they do after an add or
+ * remove.  The rotated subtree is as high as the child was, unless
+ * that child was in balance, in which case the single rotation leaves
+ * it one level higher.  The size of each node along the way is
+ * recounted before it is rotated.  The parent pointer of the tree
+ * that comes back is left for the caller to set.
+ */
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::nodeT *
+BST<ElemType, Comparator>::recJoin(nodeT *left, int leftHeight, nodeT *mid,
+                                   nodeT *right, int rightHeight, int & height) {
+	if (leftHeight > rightHeight + 1) {
+		int innerHeight = leftHeight - ((left->bf == BST_LEFT_HEAVY) ? 2 : 1);
+		int outerHeight = leftHeight - ((left->bf == BST_RIGHT_HEAVY) ? 2 : 1);
+		int joinedHeight;
+		left->right = recJoin(left->right, innerHeight, mid, right, rightHeight,
+		                      joinedHeight);
+		left->right->parent = left;
+		left->bf = joinedHeight - outerHeight;
+		updateCount(left);
+		if (left->bf > BST_RIGHT_HEAVY) {
+			bool childInBalance = (left->right->bf == BST_IN_BALANCE);
+			fixRightImbalance(left);
+			height = joinedHeight + (childInBalance ? 1 : 0);
+		} else {
+			height = 1 + ((joinedHeight > outerHeight) ? joinedHeight : outerHeight);
+		}
+		return left;
+	}
+	if (rightHeight > leftHeight + 1) {
+		int innerHeight = rightHeight - ((right->bf == BST_RIGHT_HEAVY) ? 2 : 1);
+		int outerHeight = rightHeight - ((right->bf == BST_LEFT_HEAVY) ? 2 : 1);
+		int joinedHeight;
+		right->left = recJoin(left, leftHeight, mid, right->left, innerHeight,
+		                      joinedHeight);
+		right->left->parent = right;
+		right->bf = outerHeight - joinedHeight;
+		updateCount(right);
+		if (right->bf < BST_LEFT_HEAVY) {
+			bool childInBalance = (right->left->bf == BST_IN_BALANCE);
+			fixLeftImbalance(right);
+			height = joinedHeight + (childInBalance ? 1 : 0);
+		} else {
+			height = 1 + ((joinedHeight > outerHeight) ? joinedHeight : outerHeight);
+		}
+		return right;
+	}
+	mid->left = left;
+	mid->right = right;
+	setParent(left, mid);
+	setParent(right, mid);
+	mid->bf = rightHeight - leftHeight;
+	updateCount(mid);
+	height = 1 + ((leftHeight > rightHeight) ? leftHeight : rightHeight);
+	return mid;
+}
+
+/*
+ * Implementation notes: joinWith
+ * ------------------------------
+ * The smallest element of other is taken out to serve as the node
+ * between the two trees in recJoin, after checking that it really
+ * does come after everything in this tree.
+ */
+
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::joinWith(BST & other) {
+	if (!SameComparator(cmpFn, other.cmpFn)) {
+		Error("joinWith: trees have different comparison functions");
+	}
+	if (other.root == NULL || this == &other) return;
+	if (root != NULL) {
+		nodeT *max = root;
+		while (max->right != NULL) {
+			max = max->right;
+		}
+		nodeT *min = other.root;
+		while (min->left != NULL) {
+			min = min->left;
+		}
+		if (cmpFn(max->data, min->data) >= 0) {
+			Error("joinWith: elements of the trees overlap");
+		}
+		nodeT *mid = new nodeT;
+		mid->data = min->data;
+		bool unused = false;
+		other.recRemoveNode(other.root, mid->data, unused);
+		int height;
+		root = recJoin(root, treeHeight(root), mid, other.root, treeHeight(other.root),
+		               height);
+		numNodes++;
+	} else {
+		root = other.root;
+	}
+	root->parent = NULL;
+	numNodes += other.numNodes;
+	other.root = NULL;
+	other.numNodes = 0;
+	timestamp++;
+	other.timestamp++;
+}
+
+/*
+ * Implementation notes: splitAt, recSplit
+ * ---------------------------------------
+ * recSplit follows the search path for key down from t, whose height
+ * is known.  Each node on the path goes to one side or the other
+ * along with its subtree on the far side of the path, and the pieces
+ * that collect on each side are joined back together on the way up.
+ * The joins along the way take time proportional to the differences
+ * in height, which add up to the height of the tree, so the split
+ * takes O(log n) time.  The size of rest is the size of the root of
+ * its tree.
+ */
+
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::splitAt(ElemType key, BST & rest) {
+	if (!SameComparator(cmpFn, rest.cmpFn)) {
+		Error("splitAt: trees have different comparison functions");
+	}
+	if (this == &rest) Error("splitAt: a tree can't be split into itself");
+	rest.clear();
+	nodeT *less, *notLess;
+	int lessHeight, notLessHeight;
+	recSplit(root, treeHeight(root), key, less, lessHeight, notLess, notLessHeight);
+	root = less;
+	rest.root = notLess;
+	setParent(root, NULL);
+	setParent(rest.root, NULL);
+	rest.numNodes = subtreeSize(notLess);
+	numNodes -= rest.numNodes;
+	timestamp++;
+}
+
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::recSplit(nodeT *t, int height, ElemType & key,
+                                         nodeT * & less, int & lessHeight,
+                                         nodeT * & notLess, int & notLessHeight) {
+	if (t == NULL) {
+		less = notLess = NULL;
+		lessHeight = notLessHeight = 0;
+		return;
+	}
+	int leftHeight = height - ((t->bf == BST_RIGHT_HEAVY) ? 2 : 1);
+	int rightHeight = height - ((t->bf == BST_LEFT_HEAVY) ? 2 : 1);
+	nodeT *left = t->left;
+	nodeT *right = t->right;
+	if (cmpFn(t->data, key) < 0) {
+		nodeT *rightPart;
+		int rightPartHeight;
+		recSplit(right, rightHeight, key, rightPart, rightPartHeight,
+		         notLess, notLessHeight);
+		less = recJoin(left, leftHeight, t, rightPart, rightPartHeight, lessHeight);
+	} else {
+		nodeT *leftPart;
+		int leftPartHeight;
+		recSplit(left, leftHeight, key, less, lessHeight, leftPart, leftPartHeight);
+		notLess = recJoin(leftPart, leftPartHeight, t, right, rightHeight, notLessHeight);
+	}
+}
+
+/*
+ * Implementation notes: subtreeSize, updateCount
+ * ----------------------------------------------
+ * Every node keeps the number of nodes in its subtree in count, which
+ * is what lets rank and select skip over whole subtrees.  updateCount
+ * recomputes a node's count from its children, which must already be
+ * right.
+ */
+
+template <typename ElemType, typename Comparator>
+int BST<ElemType, Comparator>::subtreeSize(nodeT *t) {
+	return (t == NULL) ? 0 : t->count;
+}
+
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::updateCount(nodeT *t) {
+	t->count = 1 + subtreeSize(t->left) + subtreeSize(t->right);
+}
+
+/*
+ * Implementation notes: setParent
+ * -------------------------------
+ * Points t back at its parent, unless t is an empty subtree.
+ */
+
+template <typename ElemType, typename Comparator>
+void BST<ElemType, Comparator>::setParent(nodeT *t, nodeT *parent) {
+	if (t != NULL) t->parent = parent;
+}
+
+/*
+ * Implementation notes: rank, select
+ * ----------------------------------
+ * Both follow a single path down from the root.  rank adds up the
+ * nodes to the left of the path each time it goes right; select
+ * compares the index with the size of the left subtree to decide
+ * which way to go, and takes off the nodes it passes over.
+ */
+
+template <typename ElemType, typename Comparator>
+int BST<ElemType, Comparator>::rank(ElemType key) {
+	int less = 0;
+	nodeT *t = root;
+	while (t != NULL) {
+		int sign = cmpFn(key, t->data);
+		if (sign <= 0) {
+			if (sign == 0) return less + subtreeSize(t->left);
+			t = t->left;
+		} else {
+			less += 1 + subtreeSize(t->left);
+			t = t->right;
+		}
+	}
+	return less;
+}
+
+template <typename ElemType, typename Comparator>
+ElemType BST<ElemType, Comparator>::select(int index) {
+	if (index < 0 || index >= numNodes) {
+		Error("select: index out of range");
+	}
+	nodeT *t = root;
+	while (true) {
+		int leftSize = subtreeSize(t->left);
+		if (index == leftSize) return t->data;
+		if (index < leftSize) {
+			t = t->left;
+		} else {
+			index -= leftSize + 1;
+			t = t->right;
+		}
+	}
+}
+
 /*
  * BST::Iterator class implementation
+ * ----------------------------------
+ * The iterator holds only the node it will return next.  It moves to
+ * the following node by way of the child and parent pointers, as in
+ * successor and predecessor, so it needs no stack and creating or
+ * copying one allocates nothing.  A reverse iterator moves the other
+ * way.  Over a full walk, each link in the tree is followed at most
+ * twice, so a step takes constant time on average.
  */
 
-template <typename ElemType>
-BST<ElemType>::Iterator::Iterator() {
+template <typename ElemType, typename Comparator>
+BST<ElemType, Comparator>::Iterator::Iterator() {
 	bstp = NULL;
 }
 
-template <typename ElemType>
-typename BST<ElemType>::Iterator BST<ElemType>::iterator() {
-	return Iterator(this);
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::Iterator BST<ElemType, Comparator>::iterator() {
+	return Iterator(this, false);
+}
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::Iterator BST<ElemType, Comparator>::reverseIterator() {
+	return Iterator(this, true);
+}
+
+/*
+ * Implementation notes: iteratorFrom, iteratorRange
+ * -------------------------------------------------
+ * Both start the iterator at the first node not less than lo, which
+ * is the last node on the search path for lo where the path turns
+ * left.  The iterator for a range knows from the ranks of its ends how
+ * many elements it will return, so it stops by counting them down
+ * rather than comparing each element against hi.
+ */
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::Iterator
+BST<ElemType, Comparator>::iteratorFrom(ElemType lo) {
+	Iterator iter(this, false);
+	nodeT *lowerBound = NULL;
+	nodeT *t = root;
+	while (t != NULL) {
+		if (cmpFn(t->data, lo) < 0) {
+			t = t->right;
+		} else {
+			lowerBound = t;
+			t = t->left;
+		}
+	}
+	iter.np = (void *) lowerBound;
+	return iter;
+}
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::Iterator
+BST<ElemType, Comparator>::iteratorRange(ElemType lo, ElemType hi) {
+	Iterator iter = iteratorFrom(lo);
+	int count = rank(hi) - rank(lo);
+	iter.remaining = (count > 0) ? count : 0;
+	return iter;
 }
 
-template <typename ElemType>
-BST<ElemType>::Iterator::Iterator(BST *bstptr) {
+template <typename ElemType, typename Comparator>
+BST<ElemType, Comparator>::Iterator::Iterator(BST *bstptr, bool backward) {
 	bstp = bstptr;
 	timestamp = bstp->timestamp;
-	if (bstp->root == NULL) return;
-	iteratorMarkerT marker = { (void *) bstp->root, false };
-	stack.push(marker);
-	findLeftmostChild();
+	remaining = -1;
+	reverse = backward;
+	nodeT *t = bstp->root;
+	if (t != NULL) {
+		if (reverse) {
+			while (t->right != NULL) t = t->right;
+		} else {
+			while (t->left != NULL) t = t->left;
+		}
+	}
+	np = (void *) t;
 }
 
-template <typename ElemType>
-bool BST<ElemType>::Iterator::hasNext() {
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::Iterator::hasNext() {
 	if (bstp == NULL) Error("hasNext called on uninitialized iterator");
 	if (timestamp != bstp->timestamp) {
 		Error("BST structure has been modified");
 	}
-	return !stack.isEmpty();
+	return np != NULL && remaining != 0;
 }
 
-template <typename ElemType>
-ElemType BST<ElemType>::Iterator::next() {
+template <typename ElemType, typename Comparator>
+ElemType BST<ElemType, Comparator>::Iterator::next() {
+	return nextRef();
+}
+
+/*
+ * Implementation notes: nextRef
+ * -----------------------------
+ * Returns a reference to the data in the node itself rather than a
+ * copy.  The node outlives the iterator's move past it, so the
+ * reference remains good until the tree is modified.
+ */
+
+template <typename ElemType, typename Comparator>
+const ElemType & BST<ElemType, Comparator>::Iterator::nextRef() {
 	if (bstp == NULL) Error("next called on uninitialized iterator");
 	if (!hasNext()) {
 		Error("Attempt to get next from iterator"
 		      " where hasNext() is false");
 	}
-	nodeT *np = (nodeT *) stack.peek().np;
-	ElemType result = np->data;
-	advanceToNextNode();
-	return result;
+	nodeT *t = (nodeT *) np;
+	np = (void *) ((reverse) ? predecessor(t) : successor(t));
+	if (remaining > 0) remaining--;
+	return t->data;
 }
 
-template <typename ElemType>
-void BST<ElemType>::Iterator::advanceToNextNode() {
-	iteratorMarkerT marker = stack.pop();
-	nodeT *np = (nodeT *) marker.np;
-	if (np->right == NULL) {
-		while (!stack.isEmpty() && stack.peek().processed) {
-			stack.pop();
+/*
+ * Implementation notes: successor, predecessor
+ * --------------------------------------------
+ * The node after t is the leftmost node in its right subtree, if it
+ * has one.  Otherwise it is the nearest ancestor that t lies to the
+ * left of, found by climbing until the climb arrives from a left
+ * child.  predecessor is the mirror image.  Both return NULL at the
+ * end of the tree.
+ */
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::nodeT *BST<ElemType, Comparator>::successor(nodeT *t) {
+	if (t->right != NULL) {
+		t = t->right;
+		while (t->left != NULL) {
+			t = t->left;
 		}
-	} else {
-		marker.processed = true;
-		stack.push(marker);
-		marker.np = (void *) np->right;
-		marker.processed = false;
-		stack.push(marker);
-		findLeftmostChild();
+		return t;
+	}
+	nodeT *parent = t->parent;
+	while (parent != NULL && t == parent->right) {
+		t = parent;
+		parent = t->parent;
 	}
+	return parent;
 }
 
-template <typename ElemType>
-void BST<ElemType>::Iterator::findLeftmostChild() {
-	nodeT *np = (nodeT *) stack.peek().np;
-	if (np == NULL) return;
-	while (np->left != NULL) {
-		iteratorMarkerT marker = { (void *) np->left,  false };
-		stack.push(marker);
-		np = np->left;
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::nodeT *BST<ElemType, Comparator>::predecessor(nodeT *t) {
+	if (t->left != NULL) {
+		t = t->left;
+		while (t->right != NULL) {
+			t = t->right;
+		}
+		return t;
 	}
+	nodeT *parent = t->parent;
+	while (parent != NULL && t == parent->left) {
+		t = parent;
+		parent = t->parent;
+	}
+	return parent;
 }
 
-template <typename ElemType>
-ElemType BST<ElemType>::foreachHook(FE_State & fe) {
-	if (fe.state == 0) fe.iter = new Iterator(this);
-	if (((Iterator *) fe.iter)->hasNext()) {
-		fe.state = 1;
-		return ((Iterator *) fe.iter)->next();
-	} else {
-		fe.state = 2;
-		return ElemType();
+/*
+ * BST::RangeIterator class implementation
+ * ---------------------------------------
+ */
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::RangeIterator BST<ElemType, Comparator>::begin() {
+	nodeT *t = root;
+	if (t != NULL) {
+		while (t->left != NULL) t = t->left;
 	}
+	return RangeIterator((void *) t);
+}
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::RangeIterator BST<ElemType, Comparator>::end() {
+	return RangeIterator(NULL);
+}
+
+template <typename ElemType, typename Comparator>
+BST<ElemType, Comparator>::RangeIterator::RangeIterator(void *node) {
+	np = node;
+}
+
+template <typename ElemType, typename Comparator>
+const ElemType & BST<ElemType, Comparator>::RangeIterator::operator*() {
+	return ((nodeT *) np)->data;
+}
+
+template <typename ElemType, typename Comparator>
+typename BST<ElemType, Comparator>::RangeIterator &
+BST<ElemType, Comparator>::RangeIterator::operator++() {
+	np = (void *) successor((nodeT *) np);
+	return *this;
+}
+
+template <typename ElemType, typename Comparator>
+bool BST<ElemType, Comparator>::RangeIterator::operator!=(const RangeIterator & other) {
+	return np != other.np;
 }
 
 #endif
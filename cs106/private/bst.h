@@ -14,7 +14,9 @@ public:
  * Class: BST<ElemType>::Iterator
  * ------------------------------
  * This interface defines a nested class within the BST template that
- * provides iterator access to the keys contained in the BST.
+ * provides iterator access to the keys contained in the BST.  It
+ * holds its place as the next node to return and steps through the
+ * tree along the parent pointers, in either direction.
  */
 
 	class Iterator {
@@ -22,23 +24,38 @@ public:
 		Iterator();
 		bool hasNext();
 		ElemType next();
+		const ElemType & nextRef();
 
 	private:
-		struct iteratorMarkerT {
-			void *np;
-			bool processed;
-		};
-
-		Iterator(BST *bstp);
+		Iterator(BST *bstp, bool reverse);
 		BST *bstp;
-		Stack<iteratorMarkerT> stack;
+		void *np;
+		bool reverse;
+		int remaining;
 		long timestamp;
-		void advanceToNextNode();
-		void findLeftmostChild();
 		friend class BST;
 	};
 	friend class Iterator;
-	ElemType foreachHook(FE_State & _fe);
+
+/*
+ * Class: BST<ElemType>::RangeIterator
+ * -----------------------------------
+ * The iterator returned by begin and end, which has just what the
+ * range-based for loop needs.  It holds the node to visit next and
+ * moves on to its successor as the Iterator does, but without the
+ * Iterator's checks; the end of the tree is a NULL node.
+ */
+	class RangeIterator {
+	public:
+		const ElemType & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(void *node);
+		void *np;
+		friend class BST;
+	};
 
 /*
  * Deep copying support
@@ -48,10 +65,11 @@ public:
  * and assign from one tree to another. The entire contents of
  * the tree, including all elements, are copied. Each tree
  * element is copied from the original tree to the copy using
- * assignment (operator=). Making copies is generally avoided
- * because of the expense and thus, trees are typically passed
- * by reference, however, when a copy is needed, these operations
- * are supported.
+ * assignment (operator=), into a copy of the original's node,
+ * so the copy takes time proportional to the size of the tree.
+ * Making copies is generally avoided because of the expense and
+ * thus, trees are typically passed by reference, however, when a
+ * copy is needed, these operations are supported.
  */
 	const BST & operator=(const BST & rhs);
 	BST(const BST & rhs);
@@ -62,7 +80,9 @@ private:
 	struct nodeT {
 		ElemType data;
 		nodeT *left, *right;
+		nodeT *parent;
 		int bf;    /* AVL balance factor */
+		int count; /* number of nodes in this subtree */
 	};
 
 /* Constant definitions */
@@ -74,7 +94,7 @@ private:
 	nodeT *root;
 	int numNodes;
 	long timestamp;
-	int (*cmpFn)(ElemType, ElemType);
+	Comparator cmpFn;
 
 /* Private method prototypes */
 	nodeT *recFindNode(nodeT *t, ElemType & key);
@@ -83,12 +103,25 @@ private:
 	bool removeTargetNode(nodeT * & t);
 	void updateBF(nodeT * & t, int bfDelta);
 	void recDeleteTree(nodeT *t);
+	nodeT *recBuildTree(Vector<ElemType> & elems, int lo, int hi, int & height);
 	void recBSTAll(nodeT *t, void (*fn)(ElemType));
 	void fixRightImbalance(nodeT * & t);
 	void fixLeftImbalance(nodeT * & t);
 	void rotateRight(nodeT * & t);
 	void rotateLeft(nodeT * & t);
 	void copyOtherEntries(const BST & other);
+	nodeT *recCloneTree(nodeT *t);
+	int treeHeight(nodeT *t);
+	nodeT *recJoin(nodeT *left, int leftHeight, nodeT *mid,
+	               nodeT *right, int rightHeight, int & height);
+	void recSplit(nodeT *t, int height, ElemType & key,
+	              nodeT * & less, int & lessHeight,
+	              nodeT * & notLess, int & notLessHeight);
+	static int subtreeSize(nodeT *t);
+	static void updateCount(nodeT *t);
+	static void setParent(nodeT *t, nodeT *parent);
+	static nodeT *successor(nodeT *t);
+	static nodeT *predecessor(nodeT *t);
 
 /* Template method prototypes */
 
@@ -0,0 +1,890 @@
+/*
+ * File: private/btree.cpp
+ * -----------------------
+ * This file contains the implementation of the btree.h interface.
+ * Because of the way C++ compiles templates, this code must be
+ * available to the compiler when it reads the header file.
+ */
+
+#ifdef _btree_h
+
+template <typename ElemType, typename Comparator>
+BTree<ElemType, Comparator>::BTree(Comparator cmp) : cmpFn(cmp) {
+	root = NULL;
+	numElems = 0;
+	timestamp = 0L;
+}
+
+template <typename ElemType, typename Comparator>
+BTree<ElemType, Comparator>::~BTree() {
+	deleteTree(root);
+}
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::deleteTree(nodeT *t) {
+	if (t == NULL) return;
+	if (t->isLeaf) {
+		delete (leafT *) t;
+	} else {
+		innerT *np = (innerT *) t;
+		for (int i = 0; i <= np->numKeys; i++) {
+			deleteTree(np->children[i]);
+		}
+		delete np;
+	}
+}
+
+template <typename ElemType, typename Comparator>
+int BTree<ElemType, Comparator>::size() {
+	return numElems;
+}
+
+template <typename ElemType, typename Comparator>
+bool BTree<ElemType, Comparator>::isEmpty() {
+	return numElems == 0;
+}
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::clear() {
+	deleteTree(root);
+	root = NULL;
+	numElems = 0;
+	timestamp++;
+}
+
+/*
+ * Implementation notes: searchNode, childIndex
+ * --------------------------------------------
+ * searchNode is a binary search within a node that returns the index of
+ * the first key not less than key, and sets found if that key is equal
+ * to it.  It makes three-way use of each comparison, stopping as soon
+ * as it hits an equal key, so a successful search never needs a final
+ * comparison to confirm the match.  In an interior node, childIndex is
+ * the child to descend into; a key equal to a separator lives to its
+ * right.
+ */
+
+template <typename ElemType, typename Comparator>
+int BTree<ElemType, Comparator>::searchNode(ElemType keys[], int numKeys, ElemType & key,
+                                bool & found) {
+	int lo = 0;
+	int hi = numKeys;
+	found = false;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int sign = cmpFn(keys[mid], key);
+		if (sign < 0) {
+			lo = mid + 1;
+		} else if (sign > 0) {
+			hi = mid;
+		} else {
+			found = true;
+			return mid;
+		}
+	}
+	return lo;
+}
+
+template <typename ElemType, typename Comparator>
+int BTree<ElemType, Comparator>::childIndex(innerT *np, ElemType & key) {
+	bool found;
+	int index = searchNode(np->keys, np->numKeys, key, found);
+	return (found) ? index + 1 : index;
+}
+
+/*
+ * Implementation notes: findLeaf
+ * ------------------------------
+ * Walks down from the root to the leaf where key belongs, recording
+ * each interior node and the child taken in path.  On return, depth
+ * is the number of entries in path.  The tree must not be empty.
+ */
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::leafT *BTree<ElemType, Comparator>::findLeaf(ElemType & key,
+                                                           pathEntryT path[],
+                                                           int & depth) {
+	nodeT *t = root;
+	depth = 0;
+	while (!t->isLeaf) {
+		innerT *np = (innerT *) t;
+		int index = childIndex(np, key);
+		path[depth].node = np;
+		path[depth].childIndex = index;
+		depth++;
+		t = np->children[index];
+	}
+	return (leafT *) t;
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::leafT *BTree<ElemType, Comparator>::leftmostLeaf() {
+	nodeT *t = root;
+	if (t == NULL) return NULL;
+	while (!t->isLeaf) {
+		t = ((innerT *) t)->children[0];
+	}
+	return (leafT *) t;
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::leafT *BTree<ElemType, Comparator>::rightmostLeaf() {
+	nodeT *t = root;
+	if (t == NULL) return NULL;
+	while (!t->isLeaf) {
+		innerT *np = (innerT *) t;
+		t = np->children[np->numKeys];
+	}
+	return (leafT *) t;
+}
+
+/*
+ * Implementation notes: find
+ * --------------------------
+ * The search is a loop rather than a recursion, and does a binary
+ * search within each node it passes through.
+ */
+
+template <typename ElemType, typename Comparator>
+ElemType *BTree<ElemType, Comparator>::find(ElemType key) {
+	if (root == NULL) return NULL;
+	nodeT *t = root;
+	while (!t->isLeaf) {
+		innerT *np = (innerT *) t;
+		t = np->children[childIndex(np, key)];
+	}
+	leafT *lp = (leafT *) t;
+	bool found;
+	int index = searchNode(lp->keys, lp->numKeys, key, found);
+	return (found) ? &lp->keys[index] : NULL;
+}
+
+/*
+ * Implementation notes: add
+ * -------------------------
+ * The new element goes into its leaf in sorted position.  If that
+ * leaves the leaf one over capacity, splitLeaf divides it in two and
+ * passes a separator up to the parent, which may split in turn.  The
+ * new element is counted under each child on the path first, so the
+ * splits need only divide those counts between the halves.
+ */
+
+template <typename ElemType, typename Comparator>
+bool BTree<ElemType, Comparator>::add(ElemType data) {
+	if (root == NULL) {
+		leafT *lp = new leafT;
+		lp->numKeys = 0;
+		lp->isLeaf = true;
+		lp->next = lp->prev = NULL;
+		root = lp;
+	}
+	pathEntryT path[MAX_HEIGHT];
+	int depth;
+	leafT *lp = findLeaf(data, path, depth);
+	bool found;
+	int index = searchNode(lp->keys, lp->numKeys, data, found);
+	if (found) {
+		lp->keys[index] = data;
+		return false;
+	}
+	for (int i = lp->numKeys; i > index; i--) {
+		lp->keys[i] = std::move(lp->keys[i - 1]);
+	}
+	lp->keys[index] = data;
+	lp->numKeys++;
+	for (int i = 0; i < depth; i++) {
+		path[i].node->counts[path[i].childIndex]++;
+	}
+	numElems++;
+	timestamp++;
+	if (lp->numKeys > LEAF_CAPACITY) splitLeaf(lp, path, depth);
+	return true;
+}
+
+/*
+ * Implementation notes: splitLeaf
+ * -------------------------------
+ * Moves the upper half of an overfull leaf into a new leaf that
+ * follows it in the chain.  The first element of the new leaf becomes
+ * the separator between the two.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::splitLeaf(leafT *lp, pathEntryT path[], int depth) {
+	leafT *right = new leafT;
+	int half = lp->numKeys / 2;
+	right->numKeys = lp->numKeys - half;
+	right->isLeaf = true;
+	for (int i = 0; i < right->numKeys; i++) {
+		right->keys[i] = std::move(lp->keys[half + i]);
+	}
+	lp->numKeys = half;
+	right->next = lp->next;
+	right->prev = lp;
+	if (right->next != NULL) right->next->prev = right;
+	lp->next = right;
+	ElemType separator = right->keys[0];
+	insertIntoParent(path, depth, separator, right);
+}
+
+/*
+ * Implementation notes: insertIntoParent
+ * --------------------------------------
+ * Adds separator and the new node to its right to the parent of the
+ * node that split, which is the last entry in path.  If the parent is
+ * then over capacity, it splits around its middle key, which moves up
+ * a level rather than being copied, and the loop continues with the
+ * grandparent.  When the node that split is the root, the tree grows
+ * a new root above it.  The counts for the two halves are recounted
+ * from the halves themselves.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::insertIntoParent(pathEntryT path[], int depth,
+                                       ElemType & separator, nodeT *right) {
+	while (depth > 0) {
+		depth--;
+		innerT *np = path[depth].node;
+		int pos = path[depth].childIndex;
+		for (int i = np->numKeys; i > pos; i--) {
+			np->keys[i] = std::move(np->keys[i - 1]);
+			np->children[i + 1] = np->children[i];
+			np->counts[i + 1] = np->counts[i];
+		}
+		np->keys[pos] = std::move(separator);
+		np->children[pos + 1] = right;
+		np->counts[pos] = subtreeSize(np->children[pos]);
+		np->counts[pos + 1] = subtreeSize(right);
+		np->numKeys++;
+		if (np->numKeys <= INNER_CAPACITY) return;
+		innerT *sibling = new innerT;
+		int mid = np->numKeys / 2;
+		sibling->numKeys = np->numKeys - mid - 1;
+		sibling->isLeaf = false;
+		for (int i = 0; i < sibling->numKeys; i++) {
+			sibling->keys[i] = std::move(np->keys[mid + 1 + i]);
+			sibling->children[i] = np->children[mid + 1 + i];
+			sibling->counts[i] = np->counts[mid + 1 + i];
+		}
+		sibling->children[sibling->numKeys] = np->children[np->numKeys];
+		sibling->counts[sibling->numKeys] = np->counts[np->numKeys];
+		separator = std::move(np->keys[mid]);
+		np->numKeys = mid;
+		right = sibling;
+	}
+	innerT *newRoot = new innerT;
+	newRoot->numKeys = 1;
+	newRoot->isLeaf = false;
+	newRoot->keys[0] = std::move(separator);
+	newRoot->children[0] = root;
+	newRoot->children[1] = right;
+	newRoot->counts[0] = subtreeSize(root);
+	newRoot->counts[1] = subtreeSize(right);
+	root = newRoot;
+}
+
+/*
+ * Implementation notes: remove
+ * ----------------------------
+ * The element is taken out of its leaf.  A separator equal to it may
+ * remain in an interior node, which does no harm: it still divides the
+ * elements on either side correctly.  If the leaf drops below half
+ * full, fixLeafUnderflow restores it, moving counts between the
+ * parent's entries along with the elements it moves.
+ */
+
+template <typename ElemType, typename Comparator>
+bool BTree<ElemType, Comparator>::remove(ElemType data) {
+	if (root == NULL) return false;
+	pathEntryT path[MAX_HEIGHT];
+	int depth;
+	leafT *lp = findLeaf(data, path, depth);
+	bool found;
+	int index = searchNode(lp->keys, lp->numKeys, data, found);
+	if (!found) return false;
+	for (int i = index + 1; i < lp->numKeys; i++) {
+		lp->keys[i - 1] = std::move(lp->keys[i]);
+	}
+	lp->keys[lp->numKeys - 1] = ElemType();
+	lp->numKeys--;
+	for (int i = 0; i < depth; i++) {
+		path[i].node->counts[path[i].childIndex]--;
+	}
+	numElems--;
+	timestamp++;
+	if (depth == 0) {
+		if (lp->numKeys == 0) {
+			delete lp;
+			root = NULL;
+		}
+	} else if (lp->numKeys < MIN_LEAF_KEYS) {
+		fixLeafUnderflow(lp, path, depth);
+	}
+	return true;
+}
+
+/*
+ * Implementation notes: fixLeafUnderflow
+ * --------------------------------------
+ * A leaf that has dropped below half full first tries to borrow an
+ * element from a sibling that can spare one, which changes only the
+ * separator between them.  If neither sibling can, the leaf is merged
+ * with one of them, which together fit in a single leaf, and the
+ * separator between them comes out of the parent.  The node on the
+ * right is always the one that goes away, so the leftmost leaf never
+ * changes.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::fixLeafUnderflow(leafT *lp, pathEntryT path[], int depth) {
+	innerT *parent = path[depth - 1].node;
+	int pos = path[depth - 1].childIndex;
+	leafT *left = (pos > 0) ? (leafT *) parent->children[pos - 1] : NULL;
+	leafT *right = (pos < parent->numKeys) ? (leafT *) parent->children[pos + 1] : NULL;
+	if (left != NULL && left->numKeys > MIN_LEAF_KEYS) {
+		for (int i = lp->numKeys; i > 0; i--) {
+			lp->keys[i] = std::move(lp->keys[i - 1]);
+		}
+		lp->keys[0] = std::move(left->keys[left->numKeys - 1]);
+		left->numKeys--;
+		lp->numKeys++;
+		parent->keys[pos - 1] = lp->keys[0];
+		parent->counts[pos - 1]--;
+		parent->counts[pos]++;
+		return;
+	}
+	if (right != NULL && right->numKeys > MIN_LEAF_KEYS) {
+		lp->keys[lp->numKeys++] = std::move(right->keys[0]);
+		for (int i = 1; i < right->numKeys; i++) {
+			right->keys[i - 1] = std::move(right->keys[i]);
+		}
+		right->numKeys--;
+		parent->keys[pos] = right->keys[0];
+		parent->counts[pos + 1]--;
+		parent->counts[pos]++;
+		return;
+	}
+	int separatorIndex = pos;
+	if (left != NULL) {
+		right = lp;
+		lp = left;
+		separatorIndex = pos - 1;
+	}
+	for (int i = 0; i < right->numKeys; i++) {
+		lp->keys[lp->numKeys + i] = std::move(right->keys[i]);
+	}
+	lp->numKeys += right->numKeys;
+	lp->next = right->next;
+	if (lp->next != NULL) lp->next->prev = lp;
+	delete right;
+	parent->counts[separatorIndex] += parent->counts[separatorIndex + 1];
+	removeFromInner(parent, separatorIndex);
+	fixInnerUnderflow(path, depth - 1);
+}
+
+/*
+ * Implementation notes: removeFromInner
+ * -------------------------------------
+ * Removes keys[keyIndex] and the child to its right from an interior
+ * node, after the two children on either side of it have been merged
+ * and their counts added together.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::removeFromInner(innerT *np, int keyIndex) {
+	for (int i = keyIndex + 1; i < np->numKeys; i++) {
+		np->keys[i - 1] = std::move(np->keys[i]);
+		np->children[i] = np->children[i + 1];
+		np->counts[i] = np->counts[i + 1];
+	}
+	np->numKeys--;
+	np->keys[np->numKeys] = ElemType();
+}
+
+/*
+ * Implementation notes: fixInnerUnderflow
+ * ---------------------------------------
+ * Restores the interior node path[depth].node after it has lost a key.
+ * Borrowing from a sibling rotates a key through the parent: the
+ * parent's separator comes down into this node and the sibling's
+ * nearest key goes up to replace it, along with the child between
+ * them.  Merging pulls the separator down between the two nodes'
+ * keys, which can leave the parent short in turn, so the loop works
+ * its way up the path.  A root left with no keys is replaced by its
+ * only child.  A child that moves between siblings takes its count
+ * with it, out of one of the parent's counts and into the other.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::fixInnerUnderflow(pathEntryT path[], int depth) {
+	while (depth > 0) {
+		innerT *np = path[depth].node;
+		if (np->numKeys >= MIN_INNER_KEYS) return;
+		innerT *parent = path[depth - 1].node;
+		int pos = path[depth - 1].childIndex;
+		innerT *left = (pos > 0) ? (innerT *) parent->children[pos - 1] : NULL;
+		innerT *right = (pos < parent->numKeys) ? (innerT *) parent->children[pos + 1] : NULL;
+		if (left != NULL && left->numKeys > MIN_INNER_KEYS) {
+			int moved = left->counts[left->numKeys];
+			np->children[np->numKeys + 1] = np->children[np->numKeys];
+			np->counts[np->numKeys + 1] = np->counts[np->numKeys];
+			for (int i = np->numKeys; i > 0; i--) {
+				np->keys[i] = std::move(np->keys[i - 1]);
+				np->children[i] = np->children[i - 1];
+				np->counts[i] = np->counts[i - 1];
+			}
+			np->keys[0] = std::move(parent->keys[pos - 1]);
+			np->children[0] = left->children[left->numKeys];
+			np->counts[0] = moved;
+			parent->counts[pos - 1] -= moved;
+			parent->counts[pos] += moved;
+			parent->keys[pos - 1] = std::move(left->keys[left->numKeys - 1]);
+			left->numKeys--;
+			np->numKeys++;
+			return;
+		}
+		if (right != NULL && right->numKeys > MIN_INNER_KEYS) {
+			int moved = right->counts[0];
+			np->keys[np->numKeys] = std::move(parent->keys[pos]);
+			np->children[np->numKeys + 1] = right->children[0];
+			np->counts[np->numKeys + 1] = moved;
+			parent->keys[pos] = std::move(right->keys[0]);
+			parent->counts[pos + 1] -= moved;
+			parent->counts[pos] += moved;
+			for (int i = 1; i < right->numKeys; i++) {
+				right->keys[i - 1] = std::move(right->keys[i]);
+				right->children[i - 1] = right->children[i];
+				right->counts[i - 1] = right->counts[i];
+			}
+			right->children[right->numKeys - 1] = right->children[right->numKeys];
+			right->counts[right->numKeys - 1] = right->counts[right->numKeys];
+			right->numKeys--;
+			np->numKeys++;
+			return;
+		}
+		int separatorIndex = pos;
+		if (left != NULL) {
+			right = np;
+			np = left;
+			separatorIndex = pos - 1;
+		}
+		np->keys[np->numKeys] = std::move(parent->keys[separatorIndex]);
+		for (int i = 0; i < right->numKeys; i++) {
+			np->keys[np->numKeys + 1 + i] = std::move(right->keys[i]);
+			np->children[np->numKeys + 1 + i] = right->children[i];
+			np->counts[np->numKeys + 1 + i] = right->counts[i];
+		}
+		np->children[np->numKeys + 1 + right->numKeys] = right->children[right->numKeys];
+		np->counts[np->numKeys + 1 + right->numKeys] = right->counts[right->numKeys];
+		np->numKeys += 1 + right->numKeys;
+		delete right;
+		parent->counts[separatorIndex] += parent->counts[separatorIndex + 1];
+		removeFromInner(parent, separatorIndex);
+		depth--;
+	}
+	innerT *oldRoot = (innerT *) root;
+	if (oldRoot->numKeys == 0) {
+		root = oldRoot->children[0];
+		delete oldRoot;
+	}
+}
+
+/*
+ * Implementation notes: buildFromSorted, buildLevelAbove
+ * ------------------------------------------------------
+ * The elements are dealt out over the fewest leaves that can hold
+ * them, as evenly as possible, so every leaf is at least half full.
+ * Each level of interior nodes is then built the same way over the
+ * level below, until a single node remains to be the root.  firstKeys
+ * holds the smallest element under each node of the current level,
+ * which is the separator to its left in the level above.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::buildFromSorted(Vector<ElemType> & elems) {
+	for (int i = 1; i < elems.size(); i++) {
+		if (cmpFn(elems[i - 1], elems[i]) >= 0) {
+			Error("buildFromSorted: elements are not in increasing order");
+		}
+	}
+	deleteTree(root);
+	root = NULL;
+	numElems = elems.size();
+	timestamp++;
+	if (numElems == 0) return;
+	int numLeaves = (numElems + LEAF_CAPACITY - 1) / LEAF_CAPACITY;
+	Vector<nodeT *> nodes(numLeaves);
+	Vector<ElemType> firstKeys(numLeaves);
+	leafT *prev = NULL;
+	int next = 0;
+	for (int i = 0; i < numLeaves; i++) {
+		leafT *lp = new leafT;
+		lp->numKeys = numElems / numLeaves + ((i < numElems % numLeaves) ? 1 : 0);
+		lp->isLeaf = true;
+		lp->next = NULL;
+		lp->prev = prev;
+		for (int j = 0; j < lp->numKeys; j++) {
+			lp->keys[j] = std::move(elems[next++]);
+		}
+		if (prev != NULL) prev->next = lp;
+		prev = lp;
+		nodes.add(lp);
+		firstKeys.add(lp->keys[0]);
+	}
+	while (nodes.size() > 1) {
+		buildLevelAbove(nodes, firstKeys);
+	}
+	root = nodes[0];
+	elems.clear();
+}
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::buildLevelAbove(Vector<nodeT *> & nodes,
+                                                  Vector<ElemType> & firstKeys) {
+	int numChildren = nodes.size();
+	int numParents = (numChildren + INNER_CAPACITY) / (INNER_CAPACITY + 1);
+	Vector<nodeT *> parents(numParents);
+	Vector<ElemType> parentFirstKeys(numParents);
+	int next = 0;
+	for (int i = 0; i < numParents; i++) {
+		innerT *np = new innerT;
+		int count = numChildren / numParents + ((i < numChildren % numParents) ? 1 : 0);
+		np->numKeys = count - 1;
+		np->isLeaf = false;
+		parentFirstKeys.add(firstKeys[next]);
+		np->children[0] = nodes[next];
+		np->counts[0] = subtreeSize(nodes[next++]);
+		for (int j = 1; j < count; j++) {
+			np->keys[j - 1] = std::move(firstKeys[next]);
+			np->children[j] = nodes[next];
+			np->counts[j] = subtreeSize(nodes[next++]);
+		}
+		parents.add(np);
+	}
+	nodes = parents;
+	firstKeys = parentFirstKeys;
+}
+
+/*
+ * Implementation notes: subtreeSize
+ * ---------------------------------
+ * Returns the number of elements under a node, which for an interior
+ * node is the sum of its counts.
+ */
+
+template <typename ElemType, typename Comparator>
+int BTree<ElemType, Comparator>::subtreeSize(nodeT *t) {
+	if (t->isLeaf) return t->numKeys;
+	innerT *np = (innerT *) t;
+	int total = 0;
+	for (int i = 0; i <= np->numKeys; i++) {
+		total += np->counts[i];
+	}
+	return total;
+}
+
+/*
+ * Implementation notes: rank, select
+ * ----------------------------------
+ * Both walk down a single path from the root.  rank adds up the counts
+ * of the children to the left of the one it descends into, and the
+ * position of key within the leaf.  select skips over whole children
+ * until the index falls within one.
+ */
+
+template <typename ElemType, typename Comparator>
+int BTree<ElemType, Comparator>::rank(ElemType key) {
+	if (root == NULL) return 0;
+	int less = 0;
+	nodeT *t = root;
+	while (!t->isLeaf) {
+		innerT *np = (innerT *) t;
+		int index = childIndex(np, key);
+		for (int i = 0; i < index; i++) {
+			less += np->counts[i];
+		}
+		t = np->children[index];
+	}
+	leafT *lp = (leafT *) t;
+	bool found;
+	return less + searchNode(lp->keys, lp->numKeys, key, found);
+}
+
+template <typename ElemType, typename Comparator>
+ElemType BTree<ElemType, Comparator>::select(int index) {
+	if (index < 0 || index >= numElems) {
+		Error("select: index out of range");
+	}
+	nodeT *t = root;
+	while (!t->isLeaf) {
+		innerT *np = (innerT *) t;
+		int child = 0;
+		while (index >= np->counts[child]) {
+			index -= np->counts[child++];
+		}
+		t = np->children[child];
+	}
+	return ((leafT *) t)->keys[index];
+}
+
+/*
+ * Implementation notes: mapAll
+ * ----------------------------
+ * Both versions of mapAll walk the chain of leaves from the leftmost.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::mapAll(void (*fn)(ElemType)) {
+	for (leafT *lp = leftmostLeaf(); lp != NULL; lp = lp->next) {
+		for (int i = 0; i < lp->numKeys; i++) {
+			fn(lp->keys[i]);
+		}
+	}
+}
+
+template <typename ElemType, typename Comparator>
+template <typename ClientDataType>
+void BTree<ElemType, Comparator>::mapAll(void (*fn)(ElemType, ClientDataType &),
+                             ClientDataType & data) {
+	for (leafT *lp = leftmostLeaf(); lp != NULL; lp = lp->next) {
+		for (int i = 0; i < lp->numKeys; i++) {
+			fn(lp->keys[i], data);
+		}
+	}
+}
+
+template <typename ElemType, typename Comparator>
+const BTree<ElemType, Comparator> &BTree<ElemType, Comparator>::operator=(const BTree & rhs) {
+	if (this != &rhs) {
+		clear();
+		copyOtherEntries(rhs);
+		timestamp = 0L;
+	}
+	return *this;
+}
+
+template <typename ElemType, typename Comparator>
+BTree<ElemType, Comparator>::BTree(const BTree & rhs) : cmpFn(rhs.cmpFn) {
+	root = NULL;
+	copyOtherEntries(rhs);
+	timestamp = 0L;
+}
+
+/*
+ * Private method: copyOtherEntries
+ * Usage: copyOtherEntries(otherTree);
+ * -----------------------------------
+ * This method makes this tree a copy of the other one, which must be
+ * empty.  cloneTree copies the nodes depth first, which visits the
+ * leaves from left to right, so each new leaf is chained onto the one
+ * copied before it.
+ */
+
+template <typename ElemType, typename Comparator>
+void BTree<ElemType, Comparator>::copyOtherEntries(const BTree & other) {
+	cmpFn = other.cmpFn;
+	numElems = other.numElems;
+	leafT *lastLeaf = NULL;
+	root = cloneTree(other.root, lastLeaf);
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::nodeT *BTree<ElemType, Comparator>::cloneTree(nodeT *t, leafT * & lastLeaf) {
+	if (t == NULL) return NULL;
+	if (t->isLeaf) {
+		leafT *lp = (leafT *) t;
+		leafT *copy = new leafT;
+		copy->numKeys = lp->numKeys;
+		copy->isLeaf = true;
+		for (int i = 0; i < lp->numKeys; i++) {
+			copy->keys[i] = lp->keys[i];
+		}
+		copy->next = NULL;
+		copy->prev = lastLeaf;
+		if (lastLeaf != NULL) lastLeaf->next = copy;
+		lastLeaf = copy;
+		return copy;
+	}
+	innerT *np = (innerT *) t;
+	innerT *copy = new innerT;
+	copy->numKeys = np->numKeys;
+	copy->isLeaf = false;
+	for (int i = 0; i < np->numKeys; i++) {
+		copy->keys[i] = np->keys[i];
+	}
+	for (int i = 0; i <= np->numKeys; i++) {
+		copy->children[i] = cloneTree(np->children[i], lastLeaf);
+		copy->counts[i] = np->counts[i];
+	}
+	return copy;
+}
+
+/*
+ * BTree::Iterator class implementation
+ */
+
+template <typename ElemType, typename Comparator>
+BTree<ElemType, Comparator>::Iterator::Iterator() {
+	tp = NULL;
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::Iterator BTree<ElemType, Comparator>::iterator() {
+	return Iterator(this, false);
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::Iterator BTree<ElemType, Comparator>::reverseIterator() {
+	return Iterator(this, true);
+}
+
+/*
+ * Implementation notes: iteratorFrom, iteratorRange
+ * -------------------------------------------------
+ * The iterator starts in the leaf where lo belongs, at the first
+ * element not less than it, which may be at the start of the next
+ * leaf.  The iterator for a range knows from the ranks of its ends how
+ * many elements it will return, so it stops by counting them down
+ * rather than comparing each element against hi.
+ */
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::Iterator
+BTree<ElemType, Comparator>::iteratorFrom(ElemType lo) {
+	Iterator iter(this, false);
+	if (root == NULL) return iter;
+	nodeT *t = root;
+	while (!t->isLeaf) {
+		innerT *np = (innerT *) t;
+		t = np->children[childIndex(np, lo)];
+	}
+	leafT *lp = (leafT *) t;
+	bool found;
+	int index = searchNode(lp->keys, lp->numKeys, lo, found);
+	if (index == lp->numKeys) {
+		lp = lp->next;
+		index = 0;
+	}
+	iter.leaf = (void *) lp;
+	iter.index = index;
+	return iter;
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::Iterator
+BTree<ElemType, Comparator>::iteratorRange(ElemType lo, ElemType hi) {
+	Iterator iter = iteratorFrom(lo);
+	int count = rank(hi) - rank(lo);
+	iter.remaining = (count > 0) ? count : 0;
+	return iter;
+}
+
+template <typename ElemType, typename Comparator>
+BTree<ElemType, Comparator>::Iterator::Iterator(BTree *treeptr, bool backward) {
+	tp = treeptr;
+	timestamp = tp->timestamp;
+	reverse = backward;
+	remaining = -1;
+	if (reverse) {
+		leafT *lp = tp->rightmostLeaf();
+		leaf = (void *) lp;
+		index = (lp == NULL) ? 0 : lp->numKeys - 1;
+	} else {
+		leaf = (void *) tp->leftmostLeaf();
+		index = 0;
+	}
+}
+
+template <typename ElemType, typename Comparator>
+bool BTree<ElemType, Comparator>::Iterator::hasNext() {
+	if (tp == NULL) Error("hasNext called on uninitialized iterator");
+	if (timestamp != tp->timestamp) {
+		Error("BTree structure has been modified");
+	}
+	return leaf != NULL && remaining != 0;
+}
+
+template <typename ElemType, typename Comparator>
+ElemType BTree<ElemType, Comparator>::Iterator::next() {
+	return nextRef();
+}
+
+/*
+ * Implementation notes: nextRef
+ * -----------------------------
+ * Returns a reference to the element in its leaf rather than a copy.
+ * The reference remains good until the tree is modified.  A reverse
+ * iterator steps down through each leaf and then on to the previous
+ * one.
+ */
+
+template <typename ElemType, typename Comparator>
+const ElemType & BTree<ElemType, Comparator>::Iterator::nextRef() {
+	if (tp == NULL) Error("next called on uninitialized iterator");
+	if (!hasNext()) {
+		Error("Attempt to get next from iterator"
+		      " where hasNext() is false");
+	}
+	leafT *lp = (leafT *) leaf;
+	const ElemType & elem = lp->keys[index];
+	if (reverse) {
+		if (--index < 0) {
+			lp = lp->prev;
+			leaf = (void *) lp;
+			if (lp != NULL) index = lp->numKeys - 1;
+		}
+	} else if (++index == lp->numKeys) {
+		leaf = (void *) lp->next;
+		index = 0;
+	}
+	if (remaining > 0) remaining--;
+	return elem;
+}
+
+/*
+ * BTree::RangeIterator class implementation
+ * -----------------------------------------
+ * Only the root can be an empty leaf, so begin checks for that and
+ * operator++ never lands on one.
+ */
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::RangeIterator BTree<ElemType, Comparator>::begin() {
+	leafT *lp = leftmostLeaf();
+	if (lp != NULL && lp->numKeys == 0) lp = NULL;
+	return RangeIterator((void *) lp);
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::RangeIterator BTree<ElemType, Comparator>::end() {
+	return RangeIterator(NULL);
+}
+
+template <typename ElemType, typename Comparator>
+BTree<ElemType, Comparator>::RangeIterator::RangeIterator(void *leafPtr) {
+	leaf = leafPtr;
+	index = 0;
+}
+
+template <typename ElemType, typename Comparator>
+const ElemType & BTree<ElemType, Comparator>::RangeIterator::operator*() {
+	return ((leafT *) leaf)->keys[index];
+}
+
+template <typename ElemType, typename Comparator>
+typename BTree<ElemType, Comparator>::RangeIterator &
+BTree<ElemType, Comparator>::RangeIterator::operator++() {
+	leafT *lp = (leafT *) leaf;
+	if (++index == lp->numKeys) {
+		leaf = (void *) lp->next;
+		index = 0;
+	}
+	return *this;
+}
+
+template <typename ElemType, typename Comparator>
+bool BTree<ElemType, Comparator>::RangeIterator::operator!=(const RangeIterator & other) {
+	return leaf != other.leaf || index != other.index;
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * File: private/btree.h
+ * ---------------------
+ * This file contains the private section of the btree.h interface.
+ * This portion of the class definition is taken out of the btree.h
+ * header so that the client need not have to see all of these
+ * details.
+ */
+
+public:
+
+/*
+ * Class: BTree<ElemType>::Iterator
+ * --------------------------------
+ * This interface defines a nested class within the BTree template that
+ * provides iterator access to the elements in the tree.  It holds its
+ * place as a leaf and an index within it, and moves through the chain
+ * of leaves in either direction.
+ */
+
+	class Iterator {
+	public:
+		Iterator();
+		bool hasNext();
+		ElemType next();
+		const ElemType & nextRef();
+
+	private:
+		Iterator(BTree *tp, bool reverse);
+		BTree *tp;
+		void *leaf;
+		int index;
+		bool reverse;
+		int remaining;
+		long timestamp;
+		friend class BTree;
+	};
+	friend class Iterator;
+
+/*
+ * Class: BTree<ElemType>::RangeIterator
+ * -------------------------------------
+ * The iterator returned by begin and end, which has just what the
+ * range-based for loop needs.  It holds a leaf and an index within it
+ * and moves along the chain of leaves as the Iterator does, but
+ * without the Iterator's checks; the end of the tree is a NULL leaf.
+ */
+	class RangeIterator {
+	public:
+		const ElemType & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(void *leafPtr);
+		void *leaf;
+		int index;
+		friend class BTree;
+	};
+
+/*
+ * Deep copying support
+ * --------------------
+ * This copy constructor and operator= are defined to make a deep
+ * copy, making it possible to pass/return trees by value and assign
+ * from one tree to another.  The copy is made node by node, so it has
+ * the same shape as the original and needs no comparisons.
+ */
+	const BTree & operator=(const BTree & rhs);
+	BTree(const BTree & rhs);
+
+private:
+
+/*
+ * Node sizes
+ * ----------
+ * Each node is sized to hold about BTREE_NODE_BYTES of elements, which
+ * is four cache lines, but never fewer than eight.  A node may hold one
+ * element more than its capacity just long enough to be split, so the
+ * arrays have a spare slot.  An interior node spends an int per child
+ * on its counts as well as the pointer.  A node other than the root is
+ * never left with fewer than half its capacity.
+ */
+	static const int BTREE_NODE_BYTES = 256;
+	static const int MIN_NODE_CAPACITY = 8;
+	static const int MAX_HEIGHT = 32;
+
+	static const int LEAF_CAPACITY =
+		(BTREE_NODE_BYTES / sizeof(ElemType) > MIN_NODE_CAPACITY)
+		? int(BTREE_NODE_BYTES / sizeof(ElemType)) : MIN_NODE_CAPACITY;
+	static const int INNER_CAPACITY =
+		(BTREE_NODE_BYTES / (sizeof(ElemType) + sizeof(void *) + sizeof(int))
+		 > MIN_NODE_CAPACITY)
+		? int(BTREE_NODE_BYTES / (sizeof(ElemType) + sizeof(void *) + sizeof(int)))
+		: MIN_NODE_CAPACITY;
+	static const int MIN_LEAF_KEYS = LEAF_CAPACITY / 2;
+	static const int MIN_INNER_KEYS = INNER_CAPACITY / 2;
+
+/*
+ * Type definitions for the nodes in the tree.  Every node starts with
+ * a nodeT header, which says which kind of node it is.  The leaves are
+ * chained both ways, so they can be walked in either order.  An interior
+ * node with numKeys keys has numKeys + 1 children; every element in
+ * children[i] compares less than keys[i], and every element in
+ * children[i + 1] compares greater than or equal to it.  counts[i] is
+ * the number of elements in the leaves under children[i].
+ */
+	struct nodeT {
+		int numKeys;
+		bool isLeaf;
+	};
+
+	struct leafT : nodeT {
+		ElemType keys[LEAF_CAPACITY + 1];
+		leafT *next, *prev;
+	};
+
+	struct innerT : nodeT {
+		ElemType keys[INNER_CAPACITY + 1];
+		nodeT *children[INNER_CAPACITY + 2];
+		int counts[INNER_CAPACITY + 2];
+	};
+
+/*
+ * The path from the root to a leaf, recorded on the way down so that
+ * splits and merges can work their way back up without parent
+ * pointers.  childIndex is the child of node that the path goes
+ * through.
+ */
+	struct pathEntryT {
+		innerT *node;
+		int childIndex;
+	};
+
+/* Instance variables */
+	nodeT *root;
+	int numElems;
+	long timestamp;
+	Comparator cmpFn;
+
+/* Private method prototypes */
+	int searchNode(ElemType keys[], int numKeys, ElemType & key, bool & found);
+	int childIndex(innerT *np, ElemType & key);
+	leafT *findLeaf(ElemType & key, pathEntryT path[], int & depth);
+	leafT *leftmostLeaf();
+	leafT *rightmostLeaf();
+	void splitLeaf(leafT *lp, pathEntryT path[], int depth);
+	void insertIntoParent(pathEntryT path[], int depth, ElemType & separator,
+	                      nodeT *right);
+	void fixLeafUnderflow(leafT *lp, pathEntryT path[], int depth);
+	void fixInnerUnderflow(pathEntryT path[], int depth);
+	void removeFromInner(innerT *np, int keyIndex);
+	static int subtreeSize(nodeT *t);
+	void deleteTree(nodeT *t);
+	void buildLevelAbove(Vector<nodeT *> & nodes, Vector<ElemType> & firstKeys);
+	nodeT *cloneTree(nodeT *t, leafT * & lastLeaf);
+	void copyOtherEntries(const BTree & other);
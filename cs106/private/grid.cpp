@@ -14,43 +14,46 @@
  * ---------------------------
  * The Grid is internally managed as a dynamic array of elements.  The array
  * itself is one-dimensional, the logical separation into rows and columns
- * is done manually.  The layout is in row-major order, which is to say that
- * the first entire row is laid out contiguously, followed by the entire
- * next row and so on. All access is bounds-checked for safety.
+ * is done by the Layout, which says where in the array each row and
+ * column lives.  With the default RowMajorLayout, the first entire row is
+ * laid out contiguously, followed by the entire next row and so on.  All
+ * access is bounds-checked for safety, except through uncheckedAt and the
+ * map methods, which stay within the grid by construction.
  */
 
-template <typename ElemType>
-Grid<ElemType>::Grid() {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::Grid() {
 	nRows = 0;
 	nCols = 0;
+	layout.resize(0, 0);
 	timestamp = 0L;
 	elements = NULL;
 }
 
-template <typename ElemType>
-Grid<ElemType>::Grid(int numRows, int numCols) {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::Grid(int numRows, int numCols) {
 	elements = NULL;
 	timestamp = 0L;
 	resize(numRows, numCols);
 }
 
-template <typename ElemType>
-Grid<ElemType>::~Grid() {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::~Grid() {
 	delete[] elements;
 }
 
-template <typename ElemType>
-int Grid<ElemType>::numRows() {
+template <typename ElemType, typename Layout>
+int Grid<ElemType, Layout>::numRows() {
 	return nRows;
 }
 
-template <typename ElemType>
-int Grid<ElemType>::numCols() {
+template <typename ElemType, typename Layout>
+int Grid<ElemType, Layout>::numCols() {
 	return nCols;
 }
 
-template <typename ElemType>
-void Grid<ElemType>::resize(int numRows, int numCols) {
+template <typename ElemType, typename Layout>
+void Grid<ElemType, Layout>::resize(int numRows, int numCols) {
 	if (numRows < 0 || numCols < 0) {
 		Error("Attempt to resize grid to invalid size ("
 		      + IntegerToString(numRows) + ", "
@@ -59,38 +62,44 @@ void Grid<ElemType>::resize(int numRows, int numCols) {
 	if (elements) delete[] elements;
 	nRows = numRows;
 	nCols = numCols;
-	elements = new ElemType[nRows * nCols];
+	layout.resize(nRows, nCols);
+	elements = new ElemType[layout.storageSize()];
 	timestamp++;
 }
 
-template <typename ElemType>
-ElemType Grid<ElemType>::getAt(int row, int col) {
+template <typename ElemType, typename Layout>
+ElemType Grid<ElemType, Layout>::getAt(int row, int col) {
 	return (*this)(row, col);
 }
 
-template <typename ElemType>
-void Grid<ElemType>::setAt(int row, int col, ElemType value) {
+template <typename ElemType, typename Layout>
+void Grid<ElemType, Layout>::setAt(int row, int col, ElemType value) {
 	(*this)(row, col) = value;
 }
 
-template <typename ElemType>
-bool Grid<ElemType>::inBounds(int row, int col) {
+template <typename ElemType, typename Layout>
+bool Grid<ElemType, Layout>::inBounds(int row, int col) {
 	return row >= 0 && col >= 0 && row < nRows && col < nCols;
 }
 
-template <typename ElemType>
-ElemType &Grid<ElemType>::operator()(int row, int col) {
+template <typename ElemType, typename Layout>
+ElemType &Grid<ElemType, Layout>::operator()(int row, int col) {
 	checkRange(row,col);
-	return elements[(row * nCols) + col];
+	return elements[layout.index(row, col)];
 }
 
-template <typename ElemType>
-typename Grid<ElemType>::GridRow Grid<ElemType>::operator[](int row) {
+template <typename ElemType, typename Layout>
+ElemType & Grid<ElemType, Layout>::uncheckedAt(int row, int col) {
+	return elements[layout.index(row, col)];
+}
+
+template <typename ElemType, typename Layout>
+typename Grid<ElemType, Layout>::GridRow Grid<ElemType, Layout>::operator[](int row) {
 	return GridRow(this, row);
 }
 
-template <typename ElemType>
-const Grid<ElemType> & Grid<ElemType>::operator=(const Grid & rhs) {
+template <typename ElemType, typename Layout>
+const Grid<ElemType, Layout> & Grid<ElemType, Layout>::operator=(const Grid & rhs) {
 	if (this != &rhs) {
 		delete[] elements;
 		copyContentsFrom(rhs);
@@ -99,14 +108,14 @@ const Grid<ElemType> & Grid<ElemType>::operator=(const Grid & rhs) {
 	return *this;
 }
 
-template <typename ElemType>
-Grid<ElemType>::Grid(const Grid & rhs) {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::Grid(const Grid & rhs) {
 	copyContentsFrom(rhs);
 	timestamp = 0L;
 }
 
-template <typename ElemType>
-void Grid<ElemType>::checkRange(int row, int col) {
+template <typename ElemType, typename Layout>
+void Grid<ElemType, Layout>::checkRange(int row, int col) {
 	if (row < 0 || row >= numRows() || col < 0 || col >= numCols()) {
 		Error("Attempt to access location ("
 		      + IntegerToString(row) + ", " + IntegerToString(col)
@@ -115,37 +124,90 @@ void Grid<ElemType>::checkRange(int row, int col) {
 	}
 }
 
-template <typename ElemType>
-void Grid<ElemType>::copyContentsFrom(const Grid & other) {
+template <typename ElemType, typename Layout>
+void Grid<ElemType, Layout>::copyContentsFrom(const Grid & other) {
 	nRows = other.nRows;
 	nCols = other.nCols;
-	elements = new ElemType[nRows * nCols];
-	for (int i = 0; i < nRows * nCols; i++) {
+	layout = other.layout;
+	long size = layout.storageSize();
+	elements = new ElemType[size];
+	for (long i = 0; i < size; i++) {
 		elements[i] = other.elements[i];
 	}
 }
 
-template <typename ElemType>
-void Grid<ElemType>::mapAll(void (*fn)(ElemType)) {
+template <typename ElemType, typename Layout>
+void Grid<ElemType, Layout>::mapAll(void (*fn)(ElemType)) {
 	long t0 = timestamp;
-	for (int i = 0; i < nRows * nCols; i++) {
-		if (timestamp != t0) {
-			Error("Grid structure has been modified");
+	for (int row = 0; row < nRows; row++) {
+		for (int col = 0; col < nCols; col++) {
+			if (timestamp != t0) {
+				Error("Grid structure has been modified");
+			}
+			fn(elements[layout.index(row, col)]);
 		}
-		fn(elements[i]);
 	}
 }
 
-template <typename ElemType>
+template <typename ElemType, typename Layout>
 template <typename ClientDataType>
-void Grid<ElemType>::mapAll(void (*fn)(ElemType, ClientDataType&),
+void Grid<ElemType, Layout>::mapAll(void (*fn)(ElemType, ClientDataType&),
                             ClientDataType & data) {
 	long t0 = timestamp;
-	for (int i = 0; i < nRows * nCols; i++) {
-		if (timestamp != t0) {
-			Error("Grid structure has been modified");
+	for (int row = 0; row < nRows; row++) {
+		for (int col = 0; col < nCols; col++) {
+			if (timestamp != t0) {
+				Error("Grid structure has been modified");
+			}
+			fn(elements[layout.index(row, col)], data);
+		}
+	}
+}
+
+/*
+ * Implementation notes: mapRow, mapTiles
+ * --------------------------------------
+ * These compute each cell's index straight from the layout, with no
+ * bounds checks and no timestamp checks, so that they cost no more per
+ * cell than a hand-written loop over the array.  mapTiles walks the
+ * grid a block of Layout::TILE_ROWS by Layout::TILE_COLS at a time,
+ * clipping the blocks at the right and bottom edges, and steps along
+ * each row of a block with a pointer when the layout stores it in one
+ * piece.
+ */
+
+template <typename ElemType, typename Layout>
+template <typename FnType>
+void Grid<ElemType, Layout>::mapRow(int row, FnType fn) {
+	if (row < 0 || row >= nRows) {
+		Error("Attempt to map row " + IntegerToString(row)
+		      + " in a grid with " + IntegerToString(nRows) + " rows");
+	}
+	for (int col = 0; col < nCols; col++) {
+		fn(col, elements[layout.index(row, col)]);
+	}
+}
+
+template <typename ElemType, typename Layout>
+template <typename FnType>
+void Grid<ElemType, Layout>::mapTiles(FnType fn) {
+	for (int row0 = 0; row0 < nRows; row0 += Layout::TILE_ROWS) {
+		int rowEnd = (nRows - row0 > Layout::TILE_ROWS) ? row0 + Layout::TILE_ROWS : nRows;
+		for (int col0 = 0; col0 < nCols; col0 += Layout::TILE_COLS) {
+			int colEnd = (nCols - col0 > Layout::TILE_COLS) ? col0 + Layout::TILE_COLS : nCols;
+			for (int row = row0; row < rowEnd; row++) {
+				if constexpr (Layout::CONTIGUOUS_TILE_ROWS) {
+					ElemType *cells = elements + layout.index(row, col0) - col0;
+					for (int col = col0; col < colEnd; col++) {
+						fn(row, col, cells[col]);
+					}
+				} else {
+					for (int col = col0; col < colEnd; col++) {
+						fn(row, col, elements[layout.index(row, col)]);
+					}
+				}
+			}
 		}
-		fn(elements[i], data);
 	}
 }
 
@@ -156,26 +218,26 @@ void Grid<ElemType>::mapAll(void (*fn)(ElemType, ClientDataType&),
  * an index into that vector that identifies the next element to return.
  */
 
-template <typename ElemType>
-Grid<ElemType>::Iterator::Iterator() {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::Iterator::Iterator() {
 	gp = NULL;
 }
 
-template <typename ElemType>
-typename Grid<ElemType>::Iterator Grid<ElemType>::iterator() {
+template <typename ElemType, typename Layout>
+typename Grid<ElemType, Layout>::Iterator Grid<ElemType, Layout>::iterator() {
 	return Iterator(this);
 }
 
-template <typename ElemType>
-Grid<ElemType>::Iterator::Iterator(Grid *gridRef) {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::Iterator::Iterator(Grid *gridRef) {
 	gp = gridRef;
 	curRow = 0;
 	curCol = 0;
 	timestamp = gp->timestamp;
 }
 
-template <typename ElemType>
-bool Grid<ElemType>::Iterator::hasNext() {
+template <typename ElemType, typename Layout>
+bool Grid<ElemType, Layout>::Iterator::hasNext() {
 	if (gp == NULL) Error("hasNext called on uninitialized iterator");
 	if (timestamp != gp->timestamp) {
 		Error("Grid structure has been modified");
@@ -183,8 +245,8 @@ bool Grid<ElemType>::Iterator::hasNext() {
 	return curRow < gp->numRows() && curCol < gp->numCols();
 }
 
-template <typename ElemType>
-ElemType Grid<ElemType>::Iterator::next() {
+template <typename ElemType, typename Layout>
+ElemType Grid<ElemType, Layout>::Iterator::next() {
 	if (gp == NULL) Error("next called on uninitialized iterator");
 	if (!hasNext()) {
 		Error("Attempt to get next from iterator"
@@ -199,33 +261,75 @@ ElemType Grid<ElemType>::Iterator::next() {
 	return (*gp)(row, col);
 }
 
-template <typename ElemType>
-ElemType Grid<ElemType>::foreachHook(FE_State & fe) {
-	if (fe.state == 0) fe.iter = new Iterator(this);
-	if (((Iterator *) fe.iter)->hasNext()) {
-		fe.state = 1;
-		return ((Iterator *) fe.iter)->next();
+/*
+ * Grid::RangeIterator class implementation
+ * ----------------------------------------
+ * The end iterator starts past the last row, or at the first row of a
+ * grid with no columns, so that an empty grid's begin and end agree.
+ */
+
+template <typename ElemType, typename Layout>
+typename Grid<ElemType, Layout>::RangeIterator Grid<ElemType, Layout>::begin() {
+	return RangeIterator(this, 0);
+}
+
+template <typename ElemType, typename Layout>
+typename Grid<ElemType, Layout>::RangeIterator Grid<ElemType, Layout>::end() {
+	return RangeIterator(this, (nCols == 0) ? 0 : nRows);
+}
+
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::RangeIterator::RangeIterator(Grid *gridRef, int startRow) {
+	gp = gridRef;
+	row = startRow;
+	col = 0;
+	cell = (gp->elements == NULL) ? NULL : gp->elements + long(startRow) * gp->nCols;
+}
+
+template <typename ElemType, typename Layout>
+ElemType & Grid<ElemType, Layout>::RangeIterator::operator*() {
+	if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+		return *cell;
+	} else {
+		return gp->uncheckedAt(row, col);
+	}
+}
+
+template <typename ElemType, typename Layout>
+typename Grid<ElemType, Layout>::RangeIterator & Grid<ElemType, Layout>::RangeIterator::operator++() {
+	if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+		cell++;
+	} else if (++col == gp->nCols) {
+		col = 0;
+		row++;
+	}
+	return *this;
+}
+
+template <typename ElemType, typename Layout>
+bool Grid<ElemType, Layout>::RangeIterator::operator!=(const RangeIterator & other) {
+	if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+		return cell != other.cell;
 	} else {
-		fe.state = 2;
-		return ElemType();
+		return row != other.row || col != other.col;
 	}
 }
 
 /* GridRow implementation */
 
-template <typename ElemType>
-Grid<ElemType>::GridRow::GridRow() {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::GridRow::GridRow() {
 	/* Empty */
 }
 
-template <typename ElemType>
-Grid<ElemType>::GridRow::GridRow(Grid *gridRef, int index) {
+template <typename ElemType, typename Layout>
+Grid<ElemType, Layout>::GridRow::GridRow(Grid *gridRef, int index) {
 	gp = gridRef;
 	row = index;
 }
 
-template <typename ElemType>
-ElemType & Grid<ElemType>::GridRow::operator[](int col) {
+template <typename ElemType, typename Layout>
+ElemType & Grid<ElemType, Layout>::GridRow::operator[](int col) {
 	return (*gp)(row,col);
 }
 
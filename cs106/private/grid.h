@@ -45,7 +45,7 @@ public:
  * This interface defines a nested class within the Grid template that
  * provides iterator access to the Grid contents.
  */
-	class Iterator : public FE_Iterator {
+	class Iterator {
 	public:
 		Iterator();
 		bool hasNext();
@@ -60,7 +60,29 @@ public:
 		friend class Grid;
 	};
 	friend class Iterator;
-	ElemType foreachHook(FE_State & _fe);
+
+/*
+ * Class: Grid<ElemType>::RangeIterator
+ * ------------------------------------
+ * The iterator returned by begin and end, which has just what the
+ * range-based for loop needs.  With the default RowMajorLayout the
+ * elements are contiguous and it steps a pointer through them; with
+ * any other layout it steps through the rows and columns and asks the
+ * layout where each element is.
+ */
+	class RangeIterator {
+	public:
+		ElemType & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(Grid *gridRef, int startRow);
+		Grid *gp;
+		ElemType *cell;
+		int row, col;
+		friend class Grid;
+	};
 
 /*
  * Deep copying support
@@ -82,6 +104,7 @@ private:
 
 	ElemType *elements;
 	int nRows, nCols;
+	Layout layout;
 	long timestamp;
 
 	void checkRange(int row, int col);
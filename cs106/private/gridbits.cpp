@@ -0,0 +1,508 @@
+/*
+ * File: private/gridbits.cpp
+ * --------------------------
+ * This file contains the implementation of the Grid<bool> class in the
+ * grid.h interface.  Because of the way C++ compiles templates, this
+ * code must be available to the compiler when it reads the header file.
+ */
+
+#ifdef _grid_h
+
+/*
+ * Grid<bool> class implementation
+ * -------------------------------
+ * The methods that work on the whole grid or on a whole row loop over
+ * words rather than cells, relying on the bits past the last column of
+ * each row being zero.  The methods that can leave ones there, setAll
+ * and flipAll, clear them again with lastWordMask.
+ */
+
+template <typename Layout>
+Grid<bool, Layout>::Grid() {
+	nRows = 0;
+	nCols = 0;
+	wordsPerRow = 0;
+	timestamp = 0L;
+	words = NULL;
+}
+
+template <typename Layout>
+Grid<bool, Layout>::Grid(int numRows, int numCols) {
+	words = NULL;
+	timestamp = 0L;
+	resize(numRows, numCols);
+}
+
+template <typename Layout>
+Grid<bool, Layout>::~Grid() {
+	delete[] words;
+}
+
+template <typename Layout>
+int Grid<bool, Layout>::numRows() {
+	return nRows;
+}
+
+template <typename Layout>
+int Grid<bool, Layout>::numCols() {
+	return nCols;
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::resize(int numRows, int numCols) {
+	if (numRows < 0 || numCols < 0) {
+		Error("Attempt to resize grid to invalid size ("
+		      + IntegerToString(numRows) + ", "
+		      + IntegerToString(numCols) + ")");
+	}
+	if (words) delete[] words;
+	nRows = numRows;
+	nCols = numCols;
+	wordsPerRow = (numCols + WORD_BITS - 1) / WORD_BITS;
+	words = new unsigned long[numWords()]();
+	timestamp++;
+}
+
+template <typename Layout>
+bool Grid<bool, Layout>::getAt(int row, int col) {
+	return (*this)(row, col);
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::setAt(int row, int col, bool value) {
+	(*this)(row, col) = value;
+}
+
+template <typename Layout>
+bool Grid<bool, Layout>::inBounds(int row, int col) {
+	return row >= 0 && col >= 0 && row < nRows && col < nCols;
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::CellRef Grid<bool, Layout>::operator()(int row, int col) {
+	checkRange(row, col);
+	return uncheckedAt(row, col);
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::CellRef Grid<bool, Layout>::uncheckedAt(int row, int col) {
+	return CellRef(rowWords(row) + col / WORD_BITS, 1UL << (col % WORD_BITS));
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::GridRow Grid<bool, Layout>::operator[](int row) {
+	return GridRow(this, row);
+}
+
+template <typename Layout>
+const Grid<bool, Layout> & Grid<bool, Layout>::operator=(const Grid & rhs) {
+	if (this != &rhs) {
+		delete[] words;
+		copyContentsFrom(rhs);
+		timestamp = 0L;
+	}
+	return *this;
+}
+
+template <typename Layout>
+Grid<bool, Layout>::Grid(const Grid & rhs) {
+	copyContentsFrom(rhs);
+	timestamp = 0L;
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::mapAll(void (*fn)(bool)) {
+	long t0 = timestamp;
+	for (int row = 0; row < nRows; row++) {
+		for (int col = 0; col < nCols; col++) {
+			if (timestamp != t0) {
+				Error("Grid structure has been modified");
+			}
+			fn(uncheckedAt(row, col));
+		}
+	}
+}
+
+template <typename Layout>
+template <typename ClientDataType>
+void Grid<bool, Layout>::mapAll(void (*fn)(bool, ClientDataType &),
+                                ClientDataType & data) {
+	long t0 = timestamp;
+	for (int row = 0; row < nRows; row++) {
+		for (int col = 0; col < nCols; col++) {
+			if (timestamp != t0) {
+				Error("Grid structure has been modified");
+			}
+			fn(uncheckedAt(row, col), data);
+		}
+	}
+}
+
+template <typename Layout>
+template <typename FnType>
+void Grid<bool, Layout>::mapRow(int row, FnType fn) {
+	if (row < 0 || row >= nRows) {
+		Error("Attempt to map row " + IntegerToString(row)
+		      + " in a grid with " + IntegerToString(nRows) + " rows");
+	}
+	for (int col = 0; col < nCols; col++) {
+		fn(col, uncheckedAt(row, col));
+	}
+}
+
+template <typename Layout>
+template <typename FnType>
+void Grid<bool, Layout>::mapTiles(FnType fn) {
+	for (int row = 0; row < nRows; row++) {
+		for (int col = 0; col < nCols; col++) {
+			fn(row, col, uncheckedAt(row, col));
+		}
+	}
+}
+
+template <typename Layout>
+int Grid<bool, Layout>::count() {
+	long total = 0;
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		total += CountBits(words[i]);
+	}
+	return int(total);
+}
+
+template <typename Layout>
+int Grid<bool, Layout>::countInRow(int row) {
+	if (row < 0 || row >= nRows) {
+		Error("Attempt to count row " + IntegerToString(row)
+		      + " in a grid with " + IntegerToString(nRows) + " rows");
+	}
+	unsigned long *rowStart = rowWords(row);
+	int total = 0;
+	for (int i = 0; i < wordsPerRow; i++) {
+		total += CountBits(rowStart[i]);
+	}
+	return total;
+}
+
+template <typename Layout>
+int Grid<bool, Layout>::nextInRow(int row, int col) {
+	if (row < 0 || row >= nRows || col < 0 || col > nCols) {
+		Error("Attempt to search from location ("
+		      + IntegerToString(row) + ", " + IntegerToString(col)
+		      + ") in a grid of size (" + IntegerToString(nRows)
+		      + ", " + IntegerToString(nCols) + ")");
+	}
+	if (col == nCols) return -1;
+	unsigned long *rowStart = rowWords(row);
+	int i = col / WORD_BITS;
+	unsigned long word = rowStart[i] & (~0UL << (col % WORD_BITS));
+	while (word == 0) {
+		if (++i == wordsPerRow) return -1;
+		word = rowStart[i];
+	}
+	return i * WORD_BITS + LowestBit(word);
+}
+
+template <typename Layout>
+template <typename FnType>
+void Grid<bool, Layout>::mapTrue(FnType fn) {
+	for (int row = 0; row < nRows; row++) {
+		unsigned long *rowStart = rowWords(row);
+		for (int i = 0; i < wordsPerRow; i++) {
+			unsigned long word = rowStart[i];
+			while (word != 0) {
+				fn(row, i * WORD_BITS + LowestBit(word));
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::setAll(bool value) {
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		words[i] = value ? ~0UL : 0UL;
+	}
+	if (value && wordsPerRow > 0) {
+		for (int row = 0; row < nRows; row++) {
+			rowWords(row)[wordsPerRow - 1] &= lastWordMask();
+		}
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::flipAll() {
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		words[i] = ~words[i];
+	}
+	if (wordsPerRow > 0) {
+		for (int row = 0; row < nRows; row++) {
+			rowWords(row)[wordsPerRow - 1] &= lastWordMask();
+		}
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::unionWith(Grid & other) {
+	checkSameSize(other, "unionWith");
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		words[i] |= other.words[i];
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::intersectWith(Grid & other) {
+	checkSameSize(other, "intersectWith");
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		words[i] &= other.words[i];
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::subtract(Grid & other) {
+	checkSameSize(other, "subtract");
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		words[i] &= ~other.words[i];
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::flipWith(Grid & other) {
+	checkSameSize(other, "flipWith");
+	long n = numWords();
+	for (long i = 0; i < n; i++) {
+		words[i] ^= other.words[i];
+	}
+}
+
+template <typename Layout>
+long Grid<bool, Layout>::numWords() {
+	return long(nRows) * wordsPerRow;
+}
+
+template <typename Layout>
+unsigned long *Grid<bool, Layout>::rowWords(int row) {
+	return words + long(row) * wordsPerRow;
+}
+
+template <typename Layout>
+unsigned long Grid<bool, Layout>::lastWordMask() {
+	int used = nCols % WORD_BITS;
+	return (used == 0) ? ~0UL : (1UL << used) - 1;
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::checkRange(int row, int col) {
+	if (row < 0 || row >= numRows() || col < 0 || col >= numCols()) {
+		Error("Attempt to access location ("
+		      + IntegerToString(row) + ", " + IntegerToString(col)
+		      + ") in a grid of size (" + IntegerToString(numRows())
+		      + ", " + IntegerToString(numCols()) + ")");
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::checkSameSize(Grid & other, string methodName) {
+	if (other.nRows != nRows || other.nCols != nCols) {
+		Error(methodName + ": grid of size (" + IntegerToString(other.nRows)
+		      + ", " + IntegerToString(other.nCols) + ") does not match ("
+		      + IntegerToString(nRows) + ", " + IntegerToString(nCols) + ")");
+	}
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::copyContentsFrom(const Grid & other) {
+	nRows = other.nRows;
+	nCols = other.nCols;
+	wordsPerRow = other.wordsPerRow;
+	long n = long(nRows) * wordsPerRow;
+	words = new unsigned long[n];
+	for (long i = 0; i < n; i++) {
+		words[i] = other.words[i];
+	}
+}
+
+/*
+ * Implementation notes: CountBits, LowestBit
+ * ------------------------------------------
+ * GCC and Clang provide these as builtins, which become single
+ * instructions on processors that have them.  The fallbacks clear one
+ * set bit per step, or shift until the lowest one is found.
+ */
+
+template <typename Layout>
+int Grid<bool, Layout>::CountBits(unsigned long word) {
+#if defined(__GNUC__)
+	return __builtin_popcountl(word);
+#else
+	int count = 0;
+	for (; word != 0; word &= word - 1) {
+		count++;
+	}
+	return count;
+#endif
+}
+
+template <typename Layout>
+int Grid<bool, Layout>::LowestBit(unsigned long word) {
+#if defined(__GNUC__)
+	return __builtin_ctzl(word);
+#else
+	int bit = 0;
+	for (; (word & 1) == 0; word >>= 1) {
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+/*
+ * Grid<bool>::CellRef class implementation
+ * ----------------------------------------
+ */
+
+template <typename Layout>
+Grid<bool, Layout>::CellRef::CellRef(unsigned long *wordPtr, unsigned long bitMask) {
+	word = wordPtr;
+	mask = bitMask;
+}
+
+template <typename Layout>
+Grid<bool, Layout>::CellRef::operator bool() const {
+	return (*word & mask) != 0;
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::CellRef & Grid<bool, Layout>::CellRef::operator=(bool value) {
+	if (value) {
+		*word |= mask;
+	} else {
+		*word &= ~mask;
+	}
+	return *this;
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::CellRef &
+Grid<bool, Layout>::CellRef::operator=(const CellRef & other) {
+	return *this = bool(other);
+}
+
+template <typename Layout>
+void Grid<bool, Layout>::CellRef::flip() {
+	*word ^= mask;
+}
+
+/*
+ * Grid<bool>::Iterator class implementation
+ * -----------------------------------------
+ */
+
+template <typename Layout>
+Grid<bool, Layout>::Iterator::Iterator() {
+	gp = NULL;
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::Iterator Grid<bool, Layout>::iterator() {
+	return Iterator(this);
+}
+
+template <typename Layout>
+Grid<bool, Layout>::Iterator::Iterator(Grid *gridRef) {
+	gp = gridRef;
+	curRow = 0;
+	curCol = 0;
+	timestamp = gp->timestamp;
+}
+
+template <typename Layout>
+bool Grid<bool, Layout>::Iterator::hasNext() {
+	if (gp == NULL) Error("hasNext called on uninitialized iterator");
+	if (timestamp != gp->timestamp) {
+		Error("Grid structure has been modified");
+	}
+	return curRow < gp->numRows() && curCol < gp->numCols();
+}
+
+template <typename Layout>
+bool Grid<bool, Layout>::Iterator::next() {
+	if (gp == NULL) Error("next called on uninitialized iterator");
+	if (!hasNext()) {
+		Error("Attempt to get next from iterator"
+		      " where hasNext() is false");
+	}
+	int row = curRow;
+	int col = curCol++;
+	if (curCol == gp->numCols()) {
+		curCol = 0;
+		curRow++;
+	}
+	return (*gp)(row, col);
+}
+
+/*
+ * Grid<bool>::RangeIterator class implementation
+ * ----------------------------------------------
+ */
+
+template <typename Layout>
+typename Grid<bool, Layout>::RangeIterator Grid<bool, Layout>::begin() {
+	return RangeIterator(this, 0);
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::RangeIterator Grid<bool, Layout>::end() {
+	return RangeIterator(this, (nCols == 0) ? 0 : nRows);
+}
+
+template <typename Layout>
+Grid<bool, Layout>::RangeIterator::RangeIterator(Grid *gridRef, int startRow) {
+	gp = gridRef;
+	row = startRow;
+	col = 0;
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::CellRef Grid<bool, Layout>::RangeIterator::operator*() {
+	return gp->uncheckedAt(row, col);
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::RangeIterator & Grid<bool, Layout>::RangeIterator::operator++() {
+	if (++col == gp->nCols) {
+		col = 0;
+		row++;
+	}
+	return *this;
+}
+
+template <typename Layout>
+bool Grid<bool, Layout>::RangeIterator::operator!=(const RangeIterator & other) {
+	return row != other.row || col != other.col;
+}
+
+/* GridRow implementation */
+
+template <typename Layout>
+Grid<bool, Layout>::GridRow::GridRow() {
+	/* Empty */
+}
+
+template <typename Layout>
+Grid<bool, Layout>::GridRow::GridRow(Grid *gridRef, int index) {
+	gp = gridRef;
+	row = index;
+}
+
+template <typename Layout>
+typename Grid<bool, Layout>::CellRef Grid<bool, Layout>::GridRow::operator[](int col) {
+	return (*gp)(row, col);
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * File: private/gridbits.h
+ * ------------------------
+ * This file contains the private section of the Grid<bool> class in
+ * the grid.h interface.
+ */
+
+public:
+
+/*
+ * Legacy method: operator()
+ * Usage: grid(0, 0) = grid(1, 1);
+ * -------------------------------
+ * This method overloads () to access elements from this grid.
+ * It has been superseded by the [] operator and is not used in
+ * new code.
+ */
+	CellRef operator()(int row, int col);
+
+/*
+ * Class: Grid<bool>::CellRef
+ * --------------------------
+ * A CellRef names one bit of the grid: the word it lives in and a mask
+ * with just that bit set.  Assigning one CellRef to another copies the
+ * value of the cell, as assigning one bool & to another would.
+ */
+	class CellRef {
+	public:
+		operator bool() const;
+		CellRef & operator=(bool value);
+		CellRef & operator=(const CellRef & other);
+		void flip();
+
+	private:
+		CellRef(unsigned long *wordPtr, unsigned long bitMask);
+		unsigned long *word;
+		unsigned long mask;
+		friend class Grid;
+	};
+
+/*
+ * Class: Grid<bool>::GridRow
+ * --------------------------
+ * This class makes it possible to use traditional subscripting on
+ * Grid<bool> values.
+ */
+	class GridRow {
+	public:
+		GridRow();
+		CellRef operator[](int col);
+
+	private:
+		GridRow(Grid *gridRef, int index);
+		Grid *gp;
+		int row;
+		friend class Grid;
+	};
+	friend class GridRow;
+
+/*
+ * Class: Grid<bool>::Iterator
+ * ---------------------------
+ * This class provides iterator access to the Grid contents.
+ */
+	class Iterator {
+	public:
+		Iterator();
+		bool hasNext();
+		bool next();
+
+	private:
+		Iterator(Grid *gridRef);
+		Grid *gp;
+		int curRow;
+		int curCol;
+		long timestamp;
+		friend class Grid;
+	};
+	friend class Iterator;
+
+/*
+ * Class: Grid<bool>::RangeIterator
+ * --------------------------------
+ * The iterator returned by begin and end, which steps through the rows
+ * and columns and gives out a CellRef for each cell.
+ */
+	class RangeIterator {
+	public:
+		CellRef operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(Grid *gridRef, int startRow);
+		Grid *gp;
+		int row, col;
+		friend class Grid;
+	};
+
+/*
+ * Deep copying support
+ * --------------------
+ * As for every other grid, the copy constructor and operator= copy the
+ * entire contents of the grid, here a word of cells at a time.
+ */
+	const Grid & operator=(const Grid & rhs);
+	Grid(const Grid & rhs);
+
+private:
+
+/*
+ * The cells are kept in an array of words, WORD_BITS cells to a word,
+ * with each row starting a new word: cell (row, col) is bit
+ * col % WORD_BITS of word row * wordsPerRow + col / WORD_BITS.  The
+ * bits past the last column of each row are always zero, so that the
+ * counting and combining methods can work on whole words without
+ * looking at the size of the grid.
+ */
+	static const int WORD_BITS = 8 * sizeof(unsigned long);
+
+	unsigned long *words;
+	int nRows, nCols;
+	int wordsPerRow;
+	long timestamp;
+
+	long numWords();
+	unsigned long *rowWords(int row);
+	unsigned long lastWordMask();
+	void checkRange(int row, int col);
+	void checkSameSize(Grid & other, string methodName);
+	void copyContentsFrom(const Grid & other);
+
+	static int CountBits(unsigned long word);
+	static int LowestBit(unsigned long word);
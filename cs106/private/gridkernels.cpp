@@ -0,0 +1,464 @@
+/*
+ * File: private/gridkernels.cpp
+ * -----------------------------
+ * This file contains the implementation of the gridkernels.h interface.
+ * Because of the way C++ compiles templates, this code must be
+ * available to the compiler when it reads the header file.
+ */
+
+#ifdef _gridkernels_h
+
+/*
+ * Class: GridKernelOps
+ * --------------------
+ * The pieces from which the bulk operations are built, gathered into a
+ * class so that their names stay out of the client's way.  The row
+ * functions work on one contiguous row of a row-major grid.  When the
+ * compiler offers GCC's vector extensions and ElemType is a built-in
+ * number type, they work on vecT values of VECTOR_BYTES at a time (4
+ * floats or 16 chars in a 16-byte vector), which the compiler turns into
+ * the target's vector instructions: 16 bytes is what every x86-64 and
+ * ARM processor has, and 32 is used when compiling for AVX.  Otherwise
+ * they fall back to plain loops that compute the same values.
+ */
+
+template <typename ElemType>
+struct GridKernelOps {
+
+	typedef typename GridSumType<ElemType>::type sumT;
+
+/*
+ * The grid is cut into bands of about BAND_CELLS cells, which is the
+ * unit of work handed to a pool and the unit in which sums are added
+ * up.  The bands depend only on the size of the grid.
+ */
+	static const int BAND_CELLS = 1 << 16;
+
+#if defined(__GNUC__)
+	static const bool SIMD = std::is_arithmetic<ElemType>::value
+	                         && !std::is_same<ElemType, bool>::value
+	                         && !std::is_same<ElemType, long double>::value;
+
+#if defined(__AVX__)
+	static const int VECTOR_BYTES = 32;
+#else
+	static const int VECTOR_BYTES = 16;
+#endif
+
+	typedef typename std::conditional<SIMD, ElemType, float>::type laneT;
+	typedef laneT vecT __attribute__((vector_size(VECTOR_BYTES)));
+	typedef laneT quadT __attribute__((vector_size(4 * sizeof(laneT))));
+	typedef long longQuadT __attribute__((vector_size(4 * sizeof(long))));
+	static const int LANES = VECTOR_BYTES / sizeof(laneT);
+
+	static vecT Load(const ElemType *p) {
+		vecT v;
+		std::memcpy(&v, p, sizeof v);
+		return v;
+	}
+
+	static void Store(ElemType *p, vecT v) {
+		std::memcpy(p, &v, sizeof v);
+	}
+#else
+	static const bool SIMD = false;
+#endif
+
+	static int BandRows(int numCols) {
+		int rows = BAND_CELLS / ((numCols > 0) ? numCols : 1);
+		return (rows > 0) ? rows : 1;
+	}
+
+	static int NumBands(int numRows, int numCols) {
+		int bandRows = BandRows(numCols);
+		return (numRows + bandRows - 1) / bandRows;
+	}
+
+/*
+ * Calls fn(band, firstRow, endRow) for each band of rows, on pool if
+ * there is one.
+ */
+	template <typename BandFn>
+	static void ForBands(int numRows, int numCols, ThreadPool *pool, BandFn fn) {
+		int bandRows = BandRows(numCols);
+		int numBands = NumBands(numRows, numCols);
+		auto runBand = [&](int band) {
+			int first = band * bandRows;
+			int end = (numRows - first > bandRows) ? first + bandRows : numRows;
+			fn(band, first, end);
+		};
+		if (pool != NULL && numBands > 1) {
+			pool->parallelFor(0, numBands, runBand, 1);
+		} else {
+			for (int band = 0; band < numBands; band++) {
+				runBand(band);
+			}
+		}
+	}
+
+	static sumT RowSum(const ElemType *p, int n) {
+		sumT sum = sumT();
+		int i = 0;
+#if defined(__GNUC__)
+		if constexpr (SIMD && std::is_floating_point<ElemType>::value) {
+			vecT acc0 = {}, acc1 = {};
+			for (; i + 2 * LANES <= n; i += 2 * LANES) {
+				acc0 += Load(p + i);
+				acc1 += Load(p + i + LANES);
+			}
+			acc0 += acc1;
+			for (int k = 0; k < LANES; k++) {
+				sum += acc0[k];
+			}
+		} else if constexpr (SIMD) {
+			longQuadT acc0 = {}, acc1 = {};
+			for (; i + 8 <= n; i += 8) {
+				quadT a, b;
+				std::memcpy(&a, p + i, sizeof a);
+				std::memcpy(&b, p + i + 4, sizeof b);
+				acc0 += __builtin_convertvector(a, longQuadT);
+				acc1 += __builtin_convertvector(b, longQuadT);
+			}
+			acc0 += acc1;
+			for (int k = 0; k < 4; k++) {
+				sum += acc0[k];
+			}
+		}
+#endif
+		for (; i < n; i++) {
+			sum += p[i];
+		}
+		return sum;
+	}
+
+/*
+ * RowMin and RowMax need n >= 1.  They keep a vector of the best value
+ * seen in each lane and combine the lanes at the end.
+ */
+	static ElemType RowMin(const ElemType *p, int n) {
+		ElemType best = p[0];
+		int i = 1;
+#if defined(__GNUC__)
+		if constexpr (SIMD) {
+			if (n >= LANES) {
+				vecT m = Load(p);
+				for (i = LANES; i + LANES <= n; i += LANES) {
+					vecT v = Load(p + i);
+					m = (v < m) ? v : m;
+				}
+				best = m[0];
+				for (int k = 1; k < LANES; k++) {
+					if (m[k] < best) best = m[k];
+				}
+			}
+		}
+#endif
+		for (; i < n; i++) {
+			if (p[i] < best) best = p[i];
+		}
+		return best;
+	}
+
+	static ElemType RowMax(const ElemType *p, int n) {
+		ElemType best = p[0];
+		int i = 1;
+#if defined(__GNUC__)
+		if constexpr (SIMD) {
+			if (n >= LANES) {
+				vecT m = Load(p);
+				for (i = LANES; i + LANES <= n; i += LANES) {
+					vecT v = Load(p + i);
+					m = (m < v) ? v : m;
+				}
+				best = m[0];
+				for (int k = 1; k < LANES; k++) {
+					if (best < m[k]) best = m[k];
+				}
+			}
+		}
+#endif
+		for (; i < n; i++) {
+			if (best < p[i]) best = p[i];
+		}
+		return best;
+	}
+
+/*
+ * Computes the convolution for columns cLo up to cHi of one row, where
+ * rows[k] points to the row of src k rows above the bottom of the
+ * kernel's reach and every column the kernel touches is inside the
+ * grid.  FIXED_RR and FIXED_RC are the kernel's radii when known at
+ * compile time, which lets the compiler unroll the taps, or -1 to use
+ * rr and rc.  Every cell is summed tap by tap in the same order, with
+ * or without vectors, so both give the same result.
+ */
+	template <int FIXED_RR, int FIXED_RC>
+	static void ConvolveRow(const ElemType *const *rows, const ElemType *weights,
+	                        ElemType *dst, int cLo, int cHi, int rr, int rc) {
+		const int RR = (FIXED_RR >= 0) ? FIXED_RR : rr;
+		const int RC = (FIXED_RC >= 0) ? FIXED_RC : rc;
+		const int SIDE = 2 * RC + 1;
+		int c = cLo;
+#if defined(__GNUC__)
+		if constexpr (SIMD) {
+			for (; c + LANES <= cHi; c += LANES) {
+				vecT acc = {};
+				for (int k = 0; k <= 2 * RR; k++) {
+					for (int j = 0; j < SIDE; j++) {
+						acc += Load(rows[k] + c + j - RC) * weights[k * SIDE + j];
+					}
+				}
+				Store(dst + c, acc);
+			}
+		}
+#endif
+		for (; c < cHi; c++) {
+			ElemType acc = ElemType();
+			for (int k = 0; k <= 2 * RR; k++) {
+				for (int j = 0; j < SIDE; j++) {
+					acc += rows[k][c + j - RC] * weights[k * SIDE + j];
+				}
+			}
+			dst[c] = acc;
+		}
+	}
+
+/*
+ * Computes the convolution at one location near the edge, where the
+ * kernel reaches outside the grid and the coordinates must be clamped.
+ */
+	template <typename Layout>
+	static ElemType ConvolveAt(Grid<ElemType, Layout> & src, const ElemType *weights,
+	                           int rr, int rc, int row, int col) {
+		int numRows = src.numRows();
+		int numCols = src.numCols();
+		ElemType acc = ElemType();
+		for (int k = 0; k <= 2 * rr; k++) {
+			int r = row + k - rr;
+			r = (r < 0) ? 0 : (r >= numRows) ? numRows - 1 : r;
+			for (int j = 0; j <= 2 * rc; j++) {
+				int c = col + j - rc;
+				c = (c < 0) ? 0 : (c >= numCols) ? numCols - 1 : c;
+				acc += src.uncheckedAt(r, c) * weights[k * (2 * rc + 1) + j];
+			}
+		}
+		return acc;
+	}
+};
+
+template <typename ElemType, typename Layout>
+void GridFill(Grid<ElemType, Layout> & grid, typename std::remove_cv<ElemType>::type value,
+              ThreadPool *pool) {
+	int numCols = grid.numCols();
+	if (numCols == 0) return;
+	GridKernelOps<ElemType>::ForBands(grid.numRows(), numCols, pool,
+	                                  [&](int, int first, int end) {
+		for (int row = first; row < end; row++) {
+			if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+				std::fill_n(&grid.uncheckedAt(row, 0), numCols, value);
+			} else {
+				for (int col = 0; col < numCols; col++) {
+					grid.uncheckedAt(row, col) = value;
+				}
+			}
+		}
+	});
+}
+
+template <typename ElemType, typename Layout, typename FnType>
+void GridTransform(Grid<ElemType, Layout> & src, Grid<ElemType, Layout> & dst,
+                   FnType fn, ThreadPool *pool) {
+	int numRows = src.numRows();
+	int numCols = src.numCols();
+	if (dst.numRows() != numRows || dst.numCols() != numCols) dst.resize(numRows, numCols);
+	if (numCols == 0) return;
+	GridKernelOps<ElemType>::ForBands(numRows, numCols, pool,
+	                                  [&](int, int first, int end) {
+		for (int row = first; row < end; row++) {
+			if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+				const ElemType *s = &src.uncheckedAt(row, 0);
+				ElemType *d = &dst.uncheckedAt(row, 0);
+				for (int col = 0; col < numCols; col++) {
+					d[col] = fn(s[col]);
+				}
+			} else {
+				for (int col = 0; col < numCols; col++) {
+					dst.uncheckedAt(row, col) = fn(src.uncheckedAt(row, col));
+				}
+			}
+		}
+	});
+}
+
+/*
+ * Implementation notes: GridSum, GridMin, GridMax
+ * -----------------------------------------------
+ * Each band is reduced on its own into its slot of partials, and the
+ * slots are combined in band order once all the bands are done.
+ */
+
+template <typename ElemType, typename Layout>
+typename GridSumType<ElemType>::type GridSum(Grid<ElemType, Layout> & grid,
+                                             ThreadPool *pool) {
+	typedef GridKernelOps<ElemType> opsT;
+	typedef typename opsT::sumT sumT;
+	int numRows = grid.numRows();
+	int numCols = grid.numCols();
+	if (numRows == 0 || numCols == 0) return sumT();
+	int numBands = opsT::NumBands(numRows, numCols);
+	Vector<sumT> partials(numBands);
+	for (int i = 0; i < numBands; i++) {
+		partials.add(sumT());
+	}
+	opsT::ForBands(numRows, numCols, pool, [&](int band, int first, int end) {
+		sumT sum = sumT();
+		for (int row = first; row < end; row++) {
+			if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+				sum += opsT::RowSum(&grid.uncheckedAt(row, 0), numCols);
+			} else {
+				for (int col = 0; col < numCols; col++) {
+					sum += grid.uncheckedAt(row, col);
+				}
+			}
+		}
+		partials[band] = sum;
+	});
+	sumT total = sumT();
+	for (int i = 0; i < numBands; i++) {
+		total += partials[i];
+	}
+	return total;
+}
+
+template <typename ElemType, typename Layout>
+ElemType GridMin(Grid<ElemType, Layout> & grid, ThreadPool *pool) {
+	typedef GridKernelOps<ElemType> opsT;
+	int numRows = grid.numRows();
+	int numCols = grid.numCols();
+	if (numRows == 0 || numCols == 0) Error("GridMin: grid is empty");
+	int numBands = opsT::NumBands(numRows, numCols);
+	Vector<ElemType> partials(numBands);
+	for (int i = 0; i < numBands; i++) {
+		partials.add(ElemType());
+	}
+	opsT::ForBands(numRows, numCols, pool, [&](int band, int first, int end) {
+		ElemType best = grid.uncheckedAt(first, 0);
+		for (int row = first; row < end; row++) {
+			if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+				ElemType rowBest = opsT::RowMin(&grid.uncheckedAt(row, 0), numCols);
+				if (rowBest < best) best = rowBest;
+			} else {
+				for (int col = 0; col < numCols; col++) {
+					if (grid.uncheckedAt(row, col) < best) best = grid.uncheckedAt(row, col);
+				}
+			}
+		}
+		partials[band] = best;
+	});
+	ElemType best = partials[0];
+	for (int i = 1; i < numBands; i++) {
+		if (partials[i] < best) best = partials[i];
+	}
+	return best;
+}
+
+template <typename ElemType, typename Layout>
+ElemType GridMax(Grid<ElemType, Layout> & grid, ThreadPool *pool) {
+	typedef GridKernelOps<ElemType> opsT;
+	int numRows = grid.numRows();
+	int numCols = grid.numCols();
+	if (numRows == 0 || numCols == 0) Error("GridMax: grid is empty");
+	int numBands = opsT::NumBands(numRows, numCols);
+	Vector<ElemType> partials(numBands);
+	for (int i = 0; i < numBands; i++) {
+		partials.add(ElemType());
+	}
+	opsT::ForBands(numRows, numCols, pool, [&](int band, int first, int end) {
+		ElemType best = grid.uncheckedAt(first, 0);
+		for (int row = first; row < end; row++) {
+			if constexpr (std::is_same<Layout, RowMajorLayout>::value) {
+				ElemType rowBest = opsT::RowMax(&grid.uncheckedAt(row, 0), numCols);
+				if (best < rowBest) best = rowBest;
+			} else {
+				for (int col = 0; col < numCols; col++) {
+					if (best < grid.uncheckedAt(row, col)) best = grid.uncheckedAt(row, col);
+				}
+			}
+		}
+		partials[band] = best;
+	});
+	ElemType best = partials[0];
+	for (int i = 1; i < numBands; i++) {
+		if (best < partials[i]) best = partials[i];
+	}
+	return best;
+}
+
+/*
+ * Implementation notes: GridConvolve
+ * ----------------------------------
+ * In a row-major grid, the rows far enough from the top and bottom for
+ * the kernel to fit are done by ConvolveRow, except for the few columns
+ * at each end where the kernel hangs over the side; those columns, the
+ * rows near the top and bottom, and every cell of a grid in another
+ * layout go through ConvolveAt.  The weights are copied out of the
+ * kernel grid first so that the inner loops read them from an array.
+ */
+
+template <typename ElemType, typename Layout>
+void GridConvolve(Grid<ElemType, Layout> & src, Grid<ElemType, Layout> & dst,
+                  Grid<ElemType> & kernel, ThreadPool *pool) {
+	typedef GridKernelOps<ElemType> opsT;
+	if (kernel.numRows() % 2 == 0 || kernel.numCols() % 2 == 0) {
+		Error("GridConvolve: kernel must have an odd number of rows and columns");
+	}
+	if (&src == &dst) {
+		Grid<ElemType, Layout> copy = src;
+		GridConvolve(copy, dst, kernel, pool);
+		return;
+	}
+	int numRows = src.numRows();
+	int numCols = src.numCols();
+	if (dst.numRows() != numRows || dst.numCols() != numCols) dst.resize(numRows, numCols);
+	if (numRows == 0 || numCols == 0) return;
+	int rr = kernel.numRows() / 2;
+	int rc = kernel.numCols() / 2;
+	Vector<ElemType> weights(kernel.numRows() * kernel.numCols());
+	for (int k = 0; k < kernel.numRows(); k++) {
+		for (int j = 0; j < kernel.numCols(); j++) {
+			weights.add(kernel[k][j]);
+		}
+	}
+	const ElemType *w = &weights[0];
+	opsT::ForBands(numRows, numCols, pool, [&](int, int first, int end) {
+		const ElemType *rows[64];
+		for (int row = first; row < end; row++) {
+			bool interior = std::is_same<Layout, RowMajorLayout>::value
+			                && row >= rr && row < numRows - rr
+			                && numCols > 2 * rc && 2 * rr + 1 <= 64;
+			if (!interior) {
+				for (int col = 0; col < numCols; col++) {
+					dst.uncheckedAt(row, col) = opsT::ConvolveAt(src, w, rr, rc, row, col);
+				}
+				continue;
+			}
+			for (int k = 0; k <= 2 * rr; k++) {
+				rows[k] = &src.uncheckedAt(row + k - rr, 0);
+			}
+			ElemType *d = &dst.uncheckedAt(row, 0);
+			if (rr == 1 && rc == 1) {
+				opsT::template ConvolveRow<1, 1>(rows, w, d, rc, numCols - rc, rr, rc);
+			} else if (rr == 2 && rc == 2) {
+				opsT::template ConvolveRow<2, 2>(rows, w, d, rc, numCols - rc, rr, rc);
+			} else {
+				opsT::template ConvolveRow<-1, -1>(rows, w, d, rc, numCols - rc, rr, rc);
+			}
+			for (int col = 0; col < rc; col++) {
+				d[col] = opsT::ConvolveAt(src, w, rr, rc, row, col);
+				d[numCols - 1 - col] = opsT::ConvolveAt(src, w, rr, rc, row, numCols - 1 - col);
+			}
+		}
+	});
+}
+
+#endif
@@ -4,7 +4,9 @@
  * -----------------------------------------------------
  * This file contains the implementation of the lexicon.h interface.
  * Because of the way C++ compiles templates, this code must be
- * available to the compiler when it reads the header file.
+ * available to the compiler when it reads the header file.  The
+ * iterator is also implemented here (as inline functions) so that the
+ * compiler can see through the per-word loop.
  */
 
 #ifdef _lexicon_h
@@ -14,8 +16,457 @@ void Lexicon::mapAll(void (*fn)(string word, ClientDataType &),
                      ClientDataType & clientData) {
 	Lexicon::Iterator iter = iterator();
 	while (iter.hasNext()) {
-		fn(iter.next(), clientData);
+		fn(iter.nextRef(), clientData);
 	}
 }
 
+inline void Lexicon::mapAll(void (*fn)(string word)) {
+	Lexicon::Iterator iter = iterator();
+	while (iter.hasNext()) {
+		fn(iter.nextRef());
+	}
+}
+
+/*
+ * Implementation notes: parallelMapAll
+ * ------------------------------------
+ * The DAWG is cut into work units by findWorkUnits, and each worker
+ * thread claims the next unclaimed unit from a shared atomic counter
+ * until none remain, so a thread that draws a short prefix simply
+ * moves on to another one.  Every unit has its own copy of the client
+ * data, which means the workers never write to anything in common;
+ * the copies are merged in unit order after the threads are joined.
+ */
+
+template <typename ClientDataType>
+void Lexicon::parallelMapAll(void (*fn)(const string &, ClientDataType &),
+                             ClientDataType & data,
+                             void (*merge)(ClientDataType &, ClientDataType &),
+                             int numThreads) {
+	Vector<workUnitT> units;
+	findWorkUnits(units);
+	Vector<ClientDataType> partials(units.size());
+	for (int i = 0; i < units.size(); i++) {
+		partials.add(data);
+	}
+	if (numThreads <= 0) numThreads = std::thread::hardware_concurrency();
+	if (numThreads > units.size()) numThreads = units.size();
+	if (numThreads <= 0) numThreads = 1;
+	std::atomic<int> nextUnit(0);
+	std::thread *workers = new std::thread[numThreads];
+	for (int i = 1; i < numThreads; i++) {
+		workers[i] = std::thread(&Lexicon::mapWorkUnits<ClientDataType>, this,
+		                         &units, &nextUnit, fn, &partials);
+	}
+	mapWorkUnits(&units, &nextUnit, fn, &partials);
+	for (int i = 1; i < numThreads; i++) {
+		workers[i].join();
+	}
+	delete[] workers;
+	for (int i = 0; i < partials.size(); i++) {
+		merge(data, partials[i]);
+	}
+}
+
+template <typename ClientDataType>
+void Lexicon::mapWorkUnits(Vector<workUnitT> *units,
+                           std::atomic<int> *nextUnit,
+                           void (*fn)(const string &, ClientDataType &),
+                           Vector<ClientDataType> *partials) {
+	while (true) {
+		int index = (*nextUnit)++;
+		if (index >= units->size()) return;
+		mapWorkUnit((*units)[index], fn, (*partials)[index]);
+	}
+}
+
+template <typename ClientDataType>
+void Lexicon::mapWorkUnit(workUnitT & unit,
+                          void (*fn)(const string &, ClientDataType &),
+                          ClientDataType & data) {
+	if (unit.depth == 0) {
+		Set<string>::Iterator iter = otherWords.iterator();
+		while (iter.hasNext()) {
+			fn(iter.nextRef(), data);
+		}
+	} else if (unit.depth == 1) {
+		fn(string(1, ordToChar(((Edge *) unit.path[0])->letter)), data);
+	} else {
+		Iterator iter(this, unit.path, unit.depth);
+		while (iter.hasNext()) {
+			fn(iter.nextRef(), data);
+		}
+	}
+}
+
+/*
+ * Private method: findWorkUnits
+ * -----------------------------
+ * Fills units with the pieces handed out by parallelMapAll, in
+ * alphabetical order: for each first letter, the one-letter word (if
+ * it is in the DAWG) followed by a unit for each two-letter prefix,
+ * and finally one unit for otherWords if it is not empty.
+ */
+
+inline void Lexicon::findWorkUnits(Vector<workUnitT> & units) {
+	for (Edge *first = start; first != NULL; first++) {
+		if (first->accept) {
+			workUnitT unit = { { (void *) first, NULL }, 1 };
+			units.add(unit);
+		}
+		if (first->children != 0) {
+			for (Edge *second = &edges[first->children]; ; second++) {
+				workUnitT unit = { { (void *) first, (void *) second }, 2 };
+				units.add(unit);
+				if (second->lastEdge) break;
+			}
+		}
+		if (first->lastEdge) break;
+	}
+	if (!otherWords.isEmpty()) {
+		workUnitT unit = { { NULL, NULL }, 0 };
+		units.add(unit);
+	}
+}
+
+typedef void (*LexiconWordFn)(const string & word);
+
+static inline void CallWordFn(const string & word, LexiconWordFn & fn) {
+	fn(word);
+}
+
+static inline void IgnoreWordFn(LexiconWordFn &, LexiconWordFn &) {
+	/* Empty */
+}
+
+inline void Lexicon::parallelMapAll(void (*fn)(const string & word),
+                                    int numThreads) {
+	LexiconWordFn data = fn;
+	parallelMapAll(CallWordFn, data, IgnoreWordFn, numThreads);
+}
+
+/*
+ * Implementation notes: findNearWords
+ * -----------------------------------
+ * This is the standard dynamic-programming edit distance, computed one
+ * row per letter as the search walks down the DAWG: the row at depth d
+ * holds the distance from the first d letters of the current path to
+ * each prefix of the target.  Words that share a prefix share its rows,
+ * and once every entry in a row exceeds maxDistance no extension of
+ * that prefix can come back into range, so the whole subtree is
+ * skipped.  All of the rows live in a single block allocated before
+ * the walk starts.
+ *
+ * The DAWG yields matches in alphabetical order, as does otherWords,
+ * so the two lists are merged and then bucketed by distance to get the
+ * ranked result.
+ */
+
+inline Vector<string> Lexicon::findNearWords(string target, int maxDistance) {
+	if (maxDistance < 0) {
+		Error("findNearWords: maxDistance must not be negative");
+	}
+	nearSearchT search;
+	search.target = ConvertToLowerCase(target);
+	search.maxDistance = maxDistance;
+	search.numCols = search.target.size() + 1;
+	search.rows = new int[(Iterator::MAX_DAWG_DEPTH + 1) * search.numCols];
+	for (int j = 0; j < search.numCols; j++) {
+		search.rows[j] = j;
+	}
+	search.word.reserve(Iterator::MAX_DAWG_DEPTH);
+	if (start != NULL) recFindNearWords(start, 1, search);
+	Vector<nearWordT> dawgMatches = search.matches;
+	search.matches.clear();
+	Set<string>::Iterator iter = otherWords.iterator();
+	while (iter.hasNext()) {
+		const string & word = iter.nextRef();
+		int distance = boundedEditDistance(word, search);
+		if (distance <= maxDistance) {
+			nearWordT match = { word, distance };
+			search.matches.add(match);
+		}
+	}
+	delete[] search.rows;
+
+	Vector<nearWordT> & setMatches = search.matches;
+	Vector<nearWordT> merged(dawgMatches.size() + setMatches.size());
+	int i = 0, j = 0;
+	while (i < dawgMatches.size() || j < setMatches.size()) {
+		if (j == setMatches.size() || (i < dawgMatches.size()
+		                   && dawgMatches[i].word < setMatches[j].word)) {
+			merged.add(dawgMatches[i++]);
+		} else {
+			merged.add(setMatches[j++]);
+		}
+	}
+	Vector<string> result(merged.size());
+	for (int distance = 0; result.size() < merged.size(); distance++) {
+		for (int k = 0; k < merged.size(); k++) {
+			if (merged[k].distance == distance) result.add(merged[k].word);
+		}
+	}
+	return result;
+}
+
+/*
+ * Private method: recFindNearWords
+ * --------------------------------
+ * Visits edge and its siblings, each of which appends one letter to
+ * the path at the given depth.  The row for that letter is computed
+ * from the row above it, the word is recorded if it is accepted and
+ * close enough, and the search descends only if some entry of the row
+ * is still within range.
+ */
+
+inline void Lexicon::recFindNearWords(Edge *edge, int depth,
+                                      nearSearchT & search) {
+	int numCols = search.numCols;
+	int *prev = search.rows + (depth - 1) * numCols;
+	int *cur = prev + numCols;
+	for (;; edge++) {
+		char ch = ordToChar(edge->letter);
+		search.word.resize(depth);
+		search.word[depth - 1] = ch;
+		cur[0] = depth;
+		int rowMin = depth;
+		for (int j = 1; j < numCols; j++) {
+			int best = prev[j - 1] + (search.target[j - 1] == ch ? 0 : 1);
+			if (prev[j] + 1 < best) best = prev[j] + 1;
+			if (cur[j - 1] + 1 < best) best = cur[j - 1] + 1;
+			cur[j] = best;
+			if (best < rowMin) rowMin = best;
+		}
+		if (edge->accept && cur[numCols - 1] <= search.maxDistance) {
+			nearWordT match = { search.word, cur[numCols - 1] };
+			search.matches.add(match);
+		}
+		if (edge->children != 0 && rowMin <= search.maxDistance) {
+			if (depth == Iterator::MAX_DAWG_DEPTH) {
+				Error("Lexicon contains a word longer than findNearWords supports");
+			}
+			recFindNearWords(&edges[edge->children], depth + 1, search);
+		}
+		if (edge->lastEdge) break;
+	}
+}
+
+/*
+ * Private method: boundedEditDistance
+ * -----------------------------------
+ * Returns the edit distance between word and the search target, using
+ * the first two rows of the search buffer in alternation.  If every
+ * entry of a row exceeds maxDistance, the method gives up early and
+ * returns maxDistance + 1.
+ */
+
+inline int Lexicon::boundedEditDistance(const string & word,
+                                        nearSearchT & search) {
+	int numCols = search.numCols;
+	int *prev = search.rows;
+	int *cur = search.rows + numCols;
+	for (int j = 0; j < numCols; j++) {
+		prev[j] = j;
+	}
+	for (int i = 1; i <= (int) word.size(); i++) {
+		char ch = tolower(word[i - 1]);
+		cur[0] = i;
+		int rowMin = i;
+		for (int j = 1; j < numCols; j++) {
+			int best = prev[j - 1] + (search.target[j - 1] == ch ? 0 : 1);
+			if (prev[j] + 1 < best) best = prev[j] + 1;
+			if (cur[j - 1] + 1 < best) best = cur[j - 1] + 1;
+			cur[j] = best;
+			if (best < rowMin) rowMin = best;
+		}
+		if (rowMin > search.maxDistance) return search.maxDistance + 1;
+		int *temp = prev;
+		prev = cur;
+		cur = temp;
+	}
+	return prev[numCols - 1];
+}
+
+/*
+ * Lexicon::Iterator class implementation
+ * --------------------------------------
+ * The iterator merges two sorted streams: the words in the DAWG, and
+ * the words added later which live in the otherWords set.  The DAWG
+ * is walked depth-first with an explicit stack of edges, one per
+ * letter of the current word, which is spelled into wordFromDAWG as
+ * the walk proceeds.  Because the returned reference aliases that
+ * buffer, the DAWG is not advanced past a word until the next call to
+ * hasNext or next.  The set stream needs no such care since the
+ * string it refers to lives in the set itself.
+ */
+
+inline Lexicon::Iterator::Iterator() {
+	lex = NULL;
+}
+
+inline Lexicon::Iterator Lexicon::iterator() {
+	return Iterator(this);
+}
+
+inline Lexicon::Iterator::Iterator(Lexicon *lp) {
+	lex = lp;
+	timestamp = lex->timestamp;
+	depth = baseDepth = 0;
+	dawgPending = false;
+	wordFromDAWG.reserve(MAX_DAWG_DEPTH);
+	if (lex->start != NULL) {
+		pushEdge(lex->start);
+		if (!lex->start->accept) advanceToNextWordInDAWG();
+	}
+	setIterator = lex->otherWords.iterator();
+	advanceToNextWordInSet();
+}
+
+/*
+ * Private constructor: Iterator(lp, path, pathLength)
+ * ---------------------------------------------------
+ * Creates an iterator over just the words that begin with the prefix
+ * spelled by the DAWG edges in path.  The prefix edges sit at the bottom
+ * of the stack below baseDepth, where the walk never pops them, and the
+ * otherWords stream is left empty.
+ */
+
+inline Lexicon::Iterator::Iterator(Lexicon *lp, void **path, int pathLength) {
+	lex = lp;
+	timestamp = lex->timestamp;
+	depth = 0;
+	dawgPending = false;
+	wordFromDAWG.reserve(MAX_DAWG_DEPTH);
+	for (int i = 0; i < pathLength; i++) {
+		pushEdge(path[i]);
+	}
+	baseDepth = pathLength;
+	if (!((Edge *) path[pathLength - 1])->accept) advanceToNextWordInDAWG();
+	wordFromSet = NULL;
+}
+
+inline bool Lexicon::Iterator::hasNext() {
+	if (lex == NULL) Error("hasNext called on uninitialized iterator");
+	if (timestamp != lex->timestamp) {
+		Error("Lexicon structure has been modified");
+	}
+	if (dawgPending) {
+		dawgPending = false;
+		advanceToNextWordInDAWG();
+	}
+	return depth > 0 || wordFromSet != NULL;
+}
+
+inline string Lexicon::Iterator::next() {
+	return nextRef();
+}
+
+inline const string & Lexicon::Iterator::nextRef() {
+	if (lex == NULL) Error("next called on uninitialized iterator");
+	if (!hasNext()) {
+		Error("Attempt to get next from iterator"
+		      " where hasNext() is false");
+	}
+	if (depth > 0) {
+		int sign = (wordFromSet == NULL) ? -1
+		                                 : wordFromDAWG.compare(*wordFromSet);
+		if (sign == 0) advanceToNextWordInSet();
+		if (sign <= 0) {
+			dawgPending = true;
+			return wordFromDAWG;
+		}
+	}
+	const string & result = *wordFromSet;
+	advanceToNextWordInSet();
+	return result;
+}
+
+/*
+ * Private method: advanceToNextWordInDAWG
+ * ---------------------------------------
+ * Moves the edge stack to the next accepting edge in a preorder walk
+ * of the DAWG.  From the current edge, the walk descends into its
+ * children if it has any; otherwise it moves to the next sibling,
+ * first popping any edges that were the last in their list.  When the
+ * walk would pop down to baseDepth, the DAWG (or the subtree being
+ * iterated) has been exhausted and the stack is emptied.
+ */
+
+inline void Lexicon::Iterator::advanceToNextWordInDAWG() {
+	while (depth > 0) {
+		Edge *top = (Edge *) edgeStack[depth - 1];
+		if (top->children != 0) {
+			pushEdge(&lex->edges[top->children]);
+		} else {
+			while (depth > baseDepth
+			       && ((Edge *) edgeStack[depth - 1])->lastEdge) {
+				depth--;
+			}
+			if (depth == baseDepth) depth = 0;
+			wordFromDAWG.resize(depth);
+			if (depth == 0) return;
+			Edge *sibling = (Edge *) edgeStack[depth - 1] + 1;
+			edgeStack[depth - 1] = (void *) sibling;
+			wordFromDAWG[depth - 1] = lex->ordToChar(sibling->letter);
+		}
+		if (((Edge *) edgeStack[depth - 1])->accept) return;
+	}
+}
+
+inline void Lexicon::Iterator::advanceToNextWordInSet() {
+	wordFromSet = setIterator.hasNext() ? &setIterator.nextRef() : NULL;
+}
+
+inline void Lexicon::Iterator::pushEdge(void *edgePtr) {
+	if (depth == MAX_DAWG_DEPTH) {
+		Error("Lexicon contains a word longer than the iterator supports");
+	}
+	edgeStack[depth++] = edgePtr;
+	wordFromDAWG += lex->ordToChar(((Edge *) edgePtr)->letter);
+}
+
+/*
+ * Lexicon::RangeIterator class implementation
+ * -------------------------------------------
+ */
+
+inline Lexicon::RangeIterator Lexicon::begin() {
+	return RangeIterator(this);
+}
+
+inline Lexicon::RangeIterator Lexicon::end() {
+	return RangeIterator();
+}
+
+inline Lexicon::RangeIterator::RangeIterator() {
+	current = NULL;
+}
+
+inline Lexicon::RangeIterator::RangeIterator(Lexicon *lp) : iter(lp) {
+	++*this;
+}
+
+inline Lexicon::RangeIterator::RangeIterator(const RangeIterator & other) {
+	*this = other;
+}
+
+inline Lexicon::RangeIterator & Lexicon::RangeIterator::operator=(const RangeIterator & other) {
+	if (other.current != NULL) iter = other.iter;
+	current = (other.current == &other.iter.wordFromDAWG) ? &iter.wordFromDAWG : other.current;
+	return *this;
+}
+
+inline const string & Lexicon::RangeIterator::operator*() {
+	return *current;
+}
+
+inline Lexicon::RangeIterator & Lexicon::RangeIterator::operator++() {
+	current = iter.hasNext() ? &iter.nextRef() : NULL;
+	return *this;
+}
+
+inline bool Lexicon::RangeIterator::operator!=(const RangeIterator & other) {
+	return current != other.current;
+}
+
 #endif
@@ -15,29 +15,66 @@ public:
  * ------------------------
  * This interface defines a nested class within the Lexicon class that
  * provides iterator access to the words in the lexicon.
+ *
+ * The iterator walks the DAWG with a fixed-size stack of edge pointers
+ * and spells the current word into a single buffer that is reused for
+ * every word, so stepping through the lexicon does not allocate. The
+ * nextRef method returns a reference to that buffer (or to the word
+ * stored in otherWords) instead of a copy; the reference is only valid
+ * until the iterator is advanced again.
  */
-	class Iterator : public FE_Iterator {
+	class Iterator {
 	public:
 		Iterator();
 		bool hasNext();
 		string next();
+		const string & nextRef();
 
 	private:
+		static const int MAX_DAWG_DEPTH = 64;
+
 		Iterator(Lexicon *lp);
+		Iterator(Lexicon *lp, void **path, int pathLength);
 		Lexicon *lex;
 		string wordFromDAWG;
-		string wordFromSet;
-		void *edgePtr;
-		Stack<void *> stack;
+		const string *wordFromSet;
+		void *edgeStack[MAX_DAWG_DEPTH];
+		int depth;
+		int baseDepth;
+		bool dawgPending;
 		Set<string>::Iterator setIterator;
 		long timestamp;
 		void advanceToNextWordInDAWG();
 		void advanceToNextWordInSet();
-		void advanceToNextEdge();
+		void pushEdge(void *edgePtr);
 		friend class Lexicon;
 	};
 	friend class Iterator;
-	string foreachHook(FE_State & _fe);
+
+/*
+ * Class: Lexicon::RangeIterator
+ * -----------------------------
+ * The iterator returned by begin and end, which wraps an Iterator and
+ * remembers the word it returned last; the end of the lexicon is a
+ * NULL word.  That word may live in the Iterator's own buffer, so a
+ * copy of a RangeIterator is pointed at the buffer in its own copy of
+ * the Iterator.
+ */
+	class RangeIterator {
+	public:
+		const string & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+		RangeIterator(const RangeIterator & other);
+		RangeIterator & operator=(const RangeIterator & other);
+
+	private:
+		RangeIterator();
+		RangeIterator(Lexicon *lp);
+		Iterator iter;
+		const string *current;
+		friend class Lexicon;
+	};
 
 /*
  * Deep copying support
@@ -76,6 +113,41 @@ private:
 #endif
         };
 
+/*
+ * Type: workUnitT
+ * ---------------
+ * One independent slice of the lexicon for parallelMapAll: the subtree
+ * below a two-letter prefix (depth 2), a single one-letter word
+ * (depth 1), or the words in otherWords (depth 0).
+ */
+	static const int PARTITION_DEPTH = 2;
+
+	struct workUnitT {
+		void *path[PARTITION_DEPTH];
+		int depth;
+	};
+
+/*
+ * Types: nearWordT, nearSearchT
+ * -----------------------------
+ * Bookkeeping for findNearWords.  The rows field points at a block of
+ * (MAX_DAWG_DEPTH + 1) rows of numCols ints, one row per letter of the
+ * word being spelled along the current DAWG path.
+ */
+	struct nearWordT {
+		string word;
+		int distance;
+	};
+
+	struct nearSearchT {
+		string target;
+		int maxDistance;
+		int numCols;
+		int *rows;
+		string word;
+		Vector<nearWordT> matches;
+	};
+
 	Edge *edges, *start;
 	int numEdges, numDawgWords;
 	long timestamp;
@@ -85,6 +157,18 @@ private:
 	Edge *traceToLastEdge(const string & s);
 	void readBinaryFile(string filename);
 	void copyContentsFrom(const Lexicon & rhs);
+	void findWorkUnits(Vector<workUnitT> & units);
+	void recFindNearWords(Edge *edge, int depth, nearSearchT & search);
+	int boundedEditDistance(const string & word, nearSearchT & search);
+
+	template <typename ClientDataType>
+	void mapWorkUnit(workUnitT & unit,
+	                 void (*fn)(const string &, ClientDataType &),
+	                 ClientDataType & data);
+	template <typename ClientDataType>
+	void mapWorkUnits(Vector<workUnitT> *units, std::atomic<int> *nextUnit,
+	                  void (*fn)(const string &, ClientDataType &),
+	                  Vector<ClientDataType> *partials);
 
 	unsigned int charToOrd(char ch) {
 		return ((unsigned int)(tolower(ch) - 'a' + 1));
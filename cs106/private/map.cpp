@@ -19,37 +19,65 @@
  * allocated so that we can change the the number of buckets (rehash)
  * when the load factor becomes too high. The map should provide O(1)
  * performance on the put/remove/get operations.
+ *
+ * A map with a SmallCapacity starts out with no hashtable at all: its
+ * entries go in the fixed array small.cells, in the order they were
+ * added, and are found by a linear scan that compares one-byte tags
+ * before comparing keys.  Removing an entry moves the last one into
+ * its place.  Adding one more entry than the array holds "spills" the
+ * map: the hashtable is built, every entry moves into it, and from then
+ * on (until the map is cleared) the map behaves like any other.  The
+ * SmallCapacity tests are compile-time constants, so a map without one
+ * pays nothing for the feature.
  */
 
-template <typename ValueType>
-Map<ValueType>::Map(int sizeHint) {
+template <typename ValueType, int SmallCapacity>
+Map<ValueType, SmallCapacity>::Map(int sizeHint) {
 	if (sizeHint < 0) Error("Negative sizeHint given to Map constructor");
-	initBuckets(sizeHint);
+	initStorage(sizeHint);
 	timestamp = 0L;
 }
 
-template <typename ValueType>
-Map<ValueType>::~Map() {
+template <typename ValueType, int SmallCapacity>
+Map<ValueType, SmallCapacity>::~Map() {
 	deleteBuckets(buckets);
 }
 
-template <typename ValueType>
-int Map<ValueType>::size() {
+template <typename ValueType, int SmallCapacity>
+int Map<ValueType, SmallCapacity>::size() {
 	return numEntries;
 }
 
-template <typename ValueType>
-bool Map<ValueType>::isEmpty() {
+template <typename ValueType, int SmallCapacity>
+bool Map<ValueType, SmallCapacity>::isEmpty() {
 	return size() == 0;
 }
 
-template <typename ValueType>
-void Map<ValueType>::put(string key, ValueType value) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::put(string key, ValueType value) {
 	(*this)[key] = value;
 }
 
-template <typename ValueType>
-void Map<ValueType>::remove(string key) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::remove(string key) {
+	if constexpr (SmallCapacity > 0) {
+		if (!spilled) {
+			int index = findSmallCell(key);
+			if (index >= 0) {
+				int last = numEntries - 1;
+				if (index != last) {
+					swap(small.cells[index].key, small.cells[last].key);
+					swap(small.cells[index].value, small.cells[last].value);
+					small.tags[index] = small.tags[last];
+				}
+				small.cells[last].key.clear();
+				small.cells[last].value = ValueType();
+				numEntries--;
+			}
+			timestamp++;
+			return;
+		}
+	}
 	int hashCode = hash(key);
 	cellT *prev;
 	cellT *found = findCell(buckets[hashCode], key, &prev);
@@ -65,28 +93,53 @@ void Map<ValueType>::remove(string key) {
 	timestamp++;
 }
 
-template <typename ValueType>
-void Map<ValueType>::clear() {
-	deleteBuckets(buckets);
-	numEntries = 0;
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::clear() {
+	if constexpr (SmallCapacity > 0) {
+		deleteBuckets(buckets);
+		clearSmallCells();
+		initStorage(small.sizeHint);
+	} else {
+		deleteBuckets(buckets);
+		numEntries = 0;
+	}
 	timestamp++;
 }
 
-template <typename ValueType>
-bool Map<ValueType>::containsKey(string key) {
+template <typename ValueType, int SmallCapacity>
+bool Map<ValueType, SmallCapacity>::containsKey(string key) {
+	if constexpr (SmallCapacity > 0) {
+		if (!spilled) return findSmallCell(key) >= 0;
+	}
 	int hashCode = hash(key);
 	return findCell(buckets[hashCode], key) != NULL;
 }
 
-template <typename ValueType>
-ValueType Map<ValueType>::get(string key) {
+template <typename ValueType, int SmallCapacity>
+ValueType Map<ValueType, SmallCapacity>::get(string key) {
 	if (containsKey(key)) return (*this)[key];
 	Error("Attempt to get value for key which is not contained in map.");
 	return ValueType();
 }
 
-template <typename ValueType>
-ValueType & Map<ValueType>::operator[](string key) {
+template <typename ValueType, int SmallCapacity>
+ValueType & Map<ValueType, SmallCapacity>::operator[](string key) {
+	if constexpr (SmallCapacity > 0) {
+		if (!spilled) {
+			int index = findSmallCell(key);
+			if (index >= 0) return small.cells[index].value;
+			if (numEntries < SmallCapacity) {
+				cellT & cell = small.cells[numEntries];
+				cell.key = key;
+				cell.value = ValueType();
+				small.tags[numEntries] = smallTag(key);
+				numEntries++;
+				timestamp++;
+				return cell.value;
+			}
+			spill();
+		}
+	}
 	int hashCode = hash(key);
 	cellT *cp = findCell(buckets[hashCode], key);
 	if (cp == NULL) {
@@ -103,37 +156,49 @@ ValueType & Map<ValueType>::operator[](string key) {
 	return cp->value;
 }
 
-template <typename ValueType>
-const Map<ValueType> &Map<ValueType>::operator=(const Map & rhs) {
+template <typename ValueType, int SmallCapacity>
+const Map<ValueType, SmallCapacity> &Map<ValueType, SmallCapacity>::operator=(const Map & rhs) {
 	if (this != &rhs) {
 		deleteBuckets(buckets);
+		if constexpr (SmallCapacity > 0) clearSmallCells();
 		copyOtherEntries(rhs);
 		timestamp = 0L;
 	}
 	return *this;
 }
 
-template <typename ValueType>
-Map<ValueType>::Map(const Map & rhs) {
+template <typename ValueType, int SmallCapacity>
+Map<ValueType, SmallCapacity>::Map(const Map & rhs) {
 	copyOtherEntries(rhs);
 	timestamp = 0L;
 }
 
-template <typename ValueType>
-void Map<ValueType>::add(string key, ValueType value) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::add(string key, ValueType value) {
 	put(key, value);
 }
 
-template <typename ValueType>
-ValueType Map<ValueType>::getValue(string key) {
+template <typename ValueType, int SmallCapacity>
+ValueType Map<ValueType, SmallCapacity>::getValue(string key) {
 	return get(key);
 }
 
-template <typename ValueType>
+template <typename ValueType, int SmallCapacity>
 template <typename ClientData>
-void Map<ValueType>::mapAll(void (*fn)(string, ValueType, ClientData &),
+void Map<ValueType, SmallCapacity>::mapAll(void (*fn)(string, ValueType, ClientData &),
                             ClientData & data) {
 	long t0 = timestamp;
+	if constexpr (SmallCapacity > 0) {
+		if (!spilled) {
+			for (int i = 0; i < numEntries; i++) {
+				fn(small.cells[i].key, small.cells[i].value, data);
+				if (t0 != timestamp) {
+					Error("mapAll: Map structure changed");
+				}
+			}
+			return;
+		}
+	}
 	for (int i = 0 ; i < buckets.size(); i++) {
 		for (cellT *cp = buckets[i]; cp != NULL; cp = cp->next) {
 			fn(cp->key, cp->value, data);
@@ -144,9 +209,20 @@ void Map<ValueType>::mapAll(void (*fn)(string, ValueType, ClientData &),
 	}
 }
 
-template <typename ValueType>
-void Map<ValueType>::mapAll(void (*fn)(string key, ValueType value)) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::mapAll(void (*fn)(string key, ValueType value)) {
 	long t0 = timestamp;
+	if constexpr (SmallCapacity > 0) {
+		if (!spilled) {
+			for (int i = 0; i < numEntries; i++) {
+				fn(small.cells[i].key, small.cells[i].value);
+				if (t0 != timestamp) {
+					Error("mapAll: Map structure changed");
+				}
+			}
+			return;
+		}
+	}
 	for (int i = 0 ; i < buckets.size(); i++) {
 		for (cellT *cp = buckets[i]; cp != NULL; cp = cp->next) {
 			fn(cp->key, cp->value);
@@ -164,8 +240,8 @@ void Map<ValueType>::mapAll(void (*fn)(string key, ValueType value)) {
  * This function deletes all the cells in the linked lists contained in vector.
  */
 
-template <typename ValueType>
-void Map<ValueType>::deleteBuckets(Vector<cellT *> & b) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::deleteBuckets(Vector<cellT *> & b) {
 	for (int i = 0; i < b.size(); i++) {
 		while (b[i] != NULL) {
 			cellT *next = b[i]->next;
@@ -187,9 +263,9 @@ void Map<ValueType>::deleteBuckets(Vector<cellT *> & b) {
  * the found cell. If not specified, NULL is the default value.
  */
 
-template <typename ValueType>
-typename Map<ValueType>::cellT
-         *Map<ValueType>::findCell(cellT *cp, string key, cellT **prevByRef) {
+template <typename ValueType, int SmallCapacity>
+typename Map<ValueType, SmallCapacity>::cellT
+         *Map<ValueType, SmallCapacity>::findCell(cellT *cp, string key, cellT **prevByRef) {
 	cellT *prev = NULL;
 	while (cp != NULL && key != cp->key) {
 		prev = cp;
@@ -208,8 +284,8 @@ typename Map<ValueType>::cellT
  * code is computed using a method called linear congruence.
  */
 
-template <typename ValueType>
-int Map<ValueType>::hash(string s) {
+template <typename ValueType, int SmallCapacity>
+int Map<ValueType, SmallCapacity>::hash(string s) {
 	const long Multiplier = -1664117991;
 	unsigned long hashcode = 0;
 	for (string::size_type i = 0; i < s.length(); i++) {
@@ -229,8 +305,8 @@ int Map<ValueType>::hash(string s) {
  * enlarge and redistribute the entries.
  */
 
-template <typename ValueType>
-void Map<ValueType>::expandAndRehash() {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::expandAndRehash() {
 	Vector<cellT *>oldBuckets = buckets;
 	initBuckets(oldBuckets.size()*2 + 1);
 	for (int i = 0; i < oldBuckets.size(); i++) {
@@ -250,8 +326,8 @@ void Map<ValueType>::expandAndRehash() {
  * just to simplify handling elsewhere.
  */
 
-template <typename ValueType>
-void Map<ValueType>::initBuckets(int nBuckets) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::initBuckets(int nBuckets) {
 	if (nBuckets == 0) nBuckets = 1;
 	buckets = Vector<cellT *>(nBuckets);
 	for (int i = 0; i < nBuckets; i++) {
@@ -260,8 +336,8 @@ void Map<ValueType>::initBuckets(int nBuckets) {
 	numEntries = 0;
 }
 
-template <typename ValueType>
-static void AddToMap(string key, ValueType val, Map<ValueType> & map) {
+template <typename ValueType, int SmallCapacity>
+static void AddToMap(string key, ValueType val, Map<ValueType, SmallCapacity> & map) {
 	map.put(key, val);
 }
 
@@ -278,29 +354,135 @@ static void AddToMap(string key, ValueType val, Map<ValueType> & map) {
  * this erroneous complaints. Sigh.
  */
 
-template <typename ValueType>
-void Map<ValueType>::copyOtherEntries(const Map & constRhs) {
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::copyOtherEntries(const Map & constRhs) {
 	Map & rhs = const_cast<Map &>(constRhs);
-	initBuckets(rhs.size());
-	rhs.mapAll< Map<ValueType> >(AddToMap, *this);
+	initStorage(rhs.size());
+	rhs.mapAll< Map<ValueType, SmallCapacity> >(AddToMap, *this);
+}
+
+/*
+ * Private method: initStorage
+ * Usage: initStorage(sizeHint);
+ * -----------------------------
+ * This method puts an empty map into its starting state: inline
+ * entries (remembering sizeHint for when they spill) if the map has a
+ * SmallCapacity, and a hashtable with sizeHint buckets otherwise.
+ */
+
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::initStorage(int sizeHint) {
+	if constexpr (SmallCapacity > 0) {
+		small.sizeHint = sizeHint;
+		buckets = Vector<cellT *>();
+		numEntries = 0;
+		spilled = false;
+	} else {
+		initBuckets(sizeHint);
+		spilled = true;
+	}
+}
+
+/*
+ * Private method: spill
+ * Usage: spill();
+ * ---------------
+ * This method moves the inline entries into a newly built hashtable.
+ * It is called when an entry is added to a full set of inline entries.
+ */
+
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::spill() {
+	if constexpr (SmallCapacity > 0) {
+		int numSmallEntries = numEntries;
+		int nBuckets = small.sizeHint;
+		if (nBuckets < 2 * SmallCapacity + 1) nBuckets = 2 * SmallCapacity + 1;
+		initBuckets(nBuckets);
+		spilled = true;
+		for (int i = 0; i < numSmallEntries; i++) {
+			cellT *cp = new cellT;
+			cp->key.swap(small.cells[i].key);
+			swap(cp->value, small.cells[i].value);
+			int hashCode = hash(cp->key);
+			cp->next = buckets[hashCode];
+			buckets[hashCode] = cp;
+		}
+		numEntries = numSmallEntries;
+	}
+}
+
+/*
+ * Private method: findSmallCell
+ * Usage: index = findSmallCell(key);
+ * ----------------------------------
+ * This method returns the index of key among the inline entries, or -1
+ * if it isn't there.  The tags are compared first, so the full key is
+ * only compared for entries whose tag matches.
+ */
+
+template <typename ValueType, int SmallCapacity>
+int Map<ValueType, SmallCapacity>::findSmallCell(const string & key) {
+	if constexpr (SmallCapacity > 0) {
+		unsigned char tag = smallTag(key);
+		for (int i = 0; i < numEntries; i++) {
+			if (small.tags[i] == tag && small.cells[i].key == key) return i;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Private method: clearSmallCells
+ * Usage: clearSmallCells();
+ * -------------------------
+ * This method resets the inline entries in use, releasing any memory
+ * their keys and values hold.
+ */
+
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::clearSmallCells() {
+	if constexpr (SmallCapacity > 0) {
+		if (spilled) return;
+		for (int i = 0; i < numEntries; i++) {
+			small.cells[i].key.clear();
+			small.cells[i].value = ValueType();
+		}
+	}
+}
+
+/*
+ * Private method: smallTag
+ * Usage: tag = smallTag(key);
+ * ---------------------------
+ * This function returns the one-byte tag for key, which mixes its
+ * length with its first and last characters.  Unlike hash, it takes
+ * the same time however long the key is.
+ */
+
+template <typename ValueType, int SmallCapacity>
+unsigned char Map<ValueType, SmallCapacity>::smallTag(const string & key) {
+	int length = key.length();
+	if (length == 0) return 0;
+	return (unsigned char) (length * 31 + (unsigned char) key[0] * 7
+	                        + (unsigned char) key[length - 1]);
 }
 
 /*
  * Map::Iterator class implementation
  */
 
-template <typename ValueType>
-Map<ValueType>::Iterator::Iterator() {
+template <typename ValueType, int SmallCapacity>
+Map<ValueType, SmallCapacity>::Iterator::Iterator() {
 	mp = NULL;
 }
 
-template <typename ValueType>
-typename Map<ValueType>::Iterator Map<ValueType>::iterator() {
+template <typename ValueType, int SmallCapacity>
+typename Map<ValueType, SmallCapacity>::Iterator Map<ValueType, SmallCapacity>::iterator() {
 	return Iterator(this);
 }
 
-template <typename ValueType>
-Map<ValueType>::Iterator::Iterator(Map *mapptr) {
+template <typename ValueType, int SmallCapacity>
+Map<ValueType, SmallCapacity>::Iterator::Iterator(Map *mapptr) {
 	mp = mapptr;
 	bucketIndex = -1;
 	cellPtr = NULL;
@@ -308,8 +490,8 @@ Map<ValueType>::Iterator::Iterator(Map *mapptr) {
 	advanceToNextKey();
 }
 
-template <typename ValueType>
-bool Map<ValueType>::Iterator::hasNext() {
+template <typename ValueType, int SmallCapacity>
+bool Map<ValueType, SmallCapacity>::Iterator::hasNext() {
 	if (mp == NULL) Error("hasNext called on uninitialized iterator");
 	if (timestamp != mp->timestamp) {
 		Error("Map structure has been modified");
@@ -317,8 +499,8 @@ bool Map<ValueType>::Iterator::hasNext() {
 	return cellPtr != NULL;
 }
 
-template <typename ValueType>
-string Map<ValueType>::Iterator::next() {
+template <typename ValueType, int SmallCapacity>
+string Map<ValueType, SmallCapacity>::Iterator::next() {
 	if (mp == NULL) Error("next called on uninitialized iterator");
 	if (!hasNext()) {
 		Error("Attempt to get next from iterator"
@@ -329,26 +511,76 @@ string Map<ValueType>::Iterator::next() {
 	return result;
 }
 
-template <typename ValueType>
-void Map<ValueType>::Iterator::advanceToNextKey() {
-	cellT *cp = (cellT *) cellPtr;
+template <typename ValueType, int SmallCapacity>
+void Map<ValueType, SmallCapacity>::Iterator::advanceToNextKey() {
+	cellPtr = (void *) mp->nextCell((cellT *) cellPtr, bucketIndex);
+}
+
+/*
+ * Private method: nextCell
+ * Usage: cp = nextCell(cp, bucketIndex);
+ * --------------------------------------
+ * Returns the cell that follows cp in the order the iterators visit
+ * them, or the first cell if cp is NULL, or NULL if there are no more.
+ * bucketIndex is the bucket that cp is in, or -1 to start with, and is
+ * moved along with it.
+ */
+
+template <typename ValueType, int SmallCapacity>
+typename Map<ValueType, SmallCapacity>::cellT *
+Map<ValueType, SmallCapacity>::nextCell(cellT *cp, int & bucketIndex) {
+	if constexpr (SmallCapacity > 0) {
+		if (!spilled) {
+			int index = (cp == NULL) ? 0 : int(cp - small.cells) + 1;
+			return (index < numEntries) ? &small.cells[index] : NULL;
+		}
+	}
 	if (cp != NULL) cp = cp->next;
-	while (cp == NULL && ++bucketIndex < mp->buckets.size()) {
-		cp = mp->buckets[bucketIndex];
+	while (cp == NULL && ++bucketIndex < buckets.size()) {
+		cp = buckets[bucketIndex];
 	}
-	cellPtr = (void *) cp;
+	return cp;
 }
 
-template <typename ValueType>
-string Map<ValueType>::foreachHook(FE_State & fe) {
-	if (fe.state == 0) fe.iter = new Iterator(this);
-	if (((Iterator *) fe.iter)->hasNext()) {
-		fe.state = 1;
-		return ((Iterator *) fe.iter)->next();
-	} else {
-		fe.state = 2;
-		return "";
-	}
+/*
+ * Map::RangeIterator class implementation
+ * ---------------------------------------
+ */
+
+template <typename ValueType, int SmallCapacity>
+typename Map<ValueType, SmallCapacity>::RangeIterator Map<ValueType, SmallCapacity>::begin() {
+	int bucket = -1;
+	cellT *first = nextCell(NULL, bucket);
+	return RangeIterator(this, (void *) first, bucket);
+}
+
+template <typename ValueType, int SmallCapacity>
+typename Map<ValueType, SmallCapacity>::RangeIterator Map<ValueType, SmallCapacity>::end() {
+	return RangeIterator(this, NULL, -1);
+}
+
+template <typename ValueType, int SmallCapacity>
+Map<ValueType, SmallCapacity>::RangeIterator::RangeIterator(Map *mapptr, void *cell, int bucket) {
+	mp = mapptr;
+	cellPtr = cell;
+	bucketIndex = bucket;
+}
+
+template <typename ValueType, int SmallCapacity>
+const string & Map<ValueType, SmallCapacity>::RangeIterator::operator*() {
+	return ((cellT *) cellPtr)->key;
+}
+
+template <typename ValueType, int SmallCapacity>
+typename Map<ValueType, SmallCapacity>::RangeIterator &
+Map<ValueType, SmallCapacity>::RangeIterator::operator++() {
+	cellPtr = (void *) mp->nextCell((cellT *) cellPtr, bucketIndex);
+	return *this;
+}
+
+template <typename ValueType, int SmallCapacity>
+bool Map<ValueType, SmallCapacity>::RangeIterator::operator!=(const RangeIterator & other) {
+	return cellPtr != other.cellPtr;
 }
 
 #endif
@@ -32,7 +32,7 @@ public:
  * This interface defines a nested class within the Map template that
  * provides iterator access to the keys contained in the Map.
  */
-	class Iterator : public FE_Iterator {
+	class Iterator {
 	public:
 		Iterator();
 		bool hasNext();
@@ -48,7 +48,28 @@ public:
 		friend class Map;
 	};
 	friend class Iterator;
-	string foreachHook(FE_State & _fe);
+
+/*
+ * Class: Map<ValType>::RangeIterator
+ * ----------------------------------
+ * The iterator returned by begin and end, which has just what the
+ * range-based for loop needs.  It moves from cell to cell with the
+ * same nextCell method as the Iterator, but without the Iterator's
+ * checks; the end of the map is a NULL cell.
+ */
+	class RangeIterator {
+	public:
+		const string & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(Map *mapptr, void *cell, int bucket);
+		Map *mp;
+		void *cellPtr;
+		int bucketIndex;
+		friend class Map;
+	};
 
 /*
  * Deep copying support
@@ -73,13 +94,42 @@ private:
 		cellT *next;
 	};
 
+/*
+ * Inline entries
+ * --------------
+ * A map with a SmallCapacity keeps its entries in small.cells until
+ * it has more than SmallCapacity of them, and spilled stays false until
+ * then.  Next to each inline entry is a one-byte tag computed from its
+ * key, which lets a lookup skip the string comparison for almost every
+ * entry that doesn't match.  When SmallCapacity is 0, small is empty
+ * and spilled is always true.
+ */
+	template <int N, bool IsEmpty = (N == 0)>
+	struct smallStorageT {
+		cellT cells[N];
+		unsigned char tags[N];
+		int sizeHint;
+	};
+
+	template <int N>
+	struct smallStorageT<N, true> {
+	};
+
 	Vector<cellT *> buckets;
 	int numEntries;
 	long timestamp;
+	bool spilled;
+	smallStorageT<SmallCapacity> small;
 
+	void initStorage(int sizeHint);
+	void spill();
+	int findSmallCell(const string & key);
+	void clearSmallCells();
+	static unsigned char smallTag(const string & key);
 	void initBuckets(int nBuckets);
 	void deleteBuckets(Vector<cellT *> & bucketsToDelete);
 	int hash(string s);
 	cellT *findCell(cellT *head, string key, cellT **prev = NULL);
+	cellT *nextCell(cellT *cp, int & bucketIndex);
 	void expandAndRehash();
 	void copyOtherEntries(const Map & rhs);
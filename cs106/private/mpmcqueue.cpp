@@ -0,0 +1,144 @@
+/*
+ * File: private/mpmcqueue.cpp
+ * ---------------------------
+ * This file contains the implementation of the mpmcqueue.h interface.
+ * Because of the way C++ compiles templates, this code must be
+ * available to the compiler when it reads the header file.
+ */
+
+#ifdef _mpmcqueue_h
+
+template <typename ElemType>
+MPMCQueue<ElemType>::MPMCQueue(int capacity) {
+	if (capacity <= 0) Error("MPMCQueue capacity must be positive");
+	long size = 1;
+	while (size < capacity) {
+		size *= 2;
+	}
+	cells = new cellT[size];
+	for (long i = 0; i < size; i++) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	mask = size - 1;
+	enqueuePos.store(0, std::memory_order_relaxed);
+	dequeuePos.store(0, std::memory_order_relaxed);
+}
+
+template <typename ElemType>
+MPMCQueue<ElemType>::~MPMCQueue() {
+	delete[] cells;
+}
+
+template <typename ElemType>
+int MPMCQueue<ElemType>::capacity() {
+	return int(mask + 1);
+}
+
+template <typename ElemType>
+int MPMCQueue<ElemType>::size() {
+	long d = dequeuePos.load(std::memory_order_acquire);
+	long e = enqueuePos.load(std::memory_order_acquire);
+	return (e > d) ? int(e - d) : 0;
+}
+
+template <typename ElemType>
+bool MPMCQueue<ElemType>::isEmpty() {
+	return size() == 0;
+}
+
+/*
+ * Implementation notes: tryEnqueue, tryDequeue
+ * --------------------------------------------
+ * A producer looks at the cell for the next enqueue position.  If its
+ * sequence says the cell is ready, the producer tries to claim the
+ * position by advancing enqueuePos with a compare-and-swap; only one
+ * producer can win it, and the losers try again at the position they
+ * find there instead.  The winner owns the cell until it stores the
+ * element and publishes it by advancing the sequence with a release
+ * store, which pairs with the acquire load in the consumer that later
+ * takes it.  A sequence behind the position means the cell still holds
+ * an element from the last trip around the ring, so the queue is full.
+ * Consumers work the same way from the other side.  Because the
+ * position advances only on a successful compare-and-swap and each
+ * cell has a single owner at a time, no thread ever waits on a lock.
+ */
+
+template <typename ElemType>
+bool MPMCQueue<ElemType>::tryEnqueue(ElemType elem) {
+	return tryPush(elem);
+}
+
+template <typename ElemType>
+bool MPMCQueue<ElemType>::tryPush(ElemType & elem) {
+	long pos = enqueuePos.load(std::memory_order_relaxed);
+	cellT *cell;
+	while (true) {
+		cell = &cells[pos & mask];
+		long seq = cell->sequence.load(std::memory_order_acquire);
+		long diff = seq - pos;
+		if (diff == 0) {
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+			                                     std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			return false;
+		} else {
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	cell->elem = std::move(elem);
+	cell->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename ElemType>
+bool MPMCQueue<ElemType>::tryDequeue(ElemType & elem) {
+	long pos = dequeuePos.load(std::memory_order_relaxed);
+	cellT *cell;
+	while (true) {
+		cell = &cells[pos & mask];
+		long seq = cell->sequence.load(std::memory_order_acquire);
+		long diff = seq - (pos + 1);
+		if (diff == 0) {
+			if (dequeuePos.compare_exchange_weak(pos, pos + 1,
+			                                     std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			return false;
+		} else {
+			pos = dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+	elem = std::move(cell->elem);
+	cell->sequence.store(pos + mask + 1, std::memory_order_release);
+	return true;
+}
+
+/*
+ * Implementation notes: enqueue, dequeue
+ * --------------------------------------
+ * The blocking versions retry the nonblocking ones, spinning briefly
+ * and then yielding the processor between tries, so that waiting
+ * threads leave the processor to the ones they are waiting for when
+ * there are more threads than cores.
+ */
+
+template <typename ElemType>
+void MPMCQueue<ElemType>::enqueue(ElemType elem) {
+	for (int tries = 0; !tryPush(elem); tries++) {
+		if (tries >= SPINS_BEFORE_YIELD) std::this_thread::yield();
+	}
+}
+
+template <typename ElemType>
+ElemType MPMCQueue<ElemType>::dequeue() {
+	ElemType elem;
+	for (int tries = 0; !tryDequeue(elem); tries++) {
+		if (tries >= SPINS_BEFORE_YIELD) std::this_thread::yield();
+	}
+	return elem;
+}
+
+#endif
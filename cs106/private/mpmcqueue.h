@@ -0,0 +1,46 @@
+/*
+ * File: private/mpmcqueue.h
+ * -------------------------
+ * This file contains the private section of the mpmcqueue.h interface.
+ * This portion of the class definition is taken out of the mpmcqueue.h
+ * header so that the client need not have to see all of these
+ * details.
+ */
+
+/*
+ * Copying is not supported: the queue belongs to the threads that
+ * share it.
+ */
+	DISALLOW_COPYING(MPMCQueue)
+
+/*
+ * Implementation notes: data layout
+ * ---------------------------------
+ * enqueuePos counts the slots ever claimed by producers and dequeuePos
+ * the slots ever claimed by consumers; position p lives in cells[p &
+ * mask].  The sequence number in each cell says what may happen to it
+ * next: a cell whose sequence equals p is empty and ready to be filled
+ * at position p, and one whose sequence equals p + 1 holds the element
+ * for position p, ready to be taken.  Emptying a cell sets its sequence
+ * to p + capacity, ready for the producer that comes around to it on
+ * the next trip around the ring.
+ *
+ * The producers contend for enqueuePos and the consumers for
+ * dequeuePos, so the two counters sit on separate cache lines to keep
+ * each side from slowing the other.
+ */
+	static const int CACHE_LINE_BYTES = 64;
+	static const int SPINS_BEFORE_YIELD = 64;
+
+	struct cellT {
+		std::atomic<long> sequence;
+		ElemType elem;
+	};
+
+	cellT *cells;
+	long mask;
+
+	alignas(CACHE_LINE_BYTES) std::atomic<long> enqueuePos;
+	alignas(CACHE_LINE_BYTES) std::atomic<long> dequeuePos;
+
+	bool tryPush(ElemType & elem);
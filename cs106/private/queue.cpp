@@ -12,20 +12,24 @@
 /*
  * Queue class implementation
  * --------------------------
- * The Queue is internally managed as a singly linked list of cells, with a
- * head and tail pointer.  The front of the queue is at the head; the end
- * is at the tail.
+ * The Queue is internally managed as a ring buffer: an array whose
+ * elements run from index head to the end of the queue, wrapping
+ * around from the end of the array to the start.  The element at
+ * position i in the queue is at index (head + i) & (capacity - 1).
+ * When the array fills, ensureCapacity moves the elements to one
+ * twice the size, straightened out so that head is at index 0.  An
+ * empty queue with no capacity allocates no array at all.
  */
 
 template <typename ElemType>
 Queue<ElemType>::Queue() {
-	head = tail = NULL;
-	count = 0;
+	elements = NULL;
+	capacity = head = count = 0;
 }
 
 template <typename ElemType>
 Queue<ElemType>::~Queue() {
-	deleteCells();
+	if (elements != NULL) delete[] elements;
 }
 
 template <typename ElemType>
@@ -40,25 +44,16 @@ bool Queue<ElemType>::isEmpty() {
 
 template <typename ElemType>
 void Queue<ElemType>::enqueue(ElemType elem) {
-	cellT *newOne = new cellT;
-	newOne->elem = elem;
-	newOne->next = NULL;
-	if (head != NULL) {
-		tail->next = newOne;
-	} else {
-		head = newOne;
-	}
-	tail = newOne;
+	if (count == capacity) ensureCapacity(count + 1);
+	elements[(head + count) & (capacity - 1)] = std::move(elem);
 	count++;
 }
 
 template <typename ElemType>
 ElemType Queue<ElemType>::dequeue() {
 	if (isEmpty()) Error("Attempt to dequeue from empty queue");
-	ElemType first = head->elem;
-	cellT *toDelete = head;
-	head = head->next;
-	delete toDelete;
+	ElemType first = std::move(elements[head]);
+	head = (head + 1) & (capacity - 1);
 	count--;
 	return first;
 }
@@ -66,23 +61,90 @@ ElemType Queue<ElemType>::dequeue() {
 template <typename ElemType>
 ElemType Queue<ElemType>::peek() {
 	if (isEmpty()) Error("Attempt to peek at empty queue");
-	return head->elem;
+	return elements[head];
+}
+
+/*
+ * Implementation notes: enqueueAll, dequeueInto
+ * ---------------------------------------------
+ * Both work on the ring as at most two runs of contiguous elements,
+ * one up to the end of the array and one from its start, so the loops
+ * need no wrapping inside them.
+ */
+
+template <typename ElemType>
+void Queue<ElemType>::enqueueAll(Vector<ElemType> & elems) {
+	int n = elems.size();
+	if (n == 0) return;
+	ensureCapacity(count + n);
+	int tail = (head + count) & (capacity - 1);
+	int firstRun = (capacity - tail < n) ? capacity - tail : n;
+	for (int i = 0; i < firstRun; i++) {
+		elements[tail + i] = elems[i];
+	}
+	for (int i = firstRun; i < n; i++) {
+		elements[i - firstRun] = elems[i];
+	}
+	count += n;
+}
+
+template <typename ElemType>
+void Queue<ElemType>::dequeueInto(Vector<ElemType> & elems, int n) {
+	if (n < 0 || n > count) {
+		Error("Attempt to dequeue " + IntegerToString(n)
+		      + " elements from a queue of size " + IntegerToString(count));
+	}
+	int firstRun = (capacity - head < n) ? capacity - head : n;
+	for (int i = 0; i < firstRun; i++) {
+		elems.add(std::move(elements[head + i]));
+	}
+	for (int i = firstRun; i < n; i++) {
+		elems.add(std::move(elements[i - firstRun]));
+	}
+	if (n > 0) head = (head + n) & (capacity - 1);
+	count -= n;
 }
 
 template <typename ElemType>
 void Queue<ElemType>::clear() {
-	deleteCells();
-	count = 0;
+	if (elements != NULL) delete[] elements;
+	elements = NULL;
+	capacity = head = count = 0;
+}
+
+template <typename ElemType>
+typename Queue<ElemType>::RangeIterator Queue<ElemType>::begin() {
+	return RangeIterator(elements, capacity - 1, head);
 }
 
 template <typename ElemType>
-void Queue<ElemType>::deleteCells() {
-	while (head != NULL) {
-		cellT *next = head->next;
-		delete head;
-		head = next;
+typename Queue<ElemType>::RangeIterator Queue<ElemType>::end() {
+	return RangeIterator(elements, capacity - 1, head + count);
+}
+
+/*
+ * Private method: ensureCapacity
+ * ------------------------------
+ * Makes room in the array for at least needed elements, doubling its
+ * capacity until it is large enough.  The elements are moved to the
+ * start of the new array, in order.
+ */
+
+template <typename ElemType>
+void Queue<ElemType>::ensureCapacity(int needed) {
+	if (needed <= capacity) return;
+	int newCapacity = (capacity == 0) ? INITIAL_CAPACITY : capacity;
+	while (newCapacity < needed) {
+		newCapacity *= 2;
+	}
+	ElemType *newArray = new ElemType[newCapacity];
+	for (int i = 0; i < count; i++) {
+		newArray[i] = std::move(elements[(head + i) & (capacity - 1)]);
 	}
-	tail = NULL;
+	if (elements != NULL) delete[] elements;
+	elements = newArray;
+	capacity = newCapacity;
+	head = 0;
 }
 
 template <typename ElemType>
@@ -96,15 +158,54 @@ const Queue<ElemType> &Queue<ElemType>::operator=(const Queue & rhs) {
 
 template <typename ElemType>
 Queue<ElemType>::Queue(const Queue & rhs) {
-	head = tail = NULL;
-	count = 0;
+	elements = NULL;
+	capacity = head = count = 0;
 	copyOtherData(rhs);
 }
 
+/*
+ * Private method: copyOtherData
+ * -----------------------------
+ * Copies the elements of the other queue into this one, which must be
+ * empty, straightening them out so that the copy's head is at index 0.
+ */
+
 template <typename ElemType>
 void Queue<ElemType>::copyOtherData(const Queue & rhs) {
-	for (cellT *cur = rhs.head; cur != NULL; cur = cur->next) {
-		enqueue(cur->elem);
+	if (rhs.count == 0) return;
+	ensureCapacity(rhs.count);
+	for (int i = 0; i < rhs.count; i++) {
+		elements[i] = rhs.elements[(rhs.head + i) & (rhs.capacity - 1)];
 	}
+	count = rhs.count;
+}
+
+/*
+ * Queue::RangeIterator class implementation
+ * -----------------------------------------
+ */
+
+template <typename ElemType>
+Queue<ElemType>::RangeIterator::RangeIterator(ElemType *array, int arrayMask, int index) {
+	elements = array;
+	mask = arrayMask;
+	position = index;
 }
+
+template <typename ElemType>
+ElemType & Queue<ElemType>::RangeIterator::operator*() {
+	return elements[position & mask];
+}
+
+template <typename ElemType>
+typename Queue<ElemType>::RangeIterator & Queue<ElemType>::RangeIterator::operator++() {
+	position++;
+	return *this;
+}
+
+template <typename ElemType>
+bool Queue<ElemType>::RangeIterator::operator!=(const RangeIterator & other) {
+	return position != other.position;
+}
+
 #endif
@@ -10,6 +10,28 @@
 
 public:
 
+/*
+ * Class: Queue<ElemType>::RangeIterator
+ * -------------------------------------
+ * The iterator returned by begin and end, which has just what the
+ * range-based for loop needs.  It holds a position counted from the
+ * start of the array, which the mask wraps into it, so that the end of
+ * a queue that wraps around is still past its front.
+ */
+	class RangeIterator {
+	public:
+		ElemType & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(ElemType *array, int arrayMask, int index);
+		ElemType *elements;
+		int mask;
+		int position;
+		friend class Queue;
+	};
+
 /*
  * Deep copying support
  * --------------------
@@ -27,13 +49,20 @@ public:
 	Queue(const Queue & rhs);
 
 private:
-	struct cellT {
-		ElemType elem;
-		cellT *next;
-	};
 
-	cellT *head;
-	cellT *tail;
+/*
+ * The elements live in the array elements, which holds capacity
+ * elements and is used as a ring: the front of the queue is at index
+ * head, and the rest follow it, wrapping around from the end of the
+ * array to the start.  capacity is always a power of two, so the
+ * wrapping is a mask rather than a division.
+ */
+	static const int INITIAL_CAPACITY = 16;
+
+	ElemType *elements;
+	int capacity;
+	int head;
 	int count;
-	void deleteCells();
+
+	void ensureCapacity(int needed);
 	void copyOtherData(const Queue & rhs);
@@ -9,49 +9,70 @@
 
 #ifdef _set_h
 
-template <typename ElemType>
-Set<ElemType>::Set(int (*cmp)(ElemType, ElemType)) : bst(cmp) {
-	cmpFn = cmp;
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>::Set(Comparator cmp) : tree(cmp), cmpFn(cmp) {
+	/* Empty */
 }
 
-template <typename ElemType>
-Set<ElemType>::~Set() {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>::~Set() {
 	/* Empty */
 }
 
-template <typename ElemType>
-int Set<ElemType>::size() {
-	return bst.size();
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+int Set<ElemType, TreeType, Comparator>::size() {
+	return tree.size();
 }
 
-template <typename ElemType>
-bool Set<ElemType>::isEmpty() {
-	return bst.isEmpty();
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+bool Set<ElemType, TreeType, Comparator>::isEmpty() {
+	return tree.isEmpty();
 }
 
-template <typename ElemType>
-void Set<ElemType>::add(ElemType element) {
-	bst.add(element);
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::add(ElemType element) {
+	tree.add(element);
 }
 
-template <typename ElemType>
-void Set<ElemType>::remove(ElemType element) {
-	bst.remove(element);
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::remove(ElemType element) {
+	tree.remove(element);
 }
 
-template <typename ElemType>
-bool Set<ElemType>::contains(ElemType element) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+bool Set<ElemType, TreeType, Comparator>::contains(ElemType element) {
 	return find(element) != NULL;
 }
 
-template <typename ElemType>
-ElemType *Set<ElemType>::find(ElemType element) {
-	return bst.find(element);
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+ElemType *Set<ElemType, TreeType, Comparator>::find(ElemType element) {
+	return tree.find(element);
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::clear() {
+	tree.clear();
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+int Set<ElemType, TreeType, Comparator>::rank(ElemType element) {
+	return tree.rank(element);
 }
 
-template <typename ElemType>
-void Set<ElemType>::clear() {
-	bst.clear();
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+ElemType Set<ElemType, TreeType, Comparator>::select(int index) {
+	return tree.select(index);
 }
 
 /*
@@ -59,24 +80,29 @@ void Set<ElemType>::clear() {
  * ------------------------------------
  * The code for equals, isSubsetOf, unionWith, intersectWith, and subtract
  * is similar in structure.  Each one uses an iterator to walk over
- * one (or both) sets, doing add/remove/comparision.
+ * one (or both) sets, doing add/remove/comparision.  The last three
+ * merge the two sets with mergeSets unless one is much smaller than
+ * the other, in which case looking up its elements is cheaper than a
+ * walk over the larger set.
  */
 
-template <typename ElemType>
-bool Set<ElemType>::equals(Set & otherSet) {
-	if (cmpFn != otherSet.cmpFn) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+bool Set<ElemType, TreeType, Comparator>::equals(Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
 		Error("Equals: sets have different comparison functions");
 	}
 	Iterator thisItr = iterator(), otherItr = otherSet.iterator();
 	while (thisItr.hasNext() && otherItr.hasNext()) {
-		if (cmpFn(thisItr.next(), otherItr.next()) != 0) return false;
+		if (cmpFn(thisItr.nextRef(), otherItr.nextRef()) != 0) return false;
 	}
 	return !thisItr.hasNext() && !otherItr.hasNext();
 }
 
-template <typename ElemType>
-bool Set<ElemType>::isSubsetOf(Set & otherSet) {
-	if (cmpFn != otherSet.cmpFn) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+bool Set<ElemType, TreeType, Comparator>::isSubsetOf(Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
 		Error("isSubsetOf: sets have different comparison functions");
 	}
 	Iterator iter = iterator();
@@ -86,14 +112,21 @@ bool Set<ElemType>::isSubsetOf(Set & otherSet) {
 	return true;
 }
 
-template <typename ElemType>
-void Set<ElemType>::unionWith(Set & otherSet) {
-	if (cmpFn != otherSet.cmpFn) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::unionWith(Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
 		Error("unionWith: sets have different comparison functions");
 	}
-	Iterator iter = otherSet.iterator();
-	while (iter.hasNext()) {
-		add(iter.next());
+	if (otherSet.size() <= size() / MERGE_SIZE_RATIO) {
+		Iterator iter = otherSet.iterator();
+		while (iter.hasNext()) {
+			add(iter.next());
+		}
+	} else {
+		Vector<ElemType> result(size() + otherSet.size());
+		mergeSets(*this, otherSet, MERGE_UNION, result);
+		tree.buildFromSorted(result);
 	}
 }
 
@@ -103,100 +136,303 @@ void Set<ElemType>::unionWith(Set & otherSet) {
  * The most obvious way to write this method (iterating over
  * one set and deleting members that are not in the second)
  * fails because you can't change the contents of a collection
- * over which you're iterating.  This code puts the elements
- * to be deleted in a vector and then deletes those.
+ * over which you're iterating.  This code collects the elements
+ * to be kept in a vector, in order, and then rebuilds the set
+ * from them.  When the other set is much smaller, the elements to
+ * keep are found by looking each of its elements up in this one.
  */
 
-template <typename ElemType>
-void Set<ElemType>::intersectWith(Set & otherSet) {
-	if (cmpFn != otherSet.cmpFn) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::intersectWith(Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
 		Error("intersectWith:"
 		      " sets have different comparison functions");
 	}
-	Iterator iter = iterator();
-	Vector<ElemType> toDelete;
-	while (iter.hasNext()) {
-		ElemType elem = iter.next();
-		if (!otherSet.contains(elem)) toDelete.add(elem);
-	}
-	for (int i = 0; i < toDelete.size(); i++) {
-		remove(toDelete[i]);
+	Vector<ElemType> result;
+	if (otherSet.size() <= size() / MERGE_SIZE_RATIO) {
+		Iterator iter = otherSet.iterator();
+		while (iter.hasNext()) {
+			ElemType *elem = find(iter.nextRef());
+			if (elem != NULL) result.add(*elem);
+		}
+	} else if (size() <= otherSet.size() / MERGE_SIZE_RATIO) {
+		Iterator iter = iterator();
+		while (iter.hasNext()) {
+			const ElemType & elem = iter.nextRef();
+			if (otherSet.contains(elem)) result.add(elem);
+		}
+	} else {
+		mergeSets(*this, otherSet, MERGE_INTERSECTION, result);
 	}
+	tree.buildFromSorted(result);
 }
 
-template <typename ElemType>
-void Set<ElemType>::intersect(Set & otherSet) {
-	if (cmpFn != otherSet.cmpFn) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::intersect(Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
 		Error("intersect: sets have different comparison functions");
 	}
 	intersectWith(otherSet);
 }
 
-template <typename ElemType>
-void Set<ElemType>::subtract(Set & otherSet) {
-	if (cmpFn != otherSet.cmpFn) {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::subtract(Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
 		Error("subtract: sets have different comparison functions");
 	}
-	Iterator iter = otherSet.iterator();
-	while (iter.hasNext()) {
-		remove(iter.next());
+	if (otherSet.size() <= size() / MERGE_SIZE_RATIO) {
+		Iterator iter = otherSet.iterator();
+		while (iter.hasNext()) {
+			remove(iter.next());
+		}
+		return;
+	}
+	Vector<ElemType> result;
+	if (size() <= otherSet.size() / MERGE_SIZE_RATIO) {
+		Iterator iter = iterator();
+		while (iter.hasNext()) {
+			const ElemType & elem = iter.nextRef();
+			if (!otherSet.contains(elem)) result.add(elem);
+		}
+	} else {
+		mergeSets(*this, otherSet, MERGE_DIFFERENCE, result);
+	}
+	tree.buildFromSorted(result);
+}
+
+/*
+ * Implementation notes: operators +, *, -
+ * ---------------------------------------
+ * The operators don't change either set, but the iterators they use
+ * aren't available on a const set, so const is cast away.
+ */
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>
+Set<ElemType, TreeType, Comparator>::operator+(const Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
+		Error("operator+: sets have different comparison functions");
+	}
+	Set & other = const_cast<Set &>(otherSet);
+	Set result(cmpFn);
+	Vector<ElemType> elems(size() + other.size());
+	mergeSets(*this, other, MERGE_UNION, elems);
+	result.tree.buildFromSorted(elems);
+	return result;
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>
+Set<ElemType, TreeType, Comparator>::operator*(const Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
+		Error("operator*: sets have different comparison functions");
+	}
+	Set & other = const_cast<Set &>(otherSet);
+	Set result(cmpFn);
+	Vector<ElemType> elems;
+	mergeSets(*this, other, MERGE_INTERSECTION, elems);
+	result.tree.buildFromSorted(elems);
+	return result;
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>
+Set<ElemType, TreeType, Comparator>::operator-(const Set & otherSet) {
+	if (!SameComparator(cmpFn, otherSet.cmpFn)) {
+		Error("operator-: sets have different comparison functions");
+	}
+	Set & other = const_cast<Set &>(otherSet);
+	Set result(cmpFn);
+	Vector<ElemType> elems(size());
+	mergeSets(*this, other, MERGE_DIFFERENCE, elems);
+	result.tree.buildFromSorted(elems);
+	return result;
+}
+
+/*
+ * Implementation notes: mergeSets
+ * -------------------------------
+ * Walks the two sets in order at once, as in the merge step of a merge
+ * sort, adding to result the elements that belong in the union,
+ * intersection or difference of one and two.  The elements come out
+ * in increasing order, ready for buildFromSorted.  When an element is
+ * in both sets, a union takes the copy from two, which is the one that
+ * unionWith has always kept.
+ */
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::mergeSets(Set & one, Set & two, mergeT kind,
+                                                   Vector<ElemType> & result) {
+	Iterator iter1 = one.iterator();
+	Iterator iter2 = two.iterator();
+	const ElemType *elem1 = nextOrNull(iter1);
+	const ElemType *elem2 = nextOrNull(iter2);
+	while (elem1 != NULL && elem2 != NULL) {
+		int sign = cmpFn(*elem1, *elem2);
+		if (sign < 0) {
+			if (kind != MERGE_INTERSECTION) result.add(*elem1);
+			elem1 = nextOrNull(iter1);
+		} else if (sign > 0) {
+			if (kind == MERGE_UNION) result.add(*elem2);
+			elem2 = nextOrNull(iter2);
+		} else {
+			if (kind == MERGE_UNION) result.add(*elem2);
+			if (kind == MERGE_INTERSECTION) result.add(*elem1);
+			elem1 = nextOrNull(iter1);
+			elem2 = nextOrNull(iter2);
+		}
+	}
+	if (kind == MERGE_INTERSECTION) return;
+	for (; elem1 != NULL; elem1 = nextOrNull(iter1)) {
+		result.add(*elem1);
+	}
+	if (kind == MERGE_DIFFERENCE) return;
+	for (; elem2 != NULL; elem2 = nextOrNull(iter2)) {
+		result.add(*elem2);
 	}
 }
 
-template <typename ElemType>
-void Set<ElemType>::mapAll(void (*fn)(ElemType)) {
-	bst.mapAll(fn);
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+const ElemType *Set<ElemType, TreeType, Comparator>::nextOrNull(Iterator & iter) {
+	return (iter.hasNext()) ? &iter.nextRef() : NULL;
 }
 
-template <typename ElemType>
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+void Set<ElemType, TreeType, Comparator>::mapAll(void (*fn)(ElemType)) {
+	tree.mapAll(fn);
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
 template <typename ClientDataType>
-void Set<ElemType>::mapAll(void (*fn)(ElemType, ClientDataType &),
+void Set<ElemType, TreeType, Comparator>::mapAll(void (*fn)(ElemType, ClientDataType &),
                            ClientDataType & data) {
-	bst.mapAll(fn, data);
+	tree.mapAll(fn, data);
 }
 
 /*
  * Set::Iterator class implementation
  * ----------------------------------
  * The Iterator for Set relies on the underlying implementation of the
- * Iterator for the BST class.
+ * Iterator for its tree class, BST or BTree.
  */
 
-template <typename ElemType>
-Set<ElemType>::Iterator::Iterator() {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>::Iterator::Iterator() {
 	/* Empty */
 }
 
-template <typename ElemType>
-typename Set<ElemType>::Iterator Set<ElemType>::iterator() {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::Iterator Set<ElemType, TreeType, Comparator>::iterator() {
 	return Iterator(this);
 }
 
-template <typename ElemType>
-Set<ElemType>::Iterator::Iterator(Set *setptr) {
-	iterator = setptr->bst.iterator();
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>::Iterator::Iterator(Set *setptr) {
+	iterator = setptr->tree.iterator();
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::Iterator
+Set<ElemType, TreeType, Comparator>::reverseIterator() {
+	Iterator iter;
+	iter.iterator = tree.reverseIterator();
+	return iter;
 }
 
-template <typename ElemType>
-bool Set<ElemType>::Iterator::hasNext() {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::Iterator
+Set<ElemType, TreeType, Comparator>::iteratorFrom(ElemType lo) {
+	Iterator iter;
+	iter.iterator = tree.iteratorFrom(lo);
+	return iter;
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::Iterator
+Set<ElemType, TreeType, Comparator>::iteratorRange(ElemType lo, ElemType hi) {
+	Iterator iter;
+	iter.iterator = tree.iteratorRange(lo, hi);
+	return iter;
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+bool Set<ElemType, TreeType, Comparator>::Iterator::hasNext() {
 	return iterator.hasNext();
 }
 
-template <typename ElemType>
-ElemType Set<ElemType>::Iterator::next() {
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+ElemType Set<ElemType, TreeType, Comparator>::Iterator::next() {
 	return iterator.next();
 }
 
-template <typename ElemType>
-ElemType Set<ElemType>::foreachHook(FE_State & fe) {
-	if (fe.state == 0) fe.iter = new Iterator(this);
-	if (((Iterator *) fe.iter)->hasNext()) {
-		fe.state = 1;
-		return ((Iterator *) fe.iter)->next();
-	} else {
-		fe.state = 2;
-		return ElemType();
-	}
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+const ElemType & Set<ElemType, TreeType, Comparator>::Iterator::nextRef() {
+	return iterator.nextRef();
+}
+
+/*
+ * Set::RangeIterator class implementation
+ * ---------------------------------------
+ */
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::RangeIterator
+Set<ElemType, TreeType, Comparator>::begin() {
+	return RangeIterator(tree.begin());
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::RangeIterator
+Set<ElemType, TreeType, Comparator>::end() {
+	return RangeIterator(tree.end());
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+Set<ElemType, TreeType, Comparator>::RangeIterator::RangeIterator(
+		typename TreeType<ElemType, Comparator>::RangeIterator treeIter) : iterator(treeIter) {
+	/* Empty */
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+const ElemType & Set<ElemType, TreeType, Comparator>::RangeIterator::operator*() {
+	return *iterator;
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+typename Set<ElemType, TreeType, Comparator>::RangeIterator &
+Set<ElemType, TreeType, Comparator>::RangeIterator::operator++() {
+	++iterator;
+	return *this;
+}
+
+template <typename ElemType, template <typename, typename> class TreeType,
+          typename Comparator>
+bool Set<ElemType, TreeType, Comparator>::RangeIterator::operator!=(const RangeIterator & other) {
+	return iterator != other.iterator;
 }
 
 #endif
@@ -23,19 +23,37 @@ public:
  * This interface defines a nested class within the Set template that
  * provides iterator access to the Set contents.
  */
-	class Iterator : public FE_Iterator {
+	class Iterator {
 	public:
 		Iterator();
 		bool hasNext();
 		ElemType next();
+		const ElemType & nextRef();
 
 	private:
 		Iterator(Set *setptr);
-		typename BST<ElemType>::Iterator iterator;
+		typename TreeType<ElemType, Comparator>::Iterator iterator;
 		friend class Set;
 	};
 	friend class Iterator;
-	ElemType foreachHook(FE_State & _fe);
+
+/*
+ * Class: Set<ElemType>::RangeIterator
+ * -----------------------------------
+ * The iterator returned by begin and end, which passes each step on to
+ * the iterator of the same name in the tree that holds the elements.
+ */
+	class RangeIterator {
+	public:
+		const ElemType & operator*();
+		RangeIterator & operator++();
+		bool operator!=(const RangeIterator & other);
+
+	private:
+		RangeIterator(typename TreeType<ElemType, Comparator>::RangeIterator treeIter);
+		typename TreeType<ElemType, Comparator>::RangeIterator iterator;
+		friend class Set;
+	};
 
 /*
  * Deep copying support
@@ -53,5 +71,17 @@ public:
  */
 
 private:
-	BST<ElemType> bst;
-	int (*cmpFn)(ElemType, ElemType);
+
+/*
+ * The kinds of merge that mergeSets can do, and the size ratio beyond
+ * which an operation on two sets looks up the elements of the smaller
+ * one instead of merging.
+ */
+	enum mergeT { MERGE_UNION, MERGE_INTERSECTION, MERGE_DIFFERENCE };
+	static const int MERGE_SIZE_RATIO = 16;
+
+	TreeType<ElemType, Comparator> tree;
+	Comparator cmpFn;
+
+	void mergeSets(Set & one, Set & two, mergeT kind, Vector<ElemType> & result);
+	static const ElemType *nextOrNull(Iterator & iter);
@@ -0,0 +1,114 @@
+/*
+ * File: private/spscqueue.cpp
+ * ---------------------------
+ * This file contains the implementation of the spscqueue.h interface.
+ * Because of the way C++ compiles templates, this code must be
+ * available to the compiler when it reads the header file.
+ */
+
+#ifdef _spscqueue_h
+
+template <typename ElemType>
+SPSCQueue<ElemType>::SPSCQueue(int capacity) {
+	if (capacity <= 0) Error("SPSCQueue capacity must be positive");
+	long size = 1;
+	while (size < capacity) {
+		size *= 2;
+	}
+	elements = new ElemType[size];
+	mask = size - 1;
+	head.store(0, std::memory_order_relaxed);
+	tail.store(0, std::memory_order_relaxed);
+	cachedHead = cachedTail = 0;
+}
+
+template <typename ElemType>
+SPSCQueue<ElemType>::~SPSCQueue() {
+	delete[] elements;
+}
+
+template <typename ElemType>
+int SPSCQueue<ElemType>::capacity() {
+	return int(mask + 1);
+}
+
+template <typename ElemType>
+int SPSCQueue<ElemType>::size() {
+	long h = head.load(std::memory_order_acquire);
+	long t = tail.load(std::memory_order_acquire);
+	return (t > h) ? int(t - h) : 0;
+}
+
+template <typename ElemType>
+bool SPSCQueue<ElemType>::isEmpty() {
+	return size() == 0;
+}
+
+/*
+ * Implementation notes: tryEnqueue, tryDequeue
+ * --------------------------------------------
+ * The producer writes the element and then publishes it by advancing
+ * tail with a release store; the consumer's acquire load of tail is
+ * what makes the element visible to it.  The consumer hands the slot
+ * back the same way through head.  Each side first checks against its
+ * cached copy of the other's counter and reloads the real one only
+ * when that copy says there is no room or nothing to take.  tryPush
+ * takes the element by reference and moves from it only once there is
+ * room, so enqueue can retry it without copying the element each time.
+ */
+
+template <typename ElemType>
+bool SPSCQueue<ElemType>::tryEnqueue(ElemType elem) {
+	return tryPush(elem);
+}
+
+template <typename ElemType>
+bool SPSCQueue<ElemType>::tryPush(ElemType & elem) {
+	long t = tail.load(std::memory_order_relaxed);
+	if (t - cachedHead > mask) {
+		cachedHead = head.load(std::memory_order_acquire);
+		if (t - cachedHead > mask) return false;
+	}
+	elements[t & mask] = std::move(elem);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename ElemType>
+bool SPSCQueue<ElemType>::tryDequeue(ElemType & elem) {
+	long h = head.load(std::memory_order_relaxed);
+	if (h == cachedTail) {
+		cachedTail = tail.load(std::memory_order_acquire);
+		if (h == cachedTail) return false;
+	}
+	elem = std::move(elements[h & mask]);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+/*
+ * Implementation notes: enqueue, dequeue
+ * --------------------------------------
+ * The blocking versions retry the nonblocking ones, spinning briefly
+ * and then yielding the processor between tries, so a thread that
+ * waits for long does not starve the one it is waiting for when the
+ * two share a core.
+ */
+
+template <typename ElemType>
+void SPSCQueue<ElemType>::enqueue(ElemType elem) {
+	for (int tries = 0; !tryPush(elem); tries++) {
+		if (tries >= SPINS_BEFORE_YIELD) std::this_thread::yield();
+	}
+}
+
+template <typename ElemType>
+ElemType SPSCQueue<ElemType>::dequeue() {
+	ElemType elem;
+	for (int tries = 0; !tryDequeue(elem); tries++) {
+		if (tries >= SPINS_BEFORE_YIELD) std::this_thread::yield();
+	}
+	return elem;
+}
+
+#endif
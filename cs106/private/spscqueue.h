@@ -0,0 +1,41 @@
+/*
+ * File: private/spscqueue.h
+ * -------------------------
+ * This file contains the private section of the spscqueue.h interface.
+ * This portion of the class definition is taken out of the spscqueue.h
+ * header so that the client need not have to see all of these
+ * details.
+ */
+
+/*
+ * Copying is not supported: the queue belongs to the two threads it
+ * connects.
+ */
+	DISALLOW_COPYING(SPSCQueue)
+
+/*
+ * Implementation notes: data layout
+ * ---------------------------------
+ * head counts the elements ever dequeued and tail the elements ever
+ * enqueued, so tail - head is the size of the queue, and position p
+ * lives at index p & mask.  Only the consumer writes head and only the
+ * producer writes tail.  Each one sits on a cache line of its own,
+ * together with that thread's last look at the other counter, so the
+ * two threads do not fight over a line and each one reads the other's
+ * counter only when its cached copy says the queue is full or empty.
+ * The alignment also rounds the size of the whole object up to a
+ * whole number of cache lines, so tail has its line to itself.
+ */
+	static const int CACHE_LINE_BYTES = 64;
+	static const int SPINS_BEFORE_YIELD = 64;
+
+	ElemType *elements;
+	long mask;
+
+	alignas(CACHE_LINE_BYTES) std::atomic<long> head;
+	long cachedTail;
+
+	alignas(CACHE_LINE_BYTES) std::atomic<long> tail;
+	long cachedHead;
+
+	bool tryPush(ElemType & elem);
@@ -12,53 +12,141 @@
 /*
  * Stack class implementation
  * ---------------------------
- * The Stack is internally managed using a Vector. This layered
- * implementation makes the job quite trivial, most methods are
- * one-liners.
+ * The Stack keeps its elements in one contiguous array, starting in
+ * the buffer inside the object and moving to the heap when it fills.
+ * Slots beyond count hold no element, so push constructs the new top
+ * in place and pop destroys it after moving it out.
  */
 
-template <typename ElemType>
-Stack<ElemType>::Stack() {
-	/* Empty */
+template <typename ElemType, int INLINE_CAPACITY>
+Stack<ElemType, INLINE_CAPACITY>::Stack() {
+	elements = inlineElements();
+	capacity = INLINE_CAPACITY;
+	count = 0;
 }
 
-template <typename ElemType>
-Stack<ElemType>::~Stack() {
-	/* Empty */
+template <typename ElemType, int INLINE_CAPACITY>
+Stack<ElemType, INLINE_CAPACITY>::~Stack() {
+	clear();
 }
 
-template <typename ElemType>
-int Stack<ElemType>::size() {
-	return elems.size();
+template <typename ElemType, int INLINE_CAPACITY>
+int Stack<ElemType, INLINE_CAPACITY>::size() {
+	return count;
 }
 
-template <typename ElemType>
-bool Stack<ElemType>::isEmpty() {
-	return size() == 0;
+template <typename ElemType, int INLINE_CAPACITY>
+bool Stack<ElemType, INLINE_CAPACITY>::isEmpty() {
+	return count == 0;
 }
 
-template <typename ElemType>
-void Stack<ElemType>::push(ElemType elem) {
-	elems.add(elem);
+template <typename ElemType, int INLINE_CAPACITY>
+void Stack<ElemType, INLINE_CAPACITY>::push(ElemType elem) {
+	if (count == capacity) grow();
+	new (elements + count) ElemType(std::move(elem));
+	count++;
 }
 
-template <typename ElemType>
-ElemType Stack<ElemType>::pop() {
+template <typename ElemType, int INLINE_CAPACITY>
+ElemType Stack<ElemType, INLINE_CAPACITY>::pop() {
 	if (isEmpty()) Error("Attempt to pop from empty stack");
-	ElemType top = elems[elems.size()-1];
-	elems.removeAt(elems.size()-1);
+	count--;
+	ElemType top = std::move(elements[count]);
+	elements[count].~ElemType();
 	return top;
 }
 
-template <typename ElemType>
-ElemType Stack<ElemType>::peek() {
+template <typename ElemType, int INLINE_CAPACITY>
+ElemType & Stack<ElemType, INLINE_CAPACITY>::peek() {
 	if (isEmpty()) Error("Attempt to peek at empty stack");
-	return elems[elems.size()-1];
+	return elements[count - 1];
 }
 
-template <typename ElemType>
-void Stack<ElemType>::clear() {
-	elems.clear();
+/*
+ * Implementation notes: clear
+ * ---------------------------
+ * Besides destroying the elements, clear gives back any heap array,
+ * so the stack returns to the state of a new one.
+ */
+
+template <typename ElemType, int INLINE_CAPACITY>
+void Stack<ElemType, INLINE_CAPACITY>::clear() {
+	for (int i = 0; i < count; i++) {
+		elements[i].~ElemType();
+	}
+	count = 0;
+	if (elements != inlineElements()) {
+		std::allocator<ElemType>().deallocate(elements, capacity);
+		elements = inlineElements();
+		capacity = INLINE_CAPACITY;
+	}
+}
+
+template <typename ElemType, int INLINE_CAPACITY>
+ElemType *Stack<ElemType, INLINE_CAPACITY>::begin() {
+	return elements;
+}
+
+template <typename ElemType, int INLINE_CAPACITY>
+ElemType *Stack<ElemType, INLINE_CAPACITY>::end() {
+	return elements + count;
+}
+
+template <typename ElemType, int INLINE_CAPACITY>
+ElemType *Stack<ElemType, INLINE_CAPACITY>::inlineElements() {
+	return reinterpret_cast<ElemType *>(inlineBuffer);
+}
+
+/*
+ * Private method: grow
+ * --------------------
+ * Moves the elements to a heap array twice the size of the current one
+ * (or 16, if that is more), destroying the moved-from originals.
+ */
+
+template <typename ElemType, int INLINE_CAPACITY>
+void Stack<ElemType, INLINE_CAPACITY>::grow() {
+	int newCapacity = (capacity < 8) ? 16 : capacity * 2;
+	ElemType *newArray = std::allocator<ElemType>().allocate(newCapacity);
+	for (int i = 0; i < count; i++) {
+		new (newArray + i) ElemType(std::move(elements[i]));
+		elements[i].~ElemType();
+	}
+	if (elements != inlineElements()) {
+		std::allocator<ElemType>().deallocate(elements, capacity);
+	}
+	elements = newArray;
+	capacity = newCapacity;
+}
+
+template <typename ElemType, int INLINE_CAPACITY>
+const Stack<ElemType, INLINE_CAPACITY> &
+Stack<ElemType, INLINE_CAPACITY>::operator=(const Stack & rhs) {
+	if (this != &rhs) {
+		clear();
+		copyOtherData(rhs);
+	}
+	return *this;
+}
+
+template <typename ElemType, int INLINE_CAPACITY>
+Stack<ElemType, INLINE_CAPACITY>::Stack(const Stack & rhs) {
+	elements = inlineElements();
+	capacity = INLINE_CAPACITY;
+	count = 0;
+	copyOtherData(rhs);
+}
+
+template <typename ElemType, int INLINE_CAPACITY>
+void Stack<ElemType, INLINE_CAPACITY>::copyOtherData(const Stack & rhs) {
+	if (rhs.count > capacity) {
+		elements = std::allocator<ElemType>().allocate(rhs.count);
+		capacity = rhs.count;
+	}
+	for (int i = 0; i < rhs.count; i++) {
+		new (elements + i) ElemType(rhs.elements[i]);
+		count++;
+	}
 }
 
 #endif
@@ -13,20 +13,36 @@ public:
 /*
  * Deep copying support
  * --------------------
- * Because all data members have correct behavior on operator=
- * and copy constructor, the default as synthesized by
- * the compiler make a correct copy of the Stack. When pass/return
- * stacks by value, or assign one to another, the entire contents
- * of the stack, including all elements, are copied. Each stack
+ * This copy constructor and operator= are defined to make a
+ * deep copy, making it possible to pass/return stacks by value
+ * and assign from one stack to another. The entire contents of
+ * the stack, including all elements, are copied. Each stack
  * element is copied from the original stack to the copy using
- * assignment (operator=). Making copies is generally avoided
+ * its copy constructor. Making copies is generally avoided
  * because of the expense and thus, stacks are typically passed by
  * reference, however, when a copy is needed, these operations
- * correctly are supported.
- *
- * const Stack & operator=(const Stack & rhs);
- * Stack(const Stack & rhs);
+ * are supported.
  */
+	const Stack & operator=(const Stack & rhs);
+	Stack(const Stack & rhs);
 
 private:
-	Vector<ElemType> elems;
+
+/*
+ * The elements live in the array elements, bottom first, which has
+ * room for capacity of them.  While the stack fits, elements points
+ * at inlineBuffer inside the object; past that, it points at an array
+ * on the heap that doubles as needed.  Neither array is constructed
+ * as a whole: each element is constructed in place when it is pushed
+ * and destroyed when it is popped, so unused slots cost nothing.
+ */
+	static const int INLINE_SLOTS = (INLINE_CAPACITY > 0) ? INLINE_CAPACITY : 1;
+
+	ElemType *elements;
+	int capacity;
+	int count;
+	alignas(ElemType) char inlineBuffer[INLINE_SLOTS * sizeof(ElemType)];
+
+	ElemType *inlineElements();
+	void grow();
+	void copyOtherData(const Stack & rhs);
@@ -0,0 +1,455 @@
+/*
+ * File: private/threadpool.cpp
+ * ----------------------------
+ * This file contains the implementation of the threadpool.h interface.
+ * Because of the way C++ compiles templates, this code must be
+ * available to the compiler when it reads the header file.  The
+ * methods that are not templates are defined inline so that the header
+ * can be included in more than one file.
+ */
+
+#ifdef _threadpool_h
+
+/*
+ * Future methods
+ * --------------
+ */
+
+template <typename ResultType>
+Future<ResultType>::Future() {
+	pool = NULL;
+}
+
+template <typename ResultType>
+bool Future<ResultType>::isReady() {
+	return state && state->ready.load(std::memory_order_acquire);
+}
+
+template <typename ResultType>
+void Future<ResultType>::wait() {
+	if (!state) Error("Future refers to no task");
+	stateT *sp = state.get();
+	pool->helpUntil([sp] { return sp->ready.load(std::memory_order_acquire); });
+}
+
+template <typename ResultType>
+ResultType Future<ResultType>::get() {
+	wait();
+	if (state->error) std::rethrow_exception(state->error);
+	if constexpr (std::is_void<ResultType>::value) {
+		return;
+	} else {
+		return state->value;
+	}
+}
+
+/*
+ * ThreadPool construction and destruction
+ * ---------------------------------------
+ */
+
+inline ThreadPool::ThreadPool(int numThreads) : injected(INJECTED_CAPACITY) {
+	if (numThreads <= 0) numThreads = std::thread::hardware_concurrency();
+	if (numThreads <= 0) numThreads = 1;
+	count = numThreads;
+	stopping.store(false);
+	epoch.store(0);
+	sleepers.store(0);
+	waiters.store(0);
+	nextVictim.store(0);
+	workers = new workerT *[count];
+	for (int i = 0; i < count; i++) {
+		workers[i] = new workerT;
+		workers[i]->pool = this;
+		workers[i]->index = i;
+	}
+	for (int i = 0; i < count; i++) {
+		workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, workers[i]);
+	}
+}
+
+inline ThreadPool::~ThreadPool() {
+	stopping.store(true);
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		wakeup.notify_all();
+	}
+	for (int i = 0; i < count; i++) {
+		workers[i]->thread.join();
+	}
+	for (int i = 0; i < count; i++) {
+		delete workers[i];
+	}
+	delete[] workers;
+}
+
+inline ThreadPool & ThreadPool::shared() {
+	static ThreadPool pool;
+	return pool;
+}
+
+inline int ThreadPool::numThreads() {
+	return count;
+}
+
+/*
+ * Implementation notes: WorkDeque
+ * -------------------------------
+ * top and bottom only ever increase, apart from take briefly lowering
+ * bottom to claim a task, and the deque holds the tasks at positions
+ * top up to bottom.  take and steal both race for the last task: take
+ * lowers bottom before reading top, steal reads top before bottom, and
+ * because those accesses are sequentially consistent at least one of
+ * them sees the other and the compare-and-swap on top picks a single
+ * winner.  push publishes the task with a release store to bottom.
+ */
+
+inline ThreadPool::WorkDeque::WorkDeque() {
+	arrayT *a = new arrayT;
+	a->capacity = INITIAL_CAPACITY;
+	a->slots = new std::atomic<taskT *>[INITIAL_CAPACITY];
+	a->older = NULL;
+	array.store(a, std::memory_order_relaxed);
+	top.store(0, std::memory_order_relaxed);
+	bottom.store(0, std::memory_order_relaxed);
+}
+
+inline ThreadPool::WorkDeque::~WorkDeque() {
+	arrayT *a = array.load(std::memory_order_relaxed);
+	while (a != NULL) {
+		arrayT *older = a->older;
+		delete[] a->slots;
+		delete a;
+		a = older;
+	}
+}
+
+inline ThreadPool::WorkDeque::arrayT *
+ThreadPool::WorkDeque::grow(arrayT *old, long t, long b) {
+	arrayT *a = new arrayT;
+	a->capacity = old->capacity * 2;
+	a->slots = new std::atomic<taskT *>[a->capacity];
+	a->older = old;
+	for (long i = t; i < b; i++) {
+		taskT *task = old->slots[i & (old->capacity - 1)].load(std::memory_order_relaxed);
+		a->slots[i & (a->capacity - 1)].store(task, std::memory_order_relaxed);
+	}
+	array.store(a, std::memory_order_release);
+	return a;
+}
+
+inline void ThreadPool::WorkDeque::push(taskT *task) {
+	long b = bottom.load(std::memory_order_relaxed);
+	long t = top.load(std::memory_order_acquire);
+	arrayT *a = array.load(std::memory_order_relaxed);
+	if (b - t >= a->capacity) a = grow(a, t, b);
+	a->slots[b & (a->capacity - 1)].store(task, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+}
+
+inline ThreadPool::taskT *ThreadPool::WorkDeque::take() {
+	long b = bottom.load(std::memory_order_relaxed) - 1;
+	arrayT *a = array.load(std::memory_order_relaxed);
+	bottom.store(b, std::memory_order_seq_cst);
+	long t = top.load(std::memory_order_seq_cst);
+	if (t > b) {
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return NULL;
+	}
+	taskT *task = a->slots[b & (a->capacity - 1)].load(std::memory_order_relaxed);
+	if (t == b) {
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+		                                 std::memory_order_relaxed)) {
+			task = NULL;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return task;
+}
+
+inline ThreadPool::taskT *ThreadPool::WorkDeque::steal() {
+	long t = top.load(std::memory_order_seq_cst);
+	long b = bottom.load(std::memory_order_seq_cst);
+	if (t >= b) return NULL;
+	arrayT *a = array.load(std::memory_order_acquire);
+	taskT *task = a->slots[t & (a->capacity - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+	                                 std::memory_order_relaxed)) {
+		return NULL;
+	}
+	return task;
+}
+
+/*
+ * Implementation notes: scheduling
+ * --------------------------------
+ * A worker looks for work first at the bottom of its own deque, then
+ * in the queue of tasks from outside the pool, and then at the top of
+ * the other workers' deques, starting from a different victim each
+ * time so that the thieves spread out.  A thread outside the pool that
+ * is waiting for its work does the same, minus the first step.  Each
+ * thread records in currentWorker which worker it is, if any, so that
+ * tasks pushed from inside a task go onto the running worker's deque.
+ * A worker that is waiting keeps looking for tasks, since its own work
+ * may be sitting in its deque, but a thread outside the pool soon
+ * blocks so as not to take a core from the workers it is waiting for.
+ */
+
+inline ThreadPool::workerT *& ThreadPool::currentWorker() {
+	static thread_local workerT *current = NULL;
+	return current;
+}
+
+inline ThreadPool::workerT *ThreadPool::ownWorker() {
+	workerT *self = currentWorker();
+	return (self != NULL && self->pool == this) ? self : NULL;
+}
+
+inline void ThreadPool::push(taskT *task) {
+	workerT *self = ownWorker();
+	if (self != NULL) {
+		self->deque.push(task);
+	} else if (!injected.tryEnqueue(task)) {
+		epoch.fetch_add(1);
+		wakeOne();
+		injected.enqueue(task);
+	}
+	epoch.fetch_add(1);
+	if (sleepers.load() > 0) wakeOne();
+}
+
+inline void ThreadPool::wakeOne() {
+	std::lock_guard<std::mutex> lock(sleepLock);
+	wakeup.notify_one();
+}
+
+inline void ThreadPool::notifyWaiters() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (waiters.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<std::mutex> lock(waitLock);
+		finished.notify_all();
+	}
+}
+
+inline ThreadPool::taskT *ThreadPool::findTask(workerT *self) {
+	taskT *task;
+	if (self != NULL) {
+		task = self->deque.take();
+		if (task != NULL) return task;
+	}
+	if (injected.tryDequeue(task)) return task;
+	unsigned first = nextVictim.fetch_add(1, std::memory_order_relaxed);
+	for (int i = 0; i < count; i++) {
+		workerT *victim = workers[(first + i) % count];
+		if (victim == self) continue;
+		task = victim->deque.steal();
+		if (task != NULL) return task;
+	}
+	return NULL;
+}
+
+inline void ThreadPool::workerLoop(workerT *self) {
+	currentWorker() = self;
+	int idle = 0;
+	while (true) {
+		long seen = epoch.load();
+		taskT *task = findTask(self);
+		if (task != NULL) {
+			task->run();
+			delete task;
+			idle = 0;
+			continue;
+		}
+		if (stopping.load()) break;
+		idle++;
+		if (idle < SPINS_BEFORE_YIELD) continue;
+		if (idle < SPINS_BEFORE_YIELD + YIELDS_BEFORE_SLEEP) {
+			std::this_thread::yield();
+			continue;
+		}
+		idle = 0;
+		std::unique_lock<std::mutex> lock(sleepLock);
+		sleepers.fetch_add(1);
+		while (epoch.load() == seen && !stopping.load()) {
+			wakeup.wait(lock);
+		}
+		sleepers.fetch_sub(1);
+	}
+}
+
+template <typename DoneFn>
+void ThreadPool::helpUntil(DoneFn done) {
+	workerT *self = ownWorker();
+	int idle = 0;
+	while (!done()) {
+		taskT *task = findTask(self);
+		if (task != NULL) {
+			task->run();
+			delete task;
+			idle = 0;
+		} else if (++idle < SPINS_BEFORE_YIELD) {
+			continue;
+		} else if (self != NULL) {
+			std::this_thread::yield();
+		} else {
+			std::unique_lock<std::mutex> lock(waitLock);
+			waiters.fetch_add(1);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			while (!done()) {
+				finished.wait(lock);
+			}
+			waiters.fetch_sub(1);
+		}
+	}
+}
+
+/*
+ * Futures
+ * -------
+ */
+
+template <typename FnType>
+Future<decltype(std::declval<FnType &>()())> ThreadPool::submit(FnType fn) {
+	typedef decltype(std::declval<FnType &>()()) resultT;
+	Future<resultT> future;
+	future.pool = this;
+	future.state = std::make_shared<typename Future<resultT>::stateT>();
+	future.state->ready.store(false, std::memory_order_relaxed);
+	futureTaskT<resultT, FnType> *task = new futureTaskT<resultT, FnType>(fn);
+	task->pool = this;
+	task->state = future.state;
+	push(task);
+	return future;
+}
+
+template <typename ResultType, typename FnType>
+void ThreadPool::futureTaskT<ResultType, FnType>::run() {
+	try {
+		if constexpr (std::is_void<ResultType>::value) {
+			fn();
+		} else {
+			state->value = fn();
+		}
+	} catch (...) {
+		state->error = std::current_exception();
+	}
+	state->ready.store(true, std::memory_order_release);
+	pool->notifyWaiters();
+}
+
+/*
+ * Loops and reductions
+ * --------------------
+ */
+
+template <typename BodyFn>
+void ThreadPool::rangeTaskT<BodyFn>::run() {
+	while (long(hi) - lo > loop->grainSize) {
+		int mid = int(lo + (long(hi) - lo) / 2);
+		rangeTaskT *upper = new rangeTaskT;
+		upper->loop = loop;
+		upper->lo = mid;
+		upper->hi = hi;
+		loop->pool->push(upper);
+		hi = mid;
+	}
+	if (!loop->failed.load(std::memory_order_relaxed)) {
+		try {
+			for (int i = lo; i < hi; i++) {
+				(*loop->body)(i);
+			}
+		} catch (...) {
+			if (!loop->failed.exchange(true)) loop->error = std::current_exception();
+		}
+	}
+	ThreadPool *pool = loop->pool;
+	long done = long(hi) - lo;
+	if (loop->remaining.fetch_sub(done, std::memory_order_acq_rel) == done) {
+		pool->notifyWaiters();
+	}
+}
+
+inline int ThreadPool::defaultGrainSize(long size) {
+	long grain = size / (long(count + 1) * RUNS_PER_THREAD);
+	return (grain < 1) ? 1 : int(grain);
+}
+
+template <typename BodyFn>
+void ThreadPool::parallelFor(int start, int end, BodyFn body, int grainSize) {
+	if (end <= start) return;
+	loopT<BodyFn> loop;
+	loop.pool = this;
+	loop.body = &body;
+	loop.grainSize = (grainSize > 0) ? grainSize : defaultGrainSize(long(end) - start);
+	loop.remaining.store(long(end) - start);
+	loop.failed.store(false);
+	rangeTaskT<BodyFn> root;
+	root.loop = &loop;
+	root.lo = start;
+	root.hi = end;
+	root.run();
+	std::atomic<long> *remaining = &loop.remaining;
+	helpUntil([remaining] { return remaining->load(std::memory_order_acquire) == 0; });
+	if (loop.failed.load()) std::rethrow_exception(loop.error);
+}
+
+template <typename ElemType, typename BodyFn>
+void ThreadPool::parallelFor(Vector<ElemType> & vec, BodyFn body) {
+	parallelFor(0, vec.size(), [&vec, &body](int i) { body(vec[i]); });
+}
+
+template <typename ElemType, typename Layout, typename BodyFn>
+void ThreadPool::parallelFor(Grid<ElemType, Layout> & grid, BodyFn body) {
+	int numCols = grid.numCols();
+	parallelFor(0, grid.numRows(), [&grid, &body, numCols](int row) {
+		for (int col = 0; col < numCols; col++) {
+			body(row, col, grid.uncheckedAt(row, col));
+		}
+	});
+}
+
+/*
+ * Implementation notes: parallelReduce
+ * ------------------------------------
+ * The range is cut into runs of grainSize indexes, and each run's
+ * result goes into its own slot so that the runs can be folded together
+ * in order at the end.  The default grainSize splits the range into
+ * REDUCE_RUNS runs, which depends on the size of the range alone, so
+ * the runs are the same however many threads the pool has.
+ */
+
+template <typename ResultType, typename MapFn, typename CombineFn>
+ResultType ThreadPool::parallelReduce(int start, int end, ResultType identity,
+                                      MapFn fn, CombineFn combine, int grainSize) {
+	if (end <= start) return identity;
+	long size = long(end) - start;
+	if (grainSize <= 0) grainSize = int((size + REDUCE_RUNS - 1) / REDUCE_RUNS);
+	int numRuns = int((size + grainSize - 1) / grainSize);
+	Vector<ResultType> partials(numRuns);
+	for (int i = 0; i < numRuns; i++) {
+		partials.add(identity);
+	}
+	parallelFor(0, numRuns, [&](int run) {
+		long lo = start + long(run) * grainSize;
+		long hi = (end - lo > grainSize) ? lo + grainSize : end;
+		ResultType result = identity;
+		for (int i = int(lo); i < int(hi); i++) {
+			result = combine(result, fn(i));
+		}
+		partials[run] = result;
+	}, 1);
+	ResultType result = identity;
+	for (int i = 0; i < numRuns; i++) {
+		result = combine(result, partials[i]);
+	}
+	return result;
+}
+
+template <typename ElemType, typename ResultType, typename MapFn, typename CombineFn>
+ResultType ThreadPool::parallelReduce(Vector<ElemType> & vec, ResultType identity,
+                                      MapFn fn, CombineFn combine) {
+	return parallelReduce(0, vec.size(), identity,
+	                      [&vec, &fn](int i) { return fn(vec[i]); }, combine);
+}
+
+#endif
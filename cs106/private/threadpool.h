@@ -0,0 +1,171 @@
+/*
+ * File: private/threadpool.h
+ * --------------------------
+ * This file contains the private section of the threadpool.h
+ * interface.  This portion of the class definition is taken out of
+ * the threadpool.h header so that the client need not have to see all
+ * of these details.
+ */
+
+/*
+ * Copying is not supported: a pool owns its threads.
+ */
+	DISALLOW_COPYING(ThreadPool)
+
+	static const int CACHE_LINE_BYTES = 64;
+	static const int SPINS_BEFORE_YIELD = 64;
+	static const int YIELDS_BEFORE_SLEEP = 16;
+	static const int INJECTED_CAPACITY = 4096;
+	static const int RUNS_PER_THREAD = 8;
+	static const int REDUCE_RUNS = 256;
+
+/*
+ * Type: taskT
+ * -----------
+ * Every unit of work the pool runs is a taskT allocated with new.
+ * Whoever runs it deletes it afterwards.
+ */
+	struct taskT {
+		virtual ~taskT() {}
+		virtual void run() = 0;
+	};
+
+/*
+ * Class: WorkDeque
+ * ----------------
+ * Each worker's tasks are kept in a work-stealing deque as described by
+ * Chase and Lev.  The owning worker pushes and takes tasks at the
+ * bottom, newest first, with no atomic read-modify-write except when
+ * just one task is left; other threads steal from the top, oldest
+ * first, by advancing top with a compare-and-swap.  The oldest tasks
+ * are the biggest pieces of a split range, so a thief takes as much
+ * work as it can in one go.  The array grows when full; arrays it
+ * outgrows are kept until the deque is destroyed, because a thief may
+ * still be reading one.
+ */
+	class WorkDeque {
+	public:
+		WorkDeque();
+		~WorkDeque();
+		void push(taskT *task);
+		taskT *take();
+		taskT *steal();
+
+	private:
+		static const long INITIAL_CAPACITY = 64;
+
+		struct arrayT {
+			long capacity;
+			std::atomic<taskT *> *slots;
+			arrayT *older;
+		};
+
+		alignas(CACHE_LINE_BYTES) std::atomic<long> top;
+		alignas(CACHE_LINE_BYTES) std::atomic<long> bottom;
+		std::atomic<arrayT *> array;
+
+		arrayT *grow(arrayT *old, long t, long b);
+	};
+
+/*
+ * Type: workerT
+ * -------------
+ * The state of one worker thread, on cache lines of its own.
+ */
+	struct alignas(CACHE_LINE_BYTES) workerT {
+		ThreadPool *pool;
+		int index;
+		WorkDeque deque;
+		std::thread thread;
+	};
+
+/*
+ * Type: loopT, rangeTaskT
+ * -----------------------
+ * A parallelFor is run by rangeTaskTs, each of which covers the
+ * indexes from lo up to hi.  A range larger than the grain size gives
+ * away its upper half as a new task before working on the rest, so
+ * the range is only cut up as far as idle workers come to steal it.
+ * The tasks of one loop share a loopT on the caller's stack, which
+ * counts the indexes not yet done and records the first exception.
+ */
+	template <typename BodyFn>
+	struct loopT {
+		ThreadPool *pool;
+		BodyFn *body;
+		int grainSize;
+		std::atomic<long> remaining;
+		std::atomic<bool> failed;
+		std::exception_ptr error;
+	};
+
+	template <typename BodyFn>
+	struct rangeTaskT : taskT {
+		loopT<BodyFn> *loop;
+		int lo, hi;
+		void run();
+	};
+
+/*
+ * Type: futureTaskT
+ * -----------------
+ * The task behind a Future: it calls fn and stores the result.
+ */
+	template <typename ResultType, typename FnType>
+	struct futureTaskT : taskT {
+		ThreadPool *pool;
+		FnType fn;
+		std::shared_ptr<typename Future<ResultType>::stateT> state;
+		futureTaskT(FnType & fn) : fn(fn) {}
+		void run();
+	};
+
+/*
+ * Implementation notes: waking workers
+ * ------------------------------------
+ * Tasks from threads outside the pool go into a shared queue that the
+ * workers check after their own deques.  Every push advances epoch.
+ * A worker that has found nothing for a while goes to sleep, but only
+ * if epoch has not moved since before it last looked for work; a
+ * pusher that sees a sleeping worker wakes one.  Both sides access
+ * epoch and sleepers in sequentially consistent order, so one of them
+ * always sees the other and no task is left behind a sleeping pool.
+ */
+	workerT **workers;
+	int count;
+	MPMCQueue<taskT *> injected;
+	std::atomic<bool> stopping;
+	std::atomic<long> epoch;
+	std::atomic<int> sleepers;
+	std::atomic<unsigned> nextVictim;
+	std::mutex sleepLock;
+	std::condition_variable wakeup;
+
+/*
+ * Implementation notes: blocking waiters
+ * --------------------------------------
+ * A thread outside the pool that has found no task to run for a while
+ * stops looking and sleeps on finished until what it waits for is done.
+ * Tasks that finish a future or a loop call notifyWaiters.  The waiter
+ * counts itself in waiters before checking whether it is done, and the
+ * task marks its work done before reading waiters, with a fence on each
+ * side, so the task either sees the waiter and wakes it or the waiter
+ * sees the work done and does not sleep.
+ */
+	std::atomic<int> waiters;
+	std::mutex waitLock;
+	std::condition_variable finished;
+
+	static workerT *& currentWorker();
+	workerT *ownWorker();
+	void push(taskT *task);
+	void wakeOne();
+	void notifyWaiters();
+	taskT *findTask(workerT *self);
+	void workerLoop(workerT *self);
+	int defaultGrainSize(long size);
+	template <typename DoneFn>
+	void helpUntil(DoneFn done);
+
+	template <typename ResultType>
+	friend class Future;
@@ -14,12 +14,13 @@
  * ---------------------------
  * The Vector is internally managed as a dynamic array of elements.
  * It tracks capacity (numAllocated) separately from size (numUsed).
+ * An empty vector with no capacity allocates no array at all.
  * All access is bounds-checked for safety.
  */
 
 template <typename ElemType>
 Vector<ElemType>::Vector(int capacity) {
-	elements = new ElemType[capacity];
+	elements = (capacity > 0) ? new ElemType[capacity] : NULL;
 	numAllocated = capacity;
 	numUsed = 0;
 	timestamp = 0L;
@@ -193,15 +194,13 @@ ElemType Vector<ElemType>::Iterator::next() {
 }
 
 template <typename ElemType>
-ElemType Vector<ElemType>::foreachHook(FE_State & fe) {
-	if (fe.state == 0) fe.iter = new Iterator(this);
-	if (((Iterator *) fe.iter)->hasNext()) {
-		fe.state = 1;
-		return ((Iterator *) fe.iter)->next();
-	} else {
-		fe.state = 2;
-		return ElemType();
-	}
+ElemType *Vector<ElemType>::begin() {
+	return elements;
+}
+
+template <typename ElemType>
+ElemType *Vector<ElemType>::end() {
+	return elements + numUsed;
 }
 
 /* Private method: enlargeCapacity
@@ -229,7 +228,7 @@ void Vector<ElemType>::enlargeCapacity() {
 
 template <typename ElemType>
 void Vector<ElemType>::copyInternalData(const Vector & other) {
-	elements = new ElemType[other.numUsed];
+	elements = (other.numUsed > 0) ? new ElemType[other.numUsed] : NULL;
 	for (int i = 0; i < other.numUsed; i++) {
 		elements[i] = other.elements[i];
 	}
@@ -16,7 +16,7 @@ public:
  * This interface defines a nested class within the Vector template that
  * provides iterator access to the Vector contents.
  */
-	class Iterator : public FE_Iterator {
+	class Iterator {
 	public:
 		Iterator();
 		bool hasNext();
@@ -30,7 +30,6 @@ public:
 		friend class Vector;
 	};
 	friend class Iterator;
-	ElemType foreachHook(FE_State & _fe);
 
 /*
  * Deep copying support
@@ -11,6 +11,8 @@
 #define _queue_h
 
 #include "genlib.h"
+#include "vector.h"
+#include <utility>
 
 /*
  * Class: Queue
@@ -24,6 +26,10 @@
  * For maximum generality, the Queue is supplied as a class template.
  * The client specializes the queue to hold values of a specific type,
  * e.g. Queue<customerT> or Queue<string>, as needed
+ *
+ * The elements are kept in a single array that is used as a ring, so
+ * enqueue and dequeue take constant time and, once the array has grown
+ * to fit the queue, allocate nothing.
  */
 
 template <typename ElemType>
@@ -31,6 +37,9 @@ class Queue {
 
 public:
 
+/* Forward references */
+    class RangeIterator;
+
 /*
  * Constructor: Queue
  * Usage: Queue<int> queue;
@@ -86,6 +95,30 @@ public:
  */
     ElemType dequeue();
 
+/*
+ * Method: enqueueAll
+ * Usage: queue.enqueueAll(elems);
+ * -------------------------------
+ * This method adds all of the elements of elems to the end of this
+ * queue, in order, as if each had been enqueued in turn.  Room for all
+ * of them is made at once, and the elements are copied in a single
+ * pass.
+ */
+    void enqueueAll(Vector<ElemType> & elems);
+
+/*
+ * Method: dequeueInto
+ * Usage: queue.dequeueInto(elems, count);
+ * ---------------------------------------
+ * This method removes the first count elements from this queue and
+ * adds them to the end of elems, in the order they would have been
+ * dequeued.  Calling queue.dequeueInto(level, queue.size()) takes the
+ * whole queue at once, as a breadth-first search does when it works
+ * one level at a time.  This function raises an error if count is
+ * negative or more than the size of the queue.
+ */
+    void dequeueInto(Vector<ElemType> & elems, int count);
+
 /*
  * Method: peek
  * Usage: first = queue.peek();
@@ -101,10 +134,23 @@ public:
  * Usage: queue.clear();
  * ---------------------
  * This method removes all elements from this queue. The
- * queue is made empty and will have size() = 0.
+ * queue is made empty and will have size() = 0, and the storage it
+ * had grown is released.
  */
     void clear();
 
+/*
+ * Methods: begin, end
+ * Usage: for (customerT & c : queue) . . .
+ * ----------------------------------------
+ * These methods return iterators to the front of this queue and just
+ * past its end, so that a range-based for loop visits the elements by
+ * reference from front to back, without dequeuing them.  Enqueuing or
+ * dequeuing during the loop leaves the iterators dangling.
+ */
+    RangeIterator begin();
+    RangeIterator end();
+
 private:
 
 #include "private/queue.h"
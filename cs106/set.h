@@ -12,8 +12,8 @@
 
 #include "cmpfn.h"
 #include "bst.h"
+#include "btree.h"
 #include "vector.h"
-#include "foreach.h"
 
 /*
  * Class: Set
@@ -28,21 +28,37 @@
  * client must supply a comparison function that compares two elements
  * (or be willing to use the default comparison function that uses
  * the built-on operators  < and ==).
+ *
+ * The elements are kept in a balanced binary search tree (the BST from
+ * bst.h) unless the client asks for another tree as the second template
+ * argument.  Set<int, BTree> keeps them in a B-tree (from btree.h)
+ * instead, which packs many elements into each node and so takes far
+ * fewer cache misses to search a large set; the operations and their
+ * results are the same either way.
+ *
+ * The third template argument is the comparator class, as described in
+ * bst.h.  By default the set holds the comparison function passed to
+ * its constructor, or compares with < and == inline if there is none.
+ * Set<student, BST, CompareById> names a comparator class instead,
+ * whose comparisons are inlined as well.
  */
 
-template <typename ElemType>
+template <typename ElemType, template <typename, typename> class TreeType = BST,
+          typename Comparator = FunctionCompare<ElemType> >
 class Set {
 
 public:
 
 /* Forward references */
 	class Iterator;
+	class RangeIterator;
 
 /*
  * Constructor: Set
  * Usage: Set<int> set;
  *        Set<student> students(CompareStudentsById);
  *        Set<string> *sp = new Set<string>;
+ *        Set<int, BTree> ids;
  * -----------------------------------------
  * The constructor initializes an empty set. The optional
  * argument is a function pointer that is applied to
@@ -50,11 +66,12 @@ public:
  * comparison function should return 0 if the two elements
  * are equal, a negative result if first is "less than" second,
  * and a positive resut if first is "greater than" second. If
- * no argument is supplied, the OperatorCmp template is used as
- * a default, which applies the bulit-in < and == to the
- * elements to determine ordering.
+ * no argument is supplied, the elements are compared as by the
+ * OperatorCmp template, which applies the bulit-in < and == to the
+ * elements to determine ordering.  A set with a comparator class
+ * of its own takes an object of that class instead.
  */
-	Set(int (*cmpFn)(ElemType, ElemType) = OperatorCmp);
+	Set(Comparator cmpFn = Comparator());
 
 /*
  * Destructor: ~Set
@@ -118,7 +135,9 @@ public:
  * If the element is contained in this set, returns a pointer
  * to that elem.  The pointer allows you to update that element
  * in place. If element is not contained in this set, NULL is
- * returned.
+ * returned.  In a Set<ElemType, BTree>, elements move between
+ * nodes as the set changes, so the pointer is good only until
+ * the next add or remove.
  */
 	ElemType *find(ElemType elem);
 
@@ -154,11 +173,32 @@ public:
  * set.unionWith(set2);      Adds all elements from set2 to this set.
  * set.intersectWith(set2);  Removes any element not in set2 from this set.
  * set.subtract(set2);       Removes all element in set2 from this set.
+ *
+ * When the two sets are of comparable size, each operation walks both
+ * sets in order at once and rebuilds this set from the result, which
+ * takes time proportional to the sizes of the two sets together.  When
+ * one set is much smaller than the other, the operation instead looks
+ * up the elements of the smaller set one at a time.
  */
 	void unionWith(Set & otherSet);
 	void intersectWith(Set & otherSet);
 	void subtract(Set & otherSet);
 
+/*
+ * Operators: +, *, -
+ * Usage: all = set1 + set2;
+ *        common = set1 * set2;
+ *        onlyInFirst = set1 - set2;
+ * ---------------------------------
+ * These operators return a new set that is the union, intersection
+ * or difference of two sets, leaving both of them unchanged.  Each
+ * one walks the two sets in order at once and builds the result
+ * directly, in time proportional to the sizes of the two sets.
+ */
+	Set operator+(const Set & otherSet);
+	Set operator*(const Set & otherSet);
+	Set operator-(const Set & otherSet);
+
 /*
  * Method: clear
  * Usage: set.clear();
@@ -168,6 +208,29 @@ public:
  */
 	void clear();
 
+/*
+ * Method: rank
+ * Usage: n = set.rank(value);
+ * ---------------------------
+ * This method returns the number of elements in this set that are
+ * less than value, which is the index value has or would have in the
+ * order of the set.  It takes time proportional to the log of the
+ * size of the set, without visiting the elements it counts.
+ */
+	int rank(ElemType elem);
+
+/*
+ * Method: select
+ * Usage: value = set.select(index);
+ * ---------------------------------
+ * This method returns the element at the given index in the order of
+ * the set, counting from 0, so set.select(0) is the smallest element
+ * and set.select(set.size() - 1) the largest.  It takes time
+ * proportional to the log of the size of the set.  It is an error to
+ * give an index outside the range from 0 to size() - 1.
+ */
+	ElemType select(int index);
+
 /*
  * SPECIAL NOTE: mapping/iteration support
  * ---------------------------------------
@@ -218,9 +281,10 @@ public:
  *         . . .
  *     }
  *
- * This pattern can be abbreviated to the following more readable form:
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
  *
- *     foreach (int value in set) {
+ *     for (int value : set) {
  *         . . .
  *     }
  *
@@ -229,6 +293,50 @@ public:
  */
 	Iterator iterator();
 
+/*
+ * Method: reverseIterator
+ * Usage: iter = set.reverseIterator();
+ * ------------------------------------
+ * This method creates an iterator that returns the elements of this
+ * set in the opposite order, from the largest to the smallest.
+ */
+	Iterator reverseIterator();
+
+/*
+ * Methods: iteratorFrom, iteratorRange
+ * Usage: iter = set.iteratorFrom(lo);
+ *        iter = set.iteratorRange(lo, hi);
+ * ----------------------------------------
+ * These methods create iterators that start at the first element that
+ * is not less than lo, without stepping through the elements before
+ * it.  The one from iteratorFrom runs to the end of the set; the one
+ * from iteratorRange returns only the elements in the range [lo, hi),
+ * stopping before the first element that is not less than hi.  Both
+ * are created in time proportional to the log of the size of the set.
+ *
+ *     Set<int>::Iterator iter = set.iteratorRange(10, 20);
+ *     while (iter.hasNext()) {
+ *         int value = iter.next();     // 10 <= value < 20
+ *         . . .
+ *     }
+ */
+	Iterator iteratorFrom(ElemType lo);
+	Iterator iteratorRange(ElemType lo, ElemType hi);
+
+/*
+ * Methods: begin, end
+ * Usage: for (const string & name : set) . . .
+ * --------------------------------------------
+ * These methods return iterators to the smallest element of this set
+ * and just past the largest, so that a range-based for loop visits the
+ * elements in order without copying them.  Each element is given as a
+ * const reference, since changing it could break the order of the
+ * set.  Adding or removing elements during the loop leaves the
+ * iterators dangling.
+ */
+	RangeIterator begin();
+	RangeIterator end();
+
 private:
 
 #include "private/set.h"
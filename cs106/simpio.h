@@ -11,6 +11,7 @@
 #define _simpio_h
 
 #include "genlib.h"
+#include <fstream>
 
 /*
  * Function: GetInteger
@@ -0,0 +1,139 @@
+/*
+ * File: spscqueue.h
+ * -----------------
+ * This interface file contains the SPSCQueue class template, a bounded
+ * FIFO queue for passing values from one thread to another without
+ * locking.
+ */
+
+#ifndef _spscqueue_h
+#define _spscqueue_h
+
+#include "genlib.h"
+#include "disallowcopy.h"
+#include <atomic>
+#include <thread>
+#include <utility>
+
+/*
+ * Class: SPSCQueue
+ * ----------------
+ * This interface defines a class template for a queue that connects
+ * exactly two threads: a producer, which is the only thread that ever
+ * calls enqueue or tryEnqueue, and a consumer, which is the only thread
+ * that ever calls dequeue or tryDequeue.  It is meant for the hand-off
+ * between two stages of a pipeline, such as a thread that parses URLs
+ * and one that tallies the results.
+ *
+ * The queue holds at most a fixed number of elements, set when it is
+ * created.  The elements live in an array used as a ring, and the two
+ * threads coordinate through a pair of atomic counters alone, with no
+ * locks, so neither thread can ever be made to wait for the other
+ * except when the queue is full or empty.
+ *
+ * With more than one producer or more than one consumer, use the
+ * MPMCQueue from mpmcqueue.h instead.
+ */
+
+template <typename ElemType>
+class SPSCQueue {
+
+public:
+
+/*
+ * Constructor: SPSCQueue
+ * Usage: SPSCQueue<int> queue;
+ *        SPSCQueue<string> queue(4096);
+ * -------------------------------------
+ * The constructor initializes a new empty queue that can hold at least
+ * capacity elements.  The capacity is rounded up to a power of two.
+ */
+	SPSCQueue(int capacity = 1024);
+
+/*
+ * Destructor: ~SPSCQueue
+ * ----------------------
+ * The destructor deallocates storage associated with this queue.  No
+ * other thread may be using the queue when it is destroyed.
+ */
+	~SPSCQueue();
+
+/*
+ * Method: capacity
+ * Usage: max = queue.capacity();
+ * ------------------------------
+ * This method returns the largest number of elements this queue can
+ * hold at once.
+ */
+	int capacity();
+
+/*
+ * Method: size
+ * Usage: count = queue.size();
+ * ----------------------------
+ * This method returns the number of elements in this queue.  While the
+ * other thread is running, the answer may be out of date by the time
+ * it is returned.
+ */
+	int size();
+
+/*
+ * Method: isEmpty
+ * Usage: if (queue.isEmpty())...
+ * ------------------------------
+ * This method returns true if this queue contains no elements, false
+ * otherwise, with the same caution as size.
+ */
+	bool isEmpty();
+
+/*
+ * Method: enqueue
+ * Usage: queue.enqueue(element);
+ * ------------------------------
+ * This method adds element to the end of this queue.  If the queue is
+ * full, it waits until the consumer makes room.  Only the producer
+ * thread may call this method.
+ */
+	void enqueue(ElemType elem);
+
+/*
+ * Method: tryEnqueue
+ * Usage: if (queue.tryEnqueue(element))...
+ * ----------------------------------------
+ * This method adds element to the end of this queue and returns true,
+ * unless the queue is full, in which case it returns false at once and
+ * leaves the queue unchanged.  Only the producer thread may call this
+ * method.
+ */
+	bool tryEnqueue(ElemType elem);
+
+/*
+ * Method: dequeue
+ * Usage: first = queue.dequeue();
+ * -------------------------------
+ * This method removes the front element from this queue and returns
+ * it.  If the queue is empty, it waits until the producer adds an
+ * element.  Only the consumer thread may call this method.
+ */
+	ElemType dequeue();
+
+/*
+ * Method: tryDequeue
+ * Usage: if (queue.tryDequeue(first))...
+ * --------------------------------------
+ * This method removes the front element from this queue, stores it in
+ * elem and returns true, unless the queue is empty, in which case it
+ * returns false at once.  Only the consumer thread may call this
+ * method.
+ */
+	bool tryDequeue(ElemType & elem);
+
+private:
+
+#include "private/spscqueue.h"
+
+};
+
+#include "private/spscqueue.cpp"
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * File: src/console.cpp
+ * ---------------------
+ * This file implements the console.h interface for programs that run
+ * in a terminal, whose size belongs to the user, so SetConsoleSize
+ * only checks its arguments.
+ */
+
+#include "genlib.h"
+#include "console.h"
+
+void SetConsoleSize(int pointSize, int numRows, int numCols, bool centered) {
+	if (pointSize <= 0 || numRows <= 0 || numCols <= 0) {
+		Error("SetConsoleSize: Sizes must be positive");
+	}
+	(void) centered;
+}
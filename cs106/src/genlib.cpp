@@ -0,0 +1,70 @@
+/*
+ * File: src/genlib.cpp
+ * --------------------
+ * This file implements the genlib.h interface.  Error throws an
+ * ErrorException; if nothing catches it, the handler installed here
+ * prints the message to cerr and exits with a failure status, as the
+ * interface promises, instead of letting the runtime abort with a
+ * message that does not mention the error.
+ */
+
+#include "genlib.h"
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+/*
+ * ErrorException class implementation
+ * -----------------------------------
+ */
+
+ErrorException::ErrorException(string msg) {
+	this->msg = msg;
+}
+
+ErrorException::~ErrorException() throw () {
+	/* Empty */
+}
+
+string ErrorException::getMessage() {
+	return msg;
+}
+
+/*
+ * Implementation notes: Error
+ * ---------------------------
+ * The terminate handler is installed by a static object in this file,
+ * which is linked into every program that can call Error.
+ */
+
+void Error(string str) {
+	throw ErrorException(str);
+}
+
+/*
+ * Implementation notes: ReportUncaughtError
+ * -----------------------------------------
+ * terminate is also called with no exception in flight, for instance
+ * when a joinable thread is destroyed.  Rethrowing then would call
+ * terminate again, so the handler aborts at once instead.
+ */
+
+static void ReportUncaughtError() {
+	exception_ptr active = current_exception();
+	if (active == NULL) abort();
+	try {
+		rethrow_exception(active);
+	} catch (ErrorException & ex) {
+		cerr << "Error: " << ex.getMessage() << endl;
+		exit(EXIT_FAILURE);
+	} catch (...) {
+		/* Fall through to abort */
+	}
+	abort();
+}
+
+static struct ErrorHandlerInstaller {
+	ErrorHandlerInstaller() {
+		set_terminate(ReportUncaughtError);
+	}
+} errorHandlerInstaller;
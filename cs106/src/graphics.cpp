@@ -0,0 +1,506 @@
+/*
+ * File: src/graphics.cpp
+ * ----------------------
+ * This file implements the graphics.h and extgraph.h interfaces for a
+ * machine with no window system, so that graphical programs can be
+ * built, run, timed and profiled from a terminal.  Every call keeps
+ * the state the interfaces describe (the pen, the fonts, the colors,
+ * the saved states and so on) and checks its arguments as a real
+ * window would, but nothing is drawn, and Pause and UpdateDisplay
+ * return at once.
+ *
+ * Mouse clicks are read from the file named by the environment
+ * variable CS106_MOUSE_EVENTS, or from standard input if it is not
+ * set.  Each line holds the x and y coordinates of one click; blank
+ * lines and lines starting with # are skipped.  WaitForMouseDown
+ * presses the button at the next click, and WaitForMouseUp releases
+ * it.  When the clicks run out, the session is over, and
+ * WaitForMouseDown calls ExitGraphics.
+ */
+
+#include "genlib.h"
+#include "graphics.h"
+#include "extgraph.h"
+#include "strutils.h"
+#include "map.h"
+#include "stack.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/*
+ * Constants
+ * ---------
+ * The pretend screen is 1920 x 1080 pixels at 96 pixels to the inch,
+ * and the graphics window starts at 8 x 6 inches.  Text is measured as
+ * if every character took PITCH times the point size, which is near
+ * the average width of a proportional font.
+ */
+
+static const double PIXELS_PER_INCH = 96;
+static const double SCREEN_WIDTH = 1920 / PIXELS_PER_INCH;
+static const double SCREEN_HEIGHT = 1080 / PIXELS_PER_INCH;
+static const double DEFAULT_WINDOW_WIDTH = 8.0;
+static const double DEFAULT_WINDOW_HEIGHT = 6.0;
+static const int DEFAULT_POINT_SIZE = 12;
+static const double POINTS_PER_INCH = 72;
+static const double PITCH = 0.55;
+static const double ASCENT = 0.75;
+static const double DESCENT = 0.25;
+static const double LEADING = 1.2;
+static const double PI = 3.14159265358979323846;
+
+/*
+ * Type: graphicsStateT
+ * --------------------
+ * The part of the state that SaveGraphicsState saves.
+ */
+
+struct graphicsStateT {
+	double x, y;
+	string font;
+	int pointSize;
+	int style;
+	bool eraseMode;
+	string color;
+};
+
+struct colorT {
+	double red, green, blue;
+};
+
+static graphicsStateT state = {
+	0, 0, "Default", DEFAULT_POINT_SIZE, Normal, false, "Black"
+};
+static Stack<graphicsStateT> savedStates;
+static Map<colorT> colorTable;
+static bool colorTableInitialized = false;
+static bool initialized = false;
+static bool inRegion = false;
+static double windowWidth = DEFAULT_WINDOW_WIDTH;
+static double windowHeight = DEFAULT_WINDOW_HEIGHT;
+static string windowTitle = "Graphics Window";
+static string coordinateSystem = "cartesian";
+static double mouseX = 0, mouseY = 0;
+static bool mouseDown = false;
+static istream *mouseEvents = NULL;
+
+/*
+ * Implementation notes: color table
+ * ---------------------------------
+ * Colors are looked up by their name in lower case, and SetPenColorRGB
+ * names its color #rrggbb, which SetPenColor also accepts, so that the
+ * pen color can always be saved with GetPenColor and put back.
+ */
+
+static void DefineBuiltInColors() {
+	if (colorTableInitialized) return;
+	colorTableInitialized = true;
+	DefineColor("Black", 0, 0, 0);
+	DefineColor("Dark Gray", .35, .35, .35);
+	DefineColor("Gray", .6, .6, .6);
+	DefineColor("Light Gray", .75, .75, .75);
+	DefineColor("White", 1, 1, 1);
+	DefineColor("Red", 1, 0, 0);
+	DefineColor("Yellow", 1, 1, 0);
+	DefineColor("Green", 0, 1, 0);
+	DefineColor("Cyan", 0, 1, 1);
+	DefineColor("Blue", 0, 0, 1);
+	DefineColor("Magenta", 1, 0, 1);
+}
+
+static bool IsHexColor(string color) {
+	if (color.length() != 7 || color[0] != '#') return false;
+	for (int i = 1; i < 7; i++) {
+		if (!isxdigit((unsigned char) color[i])) return false;
+	}
+	return true;
+}
+
+static void CheckIntensity(double value, string caller) {
+	if (value < 0 || value > 1) Error(caller + ": Color intensity must be between 0 and 1");
+}
+
+/*
+ * Implementation notes: MoveAlongArc
+ * ----------------------------------
+ * Moves the pen to the end of an elliptical arc that starts at the pen,
+ * which is where every arc starts.
+ */
+
+static void MoveAlongArc(double rx, double ry, double start, double sweep) {
+	double startAngle = start * PI / 180;
+	double endAngle = (start + sweep) * PI / 180;
+	double cx = state.x - rx * cos(startAngle);
+	double cy = state.y - ry * sin(startAngle);
+	state.x = cx + rx * cos(endAngle);
+	state.y = cy + ry * sin(endAngle);
+}
+
+/* Section 1 -- Basic functions from graphics.h */
+
+/*
+ * Implementation notes: InitGraphics
+ * ----------------------------------
+ * As with a real window, calling InitGraphics again clears the window
+ * and starts the pen and text settings over; the size, title, colors
+ * and coordinate system stay as they were.
+ */
+
+void InitGraphics() {
+	DefineBuiltInColors();
+	graphicsStateT initialState = {
+		0, 0, "Default", DEFAULT_POINT_SIZE, Normal, false, "Black"
+	};
+	state = initialState;
+	savedStates.clear();
+	inRegion = false;
+	initialized = true;
+}
+
+void MovePen(double x, double y) {
+	state.x = x;
+	state.y = y;
+}
+
+void DrawLine(double dx, double dy) {
+	state.x += dx;
+	state.y += dy;
+}
+
+void DrawArc(double r, double start, double sweep) {
+	MoveAlongArc(r, r, start, sweep);
+}
+
+double GetWindowWidth() {
+	return windowWidth;
+}
+
+double GetWindowHeight() {
+	return windowHeight;
+}
+
+double GetCurrentX() {
+	return state.x;
+}
+
+double GetCurrentY() {
+	return state.y;
+}
+
+/* Section 2 -- Elliptical arcs */
+
+void DrawEllipticalArc(double rx, double ry, double start, double sweep) {
+	MoveAlongArc(rx, ry, start, sweep);
+}
+
+/* Section 3 -- Graphical regions */
+
+void StartFilledRegion(double density) {
+	if (inRegion) Error("Region is already in progress");
+	if (density < 0 || density > 1) Error("Density for regions must be between 0 and 1");
+	inRegion = true;
+}
+
+void EndFilledRegion() {
+	if (!inRegion) Error("EndFilledRegion without StartFilledRegion");
+	inRegion = false;
+}
+
+/* Section 4 -- String functions */
+
+void DrawTextString(string text) {
+	if (inRegion) Error("Text strings are illegal inside a region");
+	if (text.find('\n') != string::npos) Error("DrawTextString: Text may not contain a newline");
+	state.x += TextStringWidth(text);
+}
+
+double TextStringWidth(string text) {
+	return text.length() * PITCH * state.pointSize / POINTS_PER_INCH;
+}
+
+void SetFont(string font) {
+	state.font = font;
+}
+
+string GetFont() {
+	return state.font;
+}
+
+void SetPointSize(int size) {
+	if (size > 0) state.pointSize = size;
+}
+
+int GetPointSize() {
+	return state.pointSize;
+}
+
+void SetStyle(int style) {
+	state.style = style;
+}
+
+int GetStyle() {
+	return state.style;
+}
+
+double GetFontAscent() {
+	return ASCENT * state.pointSize / POINTS_PER_INCH;
+}
+
+double GetFontDescent() {
+	return DESCENT * state.pointSize / POINTS_PER_INCH;
+}
+
+double GetFontHeight() {
+	return LEADING * state.pointSize / POINTS_PER_INCH;
+}
+
+/* Section 5 -- Mouse support */
+
+double GetMouseX() {
+	return mouseX;
+}
+
+double GetMouseY() {
+	return mouseY;
+}
+
+bool MouseButtonIsDown() {
+	return mouseDown;
+}
+
+/*
+ * Implementation notes: WaitForMouseDown
+ * --------------------------------------
+ * The source of clicks is opened the first time it is needed.
+ */
+
+void WaitForMouseDown() {
+	if (mouseDown) return;
+	if (mouseEvents == NULL) {
+		const char *filename = getenv("CS106_MOUSE_EVENTS");
+		if (filename == NULL) {
+			mouseEvents = &cin;
+		} else {
+			mouseEvents = new ifstream(filename);
+			if (mouseEvents->fail()) Error("Couldn't open mouse event file " + string(filename));
+		}
+	}
+	string line;
+	while (getline(*mouseEvents, line)) {
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == string::npos || line[first] == '#') continue;
+		istringstream stream(line);
+		string rest;
+		if (!(stream >> mouseX >> mouseY) || (stream >> rest)) {
+			Error("Illegal mouse event: " + line);
+		}
+		mouseDown = true;
+		return;
+	}
+	ExitGraphics();
+}
+
+void WaitForMouseUp() {
+	mouseDown = false;
+}
+
+/* Section 6 -- Color support */
+
+void SetPenColor(string color) {
+	DefineBuiltInColors();
+	if (!IsHexColor(color) && !colorTable.containsKey(ConvertToLowerCase(color))) {
+		Error("Undefined color: " + color);
+	}
+	state.color = color;
+}
+
+void SetPenColorRGB(double red, double green, double blue) {
+	CheckIntensity(red, "SetPenColorRGB");
+	CheckIntensity(green, "SetPenColorRGB");
+	CheckIntensity(blue, "SetPenColorRGB");
+	char name[8];
+	snprintf(name, sizeof name, "#%02x%02x%02x",
+	         int(red * 255 + 0.5), int(green * 255 + 0.5), int(blue * 255 + 0.5));
+	state.color = name;
+}
+
+string GetPenColor() {
+	return state.color;
+}
+
+void DefineColor(string name, double red, double green, double blue) {
+	CheckIntensity(red, "DefineColor");
+	CheckIntensity(green, "DefineColor");
+	CheckIntensity(blue, "DefineColor");
+	colorT color = { red, green, blue };
+	colorTable.put(ConvertToLowerCase(name), color);
+}
+
+/* Section 7 -- Pictures */
+
+/*
+ * Implementation notes: pictures
+ * ------------------------------
+ * The size of a picture is read from the header of its file, in the
+ * formats the interface promises, along with PNG.  The picture is drawn
+ * at one pixel of the file to one pixel of the pretend screen.
+ */
+
+static unsigned long ReadBigEndian(const unsigned char *p, int numBytes) {
+	unsigned long value = 0;
+	for (int i = 0; i < numBytes; i++) {
+		value = (value << 8) | p[i];
+	}
+	return value;
+}
+
+static unsigned long ReadLittleEndian(const unsigned char *p, int numBytes) {
+	unsigned long value = 0;
+	for (int i = numBytes - 1; i >= 0; i--) {
+		value = (value << 8) | p[i];
+	}
+	return value;
+}
+
+static bool ReadJPEGSize(ifstream & file, long & width, long & height) {
+	unsigned char marker[4];
+	file.seekg(2);
+	while (file.read((char *) marker, 4)) {
+		if (marker[0] != 0xFF) return false;
+		long length = long(ReadBigEndian(marker + 2, 2));
+		bool isFrame = marker[1] >= 0xC0 && marker[1] <= 0xCF
+		               && marker[1] != 0xC4 && marker[1] != 0xC8 && marker[1] != 0xCC;
+		if (isFrame) {
+			unsigned char frame[5];
+			if (!file.read((char *) frame, 5)) return false;
+			height = long(ReadBigEndian(frame + 1, 2));
+			width = long(ReadBigEndian(frame + 3, 2));
+			return true;
+		}
+		file.seekg(length - 2, ios::cur);
+	}
+	return false;
+}
+
+static void GetPictureSize(string name, double & width, double & height) {
+	string filename = "Pictures/" + name;
+	ifstream file(filename.c_str(), ios::in | ios::binary);
+	if (file.fail()) Error("Cannot find picture " + name);
+	unsigned char header[26] = { 0 };
+	file.read((char *) header, sizeof header);
+	long pixelWidth = -1, pixelHeight = -1;
+	if (header[0] == 'G' && header[1] == 'I' && header[2] == 'F') {
+		pixelWidth = long(ReadLittleEndian(header + 6, 2));
+		pixelHeight = long(ReadLittleEndian(header + 8, 2));
+	} else if (header[0] == 'B' && header[1] == 'M') {
+		pixelWidth = long(ReadLittleEndian(header + 18, 4));
+		pixelHeight = labs(long(int(ReadLittleEndian(header + 22, 4))));
+	} else if (header[0] == 0x89 && header[1] == 'P' && header[2] == 'N' && header[3] == 'G') {
+		pixelWidth = long(ReadBigEndian(header + 16, 4));
+		pixelHeight = long(ReadBigEndian(header + 20, 4));
+	} else if (header[0] == 0xFF && header[1] == 0xD8) {
+		file.clear();
+		ReadJPEGSize(file, pixelWidth, pixelHeight);
+	}
+	if (pixelWidth < 0 || pixelHeight < 0) Error("Unrecognized picture format in " + name);
+	width = pixelWidth / PIXELS_PER_INCH;
+	height = pixelHeight / PIXELS_PER_INCH;
+}
+
+void DrawNamedPicture(string name) {
+	double width, height;
+	GetPictureSize(name, width, height);
+}
+
+double GetPictureWidth(string name) {
+	double width, height;
+	GetPictureSize(name, width, height);
+	return width;
+}
+
+double GetPictureHeight(string name) {
+	double width, height;
+	GetPictureSize(name, width, height);
+	return height;
+}
+
+/* Section 8 -- Miscellaneous functions */
+
+void SetCoordinateSystem(string system) {
+	if (initialized) Error("SetCoordinateSystem must be called before InitGraphics");
+	system = ConvertToLowerCase(system);
+	if (system != "cartesian" && system != "screen") {
+		Error("SetCoordinateSystem: Illegal coordinate system " + system);
+	}
+	coordinateSystem = system;
+}
+
+string GetCoordinateSystem() {
+	return coordinateSystem;
+}
+
+void SetEraseMode(bool mode) {
+	state.eraseMode = mode;
+}
+
+bool GetEraseMode() {
+	return state.eraseMode;
+}
+
+void SetWindowTitle(string title) {
+	windowTitle = title;
+}
+
+string GetWindowTitle() {
+	return windowTitle;
+}
+
+void UpdateDisplay() {
+	/* Nothing is drawn, so there is nothing to update */
+}
+
+void Pause(double seconds) {
+	if (seconds < 0) Error("Pause: Time must not be negative");
+}
+
+void ExitGraphics() {
+	cout.flush();
+	exit(0);
+}
+
+void SaveGraphicsState() {
+	savedStates.push(state);
+}
+
+void RestoreGraphicsState() {
+	if (savedStates.isEmpty()) Error("RestoreGraphicsState called before SaveGraphicsState");
+	state = savedStates.pop();
+}
+
+double GetFullScreenWidth() {
+	return SCREEN_WIDTH;
+}
+
+double GetFullScreenHeight() {
+	return SCREEN_HEIGHT;
+}
+
+void SetWindowSize(double width, double height) {
+	if (initialized) return;
+	if (width <= 0 || height <= 0) Error("SetWindowSize: Dimensions must be positive");
+	windowWidth = width;
+	windowHeight = height;
+}
+
+double GetXResolution() {
+	return PIXELS_PER_INCH;
+}
+
+double GetYResolution() {
+	return PIXELS_PER_INCH;
+}
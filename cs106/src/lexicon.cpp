@@ -0,0 +1,260 @@
+/*
+ * File: src/lexicon.cpp
+ * ---------------------
+ * This file implements the parts of the lexicon.h interface that are
+ * not templates or inline: building the lexicon, looking words up in
+ * it and copying it.
+ *
+ * A lexicon holds two kinds of words.  Those read from a binary file
+ * live in a DAWG (directed acyclic word graph), an array of edges in
+ * which each edge carries a letter, a flag saying whether the path to
+ * it spells a word, and the index of the list of edges below it.  Words
+ * added one at a time, or read from a text file, go into the
+ * otherWords set instead.  A word is never kept in both.
+ *
+ * The binary file starts with a header of the form
+ *
+ *     DAWG:<start index>:<number of bytes>:
+ *
+ * followed by the edges, four bytes each, most significant byte first:
+ * 24 bits of child index, an unused bit, the accept bit, the last-edge
+ * bit and five bits of letter.  The edges are decoded one field at a
+ * time, so the file reads the same way whatever the byte order and
+ * word size of the machine.
+ */
+
+#include "genlib.h"
+#include "lexicon.h"
+#include "strutils.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+Lexicon::Lexicon() {
+	edges = start = NULL;
+	numEdges = numDawgWords = 0;
+	timestamp = 0;
+}
+
+Lexicon::Lexicon(string filename) {
+	edges = start = NULL;
+	numEdges = numDawgWords = 0;
+	timestamp = 0;
+	addWordsFromFile(filename);
+}
+
+Lexicon::~Lexicon() {
+	delete[] edges;
+}
+
+int Lexicon::size() {
+	return numDawgWords + otherWords.size();
+}
+
+bool Lexicon::isEmpty() {
+	return size() == 0;
+}
+
+void Lexicon::add(string word) {
+	word = ConvertToLowerCase(word);
+	Edge *edge = traceToLastEdge(word);
+	if (edge != NULL && edge->accept) return;
+	if (otherWords.contains(word)) return;
+	otherWords.add(word);
+	timestamp++;
+}
+
+/*
+ * Implementation notes: addWordsFromFile
+ * --------------------------------------
+ * A text file may come from Windows, so a carriage return at the end
+ * of a line is not part of the word.
+ */
+
+void Lexicon::addWordsFromFile(string filename) {
+	ifstream istr(filename.c_str(), ios::in | ios::binary);
+	if (istr.fail()) Error("Couldn't open lexicon file " + filename);
+	char firstFour[4];
+	istr.read(firstFour, 4);
+	if (istr.gcount() == 4 && memcmp(firstFour, "DAWG", 4) == 0) {
+		istr.close();
+		readBinaryFile(filename);
+		return;
+	}
+	istr.clear();
+	istr.seekg(0);
+	string line;
+	while (getline(istr, line)) {
+		if (!line.empty() && line[line.length() - 1] == '\r') {
+			line.erase(line.length() - 1);
+		}
+		if (!line.empty()) add(line);
+	}
+}
+
+bool Lexicon::containsWord(string word) {
+	Edge *edge = traceToLastEdge(word);
+	if (edge != NULL && edge->accept) return true;
+	return otherWords.contains(ConvertToLowerCase(word));
+}
+
+/*
+ * Implementation notes: containsPrefix
+ * ------------------------------------
+ * Every edge in the DAWG lies on the path to some word, so reaching the
+ * last letter of prefix is enough.  In otherWords, the first word that
+ * is not less than prefix is the only one that needs to be checked.
+ */
+
+bool Lexicon::containsPrefix(string prefix) {
+	if (prefix.empty()) return true;
+	if (traceToLastEdge(prefix) != NULL) return true;
+	prefix = ConvertToLowerCase(prefix);
+	Set<string>::Iterator iter = otherWords.iteratorFrom(prefix);
+	return iter.hasNext() && iter.nextRef().compare(0, prefix.length(), prefix) == 0;
+}
+
+void Lexicon::clear() {
+	delete[] edges;
+	edges = start = NULL;
+	numEdges = numDawgWords = 0;
+	otherWords.clear();
+	timestamp++;
+}
+
+/*
+ * Deep copying support
+ * --------------------
+ */
+
+Lexicon::Lexicon(const Lexicon & rhs) {
+	edges = start = NULL;
+	timestamp = 0;
+	copyContentsFrom(rhs);
+}
+
+const Lexicon & Lexicon::operator=(const Lexicon & rhs) {
+	if (this != &rhs) {
+		delete[] edges;
+		copyContentsFrom(rhs);
+		timestamp++;
+	}
+	return *this;
+}
+
+void Lexicon::copyContentsFrom(const Lexicon & rhs) {
+	numEdges = rhs.numEdges;
+	numDawgWords = rhs.numDawgWords;
+	edges = (numEdges == 0) ? NULL : new Edge[numEdges];
+	for (int i = 0; i < numEdges; i++) {
+		edges[i] = rhs.edges[i];
+	}
+	start = (rhs.start == NULL) ? NULL : edges + (rhs.start - rhs.edges);
+	otherWords = rhs.otherWords;
+}
+
+/*
+ * Private method: findEdgeForChar
+ * -------------------------------
+ * Returns the edge for ch in the list of edges starting at children,
+ * or NULL if there is none.
+ */
+
+Lexicon::Edge *Lexicon::findEdgeForChar(Edge *children, char ch) {
+	unsigned int ord = charToOrd(ch);
+	for (Edge *edge = children; ; edge++) {
+		if (edge->letter == ord) return edge;
+		if (edge->lastEdge) return NULL;
+	}
+}
+
+/*
+ * Private method: traceToLastEdge
+ * -------------------------------
+ * Follows the letters of s down the DAWG and returns the edge for its
+ * last letter, or NULL if s is empty or no path spells it.
+ */
+
+Lexicon::Edge *Lexicon::traceToLastEdge(const string & s) {
+	if (start == NULL || s.empty()) return NULL;
+	Edge *edge = findEdgeForChar(start, s[0]);
+	for (size_t i = 1; i < s.length() && edge != NULL; i++) {
+		if (edge->children == 0) return NULL;
+		edge = findEdgeForChar(&edges[edge->children], s[i]);
+	}
+	return edge;
+}
+
+/*
+ * Private method: readBinaryFile
+ * ------------------------------
+ * Reads the DAWG from filename, replacing any DAWG the lexicon already
+ * has, and then drops from otherWords any word the DAWG contains.  The
+ * words are counted once here, with the count below each list of edges
+ * remembered, since the lists are shared by many paths.
+ */
+
+void Lexicon::readBinaryFile(string filename) {
+	ifstream istr(filename.c_str(), ios::in | ios::binary);
+	if (istr.fail()) Error("Couldn't open lexicon file " + filename);
+	char firstFour[4];
+	long startIndex = -1, numBytes = -1;
+	istr.read(firstFour, 4);
+	istr.get();
+	istr >> startIndex;
+	istr.get();
+	istr >> numBytes;
+	istr.get();
+	if (istr.fail() || memcmp(firstFour, "DAWG", 4) != 0 || numBytes <= 0
+	    || numBytes % 4 != 0 || startIndex < 0 || startIndex >= numBytes / 4) {
+		Error("Improperly formed lexicon file " + filename);
+	}
+	std::vector<unsigned char> bytes(numBytes);
+	istr.read((char *) &bytes[0], numBytes);
+	if (istr.gcount() != numBytes) Error("Improperly formed lexicon file " + filename);
+
+	delete[] edges;
+	numEdges = int(numBytes / 4);
+	edges = new Edge[numEdges];
+	start = &edges[startIndex];
+	for (int i = 0; i < numEdges; i++) {
+		const unsigned char *p = &bytes[4 * i];
+		unsigned long word = ((unsigned long) p[0] << 24) | ((unsigned long) p[1] << 16)
+		                   | ((unsigned long) p[2] << 8) | p[3];
+		edges[i].letter = word & 0x1F;
+		edges[i].lastEdge = (word >> 5) & 1;
+		edges[i].accept = (word >> 6) & 1;
+		edges[i].unused = 0;
+		edges[i].children = word >> 8;
+		if (edges[i].children >= (unsigned long) numEdges) {
+			clear();
+			Error("Improperly formed lexicon file " + filename);
+		}
+	}
+
+	std::vector<int> wordsBelow(numEdges, -1);
+	std::function<int(int)> countWords = [&](int index) {
+		if (wordsBelow[index] < 0) {
+			int count = 0;
+			for (Edge *edge = &edges[index]; ; edge++) {
+				if (edge->accept) count++;
+				if (edge->children != 0) count += countWords(edge->children);
+				if (edge->lastEdge) break;
+			}
+			wordsBelow[index] = count;
+		}
+		return wordsBelow[index];
+	};
+	numDawgWords = countWords(int(startIndex));
+
+	Vector<string> duplicates;
+	for (const string & word : otherWords) {
+		Edge *edge = traceToLastEdge(word);
+		if (edge != NULL && edge->accept) duplicates.add(word);
+	}
+	for (int i = 0; i < duplicates.size(); i++) {
+		otherWords.remove(duplicates[i]);
+	}
+	timestamp++;
+}
@@ -0,0 +1,199 @@
+/*
+ * File: src/nstream.cpp
+ * ---------------------
+ * This file implements the nstream.h interface on POSIX sockets.  The
+ * SocketStreambuf keeps a buffer in each direction over one connected
+ * socket.  Reading flushes any unsent output first, so that a program
+ * that asks a question and then waits for the answer does not wait
+ * for an answer to a question it never sent.
+ */
+
+#include "genlib.h"
+#include "nstream.h"
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+class SocketStreambuf : public streambuf {
+public:
+	SocketStreambuf();
+	~SocketStreambuf();
+	bool connectTo(string hostName, short portNum);
+	bool listenOn(short portNum);
+	bool isOpen() const;
+	bool closeSocket();
+
+protected:
+	int_type underflow();
+	int_type overflow(int_type ch);
+	int sync();
+
+private:
+	static const int BUFFER_SIZE = 4096;
+
+	int fd;
+	char inBuffer[BUFFER_SIZE];
+	char outBuffer[BUFFER_SIZE];
+
+	bool flushOutput();
+};
+
+SocketStreambuf::SocketStreambuf() {
+	fd = -1;
+	setg(inBuffer, inBuffer, inBuffer);
+	setp(outBuffer, outBuffer + BUFFER_SIZE);
+}
+
+SocketStreambuf::~SocketStreambuf() {
+	closeSocket();
+}
+
+bool SocketStreambuf::connectTo(string hostName, short portNum) {
+	struct addrinfo hints, *addresses;
+	memset(&hints, 0, sizeof hints);
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(hostName.c_str(), to_string(portNum).c_str(), &hints, &addresses) != 0) {
+		return false;
+	}
+	for (struct addrinfo *ap = addresses; ap != NULL && fd < 0; ap = ap->ai_next) {
+		fd = socket(ap->ai_family, ap->ai_socktype, ap->ai_protocol);
+		if (fd >= 0 && connect(fd, ap->ai_addr, ap->ai_addrlen) != 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+	freeaddrinfo(addresses);
+	return fd >= 0;
+}
+
+/*
+ * Implementation notes: listenOn
+ * ------------------------------
+ * The listening socket accepts a single connection and is then closed.
+ */
+
+bool SocketStreambuf::listenOn(short portNum) {
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0) return false;
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof reuse);
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons((unsigned short) portNum);
+	if (bind(listener, (struct sockaddr *) &address, sizeof address) == 0
+	    && listen(listener, 1) == 0) {
+		do {
+			fd = accept(listener, NULL, NULL);
+		} while (fd < 0 && errno == EINTR);
+	}
+	::close(listener);
+	return fd >= 0;
+}
+
+bool SocketStreambuf::isOpen() const {
+	return fd >= 0;
+}
+
+bool SocketStreambuf::closeSocket() {
+	if (fd < 0) return false;
+	bool flushed = flushOutput();
+	::close(fd);
+	fd = -1;
+	setg(inBuffer, inBuffer, inBuffer);
+	return flushed;
+}
+
+SocketStreambuf::int_type SocketStreambuf::underflow() {
+	if (fd < 0 || !flushOutput()) return traits_type::eof();
+	ssize_t count;
+	do {
+		count = recv(fd, inBuffer, BUFFER_SIZE, 0);
+	} while (count < 0 && errno == EINTR);
+	if (count <= 0) return traits_type::eof();
+	setg(inBuffer, inBuffer, inBuffer + count);
+	return traits_type::to_int_type(inBuffer[0]);
+}
+
+SocketStreambuf::int_type SocketStreambuf::overflow(int_type ch) {
+	if (!flushOutput()) return traits_type::eof();
+	if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+int SocketStreambuf::sync() {
+	return flushOutput() ? 0 : -1;
+}
+
+bool SocketStreambuf::flushOutput() {
+	char *next = pbase();
+	while (next < pptr()) {
+		if (fd < 0) return false;
+		ssize_t count = send(fd, next, pptr() - next, MSG_NOSIGNAL);
+		if (count < 0 && errno == EINTR) continue;
+		if (count <= 0) return false;
+		next += count;
+	}
+	setp(outBuffer, outBuffer + BUFFER_SIZE);
+	return true;
+}
+
+/*
+ * nstream class implementation
+ * ----------------------------
+ */
+
+nstream::nstream() : iostream(NULL), connection(new SocketStreambuf) {
+	rdbuf(connection.get());
+}
+
+nstream::nstream(short portNum) : iostream(NULL), connection(new SocketStreambuf) {
+	rdbuf(connection.get());
+	open(portNum);
+}
+
+nstream::nstream(string hostName, short portNum) : iostream(NULL), connection(new SocketStreambuf) {
+	rdbuf(connection.get());
+	open(hostName, portNum);
+}
+
+nstream::~nstream() {
+	connection->closeSocket();
+}
+
+void nstream::open(string hostName, short portNum) {
+	if (is_open() || !connection->connectTo(hostName, portNum)) {
+		setstate(failbit);
+	} else {
+		clear();
+	}
+}
+
+void nstream::open(short portNum) {
+	if (is_open() || !connection->listenOn(portNum)) {
+		setstate(failbit);
+	} else {
+		clear();
+	}
+}
+
+bool nstream::is_open() const {
+	return connection->isOpen();
+}
+
+void nstream::close() {
+	if (!connection->closeSocket()) setstate(failbit);
+}
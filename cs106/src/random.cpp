@@ -0,0 +1,56 @@
+/*
+ * File: src/random.cpp
+ * --------------------
+ * This file implements the random.h interface on a Mersenne Twister,
+ * which gives the same sequence for a given seed on every platform,
+ * unlike rand.  Like rand, the generator is shared by the whole
+ * program and must not be used by two threads at once.
+ */
+
+#include "genlib.h"
+#include "random.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+static const unsigned int DEFAULT_SEED = 5489;
+
+static mt19937 generator(DEFAULT_SEED);
+
+/*
+ * Implementation notes: NextFraction
+ * ----------------------------------
+ * This function returns a number in [0, 1) made from 53 random bits,
+ * all that a double can hold.
+ */
+
+static double NextFraction() {
+	unsigned long high = generator() >> 5;
+	unsigned long low = generator() >> 6;
+	return (high * 67108864.0 + low) / 9007199254740992.0;
+}
+
+void Randomize() {
+	random_device device;
+	unsigned int seed = device();
+	seed ^= (unsigned int) chrono::high_resolution_clock::now().time_since_epoch().count();
+	generator.seed(seed);
+}
+
+int RandomInteger(int low, int high) {
+	if (low > high) Error("RandomInteger: low is greater than high");
+	double range = double(high) - double(low) + 1;
+	return int(floor(low + NextFraction() * range));
+}
+
+double RandomReal(double low, double high) {
+	return low + NextFraction() * (high - low);
+}
+
+bool RandomChance(double p) {
+	return NextFraction() < p;
+}
+
+void SetRandomSeed(int seed) {
+	generator.seed((unsigned int) seed);
+}
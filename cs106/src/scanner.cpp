@@ -0,0 +1,292 @@
+/*
+ * File: src/scanner.cpp
+ * ---------------------
+ * This file implements the scanner.h interface.  The scanner works on
+ * a string buffer, with cp the index of the next character to read.
+ * Input from a stream is read into the buffer in full when setInput is
+ * called, so the stream must reach its end before scanning starts.
+ */
+
+#include "genlib.h"
+#include "scanner.h"
+#include <cctype>
+#include <iterator>
+
+Scanner::Scanner() {
+	buffer = "";
+	buflen = 0;
+	cp = 0;
+	fp = NULL;
+	spaceOption = PreserveSpaces;
+	numberOption = ScanNumbersAsLetters;
+	stringOption = ScanQuotesAsPunctuation;
+	bracketOption = ScanBracketsAsPunctuation;
+}
+
+Scanner::~Scanner() {
+	/* Empty */
+}
+
+void Scanner::setInput(string str) {
+	buffer = str;
+	buflen = int(buffer.length());
+	cp = 0;
+	fp = NULL;
+	savedTokens.clear();
+}
+
+void Scanner::setInput(istream & infile) {
+	buffer.assign(istreambuf_iterator<char>(infile), istreambuf_iterator<char>());
+	buflen = int(buffer.length());
+	cp = 0;
+	fp = &infile;
+	savedTokens.clear();
+}
+
+/*
+ * Implementation notes: nextToken
+ * -------------------------------
+ * The first character of the token decides how far it extends: a
+ * letter or digit starts a word or number, a quotation mark or angle
+ * bracket may start a string or tag, and anything else is a token by
+ * itself.
+ */
+
+string Scanner::nextToken() {
+	if (!savedTokens.isEmpty()) return savedTokens.pop();
+	if (spaceOption == IgnoreSpaces) skipSpaces();
+	if (cp >= buflen) return "";
+	int start = cp;
+	unsigned char ch = buffer[cp];
+	if (isdigit(ch) && numberOption == ScanNumbersAsIntegers) {
+		scanToEndOfInteger();
+	} else if (isdigit(ch) && numberOption == ScanNumbersAsReals) {
+		scanToEndOfReal();
+	} else if (isalnum(ch)) {
+		scanToEndOfIdentifier();
+	} else if (ch == '"' && stringOption == ScanQuotesAsStrings) {
+		return scanQuotedString();
+	} else if (ch == '<' && bracketOption == ScanBracketsAsTag) {
+		return scanTag();
+	} else {
+		cp++;
+	}
+	return buffer.substr(start, cp - start);
+}
+
+bool Scanner::hasMoreTokens() {
+	if (!savedTokens.isEmpty()) return true;
+	if (spaceOption == IgnoreSpaces) skipSpaces();
+	return cp < buflen;
+}
+
+void Scanner::saveToken(string token) {
+	savedTokens.push(token);
+}
+
+void Scanner::setSpaceOption(spaceOptionT option) {
+	spaceOption = option;
+}
+
+Scanner::spaceOptionT Scanner::getSpaceOption() {
+	return spaceOption;
+}
+
+void Scanner::setNumberOption(numberOptionT option) {
+	numberOption = option;
+}
+
+Scanner::numberOptionT Scanner::getNumberOption() {
+	return numberOption;
+}
+
+void Scanner::setStringOption(stringOptionT option) {
+	stringOption = option;
+}
+
+Scanner::stringOptionT Scanner::getStringOption() {
+	return stringOption;
+}
+
+void Scanner::setBracketOption(bracketOptionT option) {
+	bracketOption = option;
+}
+
+Scanner::bracketOptionT Scanner::getBracketOption() {
+	return bracketOption;
+}
+
+/*
+ * Private method: skipSpaces
+ * --------------------------
+ * Advances cp past any whitespace.
+ */
+
+void Scanner::skipSpaces() {
+	while (cp < buflen && isspace((unsigned char) buffer[cp])) {
+		cp++;
+	}
+}
+
+/*
+ * Private methods: scanToEndOfIdentifier, scanToEndOfInteger
+ * ----------------------------------------------------------
+ * These methods advance cp past a run of letters and digits, or of
+ * digits alone, and return the new value of cp.
+ */
+
+int Scanner::scanToEndOfIdentifier() {
+	while (cp < buflen && isalnum((unsigned char) buffer[cp])) {
+		cp++;
+	}
+	return cp;
+}
+
+int Scanner::scanToEndOfInteger() {
+	while (cp < buflen && isdigit((unsigned char) buffer[cp])) {
+		cp++;
+	}
+	return cp;
+}
+
+/*
+ * Private method: scanToEndOfReal
+ * -------------------------------
+ * This method advances cp past the longest real number starting at cp,
+ * which must be a digit, and returns the new value of cp.  The states
+ * follow the parts of the number as described in scanner.h.  An E that
+ * is not followed by an exponent, perhaps with a sign, is not part of
+ * the number, so cp goes back to it.
+ */
+
+int Scanner::scanToEndOfReal() {
+	realNumScanStateT state = InitialState;
+	int exponentStart = -1;
+	while (state != FinalState) {
+		unsigned char ch = (cp < buflen) ? buffer[cp] : '\0';
+		switch (state) {
+		case InitialState:
+			state = BeforeDecimalPoint;
+			break;
+		case BeforeDecimalPoint:
+			if (ch == '.') {
+				state = AfterDecimalPoint;
+			} else if (ch == 'E' || ch == 'e') {
+				state = StartingExponent;
+				exponentStart = cp;
+			} else if (!isdigit(ch)) {
+				state = FinalState;
+			}
+			break;
+		case AfterDecimalPoint:
+			if (ch == 'E' || ch == 'e') {
+				state = StartingExponent;
+				exponentStart = cp;
+			} else if (!isdigit(ch)) {
+				state = FinalState;
+			}
+			break;
+		case StartingExponent:
+			if (ch == '+' || ch == '-') {
+				state = FoundExponentSign;
+			} else if (isdigit(ch)) {
+				state = ScanningExponent;
+			} else {
+				cp = exponentStart;
+				state = FinalState;
+			}
+			break;
+		case FoundExponentSign:
+			if (isdigit(ch)) {
+				state = ScanningExponent;
+			} else {
+				cp = exponentStart;
+				state = FinalState;
+			}
+			break;
+		case ScanningExponent:
+			if (!isdigit(ch)) state = FinalState;
+			break;
+		case FinalState:
+			break;
+		}
+		if (state != FinalState) cp++;
+	}
+	return cp;
+}
+
+/*
+ * Private method: scanQuotedString
+ * --------------------------------
+ * This method scans the string that starts at cp, with its escape
+ * sequences replaced by the characters they stand for, and returns it
+ * with its quotation marks.
+ */
+
+string Scanner::scanQuotedString() {
+	string str = "\"";
+	cp++;
+	while (true) {
+		if (cp >= buflen) Error("Scanner found unterminated string");
+		char ch = buffer[cp++];
+		if (ch == '"') break;
+		if (ch == '\\') ch = scanEscapeCharacter();
+		str += ch;
+	}
+	return str + '"';
+}
+
+/*
+ * Private method: scanEscapeCharacter
+ * -----------------------------------
+ * This method reads the escape sequence after a backslash, which may be
+ * a letter, up to three octal digits or x and hexadecimal digits, and
+ * returns the character it stands for.
+ */
+
+char Scanner::scanEscapeCharacter() {
+	if (cp >= buflen) Error("Scanner found unterminated string");
+	char ch = buffer[cp++];
+	if (ch >= '0' && ch <= '7') {
+		int value = ch - '0';
+		for (int i = 1; i < 3 && cp < buflen && buffer[cp] >= '0' && buffer[cp] <= '7'; i++) {
+			value = 8 * value + (buffer[cp++] - '0');
+		}
+		return char(value);
+	}
+	if (ch == 'x') {
+		int value = 0;
+		while (cp < buflen && isxdigit((unsigned char) buffer[cp])) {
+			char digit = char(tolower((unsigned char) buffer[cp++]));
+			value = 16 * value + (isdigit((unsigned char) digit) ? digit - '0' : digit - 'a' + 10);
+		}
+		return char(value);
+	}
+	switch (ch) {
+	case 'a': return '\a';
+	case 'b': return '\b';
+	case 'f': return '\f';
+	case 'n': return '\n';
+	case 'r': return '\r';
+	case 't': return '\t';
+	case 'v': return '\v';
+	default: return ch;
+	}
+}
+
+/*
+ * Private method: scanTag
+ * -----------------------
+ * This method scans the tag that starts at cp and returns it with its
+ * angle brackets.
+ */
+
+string Scanner::scanTag() {
+	int start = cp;
+	while (true) {
+		if (++cp >= buflen) Error("Scanner found unterminated tag");
+		if (buffer[cp] == '>') break;
+	}
+	cp++;
+	return buffer.substr(start, cp - start);
+}
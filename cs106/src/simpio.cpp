@@ -0,0 +1,109 @@
+/*
+ * File: src/simpio.cpp
+ * --------------------
+ * This file implements the simpio.h interface.  The functions that
+ * give the user another chance after a bad line raise an error instead
+ * when standard input runs out, so that a program reading from a file
+ * or a pipe cannot loop forever.
+ */
+
+#include "genlib.h"
+#include "simpio.h"
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+
+/*
+ * Implementation notes: ReadLine
+ * ------------------------------
+ * This function reads the next line of standard input into line,
+ * raising an error on behalf of caller if there is none.
+ */
+
+static void ReadLine(string & line, string caller) {
+	if (!getline(cin, line)) {
+		Error(caller + ": End of input");
+	}
+}
+
+int GetInteger() {
+	while (true) {
+		string line;
+		ReadLine(line, "GetInteger");
+		const char *start = line.c_str();
+		char *end;
+		errno = 0;
+		long value = strtol(start, &end, 10);
+		while (isspace((unsigned char) *end)) end++;
+		if (end != start && *end == '\0' && errno != ERANGE
+		    && value >= INT_MIN && value <= INT_MAX) {
+			return int(value);
+		}
+		cout << "Illegal integer format. Try again." << endl;
+	}
+}
+
+long GetLong() {
+	while (true) {
+		string line;
+		ReadLine(line, "GetLong");
+		const char *start = line.c_str();
+		char *end;
+		errno = 0;
+		long value = strtol(start, &end, 10);
+		while (isspace((unsigned char) *end)) end++;
+		if (end != start && *end == '\0' && errno != ERANGE) {
+			return value;
+		}
+		cout << "Illegal long format. Try again." << endl;
+	}
+}
+
+double GetReal() {
+	while (true) {
+		string line;
+		ReadLine(line, "GetReal");
+		const char *start = line.c_str();
+		char *end;
+		double value = strtod(start, &end);
+		while (isspace((unsigned char) *end)) end++;
+		if (end != start && *end == '\0') {
+			return value;
+		}
+		cout << "Illegal real format. Try again." << endl;
+	}
+}
+
+string GetLine() {
+	string line;
+	getline(cin, line);
+	return line;
+}
+
+void OpenFile(ifstream & infile, string filename) {
+	infile.open(filename.c_str());
+	if (infile.fail()) Error("OpenFile: Can't open " + filename);
+}
+
+void OpenFile(ofstream & outfile, string filename) {
+	outfile.open(filename.c_str());
+	if (outfile.fail()) Error("OpenFile: Can't open " + filename);
+}
+
+void AskUserForInputFile(ifstream & infile) {
+	AskUserForInputFile("Input file: ", infile);
+}
+
+void AskUserForInputFile(string prompt, ifstream & infile) {
+	while (true) {
+		cout << prompt;
+		string filename;
+		ReadLine(filename, "AskUserForInputFile");
+		infile.open(filename.c_str());
+		if (!infile.fail()) return;
+		infile.clear();
+		cout << "Unable to open that file.  Try again." << endl;
+	}
+}
@@ -0,0 +1,23 @@
+/*
+ * File: src/sound.cpp
+ * -------------------
+ * This file implements the sound.h interface for a machine with no
+ * sound facility.  PlayNamedSound still checks that the sound file
+ * exists, as the interface promises, but plays nothing.
+ */
+
+#include "genlib.h"
+#include "sound.h"
+#include <fstream>
+
+static bool soundOn = true;
+
+void PlayNamedSound(string name) {
+	if (!soundOn) return;
+	ifstream file(("Sounds/" + name).c_str());
+	if (file.fail()) Error("PlayNamedSound: Cannot find sound " + name);
+}
+
+void SetSoundOn(bool on) {
+	soundOn = on;
+}
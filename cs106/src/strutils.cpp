@@ -0,0 +1,61 @@
+/*
+ * File: src/strutils.cpp
+ * ----------------------
+ * This file implements the strutils.h interface.  The conversions
+ * from strings use strtol and strtod and insist that they consume the
+ * whole string, so that "12abc" and "" are errors rather than 12 and 0.
+ */
+
+#include "genlib.h"
+#include "strutils.h"
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <sstream>
+
+string IntegerToString(int num) {
+	return to_string(num);
+}
+
+string RealToString(double num) {
+	ostringstream stream;
+	stream << num;
+	return stream.str();
+}
+
+int StringToInteger(string str) {
+	const char *start = str.c_str();
+	char *end;
+	errno = 0;
+	long value = strtol(start, &end, 10);
+	if (end == start || end != start + str.length() || errno == ERANGE
+	    || value < INT_MIN || value > INT_MAX) {
+		Error("StringToInteger: Illegal integer format (" + str + ")");
+	}
+	return int(value);
+}
+
+double StringToReal(string str) {
+	const char *start = str.c_str();
+	char *end;
+	double value = strtod(start, &end);
+	if (end == start || end != start + str.length()) {
+		Error("StringToReal: Illegal floating-point format (" + str + ")");
+	}
+	return value;
+}
+
+string ConvertToLowerCase(string s) {
+	for (size_t i = 0; i < s.length(); i++) {
+		s[i] = char(tolower((unsigned char) s[i]));
+	}
+	return s;
+}
+
+string ConvertToUpperCase(string s) {
+	for (size_t i = 0; i < s.length(); i++) {
+		s[i] = char(toupper((unsigned char) s[i]));
+	}
+	return s;
+}
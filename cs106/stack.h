@@ -10,7 +10,10 @@
 #ifndef _stack_h
 #define _stack_h
 
-#include "vector.h"
+#include "genlib.h"
+#include <memory>
+#include <new>
+#include <utility>
 
 /*
  * Class: Stack
@@ -25,9 +28,16 @@
  * For maximum generality, the Stack is supplied as a class template.
  * The client specializes the stack to hold values of a specific type,
  * e.g. Stack<string> or Stack<stateT>, as needed.
+ *
+ * The first INLINE_CAPACITY elements are stored inside the Stack object
+ * itself, so a stack that stays that small never allocates memory; a
+ * stack that grows past it moves its elements to the heap.  Most uses
+ * of a stack, such as the path from the root of a tree to the current
+ * node, stay within the default of 8.  A client that knows how deep
+ * its stacks go can pick a different limit, e.g. Stack<nodeT *, 32>.
  */
 
-template <typename ElemType>
+template <typename ElemType, int INLINE_CAPACITY = 8>
 class Stack {
 
 public:
@@ -83,19 +93,23 @@ public:
  * This method removes the top element from this stack and
  * returns it. The top element is the one that was last pushed. The
  * stack's size decreases by one. This function raises an error if
- * called on an empty stack.
+ * called on an empty stack.  The element is moved out of the stack
+ * rather than copied.
  */
 	ElemType pop();
 
 /*
  * Method: peek
  * Usage: top = stack.peek();
- * --------------------------
- * This method returns the value of top element from this
- * stack, without removing it.  The stack's size is unchanged.
- * Raises an error if peek is called on an empty stack.
+ *        stack.peek().count++;
+ * ----------------------------
+ * This method returns the top element from this stack, without
+ * removing it.  The stack's size is unchanged.  The element is
+ * returned by reference, so it can be examined or changed in place
+ * without a copy; the reference is good until the next push, pop or
+ * clear.  Raises an error if peek is called on an empty stack.
  */
-	ElemType peek();
+	ElemType & peek();
 
 /*
  * Method: clear
@@ -106,6 +120,19 @@ public:
  */
 	void clear();
 
+/*
+ * Methods: begin, end
+ * Usage: for (string & name : stack) . . .
+ * ----------------------------------------
+ * These methods return pointers to the bottom element of this stack
+ * and just past the top one, so that a range-based for loop visits the
+ * elements by reference in the order they were pushed, without popping
+ * them.  Pushing or popping during the loop leaves the pointers
+ * dangling.
+ */
+	ElemType *begin();
+	ElemType *end();
+
 private:
 
 #include "private/stack.h"
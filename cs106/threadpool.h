@@ -0,0 +1,268 @@
+/*
+ * File: threadpool.h
+ * ------------------
+ * This interface exports the ThreadPool class, which runs work on all
+ * of the machine's cores, and the Future class template, which stands
+ * for the result of a task the pool has not necessarily finished yet.
+ *
+ * Here is some sample code that squares every element of a vector and
+ * then adds them up, using the pool that the whole program shares:
+ *
+ *      ThreadPool & pool = ThreadPool::shared();
+ *      pool.parallelFor(vec, [](int & elem) { elem *= elem; });
+ *      long total = pool.parallelReduce(vec, 0L,
+ *                       [](int & elem) { return long(elem); },
+ *                       [](long a, long b) { return a + b; });
+ *
+ * Loops, reductions and futures may be nested inside one another:
+ * a worker that waits for work it handed to the pool helps run the
+ * pool's tasks until its own are done, so waiting never ties up a
+ * worker.  A thread outside the pool helps for a moment and then
+ * sleeps, leaving the cores to the workers.
+ */
+
+#ifndef _threadpool_h
+#define _threadpool_h
+
+#include "genlib.h"
+#include "disallowcopy.h"
+#include "vector.h"
+#include "grid.h"
+#include "mpmcqueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+class ThreadPool;
+
+/*
+ * Class: Future
+ * -------------
+ * A Future holds the result of a task passed to ThreadPool::submit.
+ * Futures are cheap to copy, and all copies refer to the same result.
+ * ResultType may be void for tasks that return nothing, and otherwise
+ * must have a default constructor.
+ */
+
+template <typename ResultType>
+class Future {
+
+public:
+
+/*
+ * Constructor: Future
+ * Usage: Future<int> result;
+ * --------------------------
+ * The constructor makes a future that refers to no task, which is
+ * useful only as a placeholder until one returned by submit is
+ * assigned to it.
+ */
+	Future();
+
+/*
+ * Method: isReady
+ * Usage: if (result.isReady())...
+ * -------------------------------
+ * This method returns true if the task has finished, false otherwise.
+ */
+	bool isReady();
+
+/*
+ * Method: wait
+ * Usage: result.wait();
+ * ---------------------
+ * This method returns once the task has finished.  Until then, the
+ * calling thread runs other tasks from the pool, or, if it is not one
+ * of the pool's workers and finds none, sleeps.
+ */
+	void wait();
+
+/*
+ * Method: get
+ * Usage: int value = result.get();
+ * --------------------------------
+ * This method waits for the task to finish, as wait does, and returns
+ * the value it returned.  If the task raised an exception, get raises
+ * the same exception in the calling thread.  Calling get on a future
+ * that refers to no task signals an error.
+ */
+	ResultType get();
+
+private:
+
+/*
+ * The state of a task is shared by the task and every copy of its
+ * future.  A result of type void is stored as an unused bool.
+ */
+	typedef typename std::conditional<std::is_void<ResultType>::value,
+	                                  bool, ResultType>::type valueT;
+
+	struct stateT {
+		std::atomic<bool> ready;
+		std::exception_ptr error;
+		valueT value;
+	};
+
+	ThreadPool *pool;
+	std::shared_ptr<stateT> state;
+
+	friend class ThreadPool;
+};
+
+/*
+ * Class: ThreadPool
+ * -----------------
+ * A ThreadPool keeps a set of worker threads and shares out the tasks
+ * given to it among them.  Each worker keeps its own deque of tasks;
+ * a task that splits its work pushes the pieces onto its worker's
+ * deque, and a worker that runs out of tasks steals the oldest ones
+ * from the others.  That way every worker stays busy without the
+ * workers having to agree on who does what beforehand.  Workers that
+ * find nothing to do sleep until more work arrives.
+ *
+ * Most programs need only the one pool returned by shared, which every
+ * part of the program can use at once.
+ */
+
+class ThreadPool {
+
+public:
+
+/*
+ * Constructor: ThreadPool
+ * Usage: ThreadPool pool;
+ *        ThreadPool pool(4);
+ * --------------------------
+ * The constructor starts a pool of numThreads worker threads, or one
+ * per core if numThreads is 0.
+ */
+	ThreadPool(int numThreads = 0);
+
+/*
+ * Destructor: ~ThreadPool
+ * -----------------------
+ * The destructor waits for the pool to run every task it has been
+ * given and then stops the worker threads.
+ */
+	~ThreadPool();
+
+/*
+ * Method: shared
+ * Usage: ThreadPool & pool = ThreadPool::shared();
+ * ------------------------------------------------
+ * This method returns the pool shared by the whole program, which has
+ * one worker per core.  It is started the first time it is asked for.
+ */
+	static ThreadPool & shared();
+
+/*
+ * Method: numThreads
+ * Usage: int n = pool.numThreads();
+ * ---------------------------------
+ * This method returns the number of worker threads in this pool.
+ */
+	int numThreads();
+
+/*
+ * Method: submit
+ * Usage: Future<int> result = pool.submit(CountWords);
+ *        Future<void> done = pool.submit([&] { Sort(vec); });
+ * -----------------------------------------------------------
+ * This method gives the pool a task to run, the function or lambda fn
+ * called with no arguments, and returns a future for its result.  fn
+ * is copied into the task, so anything it refers to must remain valid
+ * until the task has finished.
+ */
+	template <typename FnType>
+	Future<decltype(std::declval<FnType &>()())> submit(FnType fn);
+
+/*
+ * Method: parallelFor
+ * Usage: pool.parallelFor(0, n, [&](int i) { out[i] = f(in[i]); });
+ * -----------------------------------------------------------------
+ * This method calls body(i) once for each i from start up to but not
+ * including end, spreading the calls across the pool, and returns when
+ * all of them have returned.  The range is handed out in runs of at
+ * most grainSize consecutive indexes; if grainSize is 0, the runs are
+ * sized to give each worker several of them.  If a call to body raises
+ * an exception, the remaining runs are skipped and the exception is
+ * raised again in the calling thread.
+ */
+	template <typename BodyFn>
+	void parallelFor(int start, int end, BodyFn body, int grainSize = 0);
+
+/*
+ * Method: parallelFor
+ * Usage: pool.parallelFor(vec, [](double & x) { x = sqrt(x); });
+ * --------------------------------------------------------------
+ * This method calls body(elem) once for each element of vec, spreading
+ * the calls across the pool.  The element is passed by reference, so
+ * body may change it.
+ */
+	template <typename ElemType, typename BodyFn>
+	void parallelFor(Vector<ElemType> & vec, BodyFn body);
+
+/*
+ * Method: parallelFor
+ * Usage: pool.parallelFor(grid, [&](int row, int col, char & cell) {
+ *            cell = NextState(old, row, col);
+ *        });
+ * -------------------------------------------------------------------
+ * This method calls body(row, col, cell) once for each cell of grid,
+ * spreading the rows across the pool.  The cell is passed by
+ * reference, so body may change it.  Each row is handled by a single
+ * thread, and every row of a Grid<bool> starts on a word of its own,
+ * so this is safe for a Grid<bool> too, where body receives a CellRef.
+ * Changing cells in other rows from body is not safe.
+ */
+	template <typename ElemType, typename Layout, typename BodyFn>
+	void parallelFor(Grid<ElemType, Layout> & grid, BodyFn body);
+
+/*
+ * Method: parallelReduce
+ * Usage: long sum = pool.parallelReduce(0, n, 0L,
+ *                       [&](int i) { return long(counts[i]); },
+ *                       [](long a, long b) { return a + b; });
+ * ---------------------------------------------------------------
+ * This method combines the values fn(i) for each i from start up to
+ * but not including end, and returns the result.  The range is cut
+ * into runs, each run is folded from identity, and the results of the
+ * runs are folded together in order, so combine must be associative
+ * but need not be commutative.  identity must leave any value unchanged
+ * when combined with it (e.g. 0 for a sum, an empty vector for a list).
+ * The runs are grainSize indexes long; if grainSize is 0, the range is
+ * cut into a fixed number of runs.  Either way the runs depend only on
+ * the range, so the answer does not depend on the number of threads,
+ * even for a combine such as a float sum that is associative only up
+ * to rounding.
+ */
+	template <typename ResultType, typename MapFn, typename CombineFn>
+	ResultType parallelReduce(int start, int end, ResultType identity,
+	                          MapFn fn, CombineFn combine, int grainSize = 0);
+
+/*
+ * Method: parallelReduce
+ * Usage: int longest = pool.parallelReduce(words, 0,
+ *                          [](string & w) { return int(w.length()); },
+ *                          [](int a, int b) { return max(a, b); });
+ * -------------------------------------------------------------------
+ * This method combines the values fn(elem) for each element of vec in
+ * the same way.
+ */
+	template <typename ElemType, typename ResultType, typename MapFn, typename CombineFn>
+	ResultType parallelReduce(Vector<ElemType> & vec, ResultType identity,
+	                          MapFn fn, CombineFn combine);
+
+private:
+
+#include "private/threadpool.h"
+
+};
+
+#include "private/threadpool.cpp"
+
+#endif
@@ -12,7 +12,6 @@
 
 #include "genlib.h"
 #include "strutils.h"
-#include "foreach.h"
 
 /*
  * Class: Vector
@@ -210,9 +209,10 @@ public:
  *         . . .
  *     }
  *
- * This pattern can be abbreviated to the following more readable form:
+ * This pattern can be abbreviated to a range-based for loop, which
+ * uses the begin and end methods below:
  *
- *     foreach (int elem in vector) {
+ *     for (int elem : vector) {
  *         . . .
  *     }
  *
@@ -221,6 +221,19 @@ public:
  */
 	Iterator iterator();
 
+/*
+ * Methods: begin, end
+ * Usage: for (double & x : vector) x *= 2;
+ * ----------------------------------------
+ * These methods return pointers to the first element of this vector
+ * and just past the last one, so that a range-based for loop, or any
+ * standard algorithm that takes a pair of iterators, steps through the
+ * elements directly, by reference and without bounds checks.  Adding
+ * or removing elements during the loop leaves the pointers dangling.
+ */
+	ElemType *begin();
+	ElemType *end();
+
 private:
 
 #include "private/vector.h"
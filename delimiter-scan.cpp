@@ -0,0 +1,226 @@
+/**
+ * File: delimiter-scan.cpp
+ * ------------------------
+ * Implements the DelimiterScanner and Explode.  Each instruction set
+ * gets its own version of the function that turns a 32-byte block into
+ * a bitmask of delimiter positions, and a function pointer set at
+ * startup selects among them.
+ */
+
+#include "genlib.h"
+#include "delimiter-scan.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DELIMITER_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+/**
+ * Returns the mask for a block of length bytes (at most 32), one
+ * byte at a time.  This is the fallback for processors without
+ * vector support, and handles the partial block at the end of the
+ * text for all of them.
+ */
+
+static unsigned int BlockMaskScalar(const char *block, int length,
+                                    const char *delims) {
+	unsigned int mask = 0;
+	for (int i = 0; i < length; i++) {
+		char ch = block[i];
+		if (ch == delims[0] || ch == delims[1]
+		    || ch == delims[2] || ch == delims[3]) {
+			mask |= 1u << i;
+		}
+	}
+	return mask;
+}
+
+static unsigned int FullBlockMaskScalar(const char *block, const char *delims) {
+	return BlockMaskScalar(block, 32, delims);
+}
+
+#ifdef DELIMITER_SCAN_X86
+
+static unsigned int HalfBlockMaskSSE2(const char *block, const char *delims) {
+	__m128i bytes = _mm_loadu_si128((const __m128i *) block);
+	__m128i hits = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(delims[0]));
+	hits = _mm_or_si128(hits, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(delims[1])));
+	hits = _mm_or_si128(hits, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(delims[2])));
+	hits = _mm_or_si128(hits, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(delims[3])));
+	return (unsigned int) _mm_movemask_epi8(hits);
+}
+
+static unsigned int FullBlockMaskSSE2(const char *block, const char *delims) {
+	return HalfBlockMaskSSE2(block, delims)
+	       | (HalfBlockMaskSSE2(block + 16, delims) << 16);
+}
+
+TARGET_AVX2
+static unsigned int FullBlockMaskAVX2(const char *block, const char *delims) {
+	__m256i bytes = _mm256_loadu_si256((const __m256i *) block);
+	__m256i hits = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(delims[0]));
+	hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(delims[1])));
+	hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(delims[2])));
+	hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(delims[3])));
+	return (unsigned int) _mm256_movemask_epi8(hits);
+}
+
+#endif
+
+/**
+ * Returns the best instruction set this processor (and operating
+ * system) supports.
+ */
+
+static scanLevelT DetectScanLevel() {
+#if defined(DELIMITER_SCAN_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return SCAN_AVX2;
+	if (__builtin_cpu_supports("sse2")) return SCAN_SSE2;
+#elif defined(DELIMITER_SCAN_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+	bool osSavesAVX = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	if (maxLeaf >= 7 && osSavesAVX) {
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5)) return SCAN_AVX2;
+	}
+	if (hasSSE2) return SCAN_SSE2;
+#endif
+	return SCAN_SCALAR;
+}
+
+static const scanLevelT kSupportedLevel = DetectScanLevel();
+static scanLevelT currentLevel = SCAN_SCALAR;
+static unsigned int (*FullBlockMask)(const char *, const char *) = FullBlockMaskScalar;
+
+void SetDelimiterScanLevel(scanLevelT level) {
+	if (level > kSupportedLevel) level = kSupportedLevel;
+	currentLevel = level;
+	FullBlockMask = FullBlockMaskScalar;
+#ifdef DELIMITER_SCAN_X86
+	if (level == SCAN_SSE2) FullBlockMask = FullBlockMaskSSE2;
+	if (level == SCAN_AVX2) FullBlockMask = FullBlockMaskAVX2;
+#endif
+}
+
+/**
+ * Sets the scanner up for the best supported instruction set before
+ * main runs.
+ */
+
+static bool InitScanLevel() {
+	SetDelimiterScanLevel(kSupportedLevel);
+	return true;
+}
+
+static bool scanLevelInitialized = InitScanLevel();
+
+scanLevelT GetDelimiterScanLevel() {
+	return currentLevel;
+}
+
+string DelimiterScanLevelName(scanLevelT level) {
+	switch (level) {
+	  case SCAN_AVX2: return "AVX2";
+	  case SCAN_SSE2: return "SSE2";
+	  default: return "scalar";
+	}
+}
+
+/**
+ * Returns the index of the lowest set bit in mask, which must
+ * not be zero.
+ */
+
+static inline int LowestSetBit(unsigned int mask) {
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int) index;
+#else
+	int index = 0;
+	while ((mask & 1) == 0) {
+		mask >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+/**
+ * Implementation notes: DelimiterScanner
+ * --------------------------------------
+ * Unused delimiter slots are filled with copies of the first delimiter,
+ * so the mask functions can always compare against four characters.
+ * The final block is handled by BlockMaskScalar whenever fewer than 32
+ * bytes remain, since reading past the end of the text could cross into
+ * an unmapped page.
+ */
+
+DelimiterScanner::DelimiterScanner(string_view text, string_view delimiters) {
+	if (delimiters.empty() || delimiters.size() > 4) {
+		Error("DelimiterScanner needs between one and four delimiters");
+	}
+	for (int i = 0; i < 4; i++) {
+		delims[i] = delimiters[i < (int) delimiters.size() ? i : 0];
+	}
+	blockStart = text.data();
+	end = text.data() + text.size();
+	mask = (blockStart < end) ? blockMask() : 0;
+}
+
+unsigned int DelimiterScanner::blockMask() {
+	if (end - blockStart >= kBlockSize) return FullBlockMask(blockStart, delims);
+	return BlockMaskScalar(blockStart, end - blockStart, delims);
+}
+
+const char *DelimiterScanner::nextDelimiter() {
+	while (mask == 0) {
+		if (end - blockStart <= kBlockSize) return NULL;
+		blockStart += kBlockSize;
+		mask = blockMask();
+	}
+	const char *delim = blockStart + LowestSetBit(mask);
+	mask &= mask - 1;
+	return delim;
+}
+
+void Explode(string_view str, char delim, Vector<string_view>& tokens) {
+	tokens.clear();
+	DelimiterScanner scanner(str, string_view(&delim, 1));
+	const char *tokenStart = str.data();
+	const char *found;
+	while ((found = scanner.nextDelimiter()) != NULL) {
+		tokens.add(string_view(tokenStart, found - tokenStart));
+		tokenStart = found + 1;
+	}
+	tokens.add(string_view(tokenStart, str.data() + str.size() - tokenStart));
+}
+
+Vector<string> Explode(string_view str, char delim) {
+	Vector<string> explosion;
+	DelimiterScanner scanner(str, string_view(&delim, 1));
+	const char *tokenStart = str.data();
+	const char *found;
+	while ((found = scanner.nextDelimiter()) != NULL) {
+		explosion.add(string(tokenStart, found - tokenStart));
+		tokenStart = found + 1;
+	}
+	explosion.add(string(tokenStart, str.data() + str.size() - tokenStart));
+	return explosion;
+}
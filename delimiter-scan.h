@@ -0,0 +1,123 @@
+/**
+ * File: delimiter-scan.h
+ * ----------------------
+ * Exports a scanner that finds the delimiters in a block of text 32 bytes
+ * at a time, using AVX2 or SSE2 compares where the processor supports
+ * them and a plain loop everywhere else.  The instruction set is picked
+ * once, at startup, by asking the CPU what it can do.  Explode and the
+ * QueryTokenizer in url-query.h are both built on top of it.
+ */
+
+#ifndef __delimiter_scan__
+#define __delimiter_scan__
+
+#include "genlib.h"
+#include "vector.h"
+#include <string_view>
+
+/**
+ * Type: scanLevelT
+ * ----------------
+ * The instruction sets the scanner knows how to use, from slowest
+ * to fastest.
+ */
+
+enum scanLevelT { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+
+/**
+ * Class: DelimiterScanner
+ * -----------------------
+ * Reports, in order, the position of every byte in a block of text that
+ * matches one of up to four delimiter characters:
+ *
+ *     DelimiterScanner scanner(query, "&=#");
+ *     const char *delim;
+ *     while ((delim = scanner.nextDelimiter()) != NULL) {
+ *         . . .
+ *     }
+ *
+ * Each 32-byte block of the text is compared against every delimiter at
+ * once, giving a bitmask of matches that nextDelimiter then reads off
+ * one bit at a time; the text is only loaded again when the mask runs
+ * out.  The text must outlive the scanner.
+ */
+
+class DelimiterScanner {
+public:
+
+/**
+ * Constructs a scanner over text that stops at any of the characters
+ * in delimiters, which must contain between one and four characters.
+ *
+ * @param string_view text the text to be scanned.
+ * @param string_view delimiters the characters to stop at.
+ */
+	DelimiterScanner(string_view text, string_view delimiters);
+
+/**
+ * Returns a pointer to the next delimiter in the text, or NULL if there
+ * are no delimiters left.
+ *
+ * @return const char * the position of the next delimiter, or NULL.
+ */
+	const char *nextDelimiter();
+
+private:
+	static const int kBlockSize = 32;
+
+	const char *blockStart;
+	const char *end;
+	unsigned int mask;
+	char delims[4];
+
+	unsigned int blockMask();
+};
+
+/**
+ * Generates the explosion of the specified string around
+ * the given delimiter, and returns the tokens, in sequence, in
+ * a Vector<string>.  The second form produces the same tokens as
+ * string_views into str, without copying any characters.
+ *
+ * @param string_view str the string to be exploded/tokenized, i.e. "171.64.64.135"
+ * @param char delim the delimiting token, i.e. '.'
+ * @param Vector<string_view>& tokens the vector that receives the tokens;
+ *        any previous contents are cleared.
+ * @return Vector<string> the series of tokens within str, when delim is considered
+ *         to be the searating delimiter, i.e. ["171". "64", "64", "135"] as a Vector<string>
+ */
+
+Vector<string> Explode(string_view str, char delim);
+void Explode(string_view str, char delim, Vector<string_view>& tokens);
+
+/**
+ * Returns the instruction set the scanner is currently using.  This
+ * starts out as the best one the processor supports.
+ *
+ * @return scanLevelT the instruction set in use.
+ */
+
+scanLevelT GetDelimiterScanLevel();
+
+/**
+ * Switches the scanner to the specified instruction set, or to the best
+ * one the processor supports if that is lower.  This is meant for
+ * benchmarks and tests that compare the implementations, and must not
+ * be called while other threads are scanning.
+ *
+ * @param scanLevelT level the instruction set to use.
+ */
+
+void SetDelimiterScanLevel(scanLevelT level);
+
+/**
+ * Returns a printable name ("scalar", "SSE2" or "AVX2") for the
+ * specified instruction set.
+ *
+ * @param scanLevelT level the instruction set of interest.
+ * @return string its name.
+ */
+
+string DelimiterScanLevelName(scanLevelT level);
+
+#endif
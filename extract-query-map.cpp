@@ -1,180 +1,236 @@
 /**
  * File: extract-query-map.cpp
  * ---------------------------
- * Provides the implementation of extractQueryMap, and the test harness
- * used to actually test and confirm it works.
+ * Provides the test harness used to actually test and confirm that
+ * extractQueryMap (implemented in url-query.cpp on top of the
+ * QueryTokenizer) works.  The test cases themselves are read from
+ * test-cases.dat by the TestCorpus loader in test-corpus.h, and are
+ * spread across every processor; each case's report is buffered and
+ * printed in corpus order, so the output reads as if the cases had
+ * been run one at a time.  Since every call to extractQueryMap is
+ * timed, a run over a large corpus doubles as a performance test.
  */
 
-#include "genlib.h"
-#include "map.h"
-#include "set.h"
 #include <string>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "genlib.h"
+#include "map.h"
+#include "simpio.h"
+#include "strutils.h"
+#include "url-query.h"
+#include "test-corpus.h"
 
 /**
- * Generates the explosion of the specified string around
- * the given delimiter, and returns the tokens, in sequence, in
- * a Vector<string>
+ * Brute force testing of a particular test case as described by the provided
+ * test case.  We extract the parameter map from the test case's url, and do some
+ * aggressive error checking to see if the extraction generated the correct information.
+ * The function has the side effect of printout out all of the errors we detect, and
+ * returning true if and only if we don't find any errors at all.
  *
- * @param string str the string to be exploded/tokenized, i.e. "171.64.64.135"
- * @param char delim the delimiting token, i.e. '.'
- * @return Vector<string> the series of tokens within str, when delim is considered
- *         to be the searating delimiter, i.e. ["171". "64", "64", "135"] as a Vector<string>
+ * @param testCase& test data about a particular test case that can be administered
+ *        to confirm extractQueryMap is working properly.
+ * @param ostream& out the stream the report on the test case is written to.
+ * @param double& parseSeconds set to the time extractQueryMap took on the url.
+ * @return bool true if the function works in the provide test case scenario, and false otherwise.
  */
 
-Vector<string> Explode(string str, char delim) {
-	Vector<string> explosion;
-	string cluster;
-	str += delim; // last cluster gets appended w/ minimal special casing
+bool testCasePasses(testCase& test, ostream& out, double& parseSeconds) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	QueryMap parameterMap = extractQueryMap(test.url);
+	parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	bool pass = true;
+	out << "Testing \"" << test.url << "\":" << '\n';
+	if (parameterMap.size() != test.numParams) {
+		out << "   Error: Expected this many parameters: " << test.numParams << '\n';
+		out << "          Got this many instead: " << parameterMap.size() << '\n';
+		pass = false;
+	}
+
+	for (const string & key : test.fullKeyValuePairs) {
+		if (!parameterMap.containsKey(key)) {
+			out << "   Error: \"" << key << "\" should be in the map, but isn't." << '\n';
+			pass = false;			
+		} else if (parameterMap[key] != test.fullKeyValuePairs[key]) {
+			out << "   Error: Expected \"" << key << "\" to map to \"" <<  test.fullKeyValuePairs[key] << "\"." << '\n'; 
+			out << "          Currently see \"" << key << "\" mapping to \"" << parameterMap[key] << "\" instead." << '\n';
+			pass = false;
+		}
+	}
 	
-	for (int i = 0; i < str.size(); i++) {
-		if (str[i] == delim) {
-			explosion.add(cluster);
-			cluster.clear(); // cluster = "" works, too
-		} else {
-			cluster += str[i];
+	for (const string & key : test.arbitraryKeys) {
+		if (!parameterMap.containsKey(key)) {
+			out << "   Error: \"" << key << "\" should be in the map (with arbitrary value), but isn't." << '\n';
+			pass = false;
 		}
 	}
 	
-	return explosion;
+	if (pass) {
+		out << "   Passed!" << '\n';
+	}
+	
+	return pass;
 }
 
 /**
- * The function you need to implement, as described in the lab handout.
- *
- * @param string url the well-formed URL whose parameter map is of interest to us.
- * @return Map<string> the URL's parameter map, in Map<string> form.
+ * Type: harnessRunT
+ * -----------------
+ * Everything shared by the threads running a corpus.  Cases are handed
+ * out kShardSize at a time through nextShard.  A finished shard's report
+ * waits in pendingOutput until every shard before it has been printed;
+ * nextShardToPrint and pendingOutput are guarded by outputLock.  Each
+ * case's parse time lands in its own slot of parseTimes.
  */
 
-Map<string> extractQueryMap(string url) {
-Map<string> parameters;
-int index = url.find('?');
-if (index == string::npos) return parameters;
-string query = url.substr(index + 1);
-index = query.find('#');
-if (index != string::npos) {
-query = query.substr(0, index); // chop off hash
-}
-Vector<string> pairs = Explode(query, '&');
-for (int i = 0; i < pairs.size(); i++) {
-Vector<string> components = Explode(pairs[i], '=');
-string key = components[0];
-string value = "true";
-if (components.size() > 1 && !components[1].empty()) {
-value = components[1];
-}
-parameters[key] = value;
-}
-return parameters;
-}
+static const int kShardSize = 64;
+static const int kNumSlowestCases = 5;
+
+struct harnessRunT {
+	TestCorpus *corpus;
+	bool verbose;
+	int numShards;
+	std::atomic<int> nextShard;
+	std::atomic<int> numFailures;
+	std::mutex outputLock;
+	int nextShardToPrint;
+	Vector<string> pendingOutput;
+	Vector<bool> shardFinished;
+	double *parseTimes;
+};
 
 /**
- * Type: testCase
- * --------------
- * Encapsulates all of the data we need for a particular test case.
- * A properly implemeted extractQueryMap will analyze the .url
- * to find a total of .numParams.  Those parameters with specific
- * values can be found in .fullKeyValuePairs, and those with arbitrary
- * values can be found in .arbitraryKeys.
+ * Prints every finished shard whose turn has come.  Must be called
+ * with run.outputLock held.
  */
 
-struct testCase {
-	string url;
-	int numParams;
-	Map<string> fullKeyValuePairs;
-	Set<string> arbitraryKeys;
-};
+static void PrintFinishedShards(harnessRunT & run) {
+	while (run.nextShardToPrint < run.numShards && run.shardFinished[run.nextShardToPrint]) {
+		cout << run.pendingOutput[run.nextShardToPrint];
+		run.pendingOutput[run.nextShardToPrint].clear();
+		run.nextShardToPrint++;
+	}
+}
 
 /**
- * Presumes the supplied file contains information about the
- * various test cases that can be given to the extractQueryMap
- * function.  You can inspect the data file to intuit the file format,
- * but it's perfectly reasonable to just ignore this function and let
- * it work for you without understanding it.  It's just file processing
- * that assumes a perfectly formatted file.
- *
- * @param string filename the name of the file with the test data.
- * @return Vector<testCases> all of the test cases rehydrated from the data file.
+ * The body of each worker thread: keep claiming shards of the corpus
+ * and testing the cases in them until none are left.  In quiet mode
+ * only the reports for failing cases are kept.
  */
 
-static const char kEndOfLine = '\n';
-Vector<testCase> buildTestCases(string filename = "test-cases.dat") {
-	ifstream infile(filename.c_str());
-	Vector<testCase> testCases;
+static void RunShards(harnessRunT *run) {
+	ostringstream caseOutput;
+	string shardOutput;
 	while (true) {
-		string url;
-		getline(infile, url, kEndOfLine);
-		if (infile.fail()) return testCases;
-		testCase test = {url, 0};
-		string numPairsString;
-		getline(infile, numPairsString, kEndOfLine);
-		int numPairs = StringToInteger(numPairsString);
-		for (int i = 0; i < numPairs; i++) {
-			string key, value;
-			getline(infile, key, kEndOfLine);
-			getline(infile, value, kEndOfLine);
-			test.fullKeyValuePairs.put(key, value);
-			test.numParams++;
-		}
-		string numArbitraryKeysString;
-		getline(infile, numArbitraryKeysString, kEndOfLine);
-		int numArbitraryKeys = StringToInteger(numArbitraryKeysString);
-		for (int j = 0; j < numArbitraryKeys; j++) {
-			string key;
-			getline(infile, key, kEndOfLine);
-			test.arbitraryKeys.add(key);
-			test.numParams++;
+		int shard = run->nextShard++;
+		if (shard >= run->numShards) return;
+		int first = shard * kShardSize;
+		int last = min(first + kShardSize, run->corpus->size());
+		shardOutput.clear();
+		for (int i = first; i < last; i++) {
+			testCase test = run->corpus->getCase(i);
+			caseOutput.str("");
+			bool passed = testCasePasses(test, caseOutput, run->parseTimes[i]);
+			if (!passed) run->numFailures++;
+			if (run->verbose || !passed) shardOutput += caseOutput.str();
 		}
-		
-		testCases.add(test);
+		std::lock_guard<std::mutex> guard(run->outputLock);
+		run->pendingOutput[shard].swap(shardOutput);
+		run->shardFinished[shard] = true;
+		PrintFinishedShards(*run);
 	}
 }
 
+static bool SlowerCase(const pair<double, int> & one, const pair<double, int> & two) {
+	return one.first > two.first;
+}
+
 /**
- * Brute force testing of a particular test case as described by the provided
- * test case.  We extract the parameter map from the test case's url, and do some
- * aggressive error checking to see if the extraction generated the correct information.
- * The function has the side effect of printout out all of the errors we detect, and
- * returning true if and only if we don't find any errors at all.
+ * Prints the throughput of a run, the total and average time spent in
+ * extractQueryMap, and the cases it took longest on.
  *
- * @param testCase& test data about a particular test case that can be administered
- *        to confirm extractQueryMap is working properly.
- * @return bool true if the function works in the provide test case scenario, and false otherwise.
+ * @param harnessRunT& run the finished run.
+ * @param double seconds the wall-clock time the run took.
+ * @param int numThreads the number of threads that ran it.
+ * @return void
  */
 
-bool testCasePasses(testCase& test) {
-	Map<string> parameterMap = extractQueryMap(test.url);
-	bool pass = true;
-	cout << "Testing \"" << test.url << "\":" << endl;
-	if (parameterMap.size() != test.numParams) {
-		cout << "   Error: Expected this many parameters: " << test.numParams << endl;
-		cout << "          Got this many instead: " << parameterMap.size() << endl;
-		pass = false;
+void PrintRunSummary(harnessRunT & run, double seconds, int numThreads) {
+	int numCases = run.corpus->size();
+	double parseSeconds = 0;
+	for (int i = 0; i < numCases; i++) {
+		parseSeconds += run.parseTimes[i];
+	}
+	std::vector<pair<double, int> > ranked;
+	for (int i = 0; i < numCases; i++) {
+		ranked.push_back(make_pair(run.parseTimes[i], i));
 	}
+	int numSlowest = min(kNumSlowestCases, numCases);
+	partial_sort(ranked.begin(), ranked.begin() + numSlowest, ranked.end(), SlowerCase);
 
-	foreach (string key in test.fullKeyValuePairs) {
-		if (!parameterMap.containsKey(key)) {
-			cout << "   Error: \"" << key << "\" should be in the map, but isn't." << endl;
-			pass = false;			
-		} else if (parameterMap[key] != test.fullKeyValuePairs[key]) {
-			cout << "   Error: Expected \"" << key << "\" to map to \"" <<  test.fullKeyValuePairs[key] << "\"." << endl; 
-			cout << "          Currently see \"" << key << "\" mapping to \"" << parameterMap[key] << "\" instead." << endl;
-			pass = false;
-		}
+	if (seconds <= 0) seconds = 1e-9;
+	cout << fixed << setprecision(3);
+	cout << numCases << " cases on " << numThreads << " threads in " << seconds << "s: "
+	     << numCases / seconds << " cases/s" << endl;
+	if (numCases > 0) {
+		cout << "Time in extractQueryMap: " << parseSeconds << "s total, "
+		     << 1e6 * parseSeconds / numCases << "us per case" << endl;
 	}
-	
-	foreach (string key in test.arbitraryKeys) {
-		if (!parameterMap.containsKey(key)) {
-			cout << "   Error: \"" << key << "\" should be in the map (with arbitrary value), but isn't." << endl;
-			pass = false;
-		}
+	for (int i = 0; i < numSlowest; i++) {
+		cout << "   " << 1e6 * ranked[i].first << "us: \""
+		     << run.corpus->getURL(ranked[i].second) << "\"" << endl;
 	}
-	
-	if (pass) {
-		cout << "   Passed!" << endl;
+}
+
+/**
+ * Tests every case in the corpus across all of the processors, printing
+ * the report on each case (or, if verbose is false, on each failing
+ * case) in corpus order, and then a summary of how fast it all went.
+ *
+ * @param TestCorpus& corpus the test cases to be run.
+ * @param bool verbose true to report on passing cases as well as failing ones.
+ * @return int the number of test cases that failed.
+ */
+
+int RunTestCorpus(TestCorpus& corpus, bool verbose) {
+	harnessRunT run;
+	run.corpus = &corpus;
+	run.verbose = verbose;
+	run.numShards = (corpus.size() + kShardSize - 1) / kShardSize;
+	run.nextShard = 0;
+	run.numFailures = 0;
+	run.nextShardToPrint = 0;
+	for (int i = 0; i < run.numShards; i++) {
+		run.pendingOutput.add("");
+		run.shardFinished.add(false);
 	}
-	
-	return pass;
+	run.parseTimes = new double[corpus.size() + 1];
+
+	int numThreads = std::thread::hardware_concurrency();
+	if (numThreads <= 0) numThreads = 1;
+	if (numThreads > run.numShards) numThreads = max(run.numShards, 1);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::thread *workers = new std::thread[numThreads];
+	for (int i = 1; i < numThreads; i++) {
+		workers[i] = std::thread(RunShards, &run);
+	}
+	RunShards(&run);
+	for (int i = 1; i < numThreads; i++) {
+		workers[i].join();
+	}
+	delete[] workers;
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	cout << endl;
+	PrintRunSummary(run, seconds, numThreads);
+	delete[] run.parseTimes;
+	return run.numFailures;
 }
 
 /**
@@ -182,17 +238,17 @@ bool testCasePasses(testCase& test) {
  * to exercise the functionality of our extractQueryMap
  * function.  Initially, most of the tests will fail, but as
  * you complete the implementation of the extractQueryMap, they should
- * start passing.
+ * start passing.  After the standard tests, it offers to run larger
+ * corpora: either an existing file in the same format, or a freshly
+ * generated one of however many cases you ask for.  Only the failing
+ * cases in those are reported.
  */
 
+static const string kGeneratedCorpusFile = "generated-test-cases.dat";
+
 int main() {
-	Vector<testCase> testCases = buildTestCases();
-	int numErrors = 0;
-	for (int i = 0; i < testCases.size(); i++) {
-		if (!testCasePasses(testCases[i])) {
-			numErrors++;
-		}
-	}
+	TestCorpus corpus("test-cases.dat");
+	int numErrors = RunTestCorpus(corpus, true);
 	
 	cout << endl;
 	if (numErrors == 0) {
@@ -201,6 +257,19 @@ int main() {
 		cout << "You had this many failures: " << numErrors << endl;
 	}
 	
+	while (true) {
+		cout << endl << "Corpus file, or number of cases to generate? [hit enter to quit]: ";
+		string response = GetLine();
+		if (response.empty()) break;
+		string filename = response;
+		if (response.find_first_not_of("0123456789") == string::npos) {
+			filename = kGeneratedCorpusFile;
+			GenerateTestCorpus(filename, StringToInteger(response));
+		}
+		TestCorpus largeCorpus(filename);
+		int numFailures = RunTestCorpus(largeCorpus, false);
+		cout << "Failures: " << numFailures << endl;
+	}
+	
 	return 0;
 }
-
@@ -0,0 +1,334 @@
+/**
+ * File: frequency-sketches.cpp
+ * ----------------------------
+ * Implements the HyperLogLog, CountMinSketch and SpaceSaving summaries
+ * exported by frequency-sketches.h.
+ */
+
+#include "genlib.h"
+#include "frequency-sketches.h"
+#include <algorithm>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Implementation notes: HashSketchItem
+ * ------------------------------------
+ * FNV-1a over the bytes, followed by the 64-bit finalizer from
+ * MurmurHash3.  FNV alone leaves the high bits poorly mixed for short
+ * strings, and HyperLogLog takes its register index from exactly those
+ * bits.
+ */
+
+uint64_t HashSketchItem(string_view text) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < text.size(); i++) {
+		hash ^= (unsigned char) text[i];
+		hash *= 1099511628211ULL;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/**
+ * Returns the number of leading zero bits in value, which must not
+ * be zero.
+ */
+
+static inline int LeadingZeros(uint64_t value) {
+#if defined(__GNUC__)
+	return __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return 63 - (int) index;
+#else
+	int count = 0;
+	while ((value & (1ULL << 63)) == 0) {
+		value <<= 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+HyperLogLog::HyperLogLog(int precision) {
+	if (precision < 4 || precision > 18) {
+		Error("HyperLogLog precision must be between 4 and 18");
+	}
+	this->precision = precision;
+}
+
+void HyperLogLog::allocateRegisters() {
+	registers.assign(1 << precision, 0);
+}
+
+/**
+ * Implementation notes: add
+ * -------------------------
+ * The top precision bits of the hash pick a register, and the register
+ * remembers the longest run of leading zeros seen in the remaining
+ * bits (plus one).  A marker bit below the remaining bits caps the run
+ * at 64 - precision, so LeadingZeros is never handed a zero.
+ */
+
+void HyperLogLog::add(string_view item) {
+	if (registers.empty()) allocateRegisters();
+	uint64_t hash = HashSketchItem(item);
+	int index = (int) (hash >> (64 - precision));
+	uint64_t rest = (hash << precision) | (1ULL << (precision - 1));
+	unsigned char rank = (unsigned char) (LeadingZeros(rest) + 1);
+	if (rank > registers[index]) registers[index] = rank;
+}
+
+/**
+ * Implementation notes: estimate
+ * ------------------------------
+ * This is the estimator from Flajolet et al., including their switch
+ * to linear counting over the empty registers when the raw estimate
+ * is small.  With 64-bit hashes no large-range correction is needed.
+ */
+
+long HyperLogLog::estimate() {
+	if (registers.empty()) return 0;
+	int numRegisters = registers.size();
+	double sum = 0;
+	int zeros = 0;
+	for (int i = 0; i < numRegisters; i++) {
+		sum += ldexp(1.0, -registers[i]);
+		if (registers[i] == 0) zeros++;
+	}
+	double alpha;
+	switch (numRegisters) {
+	  case 16: alpha = 0.673; break;
+	  case 32: alpha = 0.697; break;
+	  case 64: alpha = 0.709; break;
+	  default: alpha = 0.7213 / (1 + 1.079 / numRegisters); break;
+	}
+	double estimate = alpha * numRegisters * numRegisters / sum;
+	if (estimate <= 2.5 * numRegisters && zeros > 0) {
+		estimate = numRegisters * log(double(numRegisters) / zeros);
+	}
+	return (long) (estimate + 0.5);
+}
+
+void HyperLogLog::merge(HyperLogLog & other) {
+	if (precision != other.precision) {
+		Error("merge: HyperLogLogs have different precisions");
+	}
+	if (other.registers.empty()) return;
+	if (registers.empty()) {
+		registers = other.registers;
+		return;
+	}
+	for (size_t i = 0; i < registers.size(); i++) {
+		if (other.registers[i] > registers[i]) registers[i] = other.registers[i];
+	}
+}
+
+int HyperLogLog::memoryUsage() {
+	return registers.size();
+}
+
+/**
+ * Implementation notes: CountMinSketch
+ * ------------------------------------
+ * Rather than hashing each item once per row, the row hashes are
+ * derived from the two halves of a single 64-bit hash, as h1 + i * h2
+ * (Kirsch and Mitzenmacher), which preserves the sketch's error bounds.
+ */
+
+CountMinSketch::CountMinSketch(int width, int depth) {
+	if (width <= 0 || depth <= 0) Error("CountMinSketch dimensions must be positive");
+	this->width = 1;
+	while (this->width < width) this->width *= 2;
+	this->depth = depth;
+	total = 0;
+	counters.assign((size_t) this->width * depth, 0);
+}
+
+void CountMinSketch::add(string_view item, long count) {
+	uint64_t hash = HashSketchItem(item);
+	uint32_t h1 = (uint32_t) hash;
+	uint32_t h2 = (uint32_t) (hash >> 32) | 1;
+	for (int row = 0; row < depth; row++) {
+		counters[(size_t) row * width + ((h1 + row * h2) & (width - 1))] += count;
+	}
+	total += count;
+}
+
+long CountMinSketch::estimate(string_view item) {
+	uint64_t hash = HashSketchItem(item);
+	uint32_t h1 = (uint32_t) hash;
+	uint32_t h2 = (uint32_t) (hash >> 32) | 1;
+	long smallest = counters[h1 & (width - 1)];
+	for (int row = 1; row < depth; row++) {
+		long count = counters[(size_t) row * width + ((h1 + row * h2) & (width - 1))];
+		if (count < smallest) smallest = count;
+	}
+	return smallest;
+}
+
+long CountMinSketch::getTotal() {
+	return total;
+}
+
+void CountMinSketch::merge(CountMinSketch & other) {
+	if (width != other.width || depth != other.depth) {
+		Error("merge: CountMinSketches have different dimensions");
+	}
+	for (size_t i = 0; i < counters.size(); i++) {
+		counters[i] += other.counters[i];
+	}
+	total += other.total;
+}
+
+int CountMinSketch::memoryUsage() {
+	return counters.size() * sizeof(long);
+}
+
+/**
+ * Implementation notes: SpaceSaving
+ * ---------------------------------
+ * The counters are kept in a binary min-heap ordered by count, so the
+ * counter to be taken over is always heap[0], and slots maps each
+ * tracked item to its position in the heap.  Counts only ever grow, so
+ * an update only needs to sift the counter down.
+ */
+
+SpaceSaving::SpaceSaving(int capacity) {
+	if (capacity <= 0) Error("SpaceSaving capacity must be positive");
+	this->capacity = capacity;
+}
+
+long SpaceSaving::minimumCount() {
+	if ((int) heap.size() < capacity) return 0;
+	return heap[0].count;
+}
+
+void SpaceSaving::add(string_view item, long count) {
+	itemBuffer.assign(item.data(), item.size());
+	std::unordered_map<string, int>::iterator found = slots.find(itemBuffer);
+	if (found != slots.end()) {
+		int index = found->second;
+		heap[index].count += count;
+		siftDown(index);
+	} else if ((int) heap.size() < capacity) {
+		heavyHitterT entry = { itemBuffer, count, 0 };
+		heap.push_back(entry);
+		slots[itemBuffer] = heap.size() - 1;
+		siftUp(heap.size() - 1);
+	} else {
+		slots.erase(heap[0].item);
+		heap[0].error = heap[0].count;
+		heap[0].count += count;
+		heap[0].item = itemBuffer;
+		slots[itemBuffer] = 0;
+		siftDown(0);
+	}
+}
+
+static bool MoreFrequent(const heavyHitterT & one, const heavyHitterT & two) {
+	if (one.count != two.count) return one.count > two.count;
+	return one.item < two.item;
+}
+
+Vector<heavyHitterT> SpaceSaving::topK(int k) {
+	std::vector<heavyHitterT> sorted(heap);
+	std::sort(sorted.begin(), sorted.end(), MoreFrequent);
+	Vector<heavyHitterT> result;
+	for (int i = 0; i < k && i < (int) sorted.size(); i++) {
+		result.add(sorted[i]);
+	}
+	return result;
+}
+
+/**
+ * Implementation notes: merge
+ * ---------------------------
+ * This is the merge of Agarwal et al.: an item tracked by only one of
+ * the summaries may have occurred up to the other summary's minimum
+ * count times in the other stream without holding a counter there,
+ * so that minimum is added to both its count and its error.  The
+ * capacity largest combined counts are kept.
+ */
+
+void SpaceSaving::merge(SpaceSaving & other) {
+	if (capacity != other.capacity) {
+		Error("merge: SpaceSaving summaries have different capacities");
+	}
+	long ourMinimum = minimumCount();
+	long theirMinimum = other.minimumCount();
+	std::vector<heavyHitterT> combined;
+	for (size_t i = 0; i < heap.size(); i++) {
+		heavyHitterT entry = heap[i];
+		std::unordered_map<string, int>::iterator found = other.slots.find(entry.item);
+		if (found == other.slots.end()) {
+			entry.count += theirMinimum;
+			entry.error += theirMinimum;
+		} else {
+			entry.count += other.heap[found->second].count;
+			entry.error += other.heap[found->second].error;
+		}
+		combined.push_back(entry);
+	}
+	for (size_t i = 0; i < other.heap.size(); i++) {
+		if (slots.count(other.heap[i].item) != 0) continue;
+		heavyHitterT entry = other.heap[i];
+		entry.count += ourMinimum;
+		entry.error += ourMinimum;
+		combined.push_back(entry);
+	}
+	std::sort(combined.begin(), combined.end(), MoreFrequent);
+	if ((int) combined.size() > capacity) combined.resize(capacity);
+
+	heap.clear();
+	slots.clear();
+	for (int i = combined.size() - 1; i >= 0; i--) {
+		slots[combined[i].item] = heap.size();
+		heap.push_back(combined[i]);
+	}
+}
+
+int SpaceSaving::memoryUsage() {
+	int bytes = heap.capacity() * sizeof(heavyHitterT);
+	for (size_t i = 0; i < heap.size(); i++) {
+		bytes += 2 * heap[i].item.capacity() + sizeof(string) + 2 * sizeof(void *);
+	}
+	return bytes;
+}
+
+void SpaceSaving::siftUp(int index) {
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+		if (heap[parent].count <= heap[index].count) return;
+		swapEntries(index, parent);
+		index = parent;
+	}
+}
+
+void SpaceSaving::siftDown(int index) {
+	int size = heap.size();
+	while (true) {
+		int smallest = index;
+		int left = 2 * index + 1;
+		int right = left + 1;
+		if (left < size && heap[left].count < heap[smallest].count) smallest = left;
+		if (right < size && heap[right].count < heap[smallest].count) smallest = right;
+		if (smallest == index) return;
+		swapEntries(index, smallest);
+		index = smallest;
+	}
+}
+
+void SpaceSaving::swapEntries(int i, int j) {
+	std::swap(heap[i], heap[j]);
+	slots[heap[i].item] = i;
+	slots[heap[j].item] = j;
+}
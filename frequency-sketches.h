@@ -0,0 +1,242 @@
+/**
+ * File: frequency-sketches.h
+ * --------------------------
+ * Exports three fixed-size summaries of a stream of strings, for use
+ * when the stream is far too large to count exactly: a HyperLogLog
+ * estimates how many distinct strings there were, a CountMinSketch
+ * estimates how often any one string occurred, and a SpaceSaving
+ * summary keeps track of the most frequent strings.  Each summary uses
+ * the same amount of memory however long the stream gets, and two
+ * summaries built over different parts of a stream (by different
+ * threads, say) can be merged into the summary of the whole.
+ */
+
+#ifndef __frequency_sketches__
+#define __frequency_sketches__
+
+#include "genlib.h"
+#include "vector.h"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Returns a 64-bit hash of text whose bits are all well mixed, which
+ * the sketches below depend on.
+ *
+ * @param string_view text the string to be hashed.
+ * @return uint64_t the hash of text.
+ */
+
+uint64_t HashSketchItem(string_view text);
+
+/**
+ * Class: HyperLogLog
+ * ------------------
+ * Estimates the number of distinct strings added to it.  With a
+ * precision of p, the sketch keeps 2^p one-byte registers and its
+ * estimates have a standard error of about 1.04 / sqrt(2^p): the
+ * default of 12 uses 4KB and is typically within 2% of the true count.
+ * No registers are allocated until the first string is added, so an
+ * empty HyperLogLog is cheap to create and copy.
+ */
+
+static const int kDefaultHyperLogLogPrecision = 12;
+
+class HyperLogLog {
+public:
+
+/**
+ * Constructs an empty sketch with 2^precision registers.  Raises an
+ * error unless precision is between 4 and 18.
+ *
+ * @param int precision the base-2 log of the number of registers.
+ */
+	explicit HyperLogLog(int precision = kDefaultHyperLogLogPrecision);
+
+/**
+ * Adds a string to the sketch.  Adding a string that has already been
+ * added has no effect.
+ *
+ * @param string_view item the string to be added.
+ */
+	void add(string_view item);
+
+/**
+ * Returns the estimated number of distinct strings added so far.
+ *
+ * @return long the estimated distinct count.
+ */
+	long estimate();
+
+/**
+ * Folds other into this sketch, so that it estimates the number of
+ * distinct strings added to either one.  Raises an error if the two
+ * have different precisions.
+ *
+ * @param HyperLogLog& other the sketch to be merged in.
+ */
+	void merge(HyperLogLog & other);
+
+/**
+ * Returns the number of bytes of register storage the sketch uses.
+ *
+ * @return int the sketch's size, in bytes.
+ */
+	int memoryUsage();
+
+private:
+	int precision;
+	std::vector<unsigned char> registers;
+
+	void allocateRegisters();
+};
+
+/**
+ * Class: CountMinSketch
+ * ---------------------
+ * Estimates how many times each string has been added.  The sketch
+ * is a depth-by-width table of counters; each string bumps one counter
+ * per row, and its estimate is the smallest of those counters.  The
+ * estimate is never too low, and is too high by at most 2/width of
+ * the total count with probability 1 - (1/2)^depth.
+ */
+
+class CountMinSketch {
+public:
+
+/**
+ * Constructs an empty sketch.  width is rounded up to a power of two.
+ *
+ * @param int width the number of counters per row.
+ * @param int depth the number of rows.
+ */
+	explicit CountMinSketch(int width = 8192, int depth = 4);
+
+/**
+ * Adds count occurrences of item to the sketch.
+ *
+ * @param string_view item the string that occurred.
+ * @param long count the number of times it occurred.
+ */
+	void add(string_view item, long count = 1);
+
+/**
+ * Returns the estimated number of times item has been added.
+ *
+ * @param string_view item the string of interest.
+ * @return long an upper bound on its count.
+ */
+	long estimate(string_view item);
+
+/**
+ * Returns the total of all the counts added so far.
+ *
+ * @return long the sum of every count passed to add.
+ */
+	long getTotal();
+
+/**
+ * Folds other into this sketch.  Raises an error if the two have
+ * different dimensions.
+ *
+ * @param CountMinSketch& other the sketch to be merged in.
+ */
+	void merge(CountMinSketch & other);
+
+/**
+ * Returns the number of bytes of counter storage the sketch uses.
+ *
+ * @return int the sketch's size, in bytes.
+ */
+	int memoryUsage();
+
+private:
+	int width;
+	int depth;
+	long total;
+	std::vector<long> counters;
+};
+
+/**
+ * Type: heavyHitterT
+ * ------------------
+ * One of the most frequent strings reported by a SpaceSaving summary.
+ * The true count lies between count - error and count.
+ */
+
+struct heavyHitterT {
+	string item;
+	long count;
+	long error;
+};
+
+/**
+ * Class: SpaceSaving
+ * ------------------
+ * Tracks the most frequent strings in a stream using a fixed number of
+ * counters.  When a string without a counter arrives and every counter
+ * is in use, it takes over the counter with the smallest count, and
+ * inherits that count as its possible overestimate.  Any string that
+ * makes up more than 1/capacity of the stream is guaranteed to hold a
+ * counter.
+ */
+
+class SpaceSaving {
+public:
+
+/**
+ * Constructs an empty summary with the given number of counters.
+ *
+ * @param int capacity the number of strings that can be tracked at once.
+ */
+	explicit SpaceSaving(int capacity = 32);
+
+/**
+ * Adds count occurrences of item to the summary.
+ *
+ * @param string_view item the string that occurred.
+ * @param long count the number of times it occurred.
+ */
+	void add(string_view item, long count = 1);
+
+/**
+ * Returns up to k of the tracked strings, most frequent first.
+ *
+ * @param int k the number of strings wanted.
+ * @return Vector<heavyHitterT> the strings, with their counts and error bounds.
+ */
+	Vector<heavyHitterT> topK(int k);
+
+/**
+ * Folds other into this summary, so that it describes both streams.
+ * The merged counts keep the guarantee of the class: each reported
+ * count is an upper bound, and each error bounds its overestimate.
+ * Raises an error if the two have different capacities.
+ *
+ * @param SpaceSaving& other the summary to be merged in.
+ */
+	void merge(SpaceSaving & other);
+
+/**
+ * Returns the approximate number of bytes the summary uses, including
+ * the tracked strings themselves.
+ *
+ * @return int the summary's size, in bytes.
+ */
+	int memoryUsage();
+
+private:
+	int capacity;
+	std::vector<heavyHitterT> heap;
+	std::unordered_map<string, int> slots;
+	string itemBuffer;
+
+	long minimumCount();
+	void siftUp(int index);
+	void siftDown(int index);
+	void swapEntries(int i, int j);
+};
+
+#endif
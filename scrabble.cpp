@@ -45,12 +45,76 @@ bool CanFormWord(string word, Map<int>& masterHistogram) {
 	return false;
 }
 
+/**
+ * Type: wordSearch
+ * ----------------
+ * The state each worker thread carries while ListAllWords scans
+ * the lexicon: its own copy of the rack's histogram, and the words
+ * it has found so far.
+ */
+
+struct wordSearch {
+	Map<int> histogram;
+	Vector<string> words;
+};
+
+/**
+ * Called by Lexicon::parallelMapAll once per word in the lexicon;
+ * records the word if it's long enough and can be formed from the
+ * letters in the search's histogram.
+ *
+ * @param const string& word the word being considered.
+ * @param wordSearch& search the calling thread's search state.
+ * @return void
+ */
+
+static void AddIfFormable(const string& word, wordSearch& search) {
+	if (word.size() >= kMinWordLength && CanFormWord(word, search.histogram)) {
+		search.words.add(word);
+	}
+}
+
+/**
+ * Folds the words found by one slice of the lexicon scan into the
+ * overall result.  Each slice's words are in alphabetical order, and
+ * so far the result is too, so the two lists are merged.  The slices
+ * of the DAWG arrive in order and are simply appended, but words added
+ * to the lexicon outside the DAWG come in a slice of their own at the
+ * end and may belong anywhere in the list.
+ *
+ * @param wordSearch& all the accumulated result.
+ * @param wordSearch& part the result for one slice of the lexicon.
+ * @return void
+ */
+
+static void AppendWords(wordSearch& all, wordSearch& part) {
+	if (part.words.isEmpty()) return;
+	if (all.words.isEmpty() || all.words[all.words.size() - 1] < part.words[0]) {
+		for (int i = 0; i < part.words.size(); i++) {
+			all.words.add(part.words[i]);
+		}
+		return;
+	}
+	Vector<string> merged(all.words.size() + part.words.size());
+	int i = 0, j = 0;
+	while (i < all.words.size() || j < part.words.size()) {
+		if (j == part.words.size() || (i < all.words.size() && all.words[i] < part.words[j])) {
+			merged.add(all.words[i++]);
+		} else {
+			merged.add(part.words[j++]);
+		}
+	}
+	all.words = merged;
+}
+
 /**
  * Given the specified rack of letters (duplicates allowed) and
  * the provided English lexicon, alphebatically list all words
  * that can be formed using some or all of the letters.  The algorithm
  * is intended to be brute force and the simply count letters in any
  * given word, and if we have them in our letter rack, to print it out.
+ * The brute force scan is spread across all cores with parallelMapAll,
+ * and the words are printed once the scan is done.
  *
  * @param string letters the list of letters on your Scrabble rack.
  * @param Lexicon& english a reference to a Lexicon, already populated with
@@ -59,20 +123,16 @@ bool CanFormWord(string word, Map<int>& masterHistogram) {
  */
 
 void ListAllWords(string letters, Lexicon& english) {
-	Map<int> histogram = BuildLetterHistogram(letters);
-	int numFound = 0;
-	foreach (string word in english) {
-		if (word.size() >= kMinWordLength && CanFormWord(word, histogram)) {
-			if (numFound == 0) {
-				cout << "You can form these words: " << endl;
-			}
-			numFound++;
-			cout << "  " << numFound << ".) " << word << endl;
-		}
-	}
-
-	if (numFound == 0) {
+	wordSearch search;
+	search.histogram = BuildLetterHistogram(letters);
+	english.parallelMapAll(AddIfFormable, search, AppendWords);
+	if (search.words.isEmpty()) {
 		cout << "Sorry, but we can't make any words out of those letters." << endl; 
+	} else {
+		cout << "You can form these words: " << endl;
+		for (int i = 0; i < search.words.size(); i++) {
+			cout << "  " << (i + 1) << ".) " << search.words[i] << endl;
+		}
 	}
 	
 	cout << endl;
@@ -0,0 +1,279 @@
+/**
+ * File: test-corpus.cpp
+ * ---------------------
+ * Implements the TestCorpus loader and the synthetic corpus generator
+ * exported by test-corpus.h.
+ */
+
+#include "genlib.h"
+#include "test-corpus.h"
+#include "delimiter-scan.h"
+#include "random.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Type: lineCursorT
+ * -----------------
+ * Walks the lines of a run of text, using a DelimiterScanner to find
+ * the line breaks.  pos is the start of the next line to be returned.
+ */
+
+struct lineCursorT {
+	const char *pos;
+	const char *end;
+	DelimiterScanner scanner;
+
+	lineCursorT(const char *start, const char *end)
+		: pos(start), end(end), scanner(string_view(start, end - start), "\n") {}
+};
+
+/**
+ * Sets line to the next line under the cursor, without its line break
+ * (or a carriage return before it), and returns true; or returns false
+ * if there are no lines left.  The last line need not end in a newline.
+ */
+
+static bool NextLine(lineCursorT & cursor, string_view & line) {
+	if (cursor.pos >= cursor.end) return false;
+	const char *newline = cursor.scanner.nextDelimiter();
+	const char *lineEnd = (newline == NULL) ? cursor.end : newline;
+	const char *next = (newline == NULL) ? cursor.end : newline + 1;
+	if (lineEnd > cursor.pos && lineEnd[-1] == '\r') lineEnd--;
+	line = string_view(cursor.pos, lineEnd - cursor.pos);
+	cursor.pos = next;
+	return true;
+}
+
+/**
+ * Reads the next line as a nonnegative count and returns it, or
+ * returns -1 if there is no next line or it isn't a number.
+ */
+
+static int NextCount(lineCursorT & cursor) {
+	string_view line;
+	if (!NextLine(cursor, line) || line.empty() || line.size() > 9) return -1;
+	int count = 0;
+	for (size_t i = 0; i < line.size(); i++) {
+		if (line[i] < '0' || line[i] > '9') return -1;
+		count = count * 10 + (line[i] - '0');
+	}
+	return count;
+}
+
+/**
+ * Skips over numLines lines, returning false if the text runs out
+ * first.
+ */
+
+static bool SkipLines(lineCursorT & cursor, int numLines) {
+	string_view line;
+	for (int i = 0; i < numLines; i++) {
+		if (!NextLine(cursor, line)) return false;
+	}
+	return true;
+}
+
+TestCorpus::TestCorpus(string filename) {
+	mapFile(filename);
+	buildIndex();
+}
+
+TestCorpus::~TestCorpus() {
+	unmapFile();
+}
+
+int TestCorpus::size() {
+	return caseOffsets.size();
+}
+
+#ifdef _WIN32
+
+void TestCorpus::mapFile(string filename) {
+	contents = "";
+	length = 0;
+	mapping = NULL;
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+	                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) Error("TestCorpus: can't open " + filename);
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	if (fileSize.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL) {
+			contents = (const char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+		if (mapping == NULL || contents == NULL) {
+			CloseHandle(file);
+			Error("TestCorpus: can't map " + filename);
+		}
+		length = (size_t) fileSize.QuadPart;
+	}
+	CloseHandle(file);
+}
+
+void TestCorpus::unmapFile() {
+	if (mapping == NULL) return;
+	UnmapViewOfFile(contents);
+	CloseHandle(mapping);
+}
+
+#else
+
+void TestCorpus::mapFile(string filename) {
+	contents = "";
+	length = 0;
+	mapping = NULL;
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) Error("TestCorpus: can't open " + filename);
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			close(fd);
+			Error("TestCorpus: can't map " + filename);
+		}
+		contents = (const char *) mapping;
+		length = info.st_size;
+	}
+	close(fd);
+}
+
+void TestCorpus::unmapFile() {
+	if (mapping != NULL) munmap(mapping, length);
+}
+
+#endif
+
+/**
+ * Implementation notes: buildIndex
+ * --------------------------------
+ * The index is built by walking the file once, using the two counts in
+ * each case to skip over its keys and values without looking at them.
+ * A case whose counts are missing or promise more lines than the file
+ * holds is an error, since everything after it would be misread.
+ */
+
+void TestCorpus::buildIndex() {
+	lineCursorT cursor(contents, contents + length);
+	while (cursor.pos < cursor.end) {
+		size_t offset = cursor.pos - contents;
+		int numPairs;
+		int numArbitraryKeys;
+		if (!SkipLines(cursor, 1)
+		    || (numPairs = NextCount(cursor)) < 0
+		    || !SkipLines(cursor, 2 * numPairs)
+		    || (numArbitraryKeys = NextCount(cursor)) < 0
+		    || !SkipLines(cursor, numArbitraryKeys)) {
+			unmapFile();
+			Error("TestCorpus: test case " + IntegerToString(caseOffsets.size() + 1)
+			      + " is malformed");
+		}
+		caseOffsets.add(offset);
+	}
+}
+
+string_view TestCorpus::getURL(int index) {
+	if (index < 0 || index >= caseOffsets.size()) {
+		Error("TestCorpus::getURL: index out of range");
+	}
+	lineCursorT cursor(contents + caseOffsets[index], contents + length);
+	string_view url;
+	NextLine(cursor, url);
+	return url;
+}
+
+testCase TestCorpus::getCase(int index) {
+	if (index < 0 || index >= caseOffsets.size()) {
+		Error("TestCorpus::getCase: index out of range");
+	}
+	lineCursorT cursor(contents + caseOffsets[index], contents + length);
+	string_view url, key, value;
+	NextLine(cursor, url);
+	testCase test;
+	test.url = string(url);
+	test.numParams = 0;
+	int numPairs = NextCount(cursor);
+	for (int i = 0; i < numPairs; i++) {
+		NextLine(cursor, key);
+		NextLine(cursor, value);
+		test.fullKeyValuePairs.put(string(key), string(value));
+		test.numParams++;
+	}
+	int numArbitraryKeys = NextCount(cursor);
+	for (int j = 0; j < numArbitraryKeys; j++) {
+		NextLine(cursor, key);
+		test.arbitraryKeys.add(string(key));
+		test.numParams++;
+	}
+	return test;
+}
+
+/**
+ * Returns a random run of lowercase letters and digits whose length
+ * is between minLength and maxLength.
+ */
+
+static string RandomToken(int minLength, int maxLength) {
+	static const string kAlphabet = "abcdefghijklmnopqrstuvwxyz0123456789";
+	string token;
+	int length = RandomInteger(minLength, maxLength);
+	for (int i = 0; i < length; i++) {
+		token += kAlphabet[RandomInteger(0, kAlphabet.size() - 1)];
+	}
+	return token;
+}
+
+/**
+ * Implementation notes: GenerateTestCorpus
+ * ----------------------------------------
+ * Each key gets its position in the URL as a suffix, which keeps the
+ * keys in a URL distinct.  Keys with arbitrary values are written
+ * either bare ("?debug") or with an empty value ("?debug="), both of
+ * which extractQueryMap maps to "true".  Some values carry an '=' or a
+ * percent escape, which must come back verbatim.
+ */
+
+void GenerateTestCorpus(string filename, int numCases, int seed) {
+	FILE *out = fopen(filename.c_str(), "wb");
+	if (out == NULL) Error("GenerateTestCorpus: can't write " + filename);
+	SetRandomSeed(seed);
+	string url, pairs, arbitraryKeys;
+	for (int i = 0; i < numCases; i++) {
+		url = "http://www." + RandomToken(3, 12) + ".com/" + RandomToken(0, 16);
+		pairs.clear();
+		arbitraryKeys.clear();
+		int numParams = RandomChance(0.05) ? 0 : RandomInteger(1, 10);
+		int numPairs = 0;
+		int numArbitraryKeys = 0;
+		for (int j = 0; j < numParams; j++) {
+			string key = RandomToken(1, 8) + IntegerToString(j);
+			url += (j == 0) ? '?' : '&';
+			url += key;
+			if (RandomChance(0.75)) {
+				string value = RandomToken(1, 16);
+				if (RandomChance(0.05)) value += "%20" + RandomToken(1, 4);
+				if (RandomChance(0.02)) value += "=" + RandomToken(1, 4);
+				url += "=" + value;
+				pairs += key + "\n" + value + "\n";
+				numPairs++;
+			} else {
+				if (RandomChance(0.5)) url += "=";
+				arbitraryKeys += key + "\n";
+				numArbitraryKeys++;
+			}
+		}
+		if (RandomChance(0.1)) url += "#" + RandomToken(1, 10);
+		fprintf(out, "%s\n%d\n%s%d\n%s", url.c_str(), numPairs, pairs.c_str(),
+		        numArbitraryKeys, arbitraryKeys.c_str());
+	}
+	fclose(out);
+}
@@ -0,0 +1,127 @@
+/**
+ * File: test-corpus.h
+ * -------------------
+ * Exports a loader for extractQueryMap test corpora (files in the
+ * format of test-cases.dat) that can cope with corpora of millions of
+ * cases.  Rather than reading every case into memory up front, the
+ * TestCorpus maps the file into memory, records where each case starts
+ * in a single pass, and only builds a testCase when one is asked for.
+ * A generator for large synthetic corpora is exported as well.
+ */
+
+#ifndef __test_corpus__
+#define __test_corpus__
+
+#include "genlib.h"
+#include "map.h"
+#include "set.h"
+#include "vector.h"
+#include "disallowcopy.h"
+#include <cstddef>
+#include <string_view>
+
+/**
+ * Type: testCase
+ * --------------
+ * Encapsulates all of the data we need for a particular test case.
+ * A properly implemeted extractQueryMap will analyze the .url
+ * to find a total of .numParams.  Those parameters with specific
+ * values can be found in .fullKeyValuePairs, and those with arbitrary
+ * values can be found in .arbitraryKeys.
+ */
+
+struct testCase {
+	string url;
+	int numParams;
+	Map<string> fullKeyValuePairs;
+	Set<string> arbitraryKeys;
+};
+
+/**
+ * Class: TestCorpus
+ * -----------------
+ * A read-only view of a test corpus file.  Each case in the file is a
+ * URL on a line of its own, then the number of key/value pairs followed
+ * by a line for each key and each value, then the number of keys with
+ * arbitrary values followed by a line for each key:
+ *
+ *     TestCorpus corpus("test-cases.dat");
+ *     for (int i = 0; i < corpus.size(); i++) {
+ *         testCase test = corpus.getCase(i);
+ *         . . .
+ *     }
+ *
+ * The file stays mapped for the life of the corpus, and the only
+ * memory the corpus itself allocates is one offset per case.  A
+ * TestCorpus can be read from several threads at once.
+ */
+
+class TestCorpus {
+public:
+
+/**
+ * Maps the named corpus file into memory and indexes it.  Raises an
+ * error if the file can't be opened or isn't well formed.
+ *
+ * @param string filename the name of the corpus file.
+ */
+	explicit TestCorpus(string filename = "test-cases.dat");
+
+/**
+ * Unmaps the corpus file.
+ */
+	~TestCorpus();
+
+/**
+ * Returns the number of test cases in the corpus.
+ *
+ * @return int the number of test cases.
+ */
+	int size();
+
+/**
+ * Returns the URL of the test case at the given index, as a view into
+ * the mapped file, without building the rest of the case.
+ *
+ * @param int index the index of the test case, from 0 to size() - 1.
+ * @return string_view the URL being tested.
+ */
+	string_view getURL(int index);
+
+/**
+ * Builds and returns the test case at the given index.  Raises an
+ * error if index is out of range.
+ *
+ * @param int index the index of the test case, from 0 to size() - 1.
+ * @return testCase the test case, rehydrated from the corpus file.
+ */
+	testCase getCase(int index);
+
+private:
+	const char *contents;
+	size_t length;
+	Vector<size_t> caseOffsets;
+	void *mapping;
+
+	void mapFile(string filename);
+	void unmapFile();
+	void buildIndex();
+
+	DISALLOW_COPYING(TestCorpus)
+};
+
+/**
+ * Writes a synthetic corpus of numCases test cases to the named file.
+ * The URLs vary in host, path, number of parameters, the presence of
+ * a fragment, and the mix of keys with and without values; every key
+ * in a URL is distinct, so the expected map is unambiguous.  The same
+ * seed always produces the same corpus.
+ *
+ * @param string filename the name of the file to be written.
+ * @param int numCases the number of test cases to generate.
+ * @param int seed the seed for the random number generator.
+ */
+
+void GenerateTestCorpus(string filename, int numCases, int seed = 106);
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * File: url-query.cpp
+ * -------------------
+ * Implements the query string tokenizer, the percent-decoding
+ * helpers, and the extractQueryMap wrapper exported by url-query.h.
+ */
+
+#include "genlib.h"
+#include "url-query.h"
+
+/**
+ * Returns the portion of url after its first '?', or a view with a NULL
+ * data pointer if there is no '?' at all.  (A URL that ends in '?' has
+ * an empty query, which is not the same thing.)
+ */
+
+static string_view FindQuery(string_view url) {
+	DelimiterScanner scanner(url, "?");
+	const char *question = scanner.nextDelimiter();
+	if (question == NULL) return string_view();
+	return string_view(question + 1, url.data() + url.size() - question - 1);
+}
+
+QueryTokenizer::QueryTokenizer(string_view url)
+	: query(FindQuery(url)), scanner(query, "&=#") {
+	cur = query.data();
+	done = (cur == NULL);
+}
+
+bool QueryTokenizer::hasNext() {
+	return !done;
+}
+
+/**
+ * Implementation notes: next
+ * --------------------------
+ * The scanner reports every '&', '=' and '#' in the query.  The first
+ * '=' seen before the next '&' splits the key from the value; any later
+ * ones are part of the value.  Reaching '#' or the end of the query
+ * means this is the last pair; otherwise cur moves just past the '&'.
+ */
+
+queryParameter QueryTokenizer::next() {
+	if (done) Error("Attempt to get next from tokenizer where hasNext() is false");
+	const char *pairStart = cur;
+	const char *equals = NULL;
+	const char *delim;
+	while ((delim = scanner.nextDelimiter()) != NULL && *delim == '=') {
+		if (equals == NULL) equals = delim;
+	}
+	const char *pairEnd = (delim == NULL) ? query.data() + query.size() : delim;
+	if (delim == NULL || *delim == '#') {
+		done = true;
+	} else {
+		cur = delim + 1;
+	}
+	queryParameter param;
+	if (equals == NULL) {
+		param.key = string_view(pairStart, pairEnd - pairStart);
+	} else {
+		param.key = string_view(pairStart, equals - pairStart);
+		param.value = string_view(equals + 1, pairEnd - equals - 1);
+	}
+	return param;
+}
+
+/**
+ * Returns the value of the hexadecimal digit ch, or -1 if ch
+ * isn't one.
+ */
+
+static int HexDigitValue(char ch) {
+	if (ch >= '0' && ch <= '9') return ch - '0';
+	if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+	return -1;
+}
+
+bool NeedsDecoding(string_view encoded) {
+	for (size_t i = 0; i < encoded.size(); i++) {
+		if (encoded[i] == '%' || encoded[i] == '+') return true;
+	}
+	return false;
+}
+
+void DecodeQueryComponent(string_view encoded, string& decoded) {
+	decoded.clear();
+	for (size_t i = 0; i < encoded.size(); i++) {
+		char ch = encoded[i];
+		if (ch == '+') {
+			ch = ' ';
+		} else if (ch == '%' && i + 2 < encoded.size()) {
+			int high = HexDigitValue(encoded[i + 1]);
+			int low = HexDigitValue(encoded[i + 2]);
+			if (high >= 0 && low >= 0) {
+				ch = (char) (high * 16 + low);
+				i += 2;
+			}
+		}
+		decoded += ch;
+	}
+}
+
+string DecodeQueryComponent(string_view encoded) {
+	string decoded;
+	DecodeQueryComponent(encoded, decoded);
+	return decoded;
+}
+
+QueryMap extractQueryMap(const string& url) {
+	QueryMap parameters;
+	QueryTokenizer tokenizer(url);
+	while (tokenizer.hasNext()) {
+		queryParameter param = tokenizer.next();
+		string& value = parameters[string(param.key)];
+		if (param.value.empty()) {
+			value = "true";
+		} else {
+			value.assign(param.value.data(), param.value.size());
+		}
+	}
+	return parameters;
+}
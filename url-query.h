@@ -0,0 +1,140 @@
+/**
+ * File: url-query.h
+ * -----------------
+ * Exports a tokenizer that walks the query portion of a URL in place,
+ * handing back each key and value as a string_view into the original
+ * URL so that no strings are built unless the client asks for them.
+ * Percent-decoding is likewise left to the client, to be applied only
+ * to the keys and values that are actually of interest.
+ */
+
+#ifndef __url_query__
+#define __url_query__
+
+#include "genlib.h"
+#include "map.h"
+#include "delimiter-scan.h"
+#include <string_view>
+
+/**
+ * Type: queryParameter
+ * --------------------
+ * One key/value pair from a query string.  Both fields point into the
+ * URL the tokenizer was given, so they are only valid as long as
+ * that URL is.  The value is empty for a key with no '=' ("?debug")
+ * and for one with nothing after it ("?debug=").
+ */
+
+struct queryParameter {
+	string_view key;
+	string_view value;
+};
+
+/**
+ * Class: QueryTokenizer
+ * ---------------------
+ * Iterates over the parameters in a URL's query string: the text after
+ * the first '?' and before any '#' that follows it.  Pairs are split on
+ * '&' and each pair is split on its first '='.  Empty pairs (as in
+ * "?a=1&&b=2" or a bare "?") come back as a parameter with an empty key,
+ * matching what the Explode-based implementation produced.
+ *
+ *     QueryTokenizer tokenizer(url);
+ *     while (tokenizer.hasNext()) {
+ *         queryParameter param = tokenizer.next();
+ *         . . .
+ *     }
+ *
+ * The whole query is scanned exactly once, by a DelimiterScanner that
+ * stops only at '&', '=' and '#', and the tokenizer never allocates
+ * memory.
+ */
+
+class QueryTokenizer {
+public:
+
+/**
+ * Constructs a tokenizer over the query string of the given URL, which
+ * must outlive the tokenizer and any parameters it returns.
+ *
+ * @param string_view url the URL whose query string is tokenized.
+ */
+	explicit QueryTokenizer(string_view url);
+
+/**
+ * Returns true if and only if there is another parameter to be
+ * returned by next.
+ *
+ * @return bool true if next may be called, false otherwise.
+ */
+	bool hasNext();
+
+/**
+ * Returns the next parameter in the query string.  Raises an error
+ * if hasNext() is false.
+ *
+ * @return queryParameter the key and value of the next parameter.
+ */
+	queryParameter next();
+
+private:
+	string_view query;
+	DelimiterScanner scanner;
+	const char *cur;
+	bool done;
+};
+
+/**
+ * Percent-decodes the provided key or value from a query string,
+ * replacing each %XX escape with the byte it names and each '+' with a
+ * space.  Malformed escapes are copied through unchanged.  The second
+ * form writes into a caller-supplied string, which lets a loop reuse
+ * the same buffer instead of allocating a new string per call.
+ *
+ * @param string_view encoded the text to be decoded.
+ * @param string& decoded the string that receives the decoded text;
+ *        any previous contents are replaced.
+ * @return string the decoded text.
+ */
+
+string DecodeQueryComponent(string_view encoded);
+void DecodeQueryComponent(string_view encoded, string& decoded);
+
+/**
+ * Returns true if and only if the provided key or value contains any
+ * characters that DecodeQueryComponent would change, so that a client
+ * can skip decoding (and copying) in the common case.
+ *
+ * @param string_view encoded the text to be checked.
+ * @return bool true if decoding would change the text.
+ */
+
+bool NeedsDecoding(string_view encoded);
+
+/**
+ * Type: QueryMap
+ * --------------
+ * The map extractQueryMap returns.  Almost every URL has only a handful
+ * of parameters, so the map keeps up to kInlineQueryParameters of them
+ * inside the map object and never builds a hashtable for them.
+ */
+
+static const int kInlineQueryParameters = 16;
+typedef Map<string, kInlineQueryParameters> QueryMap;
+
+/**
+ * Returns the URL's parameter map: each key in the query string maps
+ * to its value, or to "true" if it has no value (or an empty one).
+ * If a key appears more than once, the last value wins.  Keys and
+ * values are stored exactly as they appear in the URL, without
+ * percent-decoding.  This is the convenience wrapper around
+ * QueryTokenizer; clients that only need to look at the parameters
+ * should use the tokenizer directly and skip building the map.
+ *
+ * @param const string& url the well-formed URL whose parameter map is of interest to us.
+ * @return QueryMap the URL's parameter map, in QueryMap form.
+ */
+
+QueryMap extractQueryMap(const string& url);
+
+#endif